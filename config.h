@@ -34,6 +34,9 @@
  */
 #define SERVER_URL "http://192.168.1.100:8080/data"  /**< Server endpoint URL */
 #define DATA_INTERVAL_MS 30000                        /**< Data transmission interval in milliseconds */
+#define SERVER_BATCH_URL "http://192.168.1.100:8080/api/data/batch" /**< Batch upload endpoint (duty-cycle mode) */
+#define SERVER_URGENT_URL "http://192.168.1.100:8080/api/data/urgent" /**< Anomaly report endpoint (duty-cycle mode) */
+#define NTP_SERVER "pool.ntp.org"                     /**< SNTP server used to set the clock */
 
 /**
  * @brief I2C Configuration for AHT10 Sensors
@@ -44,11 +47,38 @@
 #define I2C_MASTER_SCL_IO            GPIO_NUM_22      /**< I2C SCL pin */
 #define I2C_MASTER_SDA_IO            GPIO_NUM_21      /**< I2C SDA pin */
 #define I2C_MASTER_NUM               I2C_NUM_0        /**< I2C port number */
-#define I2C_MASTER_FREQ_HZ           100000           /**< I2C master clock frequency in Hz */
+#define I2C_MASTER_FREQ_HZ           100000           /**< Base I2C clock (probes, devices without a faster setting) */
+#define I2C_FAST_MODE_FREQ_HZ        400000           /**< Fast-mode clock for devices that support it */
+#define I2C_BUS_SPEED_PROBES         3                /**< Probes a device must answer to run at a faster clock */
 #define I2C_MASTER_TX_BUF_DISABLE   0                /**< I2C master TX buffer disable flag */
 #define I2C_MASTER_RX_BUF_DISABLE   0                /**< I2C master RX buffer disable flag */
 #define I2C_MASTER_TIMEOUT_MS        1000             /**< I2C master timeout in milliseconds */
 
+/**
+ * @brief I2C Discovery Configuration
+ * 
+ * These constants bound the cost of I2C scans. A probe that times out
+ * means the bus itself is not responding, so a scan stops after a few.
+ */
+#define I2C_SCAN_PROBE_TIMEOUT_MS    5                /**< Per-address probe timeout in milliseconds */
+#define I2C_SCAN_MAX_TIMEOUTS        3                /**< Consecutive probe timeouts before a scan is aborted */
+#define I2C_HOTPLUG_RESCAN_CYCLES    10               /**< Monitoring cycles between incremental rescans (0 = never) */
+
+/**
+ * @brief I2C Bus Recovery Configuration
+ * 
+ * Each transaction gets a deadline of the base time plus its transfer
+ * time times the margin. Devices that keep failing are quarantined with
+ * an exponential backoff so they cannot stall the monitoring cycle.
+ */
+#define I2C_BUS_DEADLINE_BASE_MS     2                /**< Fixed part of a transaction deadline in milliseconds */
+#define I2C_BUS_DEADLINE_MARGIN      4                /**< Multiplier applied to the nominal transfer time */
+#define I2C_BUS_RECOVERY_HALF_PERIOD_US 5             /**< SCL half period of the 9-clock recovery sequence */
+#define I2C_BUS_BREAKER_THRESHOLD    3                /**< Consecutive failures before a device is quarantined */
+#define I2C_BUS_BREAKER_BACKOFF_MS   30000            /**< First quarantine period in milliseconds */
+#define I2C_BUS_BREAKER_MAX_BACKOFF_MS 600000         /**< Longest quarantine period in milliseconds */
+#define I2C_BUS_MAX_DEVICES          16               /**< Devices tracked for clock speed and circuit breaker */
+
 /**
  * @brief AHT10 Sensor Addresses
  * 
@@ -58,6 +88,38 @@
 #define AHT10_SENSOR_1_ADDR          0x38             /**< First AHT10 sensor address */
 #define AHT10_SENSOR_2_ADDR          0x39             /**< Second AHT10 sensor address */
 
+/**
+ * @brief I2C Multiplexer Address
+ * 
+ * Address of the first TCA9548A multiplexer (A0-A2 low). Sensors with
+ * the same fixed address are placed on separate multiplexer channels by
+ * setting mux_address and mux_channel in their sensor_config_t.
+ */
+#define TCA9548A_MUX_ADDR            0x70             /**< First TCA9548A multiplexer address */
+
+/**
+ * @brief Sensor Registry Configuration
+ * 
+ * Number of sensor slots reserved in the sensor registry. Every slot
+ * costs about 32 bytes of RAM for metadata and readings, so override this
+ * (e.g. -DSENSOR_REGISTRY_CAPACITY=4) to fit the node. At most 32.
+ */
+#ifndef SENSOR_REGISTRY_CAPACITY
+#define SENSOR_REGISTRY_CAPACITY     24               /**< Maximum number of configured sensors */
+#endif
+
+/**
+ * @brief Sensor Topology Configuration
+ * 
+ * When set, the node's sensors are declared as a C++ type list in
+ * main.cpp and read and scored through code generated for exactly that
+ * hardware (see sensor_topology.h). When cleared, the runtime sensor
+ * table and sensor_interface_read_all() are used.
+ */
+#ifndef SENSOR_TOPOLOGY_STATIC
+#define SENSOR_TOPOLOGY_STATIC       1                /**< Use the compile-time sensor topology */
+#endif
+
 /**
  * @brief Pin Assignments
  * 
@@ -84,6 +146,256 @@
 #define WIFI_TIMEOUT_MS 10000            /**< WiFi connection timeout in milliseconds */
 #define DATA_TRANSMISSION_TIMEOUT_MS 5000 /**< Data transmission timeout in milliseconds */
 
+/**
+ * @brief Diagnostics Configuration
+ *
+ * These constants control the on-device event trace. Trace events are
+ * recorded into a fixed-size RAM ring and dumped over the console for
+ * conversion with tools/trace_to_chrome.py.
+ */
+#define TRACE_ENABLED 1                  /**< Compile in trace instrumentation (0 removes it) */
+#define TRACE_BUFFER_EVENTS 512          /**< Trace ring capacity in events (8 bytes each) */
+#define TRACE_DUMP_INTERVAL_CYCLES 0     /**< Dump the trace every N monitoring cycles (0 = never) */
+
+/**
+ * @brief Deferred Logging Configuration
+ *
+ * These constants control the tokenized log backend used on the sampling
+ * path. With DLOG_BINARY_OUTPUT set, records are printed as compact
+ * tokens and formatted on the host with tools/dlog_decode.py.
+ */
+#define DLOG_ENABLED 1                   /**< Defer formatting to a background task (0 = synchronous) */
+#define DLOG_BUFFER_SIZE 2048            /**< Log ring size in bytes */
+#define DLOG_TASK_PRIORITY 1             /**< Drain task priority (just above idle) */
+#define DLOG_BINARY_OUTPUT 0             /**< Emit DLOG: tokens instead of formatted text */
+
+/**
+ * @brief Power Management Configuration
+ *
+ * These constants configure dynamic frequency scaling and automatic light
+ * sleep between samples. CONFIG_PM_ENABLE and tickless idle must also be
+ * enabled in sdkconfig for them to take effect.
+ */
+#define POWER_MANAGEMENT_ENABLED 1       /**< Configure esp_pm at startup (0 = leave default power state) */
+#define POWER_MAX_CPU_FREQ_MHZ 160       /**< CPU frequency while work is in progress */
+#define POWER_MIN_CPU_FREQ_MHZ 40        /**< CPU frequency when idle (XTAL) */
+#define POWER_LIGHT_SLEEP_ENABLED 1      /**< Light-sleep automatically when FreeRTOS is idle */
+
+/**
+ * @brief Duty-Cycle (Deep Sleep) Configuration
+ *
+ * With DUTY_CYCLE_ENABLED set, the device takes one sample per timer
+ * wakeup, buffers it in RTC memory and returns to deep sleep instead of
+ * running the continuous monitoring task. Buffered records are uploaded
+ * once DUTY_CYCLE_FLUSH_RECORDS have accumulated. Alerts raised or
+ * cleared by the alert engine are sent at once on their own.
+ */
+#define DUTY_CYCLE_ENABLED 0             /**< Deep-sleep between samples (battery nodes) */
+#define DUTY_CYCLE_SLEEP_SECONDS 300     /**< Sampling period in seconds */
+#define DUTY_CYCLE_BUFFER_RECORDS 64     /**< RTC ring capacity in records (20 bytes each) */
+#define DUTY_CYCLE_FLUSH_RECORDS 12      /**< Upload once this many records are buffered */
+
+/**
+ * @brief Reading History Configuration
+ * 
+ * The reading history keeps the last samples of every measured quantity
+ * in its own ring of 16-bit fixed-point values. Rings are handed out per
+ * sensor and quantity, so only quantities a sensor actually measures use
+ * memory (2 bytes per sample). The pool covers two quantities for every
+ * registry slot (an AHT10 uses two), at most 64.
+ */
+#define READING_HISTORY_DEPTH        64               /**< Samples per ring (power of two) */
+#define READING_HISTORY_CHANNELS     (SENSOR_REGISTRY_CAPACITY * 2) /**< Rings shared by all sensors */
+
+/**
+ * @brief Outlier Filter Configuration
+ * 
+ * Every history channel passes through a sliding-window filter before
+ * its samples reach the history and the health analysis. A sample is an
+ * outlier when it is further from the window median than the threshold
+ * times the scaled median absolute deviation (Hampel identifier).
+ * Outliers are replaced by the median and flagged in the reading.
+ */
+#define OUTLIER_FILTER_MODE          2                /**< 0 = off, 1 = median, 2 = Hampel */
+#define OUTLIER_FILTER_WINDOW        7                /**< Window length in samples (odd, at most 15) */
+#define OUTLIER_FILTER_THRESHOLD_X10 30               /**< Outlier threshold in tenths of a sigma */
+
+/**
+ * @brief Sensor Fusion Configuration
+ * 
+ * Each physical quantity (air temperature, air humidity, soil
+ * temperature, soil moisture) is estimated by a scalar Kalman filter that combines all
+ * sensors measuring it. The sigmas are the datasheet accuracies; the
+ * process noise is how fast the true value may wander, per second.
+ */
+#define FUSION_MAX_SOURCES           8                /**< Sensor inputs across all quantities */
+#define FUSION_AIR_TEMP_PROCESS_NOISE 0.0005f         /**< Air temperature drift variance (°C² per second) */
+#define FUSION_HUMIDITY_PROCESS_NOISE 0.005f          /**< Humidity drift variance (%² per second) */
+#define FUSION_SOIL_TEMP_PROCESS_NOISE 0.00005f       /**< Soil temperature drift variance (°C² per second) */
+#define FUSION_SOIL_MOISTURE_PROCESS_NOISE 500.0f     /**< Soil moisture drift variance (counts² per second, fast while watering) */
+#define FUSION_AHT10_TEMP_SIGMA      0.3f             /**< AHT10 temperature accuracy (°C) */
+#define FUSION_AHT10_HUMIDITY_SIGMA  2.0f             /**< AHT10 humidity accuracy (%) */
+#define FUSION_DS18B20_TEMP_SIGMA    0.5f             /**< DS18B20 temperature accuracy (°C) */
+#define FUSION_SOIL_MOISTURE_SIGMA   40.0f            /**< Capacitive soil probe noise (ADC counts) */
+#define FUSION_GATE_SIGMA            5.0f             /**< Measurements further off are rejected */
+
+/**
+ * @brief Sensor Diagnostics Configuration
+ * 
+ * Self-diagnostics flag sensors that keep returning plausible but wrong
+ * values: the same value for too many samples, a change faster than the
+ * quantity can move, or a drift away from the other sensors measuring
+ * the same thing. Stuck and rate-limited readings are left out of the
+ * fused estimates and the health score.
+ */
+#define SENSOR_DIAG_STUCK_SAMPLES    40               /**< Identical samples that mark a sensor stuck */
+#define SENSOR_DIAG_COARSE_STUCK_SAMPLES 240          /**< Same, for DS18B20 (0.0625 °C steps) and light sensors */
+#define SENSOR_DIAG_AIR_TEMP_RATE    5.0f             /**< Largest air temperature change (°C per minute) */
+#define SENSOR_DIAG_SOIL_TEMP_RATE   1.0f             /**< Largest soil temperature change (°C per minute) */
+#define SENSOR_DIAG_HUMIDITY_RATE    20.0f            /**< Largest humidity change (% per minute) */
+#define SENSOR_DIAG_TEMP_DIVERGENCE  2.0f             /**< Largest mean air temperature offset from siblings (°C) */
+#define SENSOR_DIAG_HUMIDITY_DIVERGENCE 10.0f         /**< Largest mean humidity offset from siblings (%) */
+
+/**
+ * @brief Plant Health Configuration
+ * 
+ * Health is scored against the profile of the monitored species (see
+ * health_engine.c for the built-in profiles: "default", "tropical",
+ * "succulent" and "herb"). Each profile sets the acceptable and optimal
+ * range and weight of every measured quantity.
+ */
+#define HEALTH_PROFILE               "default"        /**< Species profile of the monitored plant */
+
+/**
+ * @brief Rolling Statistics Configuration
+ * 
+ * Count, mean, standard deviation, minimum and maximum of every measured
+ * quantity are kept on the device over three windows and included in
+ * the uplink. Each window is a ring of ROLLING_STATS_BUCKETS time
+ * buckets; the window lengths must be multiples of it.
+ */
+#define ROLLING_STATS_BUCKETS        12               /**< Time buckets per window */
+#define ROLLING_STATS_SHORT_S        300              /**< Short window (s) */
+#define ROLLING_STATS_MEDIUM_S       3600             /**< Medium window (s) */
+#define ROLLING_STATS_LONG_S         86400            /**< Long window (s) */
+#define ROLLING_STATS_LOG_CYCLES     10               /**< Log the summaries every N monitoring cycles (0 = never) */
+
+/**
+ * @brief Dry-Time Prediction Configuration
+ *
+ * Calibrated soil moisture is averaged over DRY_PREDICTOR_INTERVAL_S and
+ * the last DRY_PREDICTOR_SAMPLES averages are fitted with a least-squares
+ * line to predict when the soil reaches DRY_PREDICTOR_THRESHOLD. A rise
+ * of DRY_PREDICTOR_WATERING_STEP (the plant was watered) restarts the
+ * fit. In duty-cycle mode uploads become more frequent once the
+ * prediction falls below DRY_PREDICTOR_HORIZON_HOURS, down to every
+ * sample at DRY_PREDICTOR_URGENT_HOURS.
+ */
+#define DRY_PREDICTOR_SAMPLES        48               /**< Averaged samples in the fit (at most 255) */
+#define DRY_PREDICTOR_INTERVAL_S     900              /**< Averaging interval per sample (s) */
+#define DRY_PREDICTOR_MIN_SAMPLES    4                /**< Samples needed before predicting */
+#define DRY_PREDICTOR_THRESHOLD      1000             /**< Soil moisture value counted as dry (raw, higher is wetter) */
+#define DRY_PREDICTOR_WATERING_STEP  200              /**< Rise between samples that restarts the fit (raw) */
+#define DRY_PREDICTOR_MAX_HOURS      720.0f           /**< Longer predictions are reported as not drying */
+#define DRY_PREDICTOR_HORIZON_HOURS  48.0f            /**< Uploads speed up below this prediction */
+#define DRY_PREDICTOR_URGENT_HOURS   6.0f             /**< Upload every sample below this prediction */
+
+/**
+ * @brief Light Integral Configuration
+ *
+ * GY-302 illuminance is converted to PPFD with the factor of the light
+ * source (sunlight, white_led, fluorescent, hps or metal_halide) and
+ * integrated into the daily light integral. Days start at local
+ * midnight, LIGHT_UTC_OFFSET_MIN minutes ahead of UTC (daylight saving
+ * time is not applied). Until the clock has been set, the DLI covers a
+ * rolling 24 h window instead.
+ */
+#define LIGHT_SPECTRUM               "sunlight"       /**< Light source of the grow location */
+#define LIGHT_UTC_OFFSET_MIN         0                /**< Local time offset from UTC (minutes) */
+#define LIGHT_PHOTOPERIOD_PPFD       10               /**< PPFD counted as lit (µmol/m²/s) */
+#define LIGHT_MAX_GAP_S              1800             /**< Longer gaps between samples are not integrated (s) */
+
+/**
+ * @brief Vapour Pressure Deficit Configuration
+ *
+ * VPD and dew point are computed from the fused air temperature and
+ * humidity. Leaf VPD uses the DS18B20 probe when it is clipped to a
+ * leaf; otherwise the leaf is taken to be VPD_LEAF_OFFSET below the air.
+ */
+#define VPD_LEAF_PROBE               0                /**< 1 = the DS18B20 measures leaf temperature, 0 = soil */
+#define VPD_LEAF_OFFSET              2.0f             /**< Leaf below air temperature without a leaf probe (°C) */
+
+/**
+ * @brief Anomaly Detection Configuration
+ *
+ * Every sample of every quantity is checked against an exponentially
+ * weighted average and variance. In duty-cycle mode an anomaly is sent
+ * to SERVER_URGENT_URL at once in a small message, while the readings
+ * themselves keep to the batch schedule.
+ */
+#define ANOMALY_ENABLED              1                /**< Report anomalies immediately (duty-cycle mode) */
+#define ANOMALY_EWMA_SHIFT           4                /**< Weight of a new sample is 1/2^shift */
+#define ANOMALY_Z_THRESHOLD          4                /**< Standard deviations from the average that fire */
+#define ANOMALY_WARMUP_SAMPLES       16               /**< Samples before a channel can fire */
+#define ANOMALY_HOLDOFF_SAMPLES      8                /**< Samples a channel stays quiet after firing */
+
+/**
+ * @brief Alert Engine Configuration
+ *
+ * Threshold alerts (the server defaults) are evaluated on the device.
+ * An alert is raised once a threshold has been breached for
+ * ALERT_MIN_DURATION_S and cleared once the value has been back past the
+ * threshold by the hysteresis band for as long. In duty-cycle mode only
+ * these transitions are sent, at once, to SERVER_URGENT_URL.
+ */
+#define ALERT_ENGINE_ENABLED         1                /**< Report alert transitions immediately (duty-cycle mode) */
+#define ALERT_TEMP_MIN               10.0f            /**< Alert below this temperature (°C) */
+#define ALERT_TEMP_MAX               35.0f            /**< Alert above this temperature (°C) */
+#define ALERT_TEMP_HYSTERESIS        1.0f             /**< Temperature hysteresis band (°C) */
+#define ALERT_HUMIDITY_MIN           30.0f            /**< Alert below this humidity (%) */
+#define ALERT_HUMIDITY_MAX           80.0f            /**< Alert above this humidity (%) */
+#define ALERT_HUMIDITY_HYSTERESIS    3.0f             /**< Humidity hysteresis band (%) */
+#define ALERT_SOIL_MIN               1000             /**< Alert below this soil moisture value */
+#define ALERT_SOIL_MAX               3000             /**< Alert above this soil moisture value */
+#define ALERT_SOIL_HYSTERESIS        100              /**< Soil moisture hysteresis band */
+#define ALERT_LIGHT_MIN              100              /**< Alert below this light level */
+#define ALERT_LIGHT_MAX              4000             /**< Alert above this light level */
+#define ALERT_LIGHT_HYSTERESIS       100              /**< Light level hysteresis band */
+#define ALERT_MIN_DURATION_S         300              /**< Time a breach or recovery must last (s) */
+#define ALERT_COOLDOWN_S             3600             /**< Time after clearing before an alert can be raised again (s) */
+
+/**
+ * @brief Irrigation Control Configuration
+ *
+ * With IRRIGATION_ENABLED set, a task of its own drives the pump (and
+ * valve) outputs every IRRIGATION_PERIOD_MS from the fused soil moisture,
+ * which the monitoring task hands over each cycle. IRRIGATION_MODE
+ * selects the control law: 1 = bang-bang, 2 = PI. The daily dose is set
+ * in millilitres and converted to pump time with the pump's flow rate.
+ * Not available in duty-cycle mode, which sleeps between samples.
+ */
+#define IRRIGATION_ENABLED           0                /**< Run the irrigation control task (needs a pump) */
+#define IRRIGATION_PUMP_GPIO         GPIO_NUM_5       /**< Pump relay or MOSFET output */
+#define IRRIGATION_VALVE_GPIO        -1               /**< Valve output switched with the pump (-1 = none) */
+#define IRRIGATION_ACTIVE_LEVEL      1                /**< Output level that runs the pump */
+#define IRRIGATION_TASK_PRIORITY     10               /**< Above the monitoring task (5) */
+#define IRRIGATION_PERIOD_MS         100              /**< Control period (ms) */
+#define IRRIGATION_MODE              1                /**< 0 = off, 1 = bang-bang, 2 = PI */
+#define IRRIGATION_SETPOINT          2000             /**< Target soil moisture value */
+#define IRRIGATION_HYSTERESIS        200              /**< Bang-bang: start this far below the setpoint */
+#define IRRIGATION_KP_PERMILLE       3                /**< PI: pump share per count of error (‰) */
+#define IRRIGATION_KI_PERMILLE_PER_HOUR 2             /**< PI: pump share per count of error per hour (‰) */
+#define IRRIGATION_WINDOW_S          120              /**< PI: time-proportioning window (s) */
+#define IRRIGATION_MIN_ON_S          5                /**< Shortest run (s) */
+#define IRRIGATION_MIN_OFF_S         30               /**< Shortest pause, to let the water soak in (s) */
+#define IRRIGATION_MAX_PULSE_S       60               /**< Longest run (s) */
+#define IRRIGATION_PUMP_ML_PER_MIN   500              /**< Pump flow rate (mL/min) */
+#define IRRIGATION_MAX_DAILY_ML      1500             /**< Most water per 24 hours (mL) */
+#define IRRIGATION_DRY_RUN_S         90               /**< Pump time allowed without a moisture rise (s) */
+#define IRRIGATION_RESPONSE_S        300              /**< Wait for the rise before flagging a dry run (s) */
+#define IRRIGATION_RESPONSE_RISE     40               /**< Rise that shows the water arrives */
+#define IRRIGATION_MAX_AGE_S         120              /**< Older moisture estimates stop the pump (s) */
+
 /**
  * @brief Environment Variable Support (for future use)
  * 
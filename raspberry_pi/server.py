@@ -57,7 +57,7 @@ from flask_limiter import Limiter
 from flask_limiter.util import get_remote_address
 
 # Database imports
-from sqlalchemy import create_engine, Column, Integer, Float, String, DateTime, Boolean, Text, Index
+from sqlalchemy import create_engine, Column, Integer, Float, String, DateTime, Boolean, Text, Index, func
 from sqlalchemy.ext.declarative import declarative_base
 from sqlalchemy.orm import sessionmaker, Session as DBSession
 from sqlalchemy.exc import SQLAlchemyError
@@ -150,8 +150,11 @@ class AlertType(Enum):
     LIGHT_LOW = "light_low"
     LIGHT_HIGH = "light_high"
     DEVICE_OFFLINE = "device_offline"
+    ANOMALY = "anomaly"
     SYSTEM_ERROR = "system_error"
 
+DEVICE_QUANTITIES = ['temperature', 'humidity', 'soil_moisture', 'light_level', 'lux', 'vpd']
+
 # Data validation schemas
 class SensorDataSchema(Schema):
     """Marshmallow schema for sensor data validation"""
@@ -162,7 +165,15 @@ class SensorDataSchema(Schema):
     soil_moisture = fields.Int(validate=validate.Range(min=0, max=4095))
     light_level = fields.Int(validate=validate.Range(min=0, max=4095))
     lux = fields.Float(validate=validate.Range(min=0, max=100000))
+    ppfd = fields.Float(validate=validate.Range(min=0))
+    dli = fields.Float(validate=validate.Range(min=0))
+    photoperiod_h = fields.Float(validate=validate.Range(min=0, max=24))
+    vpd = fields.Float(validate=validate.Range(min=0, max=20))
+    dew_point = fields.Float(validate=validate.Range(min=-50, max=100))
     health_score = fields.Float(validate=validate.Range(min=0, max=100))
+    hours_to_dry = fields.Float(validate=validate.Range(min=0))
+    quality = fields.Dict(keys=fields.Str(validate=validate.OneOf(DEVICE_QUANTITIES)),
+                          values=fields.List(fields.Str(validate=validate.OneOf(['stuck', 'rate']))))
     health_status = fields.Str(validate=validate.OneOf([status.value for status in HealthStatus]))
     health_emoji = fields.Str(validate=validate.Length(max=10))
     recommendation = fields.Str(validate=validate.Length(max=500))
@@ -170,6 +181,36 @@ class SensorDataSchema(Schema):
     wifi_connected = fields.Bool()
     data_sent = fields.Bool()
 
+class SensorSummarySchema(Schema):
+    """Marshmallow schema for rolling window statistics computed on the device"""
+    quantity = fields.Str(required=True, validate=validate.OneOf(DEVICE_QUANTITIES))
+    window_s = fields.Int(required=True, validate=validate.Range(min=1, max=7 * 86400))
+    timestamp = fields.Int(required=True)
+    count = fields.Int(required=True, validate=validate.Range(min=1))
+    mean = fields.Float(required=True)
+    stddev = fields.Float(validate=validate.Range(min=0))
+    min = fields.Float(required=True)
+    max = fields.Float(required=True)
+
+class AnomalySchema(Schema):
+    """Marshmallow schema for an anomaly flagged by the on-device detector"""
+    quantity = fields.Str(required=True, validate=validate.OneOf(DEVICE_QUANTITIES))
+    timestamp = fields.Int(required=True)
+    value = fields.Float(required=True)
+    mean = fields.Float(required=True)
+    z = fields.Float(required=True)
+
+class AlertTransitionSchema(Schema):
+    """Marshmallow schema for an alert raised or cleared by the on-device alert engine"""
+    type = fields.Str(required=True, validate=validate.Length(min=1, max=40))
+    quantity = fields.Str(required=True, validate=validate.OneOf(DEVICE_QUANTITIES))
+    state = fields.Str(required=True, validate=validate.OneOf(['raised', 'cleared']))
+    severity = fields.Str(required=True, validate=validate.OneOf(['info', 'warning', 'critical']))
+    timestamp = fields.Int(required=True)
+    value = fields.Float(required=True)
+    threshold = fields.Float()
+    peak = fields.Float()
+
 class DeviceInfoSchema(Schema):
     """Marshmallow schema for device information validation"""
     device_id = fields.Str(required=True, validate=validate.Length(min=1, max=50))
@@ -240,7 +281,14 @@ class SensorReading(Base):
     soil_moisture = Column(Integer)
     light_level = Column(Integer)
     lux = Column(Float)
+    ppfd = Column(Float)
+    dli = Column(Float)
+    photoperiod_hours = Column(Float)
+    vpd = Column(Float)
+    dew_point = Column(Float)
     health_score = Column(Float)
+    hours_to_dry = Column(Float)
+    quality = Column(String(200))
     health_status = Column(String(50))
     health_emoji = Column(String(10))
     recommendation = Column(String(500))
@@ -267,7 +315,14 @@ class SensorReading(Base):
             'soil_moisture': self.soil_moisture,
             'light_level': self.light_level,
             'lux': self.lux,
+            'ppfd': self.ppfd,
+            'dli': self.dli,
+            'photoperiod_hours': self.photoperiod_hours,
+            'vpd': self.vpd,
+            'dew_point': self.dew_point,
             'health_score': self.health_score,
+            'hours_to_dry': self.hours_to_dry,
+            'quality': self.quality,
             'health_status': self.health_status,
             'health_emoji': self.health_emoji,
             'recommendation': self.recommendation,
@@ -277,6 +332,40 @@ class SensorReading(Base):
             'created_at': self.created_at.isoformat() if self.created_at else None
         }
 
+class SensorSummary(Base):
+    """Database model for rolling window statistics reported by devices"""
+    __tablename__ = 'sensor_summaries'
+    
+    id = Column(Integer, primary_key=True)
+    device_id = Column(String(50), nullable=False, index=True)
+    quantity = Column(String(20), nullable=False)
+    window_seconds = Column(Integer, nullable=False)
+    timestamp = Column(DateTime, nullable=False, index=True)
+    count = Column(Integer, nullable=False)
+    mean = Column(Float, nullable=False)
+    stddev = Column(Float)
+    min = Column(Float, nullable=False)
+    max = Column(Float, nullable=False)
+    created_at = Column(DateTime, default=datetime.datetime.utcnow)
+    
+    __table_args__ = (
+        Index('idx_summary_lookup', 'device_id', 'quantity', 'window_seconds', 'timestamp'),
+    )
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert to dictionary for JSON serialization"""
+        return {
+            'device_id': self.device_id,
+            'quantity': self.quantity,
+            'window_seconds': self.window_seconds,
+            'timestamp': self.timestamp.isoformat() if self.timestamp else None,
+            'count': self.count,
+            'mean': self.mean,
+            'stddev': self.stddev,
+            'min': self.min,
+            'max': self.max
+        }
+
 class Device(Base):
     """Database model for device information with comprehensive indexing"""
     __tablename__ = 'devices'
@@ -359,6 +448,9 @@ class PlantMonitorServer:
         self.config = self._load_config(config_path)
         self.sensor_schema = SensorDataSchema()
         self.device_schema = DeviceInfoSchema()
+        self.summary_schema = SensorSummarySchema()
+        self.anomaly_schema = AnomalySchema()
+        self.alert_transition_schema = AlertTransitionSchema()
         self._init_database()
         self._start_background_tasks()
         logger.info("Plant Monitor Server initialized successfully")
@@ -453,12 +545,30 @@ class PlantMonitorServer:
         cleanup_thread.start()
         logger.info("Background tasks started")
 
-    def receive_sensor_data(self, data: Dict[str, Any]) -> bool:
+    @staticmethod
+    def _format_quality(quality: Optional[Dict[str, List[str]]]) -> Optional[str]:
+        """
+        Flatten the quality flags of a reading for storage
+        
+        Args:
+            quality: Flags per quantity, e.g. {'temperature': ['stuck']}
+            
+        Returns:
+            'quantity:flag' pairs separated by commas (e.g. 'temperature:stuck'),
+            or None if nothing was flagged
+        """
+        if not quality:
+            return None
+        return ','.join(f"{quantity}:{flag}" for quantity, flags in sorted(quality.items()) for flag in flags)
+
+    def receive_sensor_data(self, data: Dict[str, Any], check_alerts: bool = True) -> bool:
         """
         Receive and process sensor data from ESP32
         
         Args:
             data: Sensor data dictionary
+            check_alerts: Check the reading against the alert thresholds
+                          (devices that evaluate alerts themselves skip this)
             
         Returns:
             True if data was processed successfully, False otherwise
@@ -481,7 +591,14 @@ class PlantMonitorServer:
                 soil_moisture=validated_data.get('soil_moisture'),
                 light_level=validated_data.get('light_level'),
                 lux=validated_data.get('lux'),
+                ppfd=validated_data.get('ppfd'),
+                dli=validated_data.get('dli'),
+                photoperiod_hours=validated_data.get('photoperiod_h'),
+                vpd=validated_data.get('vpd'),
+                dew_point=validated_data.get('dew_point'),
                 health_score=validated_data.get('health_score'),
+                hours_to_dry=validated_data.get('hours_to_dry'),
+                quality=self._format_quality(validated_data.get('quality')),
                 health_status=validated_data.get('health_status'),
                 health_emoji=validated_data.get('health_emoji'),
                 recommendation=validated_data.get('recommendation'),
@@ -501,7 +618,8 @@ class PlantMonitorServer:
                 self._update_device_info(validated_data)
                 
                 # Check for alerts
-                self._check_alerts(reading)
+                if check_alerts:
+                    self._check_alerts(reading)
                 
                 # Emit real-time update
                 socketio.emit('sensor_update', reading.to_dict())
@@ -527,6 +645,139 @@ class PlantMonitorServer:
             logger.error(f"Error processing sensor data: {e}")
             return False
 
+    def receive_statistics(self, device_id: str, summaries: List[Dict[str, Any]]) -> int:
+        """
+        Store rolling window statistics computed on a device
+        
+        Args:
+            device_id: Device ID
+            summaries: Summary dictionaries (quantity, window_s, timestamp,
+                       count, mean, stddev, min, max)
+            
+        Returns:
+            Number of summaries stored
+        """
+        rows = []
+        for summary in summaries:
+            try:
+                validated = self.summary_schema.load(summary)
+            except ValidationError as e:
+                logger.warning(f"Rejected statistics summary from {device_id}: {e}")
+                continue
+            rows.append(SensorSummary(
+                device_id=device_id,
+                quantity=validated['quantity'],
+                window_seconds=validated['window_s'],
+                timestamp=datetime.datetime.fromtimestamp(validated['timestamp']),
+                count=validated['count'],
+                mean=validated['mean'],
+                stddev=validated.get('stddev'),
+                min=validated['min'],
+                max=validated['max']
+            ))
+        
+        if not rows:
+            return 0
+        
+        session = Session()
+        try:
+            session.add_all(rows)
+            session.commit()
+            DATABASE_OPERATIONS.labels(operation='insert').inc()
+            return len(rows)
+        except SQLAlchemyError as e:
+            session.rollback()
+            logger.error(f"Database error: {e}")
+            return 0
+        finally:
+            session.close()
+
+    def receive_anomalies(self, device_id: str, anomalies: List[Dict[str, Any]]) -> int:
+        """
+        Raise alerts for anomalies flagged on a device
+        
+        Args:
+            device_id: Device ID
+            anomalies: Anomaly dictionaries (quantity, timestamp, value, mean, z)
+            
+        Returns:
+            Number of anomalies accepted
+        """
+        accepted = []
+        for anomaly in anomalies:
+            try:
+                accepted.append(self.anomaly_schema.load(anomaly))
+            except ValidationError as e:
+                logger.warning(f"Rejected anomaly from {device_id}: {e}")
+        
+        if not accepted:
+            return 0
+        
+        session = Session()
+        try:
+            for anomaly in accepted:
+                observed = datetime.datetime.fromtimestamp(anomaly['timestamp'])
+                self._create_alert(session, device_id, f"{AlertType.ANOMALY.value}_{anomaly['quantity']}",
+                                   f"Anomalous {anomaly['quantity']}: {anomaly['value']} "
+                                   f"(average {anomaly['mean']:.2f}, z {anomaly['z']:.1f}) at {observed.isoformat()}")
+            session.commit()
+            DATABASE_OPERATIONS.labels(operation='insert').inc()
+            return len(accepted)
+        except SQLAlchemyError as e:
+            session.rollback()
+            logger.error(f"Database error: {e}")
+            return 0
+        finally:
+            session.close()
+
+    def receive_alert_transitions(self, device_id: str, transitions: List[Dict[str, Any]]) -> int:
+        """
+        Apply alerts raised or cleared by the alert engine on a device
+        
+        A raised alert creates an unresolved alert of its type; a cleared
+        one resolves it. Transitions are applied in timestamp order.
+        
+        Args:
+            device_id: Device ID
+            transitions: Transition dictionaries (type, quantity, state, severity,
+                         timestamp, value, threshold, peak)
+            
+        Returns:
+            Number of transitions accepted
+        """
+        accepted = []
+        for transition in transitions:
+            try:
+                accepted.append(self.alert_transition_schema.load(transition))
+            except ValidationError as e:
+                logger.warning(f"Rejected alert transition from {device_id}: {e}")
+        
+        if not accepted:
+            return 0
+        
+        session = Session()
+        try:
+            for transition in sorted(accepted, key=lambda item: item['timestamp']):
+                observed = datetime.datetime.fromtimestamp(transition['timestamp'])
+                if transition['state'] == 'raised':
+                    threshold = transition.get('threshold')
+                    past = f" (threshold {threshold})" if threshold is not None else ""
+                    self._create_alert(session, device_id, transition['type'],
+                                       f"{transition['type']}: {transition['quantity']} {transition['value']}"
+                                       f"{past} since {observed.isoformat()}",
+                                       severity=transition['severity'])
+                else:
+                    self._resolve_alerts(session, device_id, transition['type'], observed)
+            session.commit()
+            DATABASE_OPERATIONS.labels(operation='update').inc()
+            return len(accepted)
+        except SQLAlchemyError as e:
+            session.rollback()
+            logger.error(f"Database error: {e}")
+            return 0
+        finally:
+            session.close()
+
     def _update_device_info(self, data: Dict[str, Any]) -> None:
         """
         Update device information in database
@@ -624,7 +875,8 @@ class PlantMonitorServer:
         finally:
             session.close()
 
-    def _create_alert(self, session: DBSession, device_id: str, alert_type: str, message: str) -> None:
+    def _create_alert(self, session: DBSession, device_id: str, alert_type: str, message: str,
+                      severity: str = 'warning') -> None:
         """
         Create a new alert in the database
         
@@ -633,6 +885,7 @@ class PlantMonitorServer:
             device_id: Device ID
             alert_type: Type of alert
             message: Alert message
+            severity: Alert severity (info, warning, error, critical)
         """
         # Check if similar alert already exists and is unresolved
         existing_alert = session.query(Alert).filter_by(
@@ -646,11 +899,28 @@ class PlantMonitorServer:
                 device_id=device_id,
                 alert_type=alert_type,
                 message=message,
-                severity='warning'
+                severity=severity
             )
             session.add(alert)
             logger.warning(f"Alert created: {message}")
 
+    def _resolve_alerts(self, session: DBSession, device_id: str, alert_type: str,
+                        resolved_at: datetime.datetime) -> None:
+        """
+        Resolve the unresolved alerts of a type
+        
+        Args:
+            session: Database session
+            device_id: Device ID
+            alert_type: Type of alert
+            resolved_at: Time the condition ended
+        """
+        for alert in session.query(Alert).filter_by(device_id=device_id, alert_type=alert_type,
+                                                    is_resolved=False):
+            alert.is_resolved = True
+            alert.resolved_at = resolved_at
+            logger.info(f"Alert resolved: {alert_type} on {device_id}")
+
     def get_latest_readings(self, device_id: Optional[str] = None, limit: int = 100) -> List[Dict[str, Any]]:
         """
         Get latest sensor readings
@@ -700,36 +970,61 @@ class PlantMonitorServer:
             if not latest:
                 return {'error': 'Device not found'}
             
-            # Get statistics for last 24 hours
+            stats = {
+                'device_id': device_id,
+                'latest_reading': latest.to_dict()
+            }
+            
+            # Prefer the 24 h statistics computed on the device, which cover
+            # every sample even when the device uploads rarely
             yesterday = datetime.datetime.utcnow() - datetime.timedelta(days=1)
-            readings_24h = session.query(SensorReading).filter(
+            summaries = {}
+            for quantity in ('temperature', 'humidity'):
+                summary = session.query(SensorSummary).filter(
+                    SensorSummary.device_id == device_id,
+                    SensorSummary.quantity == quantity,
+                    SensorSummary.window_seconds == 86400,
+                    SensorSummary.timestamp >= yesterday
+                ).order_by(SensorSummary.timestamp.desc()).first()
+                if summary:
+                    summaries[quantity] = summary
+            
+            # Aggregate the stored readings in the database, not in Python
+            aggregates = session.query(
+                func.count(SensorReading.id),
+                func.avg(SensorReading.temperature),
+                func.min(SensorReading.temperature),
+                func.max(SensorReading.temperature),
+                func.avg(SensorReading.humidity),
+                func.min(SensorReading.humidity),
+                func.max(SensorReading.humidity),
+                func.avg(SensorReading.health_score)
+            ).filter(
                 SensorReading.device_id == device_id,
                 SensorReading.timestamp >= yesterday
-            ).all()
+            ).one()
             
-            if readings_24h:
-                temperatures = [r.temperature for r in readings_24h if r.temperature is not None]
-                humidities = [r.humidity for r in readings_24h if r.humidity is not None]
-                health_scores = [r.health_score for r in readings_24h if r.health_score is not None]
-                
-                stats = {
-                    'device_id': device_id,
-                    'latest_reading': latest.to_dict(),
-                    'readings_24h': len(readings_24h),
-                    'avg_temperature': sum(temperatures) / len(temperatures) if temperatures else None,
-                    'avg_humidity': sum(humidities) / len(humidities) if humidities else None,
-                    'avg_health_score': sum(health_scores) / len(health_scores) if health_scores else None,
-                    'min_temperature': min(temperatures) if temperatures else None,
-                    'max_temperature': max(temperatures) if temperatures else None,
-                    'min_humidity': min(humidities) if humidities else None,
-                    'max_humidity': max(humidities) if humidities else None
-                }
-            else:
-                stats = {
-                    'device_id': device_id,
-                    'latest_reading': latest.to_dict(),
-                    'readings_24h': 0
-                }
+            stats['readings_24h'] = aggregates[0]
+            if aggregates[0] > 0:
+                stats.update({
+                    'avg_temperature': aggregates[1],
+                    'min_temperature': aggregates[2],
+                    'max_temperature': aggregates[3],
+                    'avg_humidity': aggregates[4],
+                    'min_humidity': aggregates[5],
+                    'max_humidity': aggregates[6],
+                    'avg_health_score': aggregates[7]
+                })
+            
+            for quantity, summary in summaries.items():
+                stats.update({
+                    f'avg_{quantity}': summary.mean,
+                    f'min_{quantity}': summary.min,
+                    f'max_{quantity}': summary.max,
+                    f'stddev_{quantity}': summary.stddev,
+                    f'samples_{quantity}_24h': summary.count
+                })
+            stats['statistics_source'] = 'device' if summaries else 'readings'
             
             DATABASE_OPERATIONS.labels(operation='select').inc()
             return stats
@@ -740,6 +1035,58 @@ class PlantMonitorServer:
         finally:
             session.close()
 
+    def get_dry_forecast(self, within_hours: Optional[float] = None) -> List[Dict[str, Any]]:
+        """
+        Get the devices whose soil is predicted to dry out, soonest first
+        
+        Uses each device's latest time-to-dry prediction, shortened by the
+        time elapsed since it was reported, so irrigation rounds can be
+        planned across many pots.
+        
+        Args:
+            within_hours: Only include pots predicted dry within this many hours
+            
+        Returns:
+            List of forecast dictionaries (device_id, predicted_dry_at,
+            hours_to_dry, reported_at)
+        """
+        try:
+            session = Session()
+            latest = session.query(
+                SensorReading.device_id,
+                func.max(SensorReading.timestamp).label('timestamp')
+            ).filter(SensorReading.hours_to_dry.isnot(None))\
+             .group_by(SensorReading.device_id).subquery()
+            
+            readings = session.query(SensorReading).join(
+                latest,
+                (SensorReading.device_id == latest.c.device_id) &
+                (SensorReading.timestamp == latest.c.timestamp)
+            ).filter(SensorReading.hours_to_dry.isnot(None)).all()
+            DATABASE_OPERATIONS.labels(operation='select').inc()
+            
+            now = datetime.datetime.now()
+            forecast = {}
+            for reading in readings:
+                dry_at = reading.timestamp + datetime.timedelta(hours=reading.hours_to_dry)
+                remaining = max((dry_at - now).total_seconds() / 3600.0, 0.0)
+                if within_hours is not None and remaining > within_hours:
+                    continue
+                forecast[reading.device_id] = {
+                    'device_id': reading.device_id,
+                    'predicted_dry_at': dry_at.isoformat(),
+                    'hours_to_dry': round(remaining, 2),
+                    'reported_at': reading.timestamp.isoformat()
+                }
+            
+            return sorted(forecast.values(), key=lambda item: item['hours_to_dry'])
+            
+        except Exception as e:
+            logger.error(f"Error getting dry forecast: {e}")
+            return []
+        finally:
+            session.close()
+
     def get_active_devices(self) -> List[Dict[str, Any]]:
         """
         Get list of active devices
@@ -780,6 +1127,9 @@ class PlantMonitorServer:
             deleted_count = session.query(SensorReading)\
                                  .filter(SensorReading.timestamp < cutoff_date)\
                                  .delete()
+            deleted_count += session.query(SensorSummary)\
+                                  .filter(SensorSummary.timestamp < cutoff_date)\
+                                  .delete()
             
             session.commit()
             DATABASE_OPERATIONS.labels(operation='delete').inc()
@@ -839,6 +1189,89 @@ def receive_data():
         logger.error(f"Error receiving data: {e}")
         return jsonify({'error': 'Internal server error'}), 500
 
+@app.route('/api/data/batch', methods=['POST'])
+@limiter.limit("100 per minute")
+def receive_data_batch():
+    """Receive buffered sensor readings from a duty-cycled ESP32 in one request"""
+    try:
+        data = request.get_json(silent=True)
+        
+        if not data or not isinstance(data.get('readings'), list):
+            return jsonify({'error': 'Expected a JSON object with a readings list'}), 400
+        
+        # Batching devices evaluate the alert thresholds themselves and
+        # report only the transitions (see 'alerts' below)
+        accepted = sum(1 for reading in data['readings']
+                       if isinstance(reading, dict) and server.receive_sensor_data(reading, check_alerts=False))
+        rejected = len(data['readings']) - accepted
+        
+        # Rolling statistics computed on the device (optional)
+        statistics = data.get('statistics')
+        summaries = 0
+        if isinstance(statistics, list) and isinstance(data.get('device_id'), str):
+            summaries = server.receive_statistics(data['device_id'],
+                                                  [item for item in statistics if isinstance(item, dict)])
+        
+        # Anomalies that could not be reported on their own (optional)
+        anomalies = data.get('anomalies')
+        flagged = 0
+        if isinstance(anomalies, list) and isinstance(data.get('device_id'), str):
+            flagged = server.receive_anomalies(data['device_id'],
+                                               [item for item in anomalies if isinstance(item, dict)])
+        
+        # Alert transitions that could not be reported on their own (optional)
+        alerts = data.get('alerts')
+        transitions = 0
+        if isinstance(alerts, list) and isinstance(data.get('device_id'), str):
+            transitions = server.receive_alert_transitions(data['device_id'],
+                                                           [item for item in alerts if isinstance(item, dict)])
+        
+        return jsonify({
+            'status': 'success' if rejected == 0 else 'partial',
+            'accepted': accepted,
+            'rejected': rejected,
+            'statistics': summaries,
+            'anomalies': flagged,
+            'alerts': transitions,
+            'timestamp': datetime.datetime.utcnow().isoformat()
+        }), 200 if accepted > 0 or rejected == 0 else 400
+            
+    except Exception as e:
+        logger.error(f"Error receiving batch data: {e}")
+        return jsonify({'error': 'Internal server error'}), 500
+
+@app.route('/api/data/urgent', methods=['POST'])
+@limiter.limit("100 per minute")
+def receive_data_urgent():
+    """Receive anomalies and alert transitions that a duty-cycled ESP32 reports ahead of its next batch"""
+    try:
+        data = request.get_json(silent=True)
+        
+        anomalies = data.get('anomalies', []) if isinstance(data, dict) else None
+        alerts = data.get('alerts', []) if isinstance(data, dict) else None
+        if (not isinstance(data, dict) or not isinstance(data.get('device_id'), str) or
+                not isinstance(anomalies, list) or not isinstance(alerts, list)):
+            return jsonify({'error': 'Expected a JSON object with a device_id and anomalies and/or alerts lists'}), 400
+        
+        flagged = server.receive_anomalies(data['device_id'],
+                                           [item for item in anomalies if isinstance(item, dict)])
+        transitions = server.receive_alert_transitions(data['device_id'],
+                                                       [item for item in alerts if isinstance(item, dict)])
+        if flagged + transitions == 0:
+            return jsonify({'status': 'error', 'message': 'No valid anomalies or alerts'}), 400
+        
+        return jsonify({
+            'status': 'success',
+            'accepted': flagged + transitions,
+            'anomalies': flagged,
+            'alerts': transitions,
+            'timestamp': datetime.datetime.utcnow().isoformat()
+        }), 200
+            
+    except Exception as e:
+        logger.error(f"Error receiving urgent data: {e}")
+        return jsonify({'error': 'Internal server error'}), 500
+
 @app.route('/api/readings', methods=['GET'])
 def get_readings():
     """Get latest sensor readings"""
@@ -892,6 +1325,23 @@ def get_statistics(device_id):
         logger.error(f"Error getting statistics: {e}")
         return jsonify({'error': 'Internal server error'}), 500
 
+@app.route('/api/forecast/dry', methods=['GET'])
+def get_dry_forecast():
+    """Get pots predicted to dry out, soonest first"""
+    try:
+        within_hours = request.args.get('within_hours', type=float)
+        forecast = server.get_dry_forecast(within_hours)
+        
+        return jsonify({
+            'status': 'success',
+            'data': forecast,
+            'count': len(forecast)
+        }), 200
+        
+    except Exception as e:
+        logger.error(f"Error getting dry forecast: {e}")
+        return jsonify({'error': 'Internal server error'}), 500
+
 @app.route('/api/alerts', methods=['GET'])
 def get_alerts():
     """Get active alerts"""
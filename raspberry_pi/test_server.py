@@ -383,6 +383,161 @@ class TestAPIEndpoints(unittest.TestCase):
         
         self.assertEqual(response.status_code, 400)
 
+    def test_receive_data_batch_endpoint(self):
+        """Test batch data reception endpoint used by duty-cycled devices"""
+        older = SAMPLE_SENSOR_DATA.copy()
+        older['timestamp'] -= 300
+        batch = {'device_id': SAMPLE_SENSOR_DATA['device_id'],
+                 'readings': [older, SAMPLE_SENSOR_DATA]}
+        
+        response = self.app.post('/api/data/batch',
+                               data=json.dumps(batch),
+                               content_type='application/json')
+        
+        self.assertEqual(response.status_code, 200)
+        
+        data = json.loads(response.data)
+        self.assertEqual(data['status'], 'success')
+        self.assertEqual(data['accepted'], 2)
+        self.assertEqual(data['rejected'], 0)
+
+    def test_receive_data_batch_endpoint_quality(self):
+        """Test batch data reception with readings the device flagged suspect"""
+        suspect = dict(SAMPLE_SENSOR_DATA, quality={'temperature': ['stuck'], 'lux': ['stuck', 'rate']})
+        invalid = dict(SAMPLE_SENSOR_DATA, quality={'temperature': ['drifting']})
+        batch = {'device_id': SAMPLE_SENSOR_DATA['device_id'],
+                 'readings': [suspect, invalid]}
+        
+        response = self.app.post('/api/data/batch',
+                               data=json.dumps(batch),
+                               content_type='application/json')
+        
+        self.assertEqual(response.status_code, 200)
+        
+        data = json.loads(response.data)
+        self.assertEqual(data['accepted'], 1)
+        self.assertEqual(data['rejected'], 1)
+        self.assertEqual(PlantMonitorServer._format_quality(suspect['quality']),
+                         'lux:stuck,lux:rate,temperature:stuck')
+
+    def test_receive_data_batch_endpoint_statistics(self):
+        """Test batch data reception with rolling statistics computed on the device"""
+        summary = {'quantity': 'temperature', 'window_s': 86400,
+                   'timestamp': SAMPLE_SENSOR_DATA['timestamp'], 'count': 288,
+                   'mean': 22.4, 'stddev': 1.3, 'min': 18.9, 'max': 26.1}
+        invalid = dict(summary, quantity='pressure')
+        batch = {'device_id': SAMPLE_SENSOR_DATA['device_id'],
+                 'readings': [SAMPLE_SENSOR_DATA],
+                 'statistics': [summary, invalid]}
+        
+        response = self.app.post('/api/data/batch',
+                               data=json.dumps(batch),
+                               content_type='application/json')
+        
+        self.assertEqual(response.status_code, 200)
+        
+        data = json.loads(response.data)
+        self.assertEqual(data['accepted'], 1)
+        self.assertEqual(data['statistics'], 1)
+        
+        stats = server.get_device_statistics(SAMPLE_SENSOR_DATA['device_id'])
+        self.assertEqual(stats['statistics_source'], 'device')
+        self.assertEqual(stats['min_temperature'], 18.9)
+        self.assertEqual(stats['samples_temperature_24h'], 288)
+
+    def test_urgent_anomaly_endpoint(self):
+        """Test that urgent anomaly reports raise one alert per quantity"""
+        anomaly = {'quantity': 'temperature', 'timestamp': int(time.time()),
+                   'value': 41.5, 'mean': 23.1, 'z': 9.2}
+        report = {'device_id': 'test_device_anomaly', 'anomalies': [anomaly, dict(anomaly, quantity='bogus')]}
+        
+        response = self.app.post('/api/data/urgent',
+                               data=json.dumps(report),
+                               content_type='application/json')
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual(json.loads(response.data)['accepted'], 1)
+        
+        # A repeat does not duplicate the unresolved alert
+        self.app.post('/api/data/urgent', data=json.dumps(report), content_type='application/json')
+        response = self.app.get('/api/alerts')
+        alerts = [alert for alert in json.loads(response.data)['data']
+                  if alert['device_id'] == 'test_device_anomaly']
+        self.assertEqual(len(alerts), 1)
+        self.assertEqual(alerts[0]['alert_type'], 'anomaly_temperature')
+        
+        response = self.app.post('/api/data/urgent',
+                               data=json.dumps({'device_id': 'test_device_anomaly', 'anomalies': []}),
+                               content_type='application/json')
+        self.assertEqual(response.status_code, 400)
+
+    def test_urgent_alert_transitions(self):
+        """Test that alert transitions from a device raise and resolve alerts"""
+        now = int(time.time())
+        raised = {'type': 'soil_dry', 'quantity': 'soil_moisture', 'state': 'raised', 'severity': 'critical',
+                  'timestamp': now - 600, 'value': 850, 'threshold': 1000, 'peak': 850}
+        report = {'device_id': 'test_device_alerts', 'alerts': [raised]}
+        
+        response = self.app.post('/api/data/urgent',
+                               data=json.dumps(report),
+                               content_type='application/json')
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual(json.loads(response.data)['alerts'], 1)
+        
+        response = self.app.get('/api/alerts')
+        alerts = [alert for alert in json.loads(response.data)['data']
+                  if alert['device_id'] == 'test_device_alerts']
+        self.assertEqual(len(alerts), 1)
+        self.assertEqual(alerts[0]['alert_type'], 'soil_dry')
+        self.assertEqual(alerts[0]['severity'], 'critical')
+        self.assertFalse(alerts[0]['is_resolved'])
+        
+        # Clearing resolves the alert, and readings in a batch are not
+        # checked again on the server
+        batch = {'device_id': 'test_device_alerts',
+                 'readings': [dict(SAMPLE_SENSOR_DATA, device_id='test_device_alerts', temperature=45.0)],
+                 'alerts': [dict(raised, state='cleared', timestamp=now, value=1150)]}
+        response = self.app.post('/api/data/batch',
+                               data=json.dumps(batch),
+                               content_type='application/json')
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual(json.loads(response.data)['alerts'], 1)
+        
+        response = self.app.get('/api/alerts')
+        alerts = [alert for alert in json.loads(response.data)['data']
+                  if alert['device_id'] == 'test_device_alerts']
+        self.assertEqual(alerts, [])
+
+    def test_dry_forecast_endpoint(self):
+        """Test that time-to-dry predictions are listed soonest first"""
+        soon = dict(SAMPLE_SENSOR_DATA, device_id='test_device_dry_soon', hours_to_dry=4.0)
+        later = dict(SAMPLE_SENSOR_DATA, device_id='test_device_dry_later', hours_to_dry=30.0)
+        batch = {'device_id': soon['device_id'], 'readings': [later, soon]}
+        
+        response = self.app.post('/api/data/batch',
+                               data=json.dumps(batch),
+                               content_type='application/json')
+        self.assertEqual(response.status_code, 200)
+        
+        response = self.app.get('/api/forecast/dry')
+        self.assertEqual(response.status_code, 200)
+        data = json.loads(response.data)
+        devices = [item['device_id'] for item in data['data']]
+        self.assertLess(devices.index('test_device_dry_soon'), devices.index('test_device_dry_later'))
+        self.assertLessEqual(data['data'][devices.index('test_device_dry_soon')]['hours_to_dry'], 4.0)
+        
+        response = self.app.get('/api/forecast/dry?within_hours=12')
+        devices = [item['device_id'] for item in json.loads(response.data)['data']]
+        self.assertIn('test_device_dry_soon', devices)
+        self.assertNotIn('test_device_dry_later', devices)
+
+    def test_receive_data_batch_endpoint_invalid(self):
+        """Test batch data reception endpoint without a readings list"""
+        response = self.app.post('/api/data/batch',
+                               data=json.dumps(SAMPLE_SENSOR_DATA),
+                               content_type='application/json')
+        
+        self.assertEqual(response.status_code, 400)
+
     def test_get_readings_endpoint(self):
         """Test readings retrieval endpoint"""
         response = self.app.get('/api/readings')
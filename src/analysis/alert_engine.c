@@ -0,0 +1,199 @@
+/**
+ * @file alert_engine.c
+ * @brief Threshold Alert State Machine Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "alert_engine.h"
+#include <string.h>
+
+/**
+ * @brief Built-in rules, matching the server's default alert thresholds
+ *
+ * Thresholds are in the reading history encoding: 0.01 °C, 0.01 % and
+ * raw ADC counts.
+ */
+static const alert_rule_t k_default_rules[] = {
+    { "temperature_high", HISTORY_QTY_TEMPERATURE, ALERT_ABOVE, ALERT_SEVERITY_WARNING,
+      (int16_t)(ALERT_TEMP_MAX * 100), (int16_t)(ALERT_TEMP_HYSTERESIS * 100), ALERT_MIN_DURATION_S, ALERT_COOLDOWN_S },
+    { "temperature_low", HISTORY_QTY_TEMPERATURE, ALERT_BELOW, ALERT_SEVERITY_CRITICAL,
+      (int16_t)(ALERT_TEMP_MIN * 100), (int16_t)(ALERT_TEMP_HYSTERESIS * 100), ALERT_MIN_DURATION_S, ALERT_COOLDOWN_S },
+    { "humidity_high", HISTORY_QTY_HUMIDITY, ALERT_ABOVE, ALERT_SEVERITY_INFO,
+      (int16_t)(ALERT_HUMIDITY_MAX * 100), (int16_t)(ALERT_HUMIDITY_HYSTERESIS * 100), ALERT_MIN_DURATION_S, ALERT_COOLDOWN_S },
+    { "humidity_low", HISTORY_QTY_HUMIDITY, ALERT_BELOW, ALERT_SEVERITY_WARNING,
+      (int16_t)(ALERT_HUMIDITY_MIN * 100), (int16_t)(ALERT_HUMIDITY_HYSTERESIS * 100), ALERT_MIN_DURATION_S, ALERT_COOLDOWN_S },
+    { "soil_dry", HISTORY_QTY_SOIL_MOISTURE, ALERT_BELOW, ALERT_SEVERITY_CRITICAL,
+      ALERT_SOIL_MIN, ALERT_SOIL_HYSTERESIS, ALERT_MIN_DURATION_S, ALERT_COOLDOWN_S },
+    { "soil_wet", HISTORY_QTY_SOIL_MOISTURE, ALERT_ABOVE, ALERT_SEVERITY_WARNING,
+      ALERT_SOIL_MAX, ALERT_SOIL_HYSTERESIS, ALERT_MIN_DURATION_S, ALERT_COOLDOWN_S },
+    { "light_low", HISTORY_QTY_LIGHT_LEVEL, ALERT_BELOW, ALERT_SEVERITY_INFO,
+      ALERT_LIGHT_MIN, ALERT_LIGHT_HYSTERESIS, ALERT_MIN_DURATION_S, ALERT_COOLDOWN_S },
+    { "light_high", HISTORY_QTY_LIGHT_LEVEL, ALERT_ABOVE, ALERT_SEVERITY_INFO,
+      ALERT_LIGHT_MAX, ALERT_LIGHT_HYSTERESIS, ALERT_MIN_DURATION_S, ALERT_COOLDOWN_S },
+};
+
+#define DEFAULT_RULE_COUNT  ((int)(sizeof(k_default_rules) / sizeof(k_default_rules[0])))
+
+/**
+ * @brief Whether a value is on the breaching side of the threshold
+ */
+static bool rule_breached(const alert_rule_t *rule, int16_t value)
+{
+    return rule->direction == ALERT_BELOW ? value < rule->threshold : value > rule->threshold;
+}
+
+/**
+ * @brief Whether a value is back past the threshold by the hysteresis band
+ */
+static bool rule_recovered(const alert_rule_t *rule, int32_t value)
+{
+    return rule->direction == ALERT_BELOW ? value >= (int32_t)rule->threshold + rule->hysteresis
+                                          : value <= (int32_t)rule->threshold - rule->hysteresis;
+}
+
+/**
+ * @brief Whether a value is worse than the peak so far
+ */
+static bool rule_worse(const alert_rule_t *rule, int16_t value, int16_t peak)
+{
+    return rule->direction == ALERT_BELOW ? value < peak : value > peak;
+}
+
+/**
+ * @brief Seconds since a state began, 0 if the clock went backwards
+ */
+static uint32_t elapsed(uint32_t since, uint32_t time_s)
+{
+    return time_s >= since ? time_s - since : 0;
+}
+
+void alert_engine_init(alert_engine_t *engine)
+{
+    if (!engine) {
+        return;
+    }
+    memset(engine, 0, sizeof(*engine));
+}
+
+int alert_engine_update(alert_engine_t *engine, const alert_rule_t *rules, int rule_count,
+                        history_quantity_t quantity, int16_t value, uint32_t time_s,
+                        alert_transition_t *transitions, int max_transitions)
+{
+    if (!engine || !rules) {
+        return 0;
+    }
+    if (rule_count > ALERT_ENGINE_MAX_RULES) {
+        rule_count = ALERT_ENGINE_MAX_RULES;
+    }
+
+    int count = 0;
+    for (int i = 0; i < rule_count; i++) {
+        const alert_rule_t *rule = &rules[i];
+        if (rule->quantity != (uint8_t)quantity) {
+            continue;
+        }
+
+        alert_channel_t *channel = &engine->channels[i];
+        bool raised = false;
+        bool cleared = false;
+
+        switch ((alert_state_t)channel->state) {
+            case ALERT_STATE_CLEAR:
+                if (!rule_breached(rule, value)) {
+                    break;
+                }
+                // A zero duration raises on the first sample
+                channel->state = ALERT_STATE_PENDING;
+                channel->since = time_s;
+                // fall through
+            case ALERT_STATE_PENDING:
+                if (!rule_breached(rule, value)) {
+                    channel->state = ALERT_STATE_CLEAR;
+                } else if (elapsed(channel->since, time_s) >= rule->min_duration_s &&
+                           time_s >= channel->hold_until) {
+                    channel->state = ALERT_STATE_ACTIVE;
+                    channel->peak = value;
+                    raised = true;
+                } else if (time_s < channel->since) {
+                    channel->since = time_s;
+                }
+                break;
+
+            case ALERT_STATE_ACTIVE:
+                if (rule_worse(rule, value, channel->peak)) {
+                    channel->peak = value;
+                }
+                if (!rule_recovered(rule, value)) {
+                    break;
+                }
+                channel->state = ALERT_STATE_RECOVERING;
+                channel->since = time_s;
+                // fall through
+            case ALERT_STATE_RECOVERING:
+                if (!rule_recovered(rule, value)) {
+                    channel->state = ALERT_STATE_ACTIVE;
+                    if (rule_worse(rule, value, channel->peak)) {
+                        channel->peak = value;
+                    }
+                } else if (elapsed(channel->since, time_s) >= rule->min_duration_s) {
+                    channel->state = ALERT_STATE_CLEAR;
+                    channel->hold_until = time_s + rule->cooldown_s;
+                    cleared = true;
+                } else if (time_s < channel->since) {
+                    channel->since = time_s;
+                }
+                break;
+
+            default:
+                channel->state = ALERT_STATE_CLEAR;
+                break;
+        }
+
+        if (!raised && !cleared) {
+            continue;
+        }
+        if (transitions && count < max_transitions) {
+            alert_transition_t *transition = &transitions[count];
+            transition->rule = (uint8_t)i;
+            transition->raised = raised;
+            transition->value = value;
+            transition->peak = channel->peak;
+            transition->timestamp = time_s;
+        }
+        count++;
+    }
+    return count;
+}
+
+bool alert_engine_is_active(const alert_engine_t *engine, int rule)
+{
+    if (!engine || rule < 0 || rule >= ALERT_ENGINE_MAX_RULES) {
+        return false;
+    }
+    return engine->channels[rule].state == ALERT_STATE_ACTIVE ||
+           engine->channels[rule].state == ALERT_STATE_RECOVERING;
+}
+
+const alert_rule_t *alert_engine_default_rules(int *count)
+{
+    if (count) {
+        *count = DEFAULT_RULE_COUNT;
+    }
+    return k_default_rules;
+}
+
+const char *alert_engine_severity_name(alert_severity_t severity)
+{
+    switch (severity) {
+        case ALERT_SEVERITY_INFO:
+            return "info";
+        case ALERT_SEVERITY_CRITICAL:
+            return "critical";
+        case ALERT_SEVERITY_WARNING:
+        default:
+            return "warning";
+    }
+}
@@ -0,0 +1,172 @@
+/**
+ * @file alert_engine.h
+ * @brief Threshold Alert State Machine for Plant Monitoring System
+ *
+ * This module evaluates threshold alert rules on the device, so that only
+ * the moments an alert starts or ends need to be sent instead of every
+ * sample that breaches a threshold.
+ *
+ * Each rule watches one quantity for values above or below a threshold
+ * and runs its own state machine:
+ *
+ *     CLEAR --breach--> PENDING --breach for min_duration_s--> ACTIVE (raised)
+ *       ^                  |                                     |
+ *       +----no breach-----+                       recovered past the hysteresis
+ *       |                                                        v
+ *       +------------recovered for min_duration_s----------- RECOVERING (cleared)
+ *
+ * A rule is recovered only once the value is back beyond the threshold by
+ * its hysteresis band, so a value hovering at the threshold does not
+ * toggle the alert. Requiring the breach, and the recovery, to last
+ * min_duration_s debounces single samples. After an alert clears, the
+ * same rule cannot be raised again for cooldown_s, which bounds the
+ * alerts a flapping condition can produce.
+ *
+ * Rules and values use the fixed-point encoding of the reading history
+ * (see history_quantity_t). The rule table is passed in on every call and
+ * the state is owned by the caller, so it can live in RTC memory across
+ * deep sleep. The module has no ESP-IDF dependencies.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef ALERT_ENGINE_H
+#define ALERT_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "reading_history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of rules an engine can track */
+#define ALERT_ENGINE_MAX_RULES  12
+
+/**
+ * @brief Side of the threshold that breaches a rule
+ */
+typedef enum {
+    ALERT_ABOVE = 0,          /**< Values above the threshold breach */
+    ALERT_BELOW               /**< Values below the threshold breach */
+} alert_direction_t;
+
+/**
+ * @brief Alert severity levels
+ */
+typedef enum {
+    ALERT_SEVERITY_INFO = 0,
+    ALERT_SEVERITY_WARNING,
+    ALERT_SEVERITY_CRITICAL
+} alert_severity_t;
+
+/**
+ * @brief State of one rule
+ */
+typedef enum {
+    ALERT_STATE_CLEAR = 0,    /**< Not breached */
+    ALERT_STATE_PENDING,      /**< Breached, waiting for min_duration_s */
+    ALERT_STATE_ACTIVE,       /**< Raised */
+    ALERT_STATE_RECOVERING    /**< Raised and recovered, waiting for min_duration_s */
+} alert_state_t;
+
+/**
+ * @brief Threshold alert rule
+ */
+typedef struct {
+    const char *name;         /**< Alert type, e.g. "temperature_high" */
+    uint8_t quantity;         /**< history_quantity_t watched */
+    uint8_t direction;        /**< alert_direction_t */
+    uint8_t severity;         /**< alert_severity_t */
+    int16_t threshold;        /**< Threshold, fixed-point */
+    int16_t hysteresis;       /**< Distance back past the threshold that recovers, fixed-point */
+    uint16_t min_duration_s;  /**< Time a breach or recovery must last (0 = immediate) */
+    uint16_t cooldown_s;      /**< Time after clearing before the rule can be raised again */
+} alert_rule_t;
+
+/**
+ * @brief State machine of one rule
+ */
+typedef struct {
+    uint8_t state;            /**< alert_state_t */
+    int16_t peak;             /**< Worst value since the alert was raised, fixed-point */
+    uint32_t since;           /**< Time the current PENDING or RECOVERING state began (s) */
+    uint32_t hold_until;      /**< The rule cannot be raised before this time (s) */
+} alert_channel_t;
+
+/**
+ * @brief Alert engine state
+ */
+typedef struct {
+    alert_channel_t channels[ALERT_ENGINE_MAX_RULES]; /**< State per rule, by rule index */
+} alert_engine_t;
+
+/**
+ * @brief An alert that was raised or cleared
+ */
+typedef struct {
+    uint8_t rule;             /**< Index of the rule */
+    bool raised;              /**< true when raised, false when cleared */
+    int16_t value;            /**< Value that completed the transition, fixed-point */
+    int16_t peak;             /**< Worst value while the alert was active, fixed-point */
+    uint32_t timestamp;       /**< Time of the transition (s) */
+} alert_transition_t;
+
+/**
+ * @brief Reset every rule to CLEAR
+ *
+ * @param engine Engine state
+ */
+void alert_engine_init(alert_engine_t *engine);
+
+/**
+ * @brief Run a sample through the rules that watch its quantity
+ *
+ * @param engine Engine state
+ * @param rules Rule table (at most ALERT_ENGINE_MAX_RULES rules)
+ * @param rule_count Number of rules
+ * @param quantity Quantity of the sample
+ * @param value Fixed-point sample
+ * @param time_s Time of the sample in seconds
+ * @param transitions Array to store the transitions in (may be NULL)
+ * @param max_transitions Capacity of the array
+ * @return Number of transitions (also counted when they do not fit the array)
+ */
+int alert_engine_update(alert_engine_t *engine, const alert_rule_t *rules, int rule_count,
+                        history_quantity_t quantity, int16_t value, uint32_t time_s,
+                        alert_transition_t *transitions, int max_transitions);
+
+/**
+ * @brief Whether the alert of a rule is currently raised
+ *
+ * @param engine Engine state
+ * @param rule Index of the rule
+ * @return true in ACTIVE or RECOVERING
+ */
+bool alert_engine_is_active(const alert_engine_t *engine, int rule);
+
+/**
+ * @brief Get the built-in rules, with thresholds from config.h
+ *
+ * @param count Pointer to store the number of rules
+ * @return Rule table
+ */
+const alert_rule_t *alert_engine_default_rules(int *count);
+
+/**
+ * @brief Get a severity as text
+ *
+ * @param severity Severity level
+ * @return "info", "warning" or "critical"
+ */
+const char *alert_engine_severity_name(alert_severity_t severity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ALERT_ENGINE_H
@@ -0,0 +1,119 @@
+/**
+ * @file anomaly_detector.c
+ * @brief EWMA Anomaly Detection Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "anomaly_detector.h"
+#include <string.h>
+
+/**
+ * @brief Smallest standard deviation per quantity, in fixed-point units
+ *
+ * Roughly the noise of the sensors, so that a flat signal needs a real
+ * change to fire.
+ */
+static const int16_t k_min_sigma[HISTORY_QTY_COUNT] = {
+    [HISTORY_QTY_TEMPERATURE] = 25,   // 0.25 °C
+    [HISTORY_QTY_HUMIDITY] = 100,     // 1 %
+    [HISTORY_QTY_SOIL_MOISTURE] = 30,
+    [HISTORY_QTY_LIGHT_LEVEL] = 30,
+    [HISTORY_QTY_LUX] = 25,           // 50 lux
+    [HISTORY_QTY_VPD] = 50,           // 0.05 kPa
+};
+
+/**
+ * @brief Integer square root (floor)
+ */
+static uint64_t isqrt64(uint64_t x)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+static int16_t saturate16(int64_t value)
+{
+    return (int16_t)(value < INT16_MIN ? INT16_MIN : (value > INT16_MAX ? INT16_MAX : value));
+}
+
+int16_t anomaly_detector_min_sigma(history_quantity_t quantity)
+{
+    return ((unsigned)quantity < HISTORY_QTY_COUNT) ? k_min_sigma[quantity] : 1;
+}
+
+void anomaly_detector_init(anomaly_detector_t *detector, history_quantity_t quantity)
+{
+    if (!detector) {
+        return;
+    }
+    memset(detector, 0, sizeof(*detector));
+    detector->quantity = (uint8_t)quantity;
+}
+
+bool anomaly_detector_update(anomaly_detector_t *detector, int16_t value, anomaly_event_t *event)
+{
+    if (!detector) {
+        return false;
+    }
+
+    int32_t scaled = (int32_t)value << ANOMALY_FRACTION_BITS;
+    if (detector->samples == 0) {
+        detector->mean = scaled;
+        detector->variance = 0;
+        detector->samples = 1;
+        return false;
+    }
+
+    // Deviation in units << F, its square in units² << F like the variance
+    int64_t diff = (int64_t)scaled - detector->mean;
+    uint64_t square = (uint64_t)(diff * diff) >> ANOMALY_FRACTION_BITS;
+
+    uint64_t sigma = (uint64_t)anomaly_detector_min_sigma((history_quantity_t)detector->quantity);
+    uint64_t minimum = (sigma * sigma) << ANOMALY_FRACTION_BITS;
+    uint64_t variance = detector->variance > minimum ? detector->variance : minimum;
+    uint64_t z2 = (uint64_t)ANOMALY_Z_THRESHOLD * ANOMALY_Z_THRESHOLD;
+
+    bool fired = detector->samples >= ANOMALY_WARMUP_SAMPLES && detector->holdoff == 0 &&
+                 square > z2 * variance;
+
+    if (fired && event) {
+        // sqrt(variance << F) is the standard deviation in units << F, like diff
+        int64_t deviation = (int64_t)isqrt64(variance << ANOMALY_FRACTION_BITS);
+        event->quantity = detector->quantity;
+        event->value = value;
+        event->mean = saturate16(detector->mean >> ANOMALY_FRACTION_BITS);
+        event->z = saturate16(diff * 100 / (deviation > 0 ? deviation : 1));
+    }
+
+    // Weight 1/2^k for the new sample; the variance follows
+    // v' = (1 - a)(v + a d²), dropping the a² term
+    detector->mean += (int32_t)(diff / (1 << ANOMALY_EWMA_SHIFT));
+    int64_t step = ((int64_t)square - (int64_t)detector->variance) / (1 << ANOMALY_EWMA_SHIFT);
+    detector->variance = (uint64_t)((int64_t)detector->variance + step);
+
+    if (detector->samples < ANOMALY_WARMUP_SAMPLES) {
+        detector->samples++;
+    }
+    if (fired) {
+        detector->holdoff = ANOMALY_HOLDOFF_SAMPLES;
+    } else if (detector->holdoff > 0) {
+        detector->holdoff--;
+    }
+    return fired;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file anomaly_detector.h
+ * @brief EWMA Anomaly Detection for Plant Monitoring System
+ *
+ * This module flags samples that break sharply from the recent behaviour
+ * of a channel, so that the device can report them at once instead of
+ * waiting for the next batch upload.
+ *
+ * Each channel keeps an exponentially weighted moving average and
+ * variance with weight 1/2^ANOMALY_EWMA_SHIFT per new sample. A sample
+ * fires when it lies more than ANOMALY_Z_THRESHOLD standard deviations
+ * from the average, judged against the state before the sample is
+ * added. The standard deviation has a floor per quantity so that sensor
+ * noise on a flat signal does not fire, no sample fires during the first
+ * ANOMALY_WARMUP_SAMPLES, and a channel that fired stays quiet for
+ * ANOMALY_HOLDOFF_SAMPLES. Every sample updates the state, so a lasting
+ * step fires once and then becomes the new normal.
+ *
+ * The comparison is done on squares in fixed point, so a sample costs a
+ * few integer multiplies and shifts; the z-score itself (one integer
+ * square root) is only computed for a sample that fires. State is owned
+ * by the caller, so it can live in RTC memory across deep sleep. Values
+ * use the fixed-point encoding of the reading history (see
+ * history_quantity_t); the module has no ESP-IDF dependencies.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef ANOMALY_DETECTOR_H
+#define ANOMALY_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "reading_history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Fractional bits of the average */
+#define ANOMALY_FRACTION_BITS  4
+
+/**
+ * @brief Detector state of one channel
+ */
+typedef struct {
+    int32_t mean;             /**< Average, fixed-point value << ANOMALY_FRACTION_BITS */
+    uint64_t variance;        /**< Variance, squared fixed-point units << ANOMALY_FRACTION_BITS */
+    uint16_t samples;         /**< Samples seen (saturates at ANOMALY_WARMUP_SAMPLES) */
+    uint8_t holdoff;          /**< Samples left before the channel may fire again */
+    uint8_t quantity;         /**< history_quantity_t of the channel */
+} anomaly_detector_t;
+
+/**
+ * @brief A sample that fired
+ */
+typedef struct {
+    uint8_t quantity;         /**< history_quantity_t of the channel */
+    int16_t value;            /**< The sample, fixed-point */
+    int16_t mean;             /**< Average before the sample, fixed-point */
+    int16_t z;                /**< Signed deviation in 0.01 standard deviations (saturating) */
+} anomaly_event_t;
+
+/**
+ * @brief Reset a channel
+ *
+ * @param detector Detector state
+ * @param quantity Quantity of the channel (selects the standard deviation floor)
+ */
+void anomaly_detector_init(anomaly_detector_t *detector, history_quantity_t quantity);
+
+/**
+ * @brief Add a sample and check it against the channel's recent behaviour
+ *
+ * @param detector Detector state
+ * @param value Fixed-point sample
+ * @param event Pointer to store the details if the sample fires (may be NULL)
+ * @return true if the sample is an anomaly
+ */
+bool anomaly_detector_update(anomaly_detector_t *detector, int16_t value, anomaly_event_t *event);
+
+/**
+ * @brief Standard deviation floor of a quantity
+ *
+ * @param quantity Measured quantity
+ * @return Smallest standard deviation used, in fixed-point units
+ */
+int16_t anomaly_detector_min_sigma(history_quantity_t quantity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANOMALY_DETECTOR_H
@@ -0,0 +1,168 @@
+/**
+ * @file dry_predictor.c
+ * @brief Time-to-Dry Prediction Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "dry_predictor.h"
+#include <string.h>
+
+/** Relative time at which the sums are moved to a later origin */
+#define REBASE_SECONDS  (1u << 20)
+
+/** Longest silence before the samples are considered stale */
+#define MAX_GAP_SECONDS ((uint32_t)DRY_PREDICTOR_SAMPLES * DRY_PREDICTOR_INTERVAL_S)
+
+static uint8_t newest_index(const dry_predictor_t *predictor)
+{
+    return (uint8_t)((predictor->head + predictor->count - 1) % DRY_PREDICTOR_SAMPLES);
+}
+
+/**
+ * @brief Add (sign 1) or remove (sign -1) a sample from the sums
+ */
+static void accumulate(dry_predictor_t *predictor, uint32_t time_s, int16_t value, int sign)
+{
+    int64_t t = (int64_t)(time_s - predictor->origin);
+    predictor->sum_t += sign * t;
+    predictor->sum_v += sign * value;
+    predictor->sum_tt += sign * t * t;
+    predictor->sum_tv += sign * t * value;
+}
+
+/**
+ * @brief Move the origin of the sums to a later time, keeping them exact
+ */
+static void rebase(dry_predictor_t *predictor, uint32_t origin)
+{
+    int64_t d = (int64_t)(origin - predictor->origin);
+    int64_t n = predictor->count;
+    predictor->sum_tt += -2 * d * predictor->sum_t + n * d * d;
+    predictor->sum_tv -= d * predictor->sum_v;
+    predictor->sum_t -= n * d;
+    predictor->origin = origin;
+}
+
+static void clear_samples(dry_predictor_t *predictor, uint32_t origin)
+{
+    predictor->head = 0;
+    predictor->count = 0;
+    predictor->origin = origin;
+    predictor->sum_t = 0;
+    predictor->sum_v = 0;
+    predictor->sum_tt = 0;
+    predictor->sum_tv = 0;
+}
+
+/**
+ * @brief Add an averaged sample to the ring, dropping the oldest if it is full
+ */
+static void push_sample(dry_predictor_t *predictor, int16_t value, uint32_t time_s)
+{
+    if (predictor->count == 0 ||
+        value - predictor->value[newest_index(predictor)] >= DRY_PREDICTOR_WATERING_STEP) {
+        clear_samples(predictor, time_s);
+    }
+
+    if (predictor->count == DRY_PREDICTOR_SAMPLES) {
+        accumulate(predictor, predictor->time[predictor->head], predictor->value[predictor->head], -1);
+        predictor->head = (uint8_t)((predictor->head + 1) % DRY_PREDICTOR_SAMPLES);
+        predictor->count--;
+    }
+
+    if (time_s - predictor->origin >= REBASE_SECONDS) {
+        rebase(predictor, predictor->count ? predictor->time[predictor->head] : time_s);
+    }
+
+    uint8_t index = (uint8_t)((predictor->head + predictor->count) % DRY_PREDICTOR_SAMPLES);
+    predictor->time[index] = time_s;
+    predictor->value[index] = value;
+    predictor->count++;
+    accumulate(predictor, time_s, value, 1);
+}
+
+void dry_predictor_init(dry_predictor_t *predictor)
+{
+    if (predictor) {
+        memset(predictor, 0, sizeof(*predictor));
+    }
+}
+
+void dry_predictor_update(dry_predictor_t *predictor, int16_t raw, uint32_t time_s)
+{
+    if (!predictor) {
+        return;
+    }
+
+    // A clock set back or a long silence leaves nothing to extrapolate from
+    if (predictor->pending_count > 0 || predictor->count > 0) {
+        uint32_t last = predictor->pending_count ? predictor->pending_last
+                                                 : predictor->time[newest_index(predictor)];
+        if (time_s < last || time_s - last > MAX_GAP_SECONDS) {
+            dry_predictor_init(predictor);
+        }
+    }
+
+    if (predictor->pending_count > 0 && time_s - predictor->pending_start >= DRY_PREDICTOR_INTERVAL_S) {
+        int32_t count = predictor->pending_count;
+        int16_t mean = (int16_t)((predictor->pending_sum + count / 2) / count);
+        uint32_t middle = predictor->pending_start + (predictor->pending_last - predictor->pending_start) / 2;
+        push_sample(predictor, mean, middle);
+        predictor->pending_count = 0;
+        predictor->pending_sum = 0;
+    }
+
+    if (predictor->pending_count == 0) {
+        predictor->pending_start = time_s;
+    }
+    if (predictor->pending_count < UINT16_MAX) {
+        predictor->pending_sum += raw;
+        predictor->pending_count++;
+    }
+    predictor->pending_last = time_s;
+}
+
+bool dry_predictor_slope(const dry_predictor_t *predictor, float *slope)
+{
+    if (!predictor || !slope || predictor->count < DRY_PREDICTOR_MIN_SAMPLES) {
+        return false;
+    }
+
+    int64_t n = predictor->count;
+    int64_t denominator = n * predictor->sum_tt - predictor->sum_t * predictor->sum_t;
+    if (denominator <= 0) {
+        return false;
+    }
+    int64_t numerator = n * predictor->sum_tv - predictor->sum_t * predictor->sum_v;
+    *slope = (float)numerator / (float)denominator * 3600.0f;
+    return true;
+}
+
+float dry_predictor_hours(const dry_predictor_t *predictor, int16_t threshold, uint32_t now_s)
+{
+    float slope;
+    if (!dry_predictor_slope(predictor, &slope) || slope >= 0.0f) {
+        return DRY_PREDICTOR_NONE;
+    }
+
+    // Fitted value at the newest sample: the line passes through the means
+    float n = predictor->count;
+    uint32_t newest = predictor->time[newest_index(predictor)];
+    float offset_h = ((float)(newest - predictor->origin) - predictor->sum_t / n) / 3600.0f;
+    float fitted = predictor->sum_v / n + slope * offset_h;
+    if (fitted <= threshold) {
+        return 0.0f;
+    }
+
+    float hours = (fitted - threshold) / -slope;
+    if (hours > DRY_PREDICTOR_MAX_HOURS) {
+        return DRY_PREDICTOR_NONE;
+    }
+    if (now_s > newest) {
+        hours -= (now_s - newest) / 3600.0f;
+    }
+    return hours > 0.0f ? hours : 0.0f;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file dry_predictor.h
+ * @brief Time-to-Dry Prediction for Plant Monitoring System
+ *
+ * This module estimates how long the soil will take to dry out by
+ * fitting a least-squares line through recent soil moisture samples and
+ * extrapolating it to the dry threshold.
+ *
+ * Samples are first averaged over DRY_PREDICTOR_INTERVAL_S, so the fit
+ * spans the same stretch of time whatever the sampling rate and the ADC
+ * noise is reduced before it reaches the regression. The averages go
+ * into a ring of DRY_PREDICTOR_SAMPLES; the sums of the normal equations
+ * are updated as samples enter and leave the ring, so an update is O(1)
+ * and a prediction needs one division. The sums are kept in 64-bit
+ * integers (times relative to a moving origin), so adding and removing
+ * samples never accumulates rounding error.
+ *
+ * Watering shows up as a sharp rise, after which the old samples say
+ * nothing about the new drying curve; such a rise restarts the fit, as
+ * does a gap or a clock set back.
+ *
+ * State is owned by the caller, so it can live in RTC memory across deep
+ * sleep. The module has no ESP-IDF dependencies.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef DRY_PREDICTOR_H
+#define DRY_PREDICTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if DRY_PREDICTOR_SAMPLES < 2 || DRY_PREDICTOR_SAMPLES > 255
+#error "DRY_PREDICTOR_SAMPLES must be between 2 and 255"
+#endif
+
+/** Returned by dry_predictor_hours() when no drying trend is known */
+#define DRY_PREDICTOR_NONE       (-1.0f)
+
+/**
+ * @brief Prediction state of one soil moisture series
+ */
+typedef struct {
+    uint32_t time[DRY_PREDICTOR_SAMPLES];  /**< Sample times in seconds */
+    int16_t value[DRY_PREDICTOR_SAMPLES];  /**< Averaged soil moisture samples */
+    uint8_t head;             /**< Index of the oldest sample */
+    uint8_t count;            /**< Samples in the ring */
+    uint16_t pending_count;   /**< Readings in the average being built */
+    int32_t pending_sum;      /**< Sum of those readings */
+    uint32_t pending_start;   /**< Time of the first of them */
+    uint32_t pending_last;    /**< Time of the last of them */
+    uint32_t origin;          /**< Time the sums are relative to */
+    int64_t sum_t;            /**< Sum of relative times */
+    int64_t sum_v;            /**< Sum of values */
+    int64_t sum_tt;           /**< Sum of squared relative times */
+    int64_t sum_tv;           /**< Sum of time-value products */
+} dry_predictor_t;
+
+/**
+ * @brief Discard all samples
+ *
+ * @param predictor Prediction state
+ */
+void dry_predictor_init(dry_predictor_t *predictor);
+
+/**
+ * @brief Add a soil moisture reading
+ *
+ * @param predictor Prediction state
+ * @param raw Calibrated soil moisture (higher is wetter)
+ * @param time_s Time of the reading in seconds
+ */
+void dry_predictor_update(dry_predictor_t *predictor, int16_t raw, uint32_t time_s);
+
+/**
+ * @brief Drying rate of the current fit
+ *
+ * @param predictor Prediction state
+ * @param slope Pointer to store the slope in raw units per hour (negative when drying)
+ * @return true if enough samples are available for a fit
+ */
+bool dry_predictor_slope(const dry_predictor_t *predictor, float *slope);
+
+/**
+ * @brief Predict the time until the soil reaches a threshold
+ *
+ * The fitted line is evaluated at the newest sample and extrapolated to
+ * the threshold; the time elapsed since that sample is subtracted.
+ *
+ * @param predictor Prediction state
+ * @param threshold Soil moisture counted as dry (raw)
+ * @param now_s Current time in seconds
+ * @return Hours until dry (0 if already dry), DRY_PREDICTOR_NONE if the
+ *         soil is not drying or too few samples are available
+ */
+float dry_predictor_hours(const dry_predictor_t *predictor, int16_t threshold, uint32_t now_s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DRY_PREDICTOR_H
@@ -0,0 +1,300 @@
+/**
+ * @file health_engine.c
+ * @brief Table-Driven Plant Health Scoring Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "health_engine.h"
+#include <string.h>
+
+/** Score at the edges of the acceptable range */
+#define EDGE_SCORE  (HEALTH_SCORE_MAX / 2)
+
+/**
+ * @brief Built-in profiles
+ *
+ * Temperature and humidity in hundredths, soil moisture and light level
+ * as raw ADC values (higher is wetter / brighter), lux in units of 2 lux,
+ * vapour pressure deficit in Pa.
+ * An upper limit of INT16_MAX means the quantity cannot be too high.
+ */
+static const health_profile_t k_profiles[] = {
+    {
+        .name = "default",
+        .rules = {
+            [HISTORY_QTY_TEMPERATURE] = { 1000, 1800, 2800, 3500, 50, 3 },
+            [HISTORY_QTY_HUMIDITY] = { 3000, 4000, 7000, 8000, 200, 2 },
+            [HISTORY_QTY_SOIL_MOISTURE] = { 1000, 1500, 2500, 3000, 50, 3 },
+            [HISTORY_QTY_LIGHT_LEVEL] = { 200, 1000, 3500, 4095, 50, 2 },
+            [HISTORY_QTY_LUX] = { 50, 500, 5000, 25000, 50, 2 },
+            [HISTORY_QTY_VPD] = { 400, 800, 1200, 1600, 50, 2 },
+        },
+    },
+    {
+        .name = "tropical",
+        .rules = {
+            [HISTORY_QTY_TEMPERATURE] = { 1500, 2000, 3000, 3500, 50, 3 },
+            [HISTORY_QTY_HUMIDITY] = { 5000, 6000, 8500, 9500, 200, 3 },
+            [HISTORY_QTY_SOIL_MOISTURE] = { 1500, 2000, 2800, 3300, 50, 3 },
+            [HISTORY_QTY_LIGHT_LEVEL] = { 200, 800, 3000, 4095, 50, 2 },
+            [HISTORY_QTY_LUX] = { 125, 1250, 10000, 25000, 50, 2 },
+            [HISTORY_QTY_VPD] = { 200, 400, 900, 1300, 50, 2 },
+        },
+    },
+    {
+        .name = "succulent",
+        .rules = {
+            [HISTORY_QTY_TEMPERATURE] = { 500, 1500, 3000, 4000, 50, 2 },
+            [HISTORY_QTY_HUMIDITY] = { 1000, 2000, 5000, 7000, 200, 1 },
+            [HISTORY_QTY_SOIL_MOISTURE] = { 500, 800, 1800, 2600, 50, 3 },
+            [HISTORY_QTY_LIGHT_LEVEL] = { 800, 2000, INT16_MAX, INT16_MAX, 50, 3 },
+            [HISTORY_QTY_LUX] = { 500, 5000, 25000, 32500, 50, 3 },
+            [HISTORY_QTY_VPD] = { 400, 1000, 2000, 3000, 50, 1 },
+        },
+    },
+    {
+        .name = "herb",
+        .rules = {
+            [HISTORY_QTY_TEMPERATURE] = { 1000, 1600, 2600, 3200, 50, 3 },
+            [HISTORY_QTY_HUMIDITY] = { 3000, 4000, 6500, 8000, 200, 2 },
+            [HISTORY_QTY_SOIL_MOISTURE] = { 1200, 1800, 2600, 3100, 50, 3 },
+            [HISTORY_QTY_LIGHT_LEVEL] = { 500, 1500, INT16_MAX, INT16_MAX, 50, 3 },
+            [HISTORY_QTY_LUX] = { 1000, 4000, 20000, 30000, 50, 3 },
+            [HISTORY_QTY_VPD] = { 400, 800, 1300, 1700, 50, 2 },
+        },
+    },
+};
+
+#define PROFILE_COUNT  ((int)(sizeof(k_profiles) / sizeof(k_profiles[0])))
+
+static const health_level_info_t k_levels[HEALTH_LEVEL_COUNT] = {
+    [HEALTH_LEVEL_EXCELLENT] = { "Excellent", "😊", "Perfect conditions! Keep it up." },
+    [HEALTH_LEVEL_GOOD] = { "Good", "🙂", "Good conditions, monitor regularly." },
+    [HEALTH_LEVEL_FAIR] = { "Fair", "😐", "Acceptable conditions, consider adjustments." },
+    [HEALTH_LEVEL_POOR] = { "Poor", "😟", "Needs attention, check environment." },
+    [HEALTH_LEVEL_CRITICAL] = { "Critical", "😱", "Immediate attention required!" },
+};
+
+int health_engine_profile_count(void)
+{
+    return PROFILE_COUNT;
+}
+
+const health_profile_t *health_engine_profile(int index)
+{
+    return (index >= 0 && index < PROFILE_COUNT) ? &k_profiles[index] : NULL;
+}
+
+const health_profile_t *health_engine_find_profile(const char *name)
+{
+    if (!name) {
+        return NULL;
+    }
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        if (strcmp(k_profiles[i].name, name) == 0) {
+            return &k_profiles[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Linear ramp between two knots, for x between them (x_a != x_b)
+ */
+static int32_t ramp(int32_t x, int32_t x_a, int32_t x_b, int32_t y_a, int32_t y_b)
+{
+    return y_a + (int32_t)(((int64_t)(y_b - y_a) * (x - x_a)) / (x_b - x_a));
+}
+
+/**
+ * @brief Score curve of a rule at one point (see health_engine.h for the knots)
+ */
+static uint16_t curve_point(const health_rule_t *rule, int32_t x)
+{
+    int32_t low = rule->min - (rule->optimal_min - rule->min) / 2;
+    int32_t high = rule->max + (rule->max - rule->optimal_max) / 2;
+
+    if (x >= rule->optimal_min && x <= rule->optimal_max) {
+        return HEALTH_SCORE_MAX;
+    }
+    if (x < rule->optimal_min) {
+        if (x >= rule->min) {
+            return (uint16_t)ramp(x, rule->min, rule->optimal_min, EDGE_SCORE, HEALTH_SCORE_MAX);
+        }
+        return (x >= low) ? (uint16_t)ramp(x, low, rule->min, 0, EDGE_SCORE) : 0;
+    }
+    if (x <= rule->max) {
+        return (uint16_t)ramp(x, rule->optimal_max, rule->max, HEALTH_SCORE_MAX, EDGE_SCORE);
+    }
+    return (x <= high) ? (uint16_t)ramp(x, rule->max, high, EDGE_SCORE, 0) : 0;
+}
+
+/**
+ * @brief Smallest power-of-two step that covers span in HEALTH_CURVE_SEGMENTS steps
+ */
+static uint8_t fit_shift(int32_t span)
+{
+    uint8_t shift = 0;
+    while (((int32_t)HEALTH_CURVE_SEGMENTS << shift) < span) {
+        shift++;
+    }
+    return shift;
+}
+
+/**
+ * @brief Sample a rule's score curve into a table with origin and shift set
+ */
+static void sample_side(const health_rule_t *rule, health_lut_t *lut)
+{
+    for (int i = 0; i <= HEALTH_CURVE_SEGMENTS; i++) {
+        lut->table[i] = curve_point(rule, lut->origin + ((int32_t)i << lut->shift));
+    }
+}
+
+/**
+ * @brief Compile the score curve of a rule
+ *
+ * Each side of the optimal range gets its own table, starting (high side)
+ * or ending (low side) exactly on the optimal edge, so a skewed range
+ * such as lux keeps its resolution on the narrow side.
+ */
+static void compile_curve(const health_rule_t *rule, health_curve_t *curve)
+{
+    int32_t low = rule->min - (rule->optimal_min - rule->min) / 2;
+    int32_t high = rule->max + (rule->max - rule->optimal_max) / 2;
+
+    curve->split = rule->optimal_max;
+
+    curve->side[0].shift = fit_shift(rule->optimal_min - low);
+    curve->side[0].origin = rule->optimal_min - ((int32_t)HEALTH_CURVE_SEGMENTS << curve->side[0].shift);
+    sample_side(rule, &curve->side[0]);
+
+    curve->side[1].shift = fit_shift(high - rule->optimal_max);
+    curve->side[1].origin = rule->optimal_max;
+    sample_side(rule, &curve->side[1]);
+}
+
+/**
+ * @brief Largest score change a move of the rule's hysteresis can cause on a compiled curve
+ *
+ * Taken on the steepest table segment, so the margin is fixed per
+ * profile and costs nothing at evaluation time.
+ */
+static uint16_t curve_swing(const health_rule_t *rule, const health_curve_t *curve)
+{
+    uint32_t swing = 0;
+    for (int side = 0; side < 2; side++) {
+        const health_lut_t *lut = &curve->side[side];
+        for (int i = 0; i < HEALTH_CURVE_SEGMENTS; i++) {
+            int32_t step = (int32_t)lut->table[i + 1] - lut->table[i];
+            uint32_t change = ((uint32_t)(step < 0 ? -step : step) * (uint32_t)rule->hysteresis) >> lut->shift;
+            swing = change > swing ? change : swing;
+        }
+    }
+    return (uint16_t)(swing < HEALTH_SCORE_MAX ? swing : HEALTH_SCORE_MAX);
+}
+
+void health_engine_set_profile(health_context_t *context, const health_profile_t *profile)
+{
+    if (!context) {
+        return;
+    }
+    memset(context, 0, sizeof(*context));
+    context->profile = profile ? profile : &k_profiles[0];
+    for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+        compile_curve(&context->profile->rules[q], &context->curve[q]);
+        context->swing[q] = curve_swing(&context->profile->rules[q], &context->curve[q]);
+    }
+}
+
+uint16_t health_engine_curve_score(const health_curve_t *curve, int32_t value)
+{
+    // Pick the side, clamp into its table, then interpolate between the
+    // two nearest entries
+    const health_lut_t *lut = &curve->side[value > curve->split];
+    int32_t span = (int32_t)HEALTH_CURVE_SEGMENTS << lut->shift;
+    int32_t offset = value - lut->origin;
+    offset = offset < 0 ? 0 : offset;
+    offset = offset > span ? span : offset;
+
+    uint32_t index = (uint32_t)offset >> lut->shift;
+    uint32_t fraction = (uint32_t)offset & ((1u << lut->shift) - 1);
+    uint32_t next = index + (index < HEALTH_CURVE_SEGMENTS);
+    uint32_t weighted = lut->table[index] * ((1u << lut->shift) - fraction) + lut->table[next] * fraction;
+    return (uint16_t)(weighted >> lut->shift);
+}
+
+/**
+ * @brief Level of a score, with hysteresis around the previous level
+ *
+ * The level is the number of level floors above the score. A floor the
+ * score was above last time is lowered by the margin, one it was below
+ * is raised, so changing level takes a margin in either direction.
+ */
+static health_level_t score_level(uint16_t score, health_level_t previous, int32_t margin)
+{
+    static const int32_t k_floors[HEALTH_LEVEL_COUNT - 1] = { 9000, 7000, 5000, 3000 };
+    int level = 0;
+    for (int k = 0; k < HEALTH_LEVEL_COUNT - 1; k++) {
+        int32_t shift = ((int)previous > k) ? margin : -margin;
+        level += ((int32_t)score < k_floors[k] + shift);
+    }
+    return (health_level_t)level;
+}
+
+void health_engine_evaluate(health_context_t *context, const health_inputs_t *inputs, health_result_t *result)
+{
+    if (!context || !inputs || !result) {
+        return;
+    }
+    if (!context->profile) {
+        health_engine_set_profile(context, NULL);
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->limiting = -1;
+
+    uint32_t weighted = 0;
+    uint32_t weighted_swing = 0;
+    uint32_t total_weight = 0;
+    uint16_t lowest = HEALTH_SCORE_MAX + 1;
+
+    for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+        const health_rule_t *rule = &context->profile->rules[q];
+        if (!((inputs->present >> q) & 1) || rule->weight == 0) {
+            continue;
+        }
+
+        uint16_t score = health_engine_curve_score(&context->curve[q], inputs->value[q]);
+        result->quantity_score[q] = score;
+        weighted += (uint32_t)score * rule->weight;
+        if (score > 0 && score < HEALTH_SCORE_MAX) {
+            // Only a value on the ramp moves the score when it moves
+            weighted_swing += (uint32_t)context->swing[q] * rule->weight;
+        }
+        total_weight += rule->weight;
+
+        if (score < lowest) {
+            lowest = score;
+            result->limiting = (int8_t)q;
+            result->limiting_low = inputs->value[q] < rule->optimal_min;
+        }
+    }
+
+    result->score = total_weight ? (uint16_t)((weighted + total_weight / 2) / total_weight) : 0;
+
+    // The level only changes once the score is past a floor by what the
+    // quantities' hysteresis bands are worth on their curves
+    int32_t margin = (context->scored && total_weight) ? (int32_t)(weighted_swing / total_weight) : 0;
+    result->level = score_level(result->score, context->level, margin);
+    context->level = result->level;
+    context->scored = true;
+}
+
+const health_level_info_t *health_engine_level_info(health_level_t level)
+{
+    return &k_levels[((int)level >= 0 && level < HEALTH_LEVEL_COUNT) ? level : HEALTH_LEVEL_CRITICAL];
+}
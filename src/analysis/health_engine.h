@@ -0,0 +1,204 @@
+/**
+ * @file health_engine.h
+ * @brief Table-Driven Plant Health Scoring for Plant Monitoring System
+ *
+ * This module is the single plant health calculator. What is healthy
+ * depends on the species, so the rules live in constant profile tables
+ * rather than in code: per measured quantity, an acceptable range, an
+ * optimal range inside it and a weight.
+ *
+ * A quantity scores 100 in its optimal range and 50 at the edges of the
+ * acceptable range, falling linearly in between; outside, the score
+ * falls on to 0 over half the width of the adjacent acceptable band.
+ * The curve is continuous, so a value drifting across a range edge moves
+ * the score a little rather than stepping it by 50.
+ *
+ * Selecting a profile compiles each side of each curve into a lookup
+ * table of HEALTH_CURVE_SEGMENTS power-of-two steps. Scoring a value is
+ * then a side select, a clamp, a shift, a table lookup and a linear
+ * interpolation, with no per-threshold branches and no float. The
+ * overall score is the weighted mean over the quantities that were
+ * measured; a weight of 0 leaves a quantity out for that species.
+ *
+ * The health level keeps per-quantity hysteresis: it only changes once
+ * the score is past the level floor by the amount the score would move
+ * if every measured quantity moved by its rule's hysteresis on the
+ * steepest part of its curve, so a value sitting near a boundary does
+ * not make the level flap. That amount is worked out with the tables,
+ * so evaluation still takes one lookup per quantity.
+ *
+ * Values use the fixed-point encoding of the reading history (see
+ * history_quantity_t), and all arithmetic is integer. Every plant or
+ * zone has its own health_context_t holding its compiled tables, so one
+ * greenhouse can mix species.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef HEALTH_ENGINE_H
+#define HEALTH_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "reading_history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Largest score, in hundredths of a point */
+#define HEALTH_SCORE_MAX         10000
+
+/** Segments per side of a compiled score curve */
+#define HEALTH_CURVE_SEGMENTS    32
+
+/**
+ * @brief Health levels, best first
+ */
+typedef enum {
+    HEALTH_LEVEL_EXCELLENT = 0,  /**< Score 90 and above */
+    HEALTH_LEVEL_GOOD,           /**< Score 70 and above */
+    HEALTH_LEVEL_FAIR,           /**< Score 50 and above */
+    HEALTH_LEVEL_POOR,           /**< Score 30 and above */
+    HEALTH_LEVEL_CRITICAL,       /**< Score below 30 */
+    HEALTH_LEVEL_COUNT           /**< Number of levels */
+} health_level_t;
+
+/**
+ * @brief Rule for one quantity, in fixed-point units (see history_quantity_t)
+ */
+typedef struct {
+    int16_t min;              /**< Lowest acceptable value */
+    int16_t optimal_min;      /**< Lowest optimal value */
+    int16_t optimal_max;      /**< Highest optimal value */
+    int16_t max;              /**< Highest acceptable value */
+    int16_t hysteresis;       /**< Change of value needed to change the health level */
+    uint8_t weight;           /**< Share of the overall score (0 = not scored) */
+} health_rule_t;
+
+/**
+ * @brief Scoring profile of a plant species
+ */
+typedef struct {
+    const char *name;                          /**< Profile name */
+    health_rule_t rules[HISTORY_QTY_COUNT];    /**< Rule per quantity */
+} health_profile_t;
+
+/**
+ * @brief Display text of a health level
+ */
+typedef struct {
+    const char *text;         /**< Human-readable status */
+    const char *emoji;        /**< Emoji representation */
+    const char *recommendation; /**< Care recommendation */
+} health_level_info_t;
+
+/**
+ * @brief Measured values of one plant
+ */
+typedef struct {
+    int32_t value[HISTORY_QTY_COUNT];  /**< Fixed-point value per quantity */
+    uint8_t present;                   /**< Quantities measured (bit n = quantity n) */
+} health_inputs_t;
+
+/**
+ * @brief Lookup table of one side of a score curve, sampled every (1 << shift) units
+ */
+typedef struct {
+    int32_t origin;                               /**< Value of the first entry */
+    uint8_t shift;                                /**< Log2 of the sample step */
+    uint16_t table[HEALTH_CURVE_SEGMENTS + 1];    /**< Score in hundredths per sample */
+} health_lut_t;
+
+/**
+ * @brief Compiled score curve of one quantity
+ */
+typedef struct {
+    int32_t split;            /**< Values above this use the high side */
+    health_lut_t side[2];     /**< Below and above the optimal range */
+} health_curve_t;
+
+/**
+ * @brief Scoring state of one plant or zone
+ */
+typedef struct {
+    const health_profile_t *profile;           /**< Active profile */
+    health_curve_t curve[HISTORY_QTY_COUNT];   /**< Compiled curve per quantity */
+    uint16_t swing[HISTORY_QTY_COUNT];         /**< Score change of a hysteresis move, per quantity */
+    health_level_t level;                      /**< Level of the last evaluation */
+    bool scored;                               /**< An evaluation has run since the profile was set */
+} health_context_t;
+
+/**
+ * @brief Result of an evaluation
+ */
+typedef struct {
+    uint16_t score;                          /**< Overall score in hundredths (0-HEALTH_SCORE_MAX) */
+    uint16_t quantity_score[HISTORY_QTY_COUNT]; /**< Score per quantity in hundredths */
+    health_level_t level;                    /**< Level of the overall score */
+    int8_t limiting;                         /**< Lowest scoring quantity, -1 if none was scored */
+    bool limiting_low;                       /**< The limiting quantity is below its optimal range */
+} health_result_t;
+
+/**
+ * @brief Number of built-in profiles
+ */
+int health_engine_profile_count(void);
+
+/**
+ * @brief Get a built-in profile by index
+ *
+ * @param index Profile index (0 is the default profile)
+ * @return Profile, or NULL if out of range
+ */
+const health_profile_t *health_engine_profile(int index);
+
+/**
+ * @brief Find a built-in profile by name
+ *
+ * @param name Profile name
+ * @return Profile, or NULL if unknown
+ */
+const health_profile_t *health_engine_find_profile(const char *name);
+
+/**
+ * @brief Select the profile of a context and compile its score curves
+ *
+ * @param context Context to initialize
+ * @param profile Profile to use, or NULL for the default profile
+ */
+void health_engine_set_profile(health_context_t *context, const health_profile_t *profile);
+
+/**
+ * @brief Score one value on a compiled curve
+ *
+ * @param curve Compiled curve
+ * @param value Fixed-point value
+ * @return Score in hundredths (0-HEALTH_SCORE_MAX)
+ */
+uint16_t health_engine_curve_score(const health_curve_t *curve, int32_t value);
+
+/**
+ * @brief Score a set of measured values
+ *
+ * @param context Context of the plant
+ * @param inputs Measured values
+ * @param result Pointer to store the result
+ */
+void health_engine_evaluate(health_context_t *context, const health_inputs_t *inputs, health_result_t *result);
+
+/**
+ * @brief Get the display text of a health level
+ *
+ * @param level Health level
+ * @return Level text (the critical level for out-of-range values)
+ */
+const health_level_info_t *health_engine_level_info(health_level_t level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HEALTH_ENGINE_H
@@ -0,0 +1,213 @@
+/**
+ * @file irrigation_controller.c
+ * @brief Closed-Loop Irrigation Control Law Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "irrigation_controller.h"
+#include <string.h>
+
+/** Reference moisture before the first sample */
+#define REFERENCE_UNKNOWN  INT16_MAX
+
+/** Interlocks that keep their state from one step to the next */
+#define FAULTS_PERSISTENT  (IRRIGATION_FAULT_WAITING | IRRIGATION_FAULT_DRY_RUN)
+
+static int32_t clamp32(int64_t value, int32_t min, int32_t max)
+{
+    return (int32_t)(value < min ? min : (value > max ? max : value));
+}
+
+/**
+ * @brief Bang-bang law: start below the band, run until the setpoint
+ */
+static bool law_bang_bang(const irrigation_controller_t *controller, int16_t moisture)
+{
+    const irrigation_params_t *params = &controller->params;
+    if (controller->pump_on) {
+        return moisture < params->setpoint;
+    }
+    return (int32_t)moisture < (int32_t)params->setpoint - params->hysteresis;
+}
+
+/**
+ * @brief PI law: set the run time of the window starting now
+ *
+ * @param controller Controller state
+ * @param moisture Latest soil moisture estimate
+ * @param elapsed_ms Length of the window that just ended (0 for the first)
+ * @param integrate Whether the error may be integrated (false while an interlock holds)
+ * @param now_ms Current time
+ */
+static void law_pi_window(irrigation_controller_t *controller, int16_t moisture, uint32_t elapsed_ms,
+                          bool integrate, uint32_t now_ms)
+{
+    const irrigation_params_t *params = &controller->params;
+    int32_t error = (int32_t)params->setpoint - moisture;
+    int64_t proportional = (int64_t)params->kp_permille * error;
+
+    // Keep the integral term within the output range, and only
+    // integrate while the output is not saturated in that direction
+    int32_t limit = params->ki_permille_per_hour > 0 ? (int32_t)(1000LL * 3600 / params->ki_permille_per_hour) : 0;
+    if (integrate) {
+        int64_t step = (int64_t)error * elapsed_ms / 1000;
+        int64_t output = proportional + (int64_t)params->ki_permille_per_hour * controller->integral / 3600;
+        if ((step > 0 && output < 1000) || (step < 0 && output > 0)) {
+            controller->integral = clamp32(controller->integral + step, -limit, limit);
+        }
+    }
+
+    int64_t duty = proportional + (int64_t)params->ki_permille_per_hour * controller->integral / 3600;
+    uint32_t on_ms = (uint32_t)((uint64_t)params->window_ms * clamp32(duty, 0, 1000) / 1000);
+
+    // Runs shorter than the minimum are dropped, pauses shorter than the
+    // minimum are filled in
+    if (on_ms < params->min_on_ms) {
+        on_ms = 0;
+    } else if (params->window_ms - on_ms < params->min_off_ms) {
+        on_ms = params->window_ms;
+    }
+
+    controller->window_start_ms = now_ms;
+    controller->window_on_ms = on_ms;
+}
+
+/**
+ * @brief Update the interlocks for this step
+ *
+ * @return true if the moisture estimate is recent enough to act on
+ */
+static bool update_interlocks(irrigation_controller_t *controller, int16_t moisture, uint32_t age_ms,
+                              uint32_t now_ms)
+{
+    const irrigation_params_t *params = &controller->params;
+    bool fresh = age_ms <= params->max_age_ms;
+
+    controller->faults &= FAULTS_PERSISTENT;
+    if (!fresh) {
+        controller->faults |= IRRIGATION_FAULT_STALE;
+    }
+    if (controller->dose_today_ms >= params->max_daily_ms) {
+        controller->faults |= IRRIGATION_FAULT_DAILY_LIMIT;
+    }
+
+    // A rise over the lowest moisture since the last response shows the
+    // water arrives
+    if (fresh) {
+        if ((int32_t)moisture >= (int32_t)controller->reference + params->response_rise) {
+            controller->reference = moisture;
+            controller->unanswered_ms = 0;
+            controller->faults &= (uint8_t)~IRRIGATION_FAULT_WAITING;
+        } else if (moisture < controller->reference) {
+            controller->reference = moisture;
+        }
+    }
+
+    if (!(controller->faults & FAULTS_PERSISTENT) && controller->unanswered_ms >= params->dry_run_ms) {
+        controller->faults |= IRRIGATION_FAULT_WAITING;
+        controller->wait_start_ms = now_ms;
+    }
+    if ((controller->faults & IRRIGATION_FAULT_WAITING) &&
+        now_ms - controller->wait_start_ms >= params->response_ms) {
+        controller->faults = (uint8_t)((controller->faults & ~IRRIGATION_FAULT_WAITING) | IRRIGATION_FAULT_DRY_RUN);
+    }
+    return fresh;
+}
+
+void irrigation_controller_init(irrigation_controller_t *controller, const irrigation_params_t *params)
+{
+    if (!controller || !params) {
+        return;
+    }
+    memset(controller, 0, sizeof(*controller));
+    controller->params = *params;
+    controller->reference = REFERENCE_UNKNOWN;
+}
+
+bool irrigation_controller_step(irrigation_controller_t *controller, int16_t moisture, uint32_t age_ms,
+                                uint32_t now_ms)
+{
+    if (!controller) {
+        return false;
+    }
+
+    const irrigation_params_t *params = &controller->params;
+    bool first = !controller->started;
+    if (first) {
+        controller->started = true;
+        controller->last_step_ms = now_ms;
+        controller->day_start_ms = now_ms;
+        // Allow a run right away
+        controller->switched_ms = now_ms - params->min_off_ms;
+    }
+
+    // Account the pump time of the period that just ended
+    uint32_t dt = now_ms - controller->last_step_ms;
+    controller->last_step_ms = now_ms;
+    if (controller->pump_on) {
+        controller->dose_today_ms += dt;
+        controller->unanswered_ms += dt;
+    }
+    uint32_t since_day = now_ms - controller->day_start_ms;
+    if (since_day >= IRRIGATION_DAY_MS) {
+        controller->day_start_ms += (since_day / IRRIGATION_DAY_MS) * IRRIGATION_DAY_MS;
+        controller->dose_today_ms = 0;
+    }
+
+    bool fresh = update_interlocks(controller, moisture, age_ms, now_ms);
+    bool blocked = controller->faults != 0 || params->mode == IRRIGATION_MODE_OFF;
+
+    bool want = false;
+    switch ((irrigation_mode_t)params->mode) {
+        case IRRIGATION_MODE_BANG_BANG:
+            want = fresh && law_bang_bang(controller, moisture);
+            break;
+
+        case IRRIGATION_MODE_PI: {
+            uint32_t elapsed = now_ms - controller->window_start_ms;
+            if (first || elapsed >= params->window_ms) {
+                law_pi_window(controller, moisture, first ? 0 : elapsed, !blocked, now_ms);
+            }
+            want = now_ms - controller->window_start_ms < controller->window_on_ms;
+            break;
+        }
+
+        case IRRIGATION_MODE_OFF:
+        default:
+            break;
+    }
+
+    // Interlocks stop the pump at once; otherwise respect the run and
+    // pause limits
+    uint32_t since_switch = now_ms - controller->switched_ms;
+    if (blocked) {
+        want = false;
+    } else if (controller->pump_on) {
+        if (!want && since_switch < params->min_on_ms) {
+            want = true;
+        } else if (want && since_switch >= params->max_pulse_ms) {
+            want = false;
+        }
+    } else if (want && since_switch < params->min_off_ms) {
+        want = false;
+    }
+
+    if (want != controller->pump_on) {
+        controller->pump_on = want;
+        controller->switched_ms = now_ms;
+    }
+    return controller->pump_on;
+}
+
+void irrigation_controller_reset_fault(irrigation_controller_t *controller)
+{
+    if (!controller) {
+        return;
+    }
+    controller->faults &= (uint8_t)~FAULTS_PERSISTENT;
+    controller->unanswered_ms = 0;
+    controller->reference = REFERENCE_UNKNOWN;
+}
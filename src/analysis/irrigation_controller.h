@@ -0,0 +1,137 @@
+/**
+ * @file irrigation_controller.h
+ * @brief Closed-Loop Irrigation Control Law for Plant Monitoring System
+ *
+ * This module decides, once per control period, whether the pump should
+ * run, from the latest soil moisture estimate. Two control laws are
+ * available:
+ * - Bang-bang: the pump starts once moisture falls below the setpoint by
+ *   the hysteresis band and stops when it reaches the setpoint.
+ * - PI: every window_ms the error (setpoint minus moisture) sets the
+ *   share of the next window the pump runs (time-proportioning). The
+ *   integral is only accumulated while the output is not saturated, so
+ *   it does not wind up during a dry spell or an interlock.
+ *
+ * With either law a run lasts at least min_on_ms and at most
+ * max_pulse_ms, and a pause lasts at least min_off_ms, which protects
+ * the pump and gives the water time to soak in. The safety interlocks
+ * always win over the law and the minimum run time:
+ * - A moisture sample older than max_age_ms stops the pump.
+ * - At most max_daily_ms of pumping per 24 hours.
+ * - Dry-run detection: once dry_run_ms of pumping has not raised the
+ *   moisture by response_rise, the pump pauses for up to response_ms to
+ *   let the water arrive. No rise by then latches a dry-run fault (empty
+ *   reservoir, broken hose, probe out of the pot) until it is reset.
+ *
+ * All arithmetic is integer and every step takes constant time. Times
+ * are in milliseconds on a free-running 32-bit clock; only differences
+ * are used, so the clock may wrap. Moisture is in raw ADC counts,
+ * higher meaning wetter. The module has no ESP-IDF dependencies.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef IRRIGATION_CONTROLLER_H
+#define IRRIGATION_CONTROLLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Length of the dose accounting period */
+#define IRRIGATION_DAY_MS  86400000UL
+
+/**
+ * @brief Control law
+ */
+typedef enum {
+    IRRIGATION_MODE_OFF = 0,      /**< Pump always off */
+    IRRIGATION_MODE_BANG_BANG,    /**< On/off with hysteresis */
+    IRRIGATION_MODE_PI            /**< Time-proportioning PI */
+} irrigation_mode_t;
+
+/**
+ * @brief Interlock flags
+ */
+#define IRRIGATION_FAULT_STALE        (1 << 0)  /**< No recent moisture sample */
+#define IRRIGATION_FAULT_DAILY_LIMIT  (1 << 1)  /**< Daily dose used up */
+#define IRRIGATION_FAULT_WAITING      (1 << 2)  /**< Pausing for the moisture to respond */
+#define IRRIGATION_FAULT_DRY_RUN      (1 << 3)  /**< Pumping had no effect (latched) */
+
+/**
+ * @brief Controller parameters
+ */
+typedef struct {
+    uint8_t mode;                 /**< irrigation_mode_t */
+    int16_t setpoint;             /**< Target soil moisture (counts) */
+    int16_t hysteresis;           /**< Bang-bang: start this far below the setpoint (counts) */
+    uint16_t kp_permille;         /**< PI: share of the window per count of error (‰) */
+    uint16_t ki_permille_per_hour; /**< PI: share of the window per count of error per hour (‰) */
+    uint32_t window_ms;           /**< PI: time-proportioning window */
+    uint32_t min_on_ms;           /**< Shortest run */
+    uint32_t min_off_ms;          /**< Shortest pause (soak time) */
+    uint32_t max_pulse_ms;        /**< Longest run */
+    uint32_t max_daily_ms;        /**< Pump time allowed per 24 hours */
+    uint32_t dry_run_ms;          /**< Pump time allowed without a moisture response */
+    uint32_t response_ms;         /**< Pause to wait for a response before faulting */
+    int16_t response_rise;        /**< Rise that counts as a response (counts) */
+    uint32_t max_age_ms;          /**< Older moisture samples stop the pump */
+} irrigation_params_t;
+
+/**
+ * @brief Controller state
+ */
+typedef struct {
+    irrigation_params_t params;   /**< Parameters */
+    bool started;                 /**< A step has run */
+    bool pump_on;                 /**< Current pump command */
+    uint8_t faults;               /**< IRRIGATION_FAULT_* flags */
+    int16_t reference;            /**< Lowest moisture since the last response (counts) */
+    int32_t integral;             /**< PI: integrated error (count·s) */
+    uint32_t last_step_ms;        /**< Time of the previous step */
+    uint32_t switched_ms;         /**< Time of the last pump switch */
+    uint32_t window_start_ms;     /**< PI: start of the current window */
+    uint32_t window_on_ms;        /**< PI: run time in the current window */
+    uint32_t day_start_ms;        /**< Start of the current dose period */
+    uint32_t dose_today_ms;       /**< Pump time in the current dose period */
+    uint32_t unanswered_ms;       /**< Pump time since the last moisture response */
+    uint32_t wait_start_ms;       /**< Start of the pause for a response */
+} irrigation_controller_t;
+
+/**
+ * @brief Initialize a controller with the pump off
+ *
+ * @param controller Controller state
+ * @param params Parameters (copied)
+ */
+void irrigation_controller_init(irrigation_controller_t *controller, const irrigation_params_t *params);
+
+/**
+ * @brief Run one control period
+ *
+ * @param controller Controller state
+ * @param moisture Latest soil moisture estimate (counts)
+ * @param age_ms Age of the estimate
+ * @param now_ms Current time
+ * @return true if the pump should run until the next step
+ */
+bool irrigation_controller_step(irrigation_controller_t *controller, int16_t moisture, uint32_t age_ms,
+                                uint32_t now_ms);
+
+/**
+ * @brief Clear a latched dry-run fault
+ *
+ * @param controller Controller state
+ */
+void irrigation_controller_reset_fault(irrigation_controller_t *controller);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IRRIGATION_CONTROLLER_H
@@ -0,0 +1,293 @@
+/**
+ * @file light_integral.c
+ * @brief Daily Light Integral and Photoperiod Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "light_integral.h"
+#include <string.h>
+
+#define SECONDS_PER_DAY  86400
+#define SECONDS_PER_HOUR 3600
+
+/** Photoperiod threshold in 0.01 µmol/m²/s */
+#define LIT_PPFD         ((uint32_t)(LIGHT_PHOTOPERIOD_PPFD * 100))
+
+/**
+ * @brief Spectrum presets
+ *
+ * Photon flux per 1000 lux for common light sources; sunlight is the
+ * usual 0.0185 µmol/m²/s per lux.
+ */
+static const light_spectrum_t k_spectra[] = {
+    { "sunlight", 1850 },
+    { "white_led", 1500 },
+    { "fluorescent", 1350 },
+    { "hps", 1220 },
+    { "metal_halide", 1410 },
+};
+
+#define SPECTRUM_COUNT  ((int)(sizeof(k_spectra) / sizeof(k_spectra[0])))
+
+const light_spectrum_t *light_integral_find_spectrum(const char *name)
+{
+    if (!name) {
+        return NULL;
+    }
+    for (int i = 0; i < SPECTRUM_COUNT; i++) {
+        if (strcmp(k_spectra[i].name, name) == 0) {
+            return &k_spectra[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t local_day(const light_integral_t *light, uint32_t time_s)
+{
+    return (uint32_t)(((int64_t)time_s + light->utc_offset_s) / SECONDS_PER_DAY);
+}
+
+/**
+ * @brief Seconds after the local midnight that starts a day
+ */
+static int32_t time_of_day(const light_integral_t *light, int64_t time_s, uint32_t day)
+{
+    return (int32_t)(time_s + light->utc_offset_s - (int64_t)day * SECONDS_PER_DAY);
+}
+
+static void start_day(light_day_t *day, uint32_t number)
+{
+    memset(day, 0, sizeof(*day));
+    day->day = number;
+    day->start_s = -1;
+    day->end_s = -1;
+}
+
+/**
+ * @brief Make the given day current, closing the day in progress if it is later
+ */
+static void roll_to(light_integral_t *light, uint32_t day)
+{
+    if (day == light->today.day) {
+        return;
+    }
+    if (day > light->today.day && light->has_sample) {
+        light->previous = light->today;
+        light->has_previous = true;
+    }
+    start_day(&light->today, day);
+}
+
+/**
+ * @brief Seconds from the start of an interval to where its PPFD crosses the threshold
+ *
+ * Only meaningful when one end is lit and the other is not.
+ */
+static uint32_t to_crossing(uint32_t dt, uint32_t p0, uint32_t p1)
+{
+    // Where the straight line between the samples crosses the threshold
+    return (uint32_t)((int64_t)dt * ((int64_t)LIT_PPFD - p0) / ((int64_t)p1 - p0));
+}
+
+/**
+ * @brief Seconds of an interval spent at or above the threshold
+ */
+static uint32_t lit_seconds(uint32_t dt, uint32_t p0, uint32_t p1)
+{
+    bool lit0 = p0 >= LIT_PPFD;
+    bool lit1 = p1 >= LIT_PPFD;
+    if (lit0 == lit1) {
+        return lit0 ? dt : 0;
+    }
+    uint32_t crossing = to_crossing(dt, p0, p1);
+    return lit1 ? dt - crossing : crossing;
+}
+
+/**
+ * @brief Integrate one interval that lies within the current day
+ */
+static void integrate(light_integral_t *light, uint32_t t0, uint32_t t1, uint32_t p0, uint32_t p1)
+{
+    light_day_t *today = &light->today;
+    uint32_t dt = t1 - t0;
+    today->integral += (uint64_t)(p0 + p1) * dt;
+    today->covered_s += dt;
+    today->lit_s += lit_seconds(dt, p0, p1);
+
+    bool lit0 = p0 >= LIT_PPFD;
+    bool lit1 = p1 >= LIT_PPFD;
+    if (lit0 && today->start_s < 0) {
+        today->start_s = time_of_day(light, t0, today->day);
+    }
+    if (lit0 != lit1) {
+        int64_t crossing = (int64_t)t0 + to_crossing(dt, p0, p1);
+        if (lit1 && today->start_s < 0) {
+            today->start_s = time_of_day(light, crossing, today->day);
+        } else if (!lit1) {
+            today->end_s = time_of_day(light, crossing, today->day);
+        }
+    }
+    today->lit = lit1;
+}
+
+/**
+ * @brief Integrate one interval into the hourly bins, split at every hour it spans
+ */
+static void integrate_hours(light_integral_t *light, uint32_t t0, uint32_t t1, uint32_t p0, uint32_t p1)
+{
+    uint32_t dt = t1 - t0;
+    uint32_t start = t0;
+    uint32_t p_start = p0;
+    while (start < t1) {
+        uint32_t hour = start / SECONDS_PER_HOUR;
+        uint64_t boundary = (uint64_t)(hour + 1) * SECONDS_PER_HOUR;
+        uint32_t end = boundary < t1 ? (uint32_t)boundary : t1;
+        uint32_t p_end = (end == t1) ? p1 : (uint32_t)(p0 + ((int64_t)p1 - p0) * (end - t0) / dt);
+
+        light_hour_t *bin = &light->hours[hour % (LIGHT_ROLLING_HOURS + 1)];
+        if (bin->hour != hour) {
+            memset(bin, 0, sizeof(*bin));
+            bin->hour = hour;
+        }
+        bin->integral += (uint32_t)((uint64_t)(p_start + p_end) * (end - start));
+        bin->covered_s += (uint16_t)(end - start);
+        bin->lit_s += (uint16_t)lit_seconds(end - start, p_start, p_end);
+
+        start = end;
+        p_start = p_end;
+    }
+}
+
+void light_integral_init(light_integral_t *light, const light_spectrum_t *spectrum, int32_t utc_offset_s)
+{
+    if (!light) {
+        return;
+    }
+    memset(light, 0, sizeof(*light));
+    light->ppfd_per_klux = (spectrum ? spectrum : &k_spectra[0])->ppfd_per_klux;
+    light->utc_offset_s = utc_offset_s;
+    start_day(&light->today, 0);
+    start_day(&light->previous, 0);
+}
+
+/**
+ * @brief PPFD of a lux value in 0.01 µmol/m²/s
+ */
+static uint32_t ppfd_raw(const light_integral_t *light, float lux)
+{
+    if (!(lux > 0.0f)) {
+        return 0;
+    }
+    lux = lux < 200000.0f ? lux : 200000.0f;
+    return (uint32_t)(lux * light->ppfd_per_klux / 1000.0f + 0.5f);
+}
+
+float light_integral_ppfd(const light_integral_t *light, float lux)
+{
+    return light ? ppfd_raw(light, lux) / 100.0f : 0.0f;
+}
+
+void light_integral_update(light_integral_t *light, float lux, uint32_t time_s)
+{
+    if (!light) {
+        return;
+    }
+
+    uint32_t ppfd = ppfd_raw(light, lux);
+    uint32_t day = local_day(light, time_s);
+
+    // Nothing to integrate from: the first sample, the clock set back or
+    // a gap during which the light is unknown
+    if (!light->has_sample || time_s < light->last_time || time_s - light->last_time > LIGHT_MAX_GAP_S) {
+        roll_to(light, day);
+        light->today.lit = ppfd >= LIT_PPFD;
+        light->has_sample = true;
+        light->last_time = time_s;
+        light->last_ppfd = ppfd;
+        return;
+    }
+
+    integrate_hours(light, light->last_time, time_s, light->last_ppfd, ppfd);
+
+    // Split the interval at every local midnight it spans
+    uint32_t t0 = light->last_time;
+    uint32_t p0 = light->last_ppfd;
+    uint32_t dt = time_s - t0;
+    while (local_day(light, t0) < day) {
+        uint32_t next = local_day(light, t0) + 1;
+        uint32_t midnight = (uint32_t)((int64_t)next * SECONDS_PER_DAY - light->utc_offset_s);
+        int64_t fraction = (int64_t)((int64_t)ppfd - p0) * (midnight - light->last_time);
+        uint32_t p_midnight = (uint32_t)(light->last_ppfd + fraction / dt);
+
+        roll_to(light, local_day(light, t0));
+        integrate(light, t0, midnight, p0, p_midnight);
+        roll_to(light, next);
+        t0 = midnight;
+        p0 = p_midnight;
+    }
+
+    roll_to(light, day);
+    integrate(light, t0, time_s, p0, ppfd);
+    light->last_time = time_s;
+    light->last_ppfd = ppfd;
+}
+
+static void summarize(const light_day_t *day, light_summary_t *summary)
+{
+    summary->day = day->day;
+    summary->dli = (float)day->integral * 5e-9f;
+    summary->photoperiod_h = day->lit_s / 3600.0f;
+    summary->covered_h = day->covered_s / 3600.0f;
+    summary->start_s = day->start_s;
+    summary->end_s = day->end_s;
+    summary->lit = day->lit;
+}
+
+bool light_integral_today(const light_integral_t *light, light_summary_t *summary)
+{
+    if (!light || !summary || !light->has_sample) {
+        return false;
+    }
+    summarize(&light->today, summary);
+    return true;
+}
+
+bool light_integral_rolling(const light_integral_t *light, light_summary_t *summary)
+{
+    if (!light || !summary || !light->has_sample) {
+        return false;
+    }
+
+    // Bins of hours outside the window are stale (or from before the
+    // clock was set back) and left out; the oldest hour only counts for
+    // the part of it the window still covers
+    uint32_t newest = light->last_time / SECONDS_PER_HOUR;
+    uint32_t remaining_s = SECONDS_PER_HOUR - light->last_time % SECONDS_PER_HOUR;
+    light_day_t window;
+    start_day(&window, 0);
+    for (int i = 0; i <= LIGHT_ROLLING_HOURS; i++) {
+        const light_hour_t *bin = &light->hours[i];
+        if (bin->hour > newest || newest - bin->hour > LIGHT_ROLLING_HOURS) {
+            continue;
+        }
+        uint32_t share_s = (newest - bin->hour == LIGHT_ROLLING_HOURS) ? remaining_s : SECONDS_PER_HOUR;
+        window.integral += (uint64_t)bin->integral * share_s / SECONDS_PER_HOUR;
+        window.covered_s += bin->covered_s * share_s / SECONDS_PER_HOUR;
+        window.lit_s += bin->lit_s * share_s / SECONDS_PER_HOUR;
+    }
+    window.lit = light->today.lit;
+    summarize(&window, summary);
+    return true;
+}
+
+bool light_integral_previous(const light_integral_t *light, light_summary_t *summary)
+{
+    if (!light || !summary || !light->has_previous) {
+        return false;
+    }
+    summarize(&light->previous, summary);
+    return true;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file light_integral.h
+ * @brief Daily Light Integral and Photoperiod for Plant Monitoring System
+ *
+ * This module turns instantaneous illuminance samples into the numbers
+ * growers act on: photosynthetic photon flux density (PPFD), the daily
+ * light integral (DLI) and the photoperiod.
+ *
+ * Lux weights light by the human eye, so the photon flux it stands for
+ * depends on the light source. Lux is converted to PPFD with the factor
+ * of a spectrum preset (sunlight, white LED, HPS, ...). PPFD is then
+ * integrated with the trapezoidal rule between consecutive samples,
+ * which need not be evenly spaced; an interval that spans local midnight
+ * is split there, with PPFD interpolated at the boundary. Gaps longer
+ * than LIGHT_MAX_GAP_S are not integrated (the light during them is
+ * unknown) and show up as missing coverage.
+ *
+ * The photoperiod is tracked from the crossings of the
+ * LIGHT_PHOTOPERIOD_PPFD threshold, interpolated between samples:
+ * the time of the first crossing upwards, the last crossing downwards
+ * and the total time above it.
+ *
+ * Local days need a wall clock. The light is also kept in hourly bins
+ * over the last LIGHT_ROLLING_HOURS, so that a device whose clock has
+ * not been set can report a rolling 24 h integral instead (see
+ * light_integral_rolling()).
+ *
+ * Integration is in integers (PPFD in 0.01 µmol/m²/s, time in seconds),
+ * so a day of samples accumulates no rounding error and needs no
+ * floating point on a core without an FPU. State is owned by the
+ * caller, so it can live in RTC memory across deep sleep. The module has
+ * no ESP-IDF dependencies.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef LIGHT_INTEGRAL_H
+#define LIGHT_INTEGRAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Lux to PPFD conversion of a light source
+ */
+typedef struct {
+    const char *name;           /**< Preset name */
+    uint16_t ppfd_per_klux;     /**< PPFD per 1000 lux, in 0.01 µmol/m²/s */
+} light_spectrum_t;
+
+/**
+ * @brief Light accumulated over one local day
+ */
+typedef struct {
+    uint32_t day;             /**< Local day number (days since the epoch) */
+    uint64_t integral;        /**< Twice the photon count, in 0.01 µmol/m² */
+    uint32_t covered_s;       /**< Seconds integrated */
+    uint32_t lit_s;           /**< Seconds at or above the photoperiod threshold */
+    int32_t start_s;          /**< First crossing upwards, seconds after midnight (-1 = none) */
+    int32_t end_s;            /**< Last crossing downwards, seconds after midnight (-1 = none) */
+    bool lit;                 /**< Above the threshold at the last sample */
+} light_day_t;
+
+/** Hours in the rolling window of light_integral_rolling() */
+#define LIGHT_ROLLING_HOURS  24
+
+/**
+ * @brief Light accumulated over one hour of the rolling window
+ */
+typedef struct {
+    uint32_t hour;            /**< Hour number (hours since the epoch, or since boot) */
+    uint32_t integral;        /**< Twice the photon count, in 0.01 µmol/m² */
+    uint16_t covered_s;       /**< Seconds integrated */
+    uint16_t lit_s;           /**< Seconds at or above the photoperiod threshold */
+} light_hour_t;
+
+/**
+ * @brief Light integral state of one sensor location
+ */
+typedef struct {
+    uint16_t ppfd_per_klux;   /**< Conversion factor of the spectrum */
+    int32_t utc_offset_s;     /**< Local time offset from UTC */
+    bool has_sample;          /**< last_time and last_ppfd are set */
+    uint32_t last_time;       /**< Time of the last sample */
+    uint32_t last_ppfd;       /**< PPFD of the last sample, 0.01 µmol/m²/s */
+    light_day_t today;        /**< Day in progress */
+    light_day_t previous;     /**< Last completed day */
+    bool has_previous;        /**< previous holds a completed day */
+    light_hour_t hours[LIGHT_ROLLING_HOURS + 1]; /**< Rolling window, indexed by hour number modulo its length */
+} light_integral_t;
+
+/**
+ * @brief Light summary of one day in engineering units
+ */
+typedef struct {
+    uint32_t day;             /**< Local day number (days since the epoch) */
+    float dli;                /**< Daily light integral (mol/m²/d), so far for today */
+    float photoperiod_h;      /**< Hours at or above the photoperiod threshold */
+    float covered_h;          /**< Hours with samples on both sides */
+    int32_t start_s;          /**< Lights on, seconds after local midnight (-1 = none) */
+    int32_t end_s;            /**< Lights off, seconds after local midnight (-1 = none) */
+    bool lit;                 /**< Lit at the last sample of the day */
+} light_summary_t;
+
+/**
+ * @brief Find a spectrum preset by name
+ *
+ * @param name Preset name ("sunlight", "white_led", "fluorescent", "hps", "metal_halide")
+ * @return Preset, NULL if there is none of that name
+ */
+const light_spectrum_t *light_integral_find_spectrum(const char *name);
+
+/**
+ * @brief Reset the state
+ *
+ * @param light Light integral state
+ * @param spectrum Light source (NULL = sunlight)
+ * @param utc_offset_s Offset of local time from UTC, which places midnight
+ */
+void light_integral_init(light_integral_t *light, const light_spectrum_t *spectrum, int32_t utc_offset_s);
+
+/**
+ * @brief Convert illuminance to PPFD
+ *
+ * @param light Light integral state (for the spectrum)
+ * @param lux Illuminance in lux
+ * @return PPFD in µmol/m²/s
+ */
+float light_integral_ppfd(const light_integral_t *light, float lux);
+
+/**
+ * @brief Add an illuminance sample
+ *
+ * A sample in a later local day closes the current day. A sample earlier
+ * than the previous one (the clock was set back) starts integrating
+ * afresh from it.
+ *
+ * @param light Light integral state
+ * @param lux Illuminance in lux
+ * @param time_s Time of the sample in seconds since the epoch (UTC)
+ */
+void light_integral_update(light_integral_t *light, float lux, uint32_t time_s);
+
+/**
+ * @brief Get the light accumulated so far today
+ *
+ * @param light Light integral state
+ * @param summary Pointer to store the summary
+ * @return true if a sample has been added
+ */
+bool light_integral_today(const light_integral_t *light, light_summary_t *summary);
+
+/**
+ * @brief Get the light of the rolling window ending at the last sample
+ *
+ * Covers the LIGHT_ROLLING_HOURS up to the last sample. The light is
+ * kept per clock hour, so the oldest hour, which the window only partly
+ * covers, is counted pro rata. Works on any time base, so it is the
+ * daily figure to report while the clock has not been set. The day is
+ * 0, and there are no lights on and off times (-1).
+ *
+ * @param light Light integral state
+ * @param summary Pointer to store the summary
+ * @return true if a sample has been added
+ */
+bool light_integral_rolling(const light_integral_t *light, light_summary_t *summary);
+
+/**
+ * @brief Get the light of the last completed day
+ *
+ * @param light Light integral state
+ * @param summary Pointer to store the summary
+ * @return true if a day has been completed
+ */
+bool light_integral_previous(const light_integral_t *light, light_summary_t *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIGHT_INTEGRAL_H
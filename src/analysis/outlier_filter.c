@@ -0,0 +1,154 @@
+/**
+ * @file outlier_filter.c
+ * @brief Sliding-Window Outlier Filter Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "outlier_filter.h"
+#include <string.h>
+
+/** Rejection limit per unit of MAD, in thousandths (threshold * 1.4826) */
+#define OUTLIER_FILTER_LIMIT_X1000  ((OUTLIER_FILTER_THRESHOLD_X10 * 14826) / 100)
+
+/** Samples needed before the filter starts judging */
+#define OUTLIER_FILTER_MIN_FILL     ((OUTLIER_FILTER_WINDOW + 1) / 2)
+
+/**
+ * @brief Smallest rejection distance per quantity, in fixed-point units
+ *
+ * Keeps sensor noise from being rejected while the signal is flat (MAD 0).
+ */
+static const int16_t k_min_limit[HISTORY_QTY_COUNT] = {
+    [HISTORY_QTY_TEMPERATURE] = 20,   // 0.2 °C
+    [HISTORY_QTY_HUMIDITY] = 100,     // 1 %
+    [HISTORY_QTY_SOIL_MOISTURE] = 40,
+    [HISTORY_QTY_LIGHT_LEVEL] = 40,
+    [HISTORY_QTY_LUX] = 10,           // 20 lux
+    [HISTORY_QTY_VPD] = 50,           // 0.05 kPa
+};
+
+// Global variables
+static outlier_filter_mode_t g_mode = OUTLIER_FILTER_MODE_OFF;
+static int16_t g_window[READING_HISTORY_CHANNELS][OUTLIER_FILTER_WINDOW];   // Arrival order
+static int16_t g_sorted[READING_HISTORY_CHANNELS][OUTLIER_FILTER_WINDOW];
+static uint8_t g_next[READING_HISTORY_CHANNELS];
+static uint8_t g_fill[READING_HISTORY_CHANNELS];
+
+/**
+ * @brief Index of the first sorted element not less than value
+ */
+static int lower_bound(const int16_t *sorted, int count, int16_t value)
+{
+    int low = 0;
+    int high = count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (sorted[mid] < value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Add a sample to a channel window, evicting the oldest when full
+ */
+static void window_push(int channel, int16_t raw)
+{
+    int16_t *sorted = g_sorted[channel];
+    int count = g_fill[channel];
+
+    if (count == OUTLIER_FILTER_WINDOW) {
+        int16_t oldest = g_window[channel][g_next[channel]];
+        int pos = lower_bound(sorted, count, oldest);
+        memmove(&sorted[pos], &sorted[pos + 1], (count - pos - 1) * sizeof(sorted[0]));
+        count--;
+    }
+
+    int pos = lower_bound(sorted, count, raw);
+    memmove(&sorted[pos + 1], &sorted[pos], (count - pos) * sizeof(sorted[0]));
+    sorted[pos] = raw;
+    g_fill[channel] = (uint8_t)(count + 1);
+
+    g_window[channel][g_next[channel]] = raw;
+    g_next[channel] = (uint8_t)((g_next[channel] + 1) % OUTLIER_FILTER_WINDOW);
+}
+
+/**
+ * @brief Median absolute deviation of a sorted window around its median
+ *
+ * Deviations below and above the median are each already ascending, so
+ * merging the two runs up to the middle position yields the MAD.
+ */
+static int32_t window_mad(const int16_t *sorted, int count)
+{
+    int mid = (count - 1) / 2;
+    int32_t median = sorted[mid];
+    int below = mid;
+    int above = mid + 1;
+    int32_t deviation = 0;
+
+    for (int picked = 0; picked <= mid; picked++) {
+        int32_t low = (below >= 0) ? median - sorted[below] : INT32_MAX;
+        int32_t high = (above < count) ? sorted[above] - median : INT32_MAX;
+        if (low <= high) {
+            deviation = low;
+            below--;
+        } else {
+            deviation = high;
+            above++;
+        }
+    }
+    return deviation;
+}
+
+void outlier_filter_init(outlier_filter_mode_t mode)
+{
+    g_mode = mode;
+    memset(g_next, 0, sizeof(g_next));
+    memset(g_fill, 0, sizeof(g_fill));
+}
+
+outlier_filter_result_t outlier_filter_apply(int channel, int16_t raw)
+{
+    outlier_filter_result_t result = { .value = raw, .rejected = false };
+
+    history_quantity_t quantity = reading_history_quantity(channel);
+    if (g_mode == OUTLIER_FILTER_MODE_OFF || quantity >= HISTORY_QTY_COUNT) {
+        return result;
+    }
+
+    window_push(channel, raw);
+
+    int count = g_fill[channel];
+    if (count < OUTLIER_FILTER_MIN_FILL) {
+        return result;
+    }
+
+    const int16_t *sorted = g_sorted[channel];
+    int16_t median = sorted[(count - 1) / 2];
+    int32_t limit = window_mad(sorted, count) * OUTLIER_FILTER_LIMIT_X1000 / 1000;
+    if (limit < k_min_limit[quantity]) {
+        limit = k_min_limit[quantity];
+    }
+
+    int32_t distance = (int32_t)raw - median;
+    result.rejected = (distance > limit || -distance > limit);
+    if (g_mode == OUTLIER_FILTER_MODE_MEDIAN || result.rejected) {
+        result.value = median;
+    }
+    return result;
+}
+
+void outlier_filter_reset(int channel)
+{
+    if (channel >= 0 && channel < READING_HISTORY_CHANNELS) {
+        g_next[channel] = 0;
+        g_fill[channel] = 0;
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file outlier_filter.h
+ * @brief Sliding-Window Outlier Filter for Plant Monitoring System
+ *
+ * This module removes single-sample glitches (a bad I2C transfer, an ADC
+ * spike) before readings are analysed. Each reading history channel has
+ * its own window of the last OUTLIER_FILTER_WINDOW samples, kept both in
+ * arrival order and sorted. A new sample costs one binary search and one
+ * short move in the sorted copy; the median is read directly and the
+ * median absolute deviation (MAD) is found with a single merge pass.
+ *
+ * Two modes are supported:
+ * - OUTLIER_FILTER_MODE_MEDIAN: the output is always the window median;
+ * - OUTLIER_FILTER_MODE_HAMPEL: samples pass unchanged unless they are
+ *   outliers, which are replaced by the median.
+ *
+ * In both modes a sample is reported as rejected when it lies more than
+ * the threshold times 1.4826 * MAD (the MAD estimate of sigma) from the
+ * median. A per-quantity floor keeps sensor noise on a flat signal from
+ * being rejected. The window keeps the raw samples, so a genuine step
+ * change becomes the median after half a window and stops being rejected.
+ *
+ * All arithmetic is integer, on the fixed-point history values.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef OUTLIER_FILTER_H
+#define OUTLIER_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "reading_history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (OUTLIER_FILTER_WINDOW % 2) == 0 || OUTLIER_FILTER_WINDOW < 3 || OUTLIER_FILTER_WINDOW > 15
+#error "OUTLIER_FILTER_WINDOW must be odd and between 3 and 15"
+#endif
+
+/**
+ * @brief Filter modes
+ */
+typedef enum {
+    OUTLIER_FILTER_MODE_OFF = 0,  /**< Samples pass unchanged and are never rejected */
+    OUTLIER_FILTER_MODE_MEDIAN,   /**< Output the window median */
+    OUTLIER_FILTER_MODE_HAMPEL,   /**< Output the sample, or the median for outliers */
+} outlier_filter_mode_t;
+
+/**
+ * @brief Result of filtering one sample
+ */
+typedef struct {
+    int16_t value;            /**< Filtered fixed-point value */
+    bool rejected;            /**< Sample was classified as an outlier */
+} outlier_filter_result_t;
+
+/**
+ * @brief Reset all channels and set the filter mode
+ *
+ * @param mode Filter mode
+ */
+void outlier_filter_init(outlier_filter_mode_t mode);
+
+/**
+ * @brief Filter one sample of a reading history channel
+ *
+ * Until half a window of samples has been seen, samples pass unchanged.
+ *
+ * @param channel Reading history channel number
+ * @param raw Fixed-point sample (see history_quantity_t)
+ * @return Filtered value and rejection flag
+ */
+outlier_filter_result_t outlier_filter_apply(int channel, int16_t raw);
+
+/**
+ * @brief Forget the window of a channel (e.g. after a sensor was replaced)
+ *
+ * @param channel Reading history channel number
+ */
+void outlier_filter_reset(int channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OUTLIER_FILTER_H
@@ -0,0 +1,201 @@
+/**
+ * @file reading_history.c
+ * @brief Reading History Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "reading_history.h"
+#include <string.h>
+
+#define HISTORY_MASK  (READING_HISTORY_DEPTH - 1)
+
+/** Fixed-point steps per engineering unit, per quantity */
+static const float k_quantity_scale[HISTORY_QTY_COUNT] = {
+    [HISTORY_QTY_TEMPERATURE] = 100.0f,
+    [HISTORY_QTY_HUMIDITY] = 100.0f,
+    [HISTORY_QTY_SOIL_MOISTURE] = 1.0f,
+    [HISTORY_QTY_LIGHT_LEVEL] = 1.0f,
+    [HISTORY_QTY_LUX] = 0.5f,
+    [HISTORY_QTY_VPD] = 1000.0f,
+};
+
+/** Quantity names, as used in the uplink payload */
+static const char *const k_quantity_name[HISTORY_QTY_COUNT] = {
+    [HISTORY_QTY_TEMPERATURE] = "temperature",
+    [HISTORY_QTY_HUMIDITY] = "humidity",
+    [HISTORY_QTY_SOIL_MOISTURE] = "soil_moisture",
+    [HISTORY_QTY_LIGHT_LEVEL] = "light_level",
+    [HISTORY_QTY_LUX] = "lux",
+    [HISTORY_QTY_VPD] = "vpd",
+};
+
+// Global variables
+static int16_t g_values[READING_HISTORY_CHANNELS][READING_HISTORY_DEPTH];
+static uint16_t g_head[READING_HISTORY_CHANNELS];      // Next write position
+static uint16_t g_count[READING_HISTORY_CHANNELS];
+static uint8_t g_sensor[READING_HISTORY_CHANNELS];
+static uint8_t g_quantity[READING_HISTORY_CHANNELS];
+static uint64_t g_used_mask = 0;
+
+// Every registered sensor must get a channel per quantity it measures
+_Static_assert(READING_HISTORY_CHANNELS >= SENSOR_REGISTRY_CAPACITY * READING_HISTORY_QUANTITIES_PER_SENSOR,
+               "READING_HISTORY_CHANNELS does not cover the sensor registry");
+
+/**
+ * @brief Check whether a channel number refers to an attached channel
+ */
+static bool channel_valid(int channel)
+{
+    return channel >= 0 && channel < READING_HISTORY_CHANNELS && ((g_used_mask >> channel) & 1);
+}
+
+void reading_history_init(void)
+{
+    memset(g_head, 0, sizeof(g_head));
+    memset(g_count, 0, sizeof(g_count));
+    g_used_mask = 0;
+}
+
+int reading_history_find(uint8_t sensor, history_quantity_t quantity)
+{
+    for (int ch = 0; ch < READING_HISTORY_CHANNELS; ch++) {
+        if (((g_used_mask >> ch) & 1) && g_sensor[ch] == sensor && g_quantity[ch] == quantity) {
+            return ch;
+        }
+    }
+    return -1;
+}
+
+int reading_history_attach(uint8_t sensor, history_quantity_t quantity)
+{
+    if ((unsigned)quantity >= HISTORY_QTY_COUNT) {
+        return -1;
+    }
+
+    int ch = reading_history_find(sensor, quantity);
+    if (ch >= 0) {
+        return ch;
+    }
+
+    for (ch = 0; ch < READING_HISTORY_CHANNELS; ch++) {
+        if (!((g_used_mask >> ch) & 1)) {
+            g_sensor[ch] = sensor;
+            g_quantity[ch] = (uint8_t)quantity;
+            g_head[ch] = 0;
+            g_count[ch] = 0;
+            g_used_mask |= (1ULL << ch);
+            return ch;
+        }
+    }
+    return -1;
+}
+
+void reading_history_push_raw(int channel, int16_t raw)
+{
+    if (!channel_valid(channel)) {
+        return;
+    }
+
+    g_values[channel][g_head[channel]] = raw;
+    g_head[channel] = (g_head[channel] + 1) & HISTORY_MASK;
+    if (g_count[channel] < READING_HISTORY_DEPTH) {
+        g_count[channel]++;
+    }
+}
+
+void reading_history_push(int channel, float value)
+{
+    if (!channel_valid(channel)) {
+        return;
+    }
+    reading_history_push_raw(channel, reading_history_encode((history_quantity_t)g_quantity[channel], value));
+}
+
+int reading_history_count(int channel)
+{
+    return channel_valid(channel) ? g_count[channel] : 0;
+}
+
+history_quantity_t reading_history_quantity(int channel)
+{
+    return channel_valid(channel) ? (history_quantity_t)g_quantity[channel] : HISTORY_QTY_COUNT;
+}
+
+int16_t reading_history_raw(int channel, int age)
+{
+    if (!channel_valid(channel) || age < 0 || age >= g_count[channel]) {
+        return 0;
+    }
+    return g_values[channel][(g_head[channel] - 1 - age) & HISTORY_MASK];
+}
+
+bool reading_history_span(int channel, history_span_t *span)
+{
+    if (!span || !channel_valid(channel)) {
+        return false;
+    }
+
+    uint16_t count = g_count[channel];
+    uint16_t start = (g_head[channel] - count) & HISTORY_MASK;
+    uint16_t first_count = READING_HISTORY_DEPTH - start;
+    if (first_count > count) {
+        first_count = count;
+    }
+
+    span->first = &g_values[channel][start];
+    span->first_count = first_count;
+    span->second = g_values[channel];
+    span->second_count = count - first_count;
+    return true;
+}
+
+void reading_history_clear(int channel)
+{
+    if (channel_valid(channel)) {
+        g_head[channel] = 0;
+        g_count[channel] = 0;
+    }
+}
+
+int16_t reading_history_encode(history_quantity_t quantity, float value)
+{
+    if ((unsigned)quantity >= HISTORY_QTY_COUNT) {
+        return 0;
+    }
+
+    float scaled = value * k_quantity_scale[quantity];
+    if (scaled >= (float)INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (scaled <= (float)INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+float reading_history_decode(history_quantity_t quantity, int32_t raw)
+{
+    if ((unsigned)quantity >= HISTORY_QTY_COUNT) {
+        return 0.0f;
+    }
+    return (float)raw / k_quantity_scale[quantity];
+}
+
+float reading_history_scale(history_quantity_t quantity)
+{
+    if ((unsigned)quantity >= HISTORY_QTY_COUNT) {
+        return 1.0f;
+    }
+    return k_quantity_scale[quantity];
+}
+
+const char *reading_history_quantity_name(history_quantity_t quantity)
+{
+    if ((unsigned)quantity >= HISTORY_QTY_COUNT) {
+        return "unknown";
+    }
+    return k_quantity_name[quantity];
+}
@@ -0,0 +1,194 @@
+/**
+ * @file reading_history.h
+ * @brief Reading History for Plant Monitoring System
+ *
+ * This module keeps recent samples for batch analytics (rolling
+ * statistics, filtering, serialization). Every measured quantity of a
+ * sensor gets its own channel: a fixed-capacity ring of 16-bit
+ * fixed-point values in contiguous memory. Analytics walk one dense
+ * int16_t array instead of striding over sensor_reading_t records whose
+ * other fields are unused for that sensor type.
+ *
+ * Channels are taken from a shared pool of READING_HISTORY_CHANNELS on
+ * first use, so a temperature probe costs one ring and an AHT10 two.
+ *
+ * The module is plain C with no ESP-IDF dependencies so it can be built
+ * and benchmarked on the host.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef READING_HISTORY_H
+#define READING_HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (READING_HISTORY_DEPTH & (READING_HISTORY_DEPTH - 1)) != 0
+#error "READING_HISTORY_DEPTH must be a power of two"
+#endif
+
+#if READING_HISTORY_CHANNELS > 64
+#error "READING_HISTORY_CHANNELS must fit the 64-bit channel mask"
+#endif
+
+/** Most quantities a single sensor records (AHT10: temperature and humidity) */
+#define READING_HISTORY_QUANTITIES_PER_SENSOR  2
+
+/**
+ * @brief Measured quantities and their fixed-point encoding
+ */
+typedef enum {
+    HISTORY_QTY_TEMPERATURE = 0, /**< Temperature in 0.01 °C */
+    HISTORY_QTY_HUMIDITY,        /**< Relative humidity in 0.01 % */
+    HISTORY_QTY_SOIL_MOISTURE,   /**< Raw soil moisture value (0-4095) */
+    HISTORY_QTY_LIGHT_LEVEL,     /**< Raw light level value (0-4095) */
+    HISTORY_QTY_LUX,             /**< Light intensity in units of 2 lux */
+    HISTORY_QTY_VPD,             /**< Vapour pressure deficit in Pa */
+    HISTORY_QTY_COUNT            /**< Number of quantities */
+} history_quantity_t;
+
+/**
+ * @brief Channel contents in chronological order, as two contiguous runs
+ *
+ * The ring may wrap, so the samples are first[0..first_count) followed
+ * by second[0..second_count). Oldest sample first.
+ */
+typedef struct {
+    const int16_t *first;     /**< Older run */
+    uint16_t first_count;     /**< Samples in the older run */
+    const int16_t *second;    /**< Newer run (wrapped part) */
+    uint16_t second_count;    /**< Samples in the newer run */
+} history_span_t;
+
+/**
+ * @brief Release all channels and discard their samples
+ */
+void reading_history_init(void);
+
+/**
+ * @brief Get the channel of a sensor quantity, allocating it on first use
+ *
+ * @param sensor Sensor index
+ * @param quantity Measured quantity
+ * @return Channel number, -1 if the quantity is invalid or the pool is full
+ */
+int reading_history_attach(uint8_t sensor, history_quantity_t quantity);
+
+/**
+ * @brief Look up the channel of a sensor quantity
+ *
+ * @param sensor Sensor index
+ * @param quantity Measured quantity
+ * @return Channel number, -1 if none is attached
+ */
+int reading_history_find(uint8_t sensor, history_quantity_t quantity);
+
+/**
+ * @brief Append a sample, overwriting the oldest one when the ring is full
+ *
+ * @param channel Channel number
+ * @param value Sample in engineering units (°C, %, raw, lux, kPa)
+ */
+void reading_history_push(int channel, float value);
+
+/**
+ * @brief Append an already encoded sample
+ *
+ * @param channel Channel number
+ * @param raw Fixed-point sample (see history_quantity_t)
+ */
+void reading_history_push_raw(int channel, int16_t raw);
+
+/**
+ * @brief Number of samples held by a channel
+ *
+ * @param channel Channel number
+ * @return Sample count (0 for an unused channel)
+ */
+int reading_history_count(int channel);
+
+/**
+ * @brief Quantity stored in a channel
+ *
+ * @param channel Channel number
+ * @return Quantity, HISTORY_QTY_COUNT for an unused channel
+ */
+history_quantity_t reading_history_quantity(int channel);
+
+/**
+ * @brief Get a sample by age
+ *
+ * @param channel Channel number
+ * @param age 0 for the newest sample, count - 1 for the oldest
+ * @return Fixed-point sample, 0 if out of range
+ */
+int16_t reading_history_raw(int channel, int age);
+
+/**
+ * @brief Get the channel contents as contiguous runs
+ *
+ * @param channel Channel number
+ * @param span Pointer to store the runs
+ * @return true on success, false for an unused channel
+ */
+bool reading_history_span(int channel, history_span_t *span);
+
+/**
+ * @brief Discard the samples of a channel, keeping it attached
+ *
+ * @param channel Channel number
+ */
+void reading_history_clear(int channel);
+
+/**
+ * @brief Convert a value to the fixed-point encoding of a quantity
+ *
+ * Values are rounded and clamped to the int16_t range.
+ *
+ * @param quantity Measured quantity
+ * @param value Value in engineering units
+ * @return Fixed-point value
+ */
+int16_t reading_history_encode(history_quantity_t quantity, float value);
+
+/**
+ * @brief Convert a fixed-point value (or a sum of them) to engineering units
+ *
+ * @param quantity Measured quantity
+ * @param raw Fixed-point value
+ * @return Value in engineering units
+ */
+float reading_history_decode(history_quantity_t quantity, int32_t raw);
+
+/**
+ * @brief Fixed-point steps per engineering unit of a quantity
+ *
+ * Divide fixed-point statistics such as means by this to get
+ * engineering units.
+ *
+ * @param quantity Measured quantity
+ * @return Steps per unit (1 for an invalid quantity)
+ */
+float reading_history_scale(history_quantity_t quantity);
+
+/**
+ * @brief Name of a quantity, as used in the uplink payload
+ *
+ * @param quantity Measured quantity
+ * @return Static name string ("unknown" for an invalid quantity)
+ */
+const char *reading_history_quantity_name(history_quantity_t quantity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // READING_HISTORY_H
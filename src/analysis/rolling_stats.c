@@ -0,0 +1,235 @@
+/**
+ * @file rolling_stats.c
+ * @brief Rolling Window Statistics Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "rolling_stats.h"
+#include <math.h>
+#include <string.h>
+
+#if (ROLLING_STATS_SHORT_S % ROLLING_STATS_BUCKETS) != 0 || \
+    (ROLLING_STATS_MEDIUM_S % ROLLING_STATS_BUCKETS) != 0 || \
+    (ROLLING_STATS_LONG_S % ROLLING_STATS_BUCKETS) != 0
+#error "Rolling statistics windows must be a whole number of buckets"
+#endif
+
+/** Bucket length per window, in seconds */
+static const uint32_t k_bucket_seconds[ROLLING_STATS_WINDOWS] = {
+    ROLLING_STATS_SHORT_S / ROLLING_STATS_BUCKETS,
+    ROLLING_STATS_MEDIUM_S / ROLLING_STATS_BUCKETS,
+    ROLLING_STATS_LONG_S / ROLLING_STATS_BUCKETS,
+};
+
+/**
+ * @brief Ring slot of the bucket age buckets older than the current one
+ */
+static uint8_t slot_of_age(const rolling_window_t *window, uint32_t age)
+{
+    return (uint8_t)((window->current % ROLLING_STATS_BUCKETS + ROLLING_STATS_BUCKETS - age) % ROLLING_STATS_BUCKETS);
+}
+
+/**
+ * @brief Age of the bucket in a ring slot, relative to the current one
+ */
+static uint32_t age_of_slot(const rolling_window_t *window, uint8_t slot)
+{
+    return (window->current % ROLLING_STATS_BUCKETS + ROLLING_STATS_BUCKETS - slot) % ROLLING_STATS_BUCKETS;
+}
+
+static uint8_t deque_at(const rolling_deque_t *deque, int index)
+{
+    return deque->slot[(deque->head + index) % ROLLING_STATS_BUCKETS];
+}
+
+static uint8_t deque_back(const rolling_deque_t *deque)
+{
+    return deque_at(deque, deque->length - 1);
+}
+
+static void deque_pop_front(rolling_deque_t *deque)
+{
+    deque->head = (uint8_t)((deque->head + 1) % ROLLING_STATS_BUCKETS);
+    deque->length--;
+}
+
+static void deque_push_back(rolling_deque_t *deque, uint8_t slot)
+{
+    deque->slot[(deque->head + deque->length) % ROLLING_STATS_BUCKETS] = slot;
+    deque->length++;
+}
+
+/**
+ * @brief Add a closed bucket to the min and max deques
+ *
+ * Entries whose extreme the new bucket matches or beats can never be the
+ * window extreme again (the new bucket outlives them), so they are dropped.
+ */
+static void close_bucket(rolling_window_t *window, uint8_t slot)
+{
+    const rolling_bucket_t *bucket = &window->buckets[slot];
+    if (bucket->count == 0) {
+        return;
+    }
+
+    while (window->min_deque.length > 0 && window->buckets[deque_back(&window->min_deque)].min >= bucket->min) {
+        window->min_deque.length--;
+    }
+    deque_push_back(&window->min_deque, slot);
+
+    while (window->max_deque.length > 0 && window->buckets[deque_back(&window->max_deque)].max <= bucket->max) {
+        window->max_deque.length--;
+    }
+    deque_push_back(&window->max_deque, slot);
+}
+
+/**
+ * @brief Move a window on to bucket number next, dropping the buckets that age out
+ */
+static void advance(rolling_window_t *window, uint32_t next)
+{
+    close_bucket(window, (uint8_t)(window->current % ROLLING_STATS_BUCKETS));
+
+    if (next - window->current >= ROLLING_STATS_BUCKETS) {
+        memset(window->buckets, 0, sizeof(window->buckets));
+        memset(&window->min_deque, 0, sizeof(window->min_deque));
+        memset(&window->max_deque, 0, sizeof(window->max_deque));
+    } else {
+        for (uint32_t number = window->current + 1; number <= next; number++) {
+            // The slot held the oldest bucket, which is at the front of a
+            // deque if it is in it at all
+            uint8_t slot = (uint8_t)(number % ROLLING_STATS_BUCKETS);
+            if (window->min_deque.length > 0 && deque_at(&window->min_deque, 0) == slot) {
+                deque_pop_front(&window->min_deque);
+            }
+            if (window->max_deque.length > 0 && deque_at(&window->max_deque, 0) == slot) {
+                deque_pop_front(&window->max_deque);
+            }
+            memset(&window->buckets[slot], 0, sizeof(window->buckets[slot]));
+        }
+    }
+    window->current = next;
+}
+
+static void bucket_add(rolling_bucket_t *bucket, int16_t raw)
+{
+    if (bucket->count == 0) {
+        bucket->min = raw;
+        bucket->max = raw;
+    }
+    bucket->min = raw < bucket->min ? raw : bucket->min;
+    bucket->max = raw > bucket->max ? raw : bucket->max;
+
+    if (bucket->count == UINT16_MAX) {
+        return;
+    }
+    bucket->count++;
+    float delta = raw - bucket->mean;
+    bucket->mean += delta / bucket->count;
+    bucket->m2 += delta * (raw - bucket->mean);
+}
+
+void rolling_stats_init(rolling_stats_t *stats)
+{
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+void rolling_stats_update(rolling_stats_t *stats, int16_t raw, uint32_t time_s)
+{
+    if (!stats) {
+        return;
+    }
+
+    for (int w = 0; w < ROLLING_STATS_WINDOWS; w++) {
+        rolling_window_t *window = &stats->window[w];
+        uint32_t number = time_s / k_bucket_seconds[w];
+        if (!stats->started) {
+            window->current = number;
+        } else if (number > window->current) {
+            advance(window, number);
+        }
+        bucket_add(&window->buckets[window->current % ROLLING_STATS_BUCKETS], raw);
+    }
+    stats->started = true;
+}
+
+bool rolling_stats_summary(const rolling_stats_t *stats, int window_index, uint32_t now_s,
+                           rolling_summary_t *summary)
+{
+    if (!summary) {
+        return false;
+    }
+    memset(summary, 0, sizeof(*summary));
+    if (!stats || !stats->started || window_index < 0 || window_index >= ROLLING_STATS_WINDOWS) {
+        return false;
+    }
+
+    const rolling_window_t *window = &stats->window[window_index];
+    uint32_t now = now_s / k_bucket_seconds[window_index];
+    now = now > window->current ? now : window->current;
+
+    // A bucket is live while its age plus the time since the last sample
+    // (both in buckets) is below the window length
+    uint32_t idle = now - window->current;
+    if (idle >= ROLLING_STATS_BUCKETS) {
+        return false;
+    }
+
+    // Welford accumulators of the live buckets, merged pairwise
+    float mean = 0.0f;
+    float m2 = 0.0f;
+    uint32_t count = 0;
+    for (uint32_t age = 0; age + idle < ROLLING_STATS_BUCKETS; age++) {
+        const rolling_bucket_t *bucket = &window->buckets[slot_of_age(window, age)];
+        if (bucket->count == 0) {
+            continue;
+        }
+        uint32_t total = count + bucket->count;
+        float delta = bucket->mean - mean;
+        mean += delta * bucket->count / total;
+        m2 += bucket->m2 + delta * delta * ((float)count * bucket->count / total);
+        count = total;
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    // The first live deque entry is the extreme of the closed buckets
+    const rolling_bucket_t *current = &window->buckets[window->current % ROLLING_STATS_BUCKETS];
+    int16_t min = current->count ? current->min : INT16_MAX;
+    int16_t max = current->count ? current->max : INT16_MIN;
+    for (int i = 0; i < window->min_deque.length; i++) {
+        uint8_t slot = deque_at(&window->min_deque, i);
+        if (age_of_slot(window, slot) + idle < ROLLING_STATS_BUCKETS) {
+            min = window->buckets[slot].min < min ? window->buckets[slot].min : min;
+            break;
+        }
+    }
+    for (int i = 0; i < window->max_deque.length; i++) {
+        uint8_t slot = deque_at(&window->max_deque, i);
+        if (age_of_slot(window, slot) + idle < ROLLING_STATS_BUCKETS) {
+            max = window->buckets[slot].max > max ? window->buckets[slot].max : max;
+            break;
+        }
+    }
+
+    summary->count = count;
+    summary->mean = mean;
+    summary->stddev = count > 1 ? sqrtf(m2 / (count - 1)) : 0.0f;
+    summary->min = min;
+    summary->max = max;
+    return true;
+}
+
+uint32_t rolling_stats_window_seconds(int window)
+{
+    if (window < 0 || window >= ROLLING_STATS_WINDOWS) {
+        return 0;
+    }
+    return k_bucket_seconds[window] * ROLLING_STATS_BUCKETS;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file rolling_stats.h
+ * @brief Rolling Window Statistics for Plant Monitoring System
+ *
+ * This module keeps count, mean, standard deviation, minimum and maximum
+ * of one series over ROLLING_STATS_WINDOWS time windows (5 minutes, 1
+ * hour and 24 hours by default), so the device can report meaningful
+ * statistics however rarely it uploads.
+ *
+ * A window is a ring of ROLLING_STATS_BUCKETS time buckets, each holding
+ * a Welford accumulator (count, mean, sum of squared deviations) and the
+ * bucket minimum and maximum. A sample updates the current bucket in
+ * O(1); when time moves on, the oldest bucket is dropped whole. The
+ * window therefore covers between BUCKETS - 1 and BUCKETS bucket lengths
+ * of history, and memory does not grow with the sample rate.
+ *
+ * Minimum and maximum come from monotonic deques over the closed
+ * buckets, so they are O(1) amortized per bucket and O(1) to read. Mean
+ * and variance of a window merge the bucket accumulators (Chan et al.),
+ * which is only done when a summary is requested.
+ *
+ * State is owned by the caller (one rolling_stats_t per series), so it
+ * can live in ordinary RAM or in RTC memory across deep sleep. Samples
+ * use the fixed-point encoding of the reading history (see
+ * history_quantity_t); the module has no ESP-IDF dependencies.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef ROLLING_STATS_H
+#define ROLLING_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if ROLLING_STATS_BUCKETS < 2 || ROLLING_STATS_BUCKETS > 255
+#error "ROLLING_STATS_BUCKETS must be between 2 and 255"
+#endif
+
+/** Number of windows per series */
+#define ROLLING_STATS_WINDOWS    3
+
+/**
+ * @brief Welford accumulator of one time bucket
+ */
+typedef struct {
+    uint16_t count;           /**< Samples in the bucket */
+    int16_t min;              /**< Smallest sample */
+    int16_t max;              /**< Largest sample */
+    float mean;               /**< Running mean */
+    float m2;                 /**< Sum of squared deviations from the mean */
+} rolling_bucket_t;
+
+/**
+ * @brief Monotonic deque of bucket slots, oldest first
+ */
+typedef struct {
+    uint8_t slot[ROLLING_STATS_BUCKETS]; /**< Bucket slots */
+    uint8_t head;                        /**< Index of the oldest entry */
+    uint8_t length;                      /**< Number of entries */
+} rolling_deque_t;
+
+/**
+ * @brief One time window of a series
+ */
+typedef struct {
+    uint32_t current;                            /**< Number of the current bucket (time / bucket length) */
+    rolling_bucket_t buckets[ROLLING_STATS_BUCKETS]; /**< Bucket ring, indexed by number % BUCKETS */
+    rolling_deque_t min_deque;                   /**< Closed buckets with ascending minima */
+    rolling_deque_t max_deque;                   /**< Closed buckets with descending maxima */
+} rolling_window_t;
+
+/**
+ * @brief Statistics state of one series
+ */
+typedef struct {
+    rolling_window_t window[ROLLING_STATS_WINDOWS]; /**< Windows, shortest first */
+    bool started;                                /**< A sample has been added */
+} rolling_stats_t;
+
+/**
+ * @brief Statistics of one window, in fixed-point units
+ */
+typedef struct {
+    uint32_t count;           /**< Samples in the window */
+    float mean;               /**< Mean */
+    float stddev;             /**< Sample standard deviation (0 below two samples) */
+    int16_t min;              /**< Smallest sample */
+    int16_t max;              /**< Largest sample */
+} rolling_summary_t;
+
+/**
+ * @brief Discard all samples of a series
+ *
+ * @param stats Series state
+ */
+void rolling_stats_init(rolling_stats_t *stats);
+
+/**
+ * @brief Add a sample to every window of a series
+ *
+ * A timestamp earlier than the current bucket (the clock was set back)
+ * is counted in the current bucket.
+ *
+ * @param stats Series state
+ * @param raw Fixed-point sample
+ * @param time_s Time of the sample in seconds
+ */
+void rolling_stats_update(rolling_stats_t *stats, int16_t raw, uint32_t time_s);
+
+/**
+ * @brief Get the statistics of one window
+ *
+ * Buckets that have aged out by now_s are left out even if no sample
+ * arrived since, so a sensor that stopped reporting shows an empty window.
+ *
+ * @param stats Series state
+ * @param window Window index (0 to ROLLING_STATS_WINDOWS - 1)
+ * @param now_s Current time in seconds
+ * @param summary Pointer to store the statistics
+ * @return true if the window holds samples
+ */
+bool rolling_stats_summary(const rolling_stats_t *stats, int window, uint32_t now_s,
+                           rolling_summary_t *summary);
+
+/**
+ * @brief Length of a window
+ *
+ * @param window Window index
+ * @return Window length in seconds, 0 for an invalid index
+ */
+uint32_t rolling_stats_window_seconds(int window);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ROLLING_STATS_H
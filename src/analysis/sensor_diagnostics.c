@@ -0,0 +1,153 @@
+/**
+ * @file sensor_diagnostics.c
+ * @brief Sensor Self-Diagnostics Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "sensor_diagnostics.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Divergence averaging: weight 1 / (1 << SHIFT) per sample */
+#define DIVERGENCE_SHIFT  3
+
+// Global variables
+static sensor_diag_state_t g_channels[READING_HISTORY_CHANNELS];
+
+static bool channel_is_valid(int channel)
+{
+    return channel >= 0 && channel < READING_HISTORY_CHANNELS;
+}
+
+void sensor_diagnostics_init(void)
+{
+    memset(g_channels, 0, sizeof(g_channels));
+}
+
+void sensor_diagnostics_configure(int channel, const sensor_diag_limits_t *limits)
+{
+    if (!channel_is_valid(channel)) {
+        return;
+    }
+    sensor_diagnostics_state_init(&g_channels[channel], limits);
+}
+
+void sensor_diagnostics_state_init(sensor_diag_state_t *state, const sensor_diag_limits_t *limits)
+{
+    if (!state || !limits) {
+        return;
+    }
+    memset(state, 0, sizeof(*state));
+    state->limits = *limits;
+}
+
+uint8_t sensor_diagnostics_check(int channel, int16_t raw, uint32_t timestamp_ms)
+{
+    if (!channel_is_valid(channel)) {
+        return 0;
+    }
+    return sensor_diagnostics_update(&g_channels[channel], raw, timestamp_ms);
+}
+
+uint8_t sensor_diagnostics_update(sensor_diag_state_t *state, int16_t raw, uint32_t timestamp_ms)
+{
+    if (!state) {
+        return 0;
+    }
+
+    uint8_t flags = 0;
+
+    if (state->seeded) {
+        if (raw == state->last) {
+            if (state->repeats < UINT16_MAX) {
+                state->repeats++;
+            }
+        } else {
+            state->repeats = 0;
+        }
+
+        // N identical samples are N - 1 repeats
+        if (state->limits.stuck_samples > 0 && state->repeats + 1 >= state->limits.stuck_samples &&
+            !(raw == 0 && state->limits.zero_may_stick)) {
+            flags |= SENSOR_DIAG_STUCK;
+        }
+
+        // |change| / elapsed > max_rate / 60000 ms, without dividing
+        if (state->limits.max_rate > 0) {
+            uint32_t elapsed_ms = timestamp_ms - state->last_ms;
+            int64_t change = llabs((int64_t)raw - state->last);
+            if (change * 60000 > (int64_t)state->limits.max_rate * (elapsed_ms ? elapsed_ms : 1)) {
+                flags |= SENSOR_DIAG_RATE;
+            }
+        }
+    }
+
+    state->last = raw;
+    state->last_ms = timestamp_ms;
+    state->seeded = true;
+    return flags;
+}
+
+void sensor_diagnostics_compare(const int *channels, const int16_t *raw, int count, uint8_t *flags)
+{
+    if (!channels || count <= 0 || count > READING_HISTORY_CHANNELS) {
+        return;
+    }
+
+    sensor_diag_state_t *states[READING_HISTORY_CHANNELS];
+    for (int i = 0; i < count; i++) {
+        states[i] = channel_is_valid(channels[i]) ? &g_channels[channels[i]] : NULL;
+    }
+    sensor_diagnostics_compare_states(states, raw, count, flags);
+}
+
+void sensor_diagnostics_compare_states(sensor_diag_state_t *const *states, const int16_t *raw, int count,
+                                       uint8_t *flags)
+{
+    if (!states || !raw || !flags || count <= 0 || count > READING_HISTORY_CHANNELS) {
+        return;
+    }
+
+    // Median by insertion sort: sibling groups are a handful of sensors
+    int16_t sorted[READING_HISTORY_CHANNELS];
+    for (int i = 0; i < count; i++) {
+        int j = i;
+        while (j > 0 && sorted[j - 1] > raw[i]) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = raw[i];
+    }
+    int32_t median = (count % 2) ? sorted[count / 2]
+                                 : ((int32_t)sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+
+    for (int i = 0; i < count; i++) {
+        flags[i] &= (uint8_t)~SENSOR_DIAG_DIVERGENT;
+        sensor_diag_state_t *state = states[i];
+        if (count < 2 || !state) {
+            continue;
+        }
+
+        // A pair has no majority: each sensor tracks its offset from the
+        // other, so both are flagged when they drift apart
+        int32_t deviation = (count == 2) ? raw[i] - raw[1 - i] : raw[i] - median;
+        state->divergence += deviation - state->divergence / (1 << DIVERGENCE_SHIFT);
+
+        int32_t limit = (int32_t)state->limits.max_divergence * (1 << DIVERGENCE_SHIFT);
+        if (limit > 0 && abs(state->divergence) > limit) {
+            flags[i] |= SENSOR_DIAG_DIVERGENT;
+        }
+    }
+}
+
+void sensor_diagnostics_reset(int channel)
+{
+    if (!channel_is_valid(channel)) {
+        return;
+    }
+    sensor_diag_limits_t limits = g_channels[channel].limits;
+    sensor_diagnostics_configure(channel, &limits);
+}
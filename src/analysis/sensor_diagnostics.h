@@ -0,0 +1,157 @@
+/**
+ * @file sensor_diagnostics.h
+ * @brief Sensor Self-Diagnostics for Plant Monitoring System
+ *
+ * This module catches sensors that fail while still returning plausible
+ * values, which range checks in the drivers cannot see. Every reading
+ * history channel has three detectors, each O(1) per sample:
+ * - stuck value: the same fixed-point value for a number of samples in
+ *   a row (a frozen sensor repeating its last conversion);
+ * - rate limit: a change faster than the quantity can physically move;
+ * - divergence: a running mean of the deviation from the median of the
+ *   sibling sensors measuring the same quantity in the same place (for
+ *   a pair, from the other sensor, flagging both).
+ *
+ * Limits are set per channel, so the caller can account for the sensor
+ * type (a coarse DS18B20 legitimately repeats values for much longer
+ * than a 20-bit AHT10). Detectors with a zero limit are off.
+ *
+ * The module keeps the state of every reading history channel. Callers
+ * that must keep it elsewhere, such as in RTC memory across deep sleep,
+ * can own a sensor_diag_state_t and run the detectors on it with
+ * sensor_diagnostics_update() and sensor_diagnostics_compare_states().
+ *
+ * The module works on the fixed-point history values and has no
+ * ESP-IDF dependencies.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef SENSOR_DIAGNOSTICS_H
+#define SENSOR_DIAGNOSTICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "reading_history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Diagnostic flags */
+#define SENSOR_DIAG_STUCK      (1 << 0)   /**< Value has not changed for too long */
+#define SENSOR_DIAG_RATE       (1 << 1)   /**< Value changed faster than physically possible */
+#define SENSOR_DIAG_DIVERGENT  (1 << 2)   /**< Value disagrees with the sibling sensors */
+
+/**
+ * @brief Detector limits of a channel, in fixed-point units (see history_quantity_t)
+ */
+typedef struct {
+    uint16_t stuck_samples;   /**< Identical samples in a row that count as stuck (0 = off) */
+    int16_t max_rate;         /**< Largest change per minute (0 = off) */
+    int16_t max_divergence;   /**< Largest mean deviation from the sibling median (0 = off) */
+    bool zero_may_stick;      /**< A constant zero is legitimate (e.g. darkness) */
+} sensor_diag_limits_t;
+
+/**
+ * @brief Detector state of one channel
+ */
+typedef struct {
+    sensor_diag_limits_t limits;  /**< Detector limits */
+    int16_t last;             /**< Previous sample */
+    uint16_t repeats;         /**< Samples equal to the previous one, in a row */
+    uint32_t last_ms;         /**< Time of the previous sample */
+    int32_t divergence;       /**< Mean deviation from the sibling median, << 3 */
+    bool seeded;              /**< A previous sample exists */
+} sensor_diag_state_t;
+
+/**
+ * @brief Reset all channels and turn every detector off
+ */
+void sensor_diagnostics_init(void);
+
+/**
+ * @brief Set the detector limits of a channel and forget its state
+ *
+ * @param channel Reading history channel number
+ * @param limits Detector limits
+ */
+void sensor_diagnostics_configure(int channel, const sensor_diag_limits_t *limits);
+
+/**
+ * @brief Run the stuck-value and rate-limit detectors on a new sample
+ *
+ * @param channel Reading history channel number
+ * @param raw Fixed-point sample, before any filtering
+ * @param timestamp_ms Sample time in milliseconds (may wrap)
+ * @return SENSOR_DIAG_STUCK and/or SENSOR_DIAG_RATE, or 0
+ */
+uint8_t sensor_diagnostics_check(int channel, int16_t raw, uint32_t timestamp_ms);
+
+/**
+ * @brief Reset caller-owned detector state
+ *
+ * @param state Detector state
+ * @param limits Detector limits
+ */
+void sensor_diagnostics_state_init(sensor_diag_state_t *state, const sensor_diag_limits_t *limits);
+
+/**
+ * @brief Run the stuck-value and rate-limit detectors on caller-owned state
+ *
+ * Same as sensor_diagnostics_check(), for state kept by the caller.
+ *
+ * @param state Detector state
+ * @param raw Fixed-point sample, before any filtering
+ * @param timestamp_ms Sample time in milliseconds (may wrap)
+ * @return SENSOR_DIAG_STUCK and/or SENSOR_DIAG_RATE, or 0
+ */
+uint8_t sensor_diagnostics_update(sensor_diag_state_t *state, int16_t raw, uint32_t timestamp_ms);
+
+/**
+ * @brief Run the divergence detector on samples of sibling sensors
+ *
+ * The reference is the median of the samples. The mean deviation of
+ * each channel from it is tracked with an exponential moving average
+ * (weight 1/8), so a single disagreement does not raise the flag but a
+ * sensor that has drifted away does. A pair has no majority to tell
+ * which one is wrong: each sensor tracks its offset from the other
+ * instead, and both are flagged once the mean offset exceeds the limit.
+ *
+ * @param channels Reading history channel numbers of the siblings
+ * @param raw Fixed-point samples of this cycle, one per channel
+ * @param count Number of siblings (at most READING_HISTORY_CHANNELS)
+ * @param flags Per sibling, SENSOR_DIAG_DIVERGENT is set or cleared
+ */
+void sensor_diagnostics_compare(const int *channels, const int16_t *raw, int count, uint8_t *flags);
+
+/**
+ * @brief Run the divergence detector on caller-owned state
+ *
+ * Same as sensor_diagnostics_compare(), for state kept by the caller.
+ *
+ * @param states Detector state of each sibling (NULL entries are skipped)
+ * @param raw Fixed-point samples of this cycle, one per sibling
+ * @param count Number of siblings (at most READING_HISTORY_CHANNELS)
+ * @param flags Per sibling, SENSOR_DIAG_DIVERGENT is set or cleared
+ */
+void sensor_diagnostics_compare_states(sensor_diag_state_t *const *states, const int16_t *raw, int count,
+                                       uint8_t *flags);
+
+/**
+ * @brief Forget the state of a channel (e.g. after a sensor was replaced)
+ *
+ * The limits are kept.
+ *
+ * @param channel Reading history channel number
+ */
+void sensor_diagnostics_reset(int channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_DIAGNOSTICS_H
@@ -0,0 +1,177 @@
+/**
+ * @file sensor_fusion.c
+ * @brief Multi-Sensor Fusion Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "sensor_fusion.h"
+#include <math.h>
+#include <string.h>
+
+/** Learning rate of the per-source noise model */
+#define FUSION_LEARNING_RATE   0.1f
+
+/** Bounds of the variance inflation factor */
+#define FUSION_SCALE_MAX       100.0f
+
+/** Process noise per quantity */
+static const float k_process_noise[FUSION_QTY_COUNT] = {
+    [FUSION_AIR_TEMPERATURE] = FUSION_AIR_TEMP_PROCESS_NOISE,
+    [FUSION_AIR_HUMIDITY] = FUSION_HUMIDITY_PROCESS_NOISE,
+    [FUSION_SOIL_TEMPERATURE] = FUSION_SOIL_TEMP_PROCESS_NOISE,
+    [FUSION_LEAF_TEMPERATURE] = FUSION_AIR_TEMP_PROCESS_NOISE,
+    [FUSION_SOIL_MOISTURE] = FUSION_SOIL_MOISTURE_PROCESS_NOISE,
+};
+
+// Global variables
+static sensor_fusion_state_t g_fusion;
+static uint8_t g_accepted[FUSION_QTY_COUNT];
+
+/**
+ * @brief Effective measurement variance of a source
+ */
+static float source_variance(const fusion_source_t *source)
+{
+    return source->variance * source->scale + source->bias * source->bias;
+}
+
+/**
+ * @brief Inflate the variance of a misbehaving source
+ */
+static void source_penalize(fusion_source_t *source)
+{
+    source->scale = fminf(source->scale * 2.0f, FUSION_SCALE_MAX);
+}
+
+void sensor_fusion_init(void)
+{
+    memset(&g_fusion, 0, sizeof(g_fusion));
+    memset(g_accepted, 0, sizeof(g_accepted));
+}
+
+int sensor_fusion_add_source(fusion_quantity_t quantity, float sigma)
+{
+    if ((unsigned)quantity >= FUSION_QTY_COUNT || sigma <= 0.0f || g_fusion.source_count >= FUSION_MAX_SOURCES) {
+        return -1;
+    }
+
+    fusion_source_t *source = &g_fusion.sources[g_fusion.source_count];
+    source->quantity = (uint8_t)quantity;
+    source->variance = sigma * sigma;
+    source->scale = 1.0f;
+    source->bias = 0.0f;
+    return g_fusion.source_count++;
+}
+
+void sensor_fusion_predict(float dt_seconds)
+{
+    if (dt_seconds < 0.0f) {
+        dt_seconds = 0.0f;
+    }
+    for (int q = 0; q < FUSION_QTY_COUNT; q++) {
+        g_fusion.variance[q] += k_process_noise[q] * dt_seconds;
+        g_accepted[q] = 0;
+    }
+}
+
+bool sensor_fusion_update(int source_id, float value)
+{
+    if (source_id < 0 || source_id >= g_fusion.source_count || isnan(value)) {
+        return false;
+    }
+
+    fusion_source_t *source = &g_fusion.sources[source_id];
+    int q = source->quantity;
+    float r = source_variance(source);
+
+    if (!g_fusion.valid[q]) {
+        g_fusion.value[q] = value;
+        g_fusion.variance[q] = r;
+        g_fusion.valid[q] = true;
+        g_accepted[q]++;
+        return true;
+    }
+
+    float innovation = value - g_fusion.value[q];
+    float s = g_fusion.variance[q] + r;
+    float nis = innovation * innovation / s;
+    if (nis > FUSION_GATE_SIGMA * FUSION_GATE_SIGMA) {
+        source_penalize(source);
+        return false;
+    }
+
+    float gain = g_fusion.variance[q] / s;
+    g_fusion.value[q] += gain * innovation;
+    g_fusion.variance[q] *= (1.0f - gain);
+    g_accepted[q]++;
+
+    // Learn the noise model: drift shows up in the mean innovation,
+    // excess noise in a normalized innovation variance above one
+    source->bias += FUSION_LEARNING_RATE * (innovation - source->bias);
+    source->scale *= 1.0f + FUSION_LEARNING_RATE * (nis - 1.0f);
+    source->scale = fminf(fmaxf(source->scale, 1.0f), FUSION_SCALE_MAX);
+    return true;
+}
+
+void sensor_fusion_miss(int source_id)
+{
+    if (source_id >= 0 && source_id < g_fusion.source_count) {
+        source_penalize(&g_fusion.sources[source_id]);
+    }
+}
+
+bool sensor_fusion_get(fusion_quantity_t quantity, fusion_estimate_t *estimate)
+{
+    if ((unsigned)quantity >= FUSION_QTY_COUNT || !estimate) {
+        return false;
+    }
+
+    estimate->value = g_fusion.value[quantity];
+    estimate->sigma = g_fusion.valid[quantity] ? sqrtf(g_fusion.variance[quantity]) : 0.0f;
+    estimate->sources = g_accepted[quantity];
+    estimate->valid = g_fusion.valid[quantity];
+    return estimate->valid;
+}
+
+float sensor_fusion_get_weight(int source_id)
+{
+    if (source_id < 0 || source_id >= g_fusion.source_count) {
+        return 0.0f;
+    }
+
+    int q = g_fusion.sources[source_id].quantity;
+    float total = 0.0f;
+    for (int i = 0; i < g_fusion.source_count; i++) {
+        if (g_fusion.sources[i].quantity == q) {
+            total += 1.0f / source_variance(&g_fusion.sources[i]);
+        }
+    }
+    return (1.0f / source_variance(&g_fusion.sources[source_id])) / total;
+}
+
+void sensor_fusion_save(sensor_fusion_state_t *state)
+{
+    if (state) {
+        *state = g_fusion;
+    }
+}
+
+bool sensor_fusion_restore(const sensor_fusion_state_t *state)
+{
+    if (!state || state->source_count != g_fusion.source_count) {
+        return false;
+    }
+    for (int i = 0; i < g_fusion.source_count; i++) {
+        if (state->sources[i].quantity != g_fusion.sources[i].quantity ||
+            state->sources[i].variance != g_fusion.sources[i].variance) {
+            return false;
+        }
+    }
+
+    g_fusion = *state;
+    memset(g_accepted, 0, sizeof(g_accepted));
+    return true;
+}
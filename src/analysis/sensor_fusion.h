@@ -0,0 +1,169 @@
+/**
+ * @file sensor_fusion.h
+ * @brief Multi-Sensor Fusion for Plant Monitoring System
+ *
+ * This module combines all sensors measuring the same physical quantity
+ * into one estimate with a scalar Kalman filter per quantity. Air and
+ * soil temperature are separate quantities, so a soil probe no longer
+ * pulls the air temperature towards the soil.
+ *
+ * Every source (one sensor measuring one quantity) has a noise model:
+ * its datasheet variance, inflated by what the filter learns about it.
+ * - A running mean of its innovations (measurement minus estimate)
+ *   captures drift; its square is added to the variance.
+ * - A running normalized innovation variance captures a sensor that is
+ *   noisier than specified.
+ * - Missed readings and measurements outside the FUSION_GATE_SIGMA gate
+ *   double the variance, which decays again with consistent readings.
+ * A sensor that drifts or fails is therefore down-weighted rather than
+ * averaged in at full weight. With two sensors a drift is shared between
+ * them; with three or more the odd one out carries it.
+ *
+ * The estimate variance is reported so callers can tell how much the
+ * current samples are worth.
+ *
+ * The filter state can be saved and restored, so that a device that
+ * deep-sleeps between samples can keep it in RTC memory and carry the
+ * estimates and the learned noise models from one wakeup to the next.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef SENSOR_FUSION_H
+#define SENSOR_FUSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fused physical quantities
+ */
+typedef enum {
+    FUSION_AIR_TEMPERATURE = 0,  /**< Air temperature in °C */
+    FUSION_AIR_HUMIDITY,         /**< Air relative humidity in % */
+    FUSION_SOIL_TEMPERATURE,     /**< Soil temperature in °C */
+    FUSION_LEAF_TEMPERATURE,     /**< Leaf temperature in °C */
+    FUSION_SOIL_MOISTURE,        /**< Soil moisture in raw ADC counts */
+    FUSION_QTY_COUNT             /**< Number of quantities */
+} fusion_quantity_t;
+
+/**
+ * @brief Fused estimate of a quantity
+ */
+typedef struct {
+    float value;              /**< Estimated value */
+    float sigma;              /**< Standard deviation of the estimate */
+    uint8_t sources;          /**< Measurements accepted since the last predict step */
+    bool valid;               /**< At least one measurement was ever accepted */
+} fusion_estimate_t;
+
+/**
+ * @brief Per-source noise model
+ */
+typedef struct {
+    uint8_t quantity;         /**< fusion_quantity_t */
+    float variance;           /**< Datasheet variance */
+    float scale;              /**< Variance inflation (>= 1) */
+    float bias;               /**< Running mean of the innovation */
+} fusion_source_t;
+
+/**
+ * @brief Filter state: the sources and the estimate of every quantity
+ */
+typedef struct {
+    fusion_source_t sources[FUSION_MAX_SOURCES];  /**< Registered sources */
+    int source_count;                             /**< Number of registered sources */
+    float value[FUSION_QTY_COUNT];                /**< Estimate per quantity */
+    float variance[FUSION_QTY_COUNT];             /**< Estimate variance per quantity */
+    bool valid[FUSION_QTY_COUNT];                 /**< A measurement was ever accepted */
+} sensor_fusion_state_t;
+
+/**
+ * @brief Remove all sources and estimates
+ */
+void sensor_fusion_init(void);
+
+/**
+ * @brief Register a sensor as a source for a quantity
+ *
+ * @param quantity Quantity the sensor measures
+ * @param sigma Datasheet accuracy (one standard deviation)
+ * @return Source id, -1 if the quantity is invalid or FUSION_MAX_SOURCES are in use
+ */
+int sensor_fusion_add_source(fusion_quantity_t quantity, float sigma);
+
+/**
+ * @brief Advance all estimates in time
+ *
+ * Call once per sampling cycle before the measurements.
+ *
+ * @param dt_seconds Time since the previous predict step
+ */
+void sensor_fusion_predict(float dt_seconds);
+
+/**
+ * @brief Feed one measurement of a source
+ *
+ * @param source Source id
+ * @param value Measured value
+ * @return true if the measurement was used, false if rejected by the gate
+ */
+bool sensor_fusion_update(int source, float value);
+
+/**
+ * @brief Record that a source produced no usable reading this cycle
+ *
+ * @param source Source id
+ */
+void sensor_fusion_miss(int source);
+
+/**
+ * @brief Get the estimate of a quantity
+ *
+ * @param quantity Quantity
+ * @param estimate Pointer to store the estimate
+ * @return true if the estimate is valid
+ */
+bool sensor_fusion_get(fusion_quantity_t quantity, fusion_estimate_t *estimate);
+
+/**
+ * @brief Current weight of a source within its quantity
+ *
+ * @param source Source id
+ * @return Share of the source in the combined measurement (0-1)
+ */
+float sensor_fusion_get_weight(int source);
+
+/**
+ * @brief Copy the filter state out
+ *
+ * @param state Pointer to store the state
+ */
+void sensor_fusion_save(sensor_fusion_state_t *state);
+
+/**
+ * @brief Restore a saved filter state
+ *
+ * The sources must have been registered again, in the same order and
+ * with the same accuracy, as when the state was saved; otherwise the
+ * state is ignored and the filters start afresh. Call
+ * sensor_fusion_predict() with the time since the state was saved
+ * before the next measurements.
+ *
+ * @param state Saved state
+ * @return true if the state was restored
+ */
+bool sensor_fusion_restore(const sensor_fusion_state_t *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_FUSION_H
@@ -0,0 +1,97 @@
+/**
+ * @file vpd.c
+ * @brief Vapour Pressure Deficit and Dew Point Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "vpd.h"
+
+/** Temperature step between table entries, in 0.01 °C */
+#define TABLE_STEP   100
+
+#define TABLE_SIZE   ((VPD_TABLE_MAX - VPD_TABLE_MIN) / TABLE_STEP + 1)
+
+/**
+ * @brief Saturation vapour pressure in Pa, one entry per °C from VPD_TABLE_MIN
+ *
+ * round(610.94 * exp(17.625 * T / (T + 243.04))) for T = -40 .. 60 °C.
+ */
+static const uint16_t k_saturation[TABLE_SIZE] = {
+    19, 21, 23, 26, 29, 31, 35, 38, 42, 46,                              // -40 °C
+    51, 56, 62, 68, 74, 81, 89, 97, 106, 115,                            // -30 °C
+    126, 137, 149, 162, 176, 192, 208, 226, 245, 265,                    // -20 °C
+    287, 310, 335, 362, 391, 422, 455, 490, 528, 568,                    // -10 °C
+    611, 657, 705, 757, 813, 872, 934, 1001, 1071, 1146,                 // 0 °C
+    1226, 1311, 1400, 1495, 1596, 1702, 1815, 1934, 2060, 2193,          // 10 °C
+    2333, 2482, 2639, 2804, 2978, 3162, 3355, 3559, 3774, 3999,          // 20 °C
+    4237, 4486, 4749, 5024, 5314, 5618, 5936, 6271, 6622, 6989,          // 30 °C
+    7375, 7778, 8201, 8643, 9106, 9590, 10097, 10626, 11179, 11757,      // 40 °C
+    12361, 12991, 13648, 14334, 15050, 15796, 16574, 17384, 18228, 19108, // 50 °C
+    20023,                                                               // 60 °C
+};
+
+static int32_t clamp(int32_t value, int32_t min, int32_t max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+int32_t vpd_saturation_pressure(int32_t temperature)
+{
+    int32_t offset = clamp(temperature, VPD_TABLE_MIN, VPD_TABLE_MAX) - VPD_TABLE_MIN;
+    int32_t index = offset / TABLE_STEP;
+    int32_t fraction = offset % TABLE_STEP;
+    if (index == TABLE_SIZE - 1) {
+        return k_saturation[index];
+    }
+
+    int32_t low = k_saturation[index];
+    int32_t high = k_saturation[index + 1];
+    return low + ((high - low) * fraction + TABLE_STEP / 2) / TABLE_STEP;
+}
+
+int32_t vpd_vapour_pressure(int32_t temperature, int32_t humidity)
+{
+    int32_t saturation = vpd_saturation_pressure(temperature);
+    return (saturation * clamp(humidity, 0, 10000) + 5000) / 10000;
+}
+
+int32_t vpd_air(int32_t temperature, int32_t humidity)
+{
+    int32_t saturation = vpd_saturation_pressure(temperature);
+    return (saturation * (10000 - clamp(humidity, 0, 10000)) + 5000) / 10000;
+}
+
+int32_t vpd_leaf(int32_t leaf_temperature, int32_t temperature, int32_t humidity)
+{
+    return vpd_saturation_pressure(leaf_temperature) - vpd_vapour_pressure(temperature, humidity);
+}
+
+int32_t vpd_dew_point(int32_t temperature, int32_t humidity)
+{
+    int32_t pressure = vpd_vapour_pressure(temperature, humidity);
+    if (pressure <= k_saturation[0]) {
+        return VPD_TABLE_MIN;
+    }
+    if (pressure >= k_saturation[TABLE_SIZE - 1]) {
+        return VPD_TABLE_MAX;
+    }
+
+    // Last entry at or below the pressure; the table is strictly increasing
+    int32_t low = 0;
+    int32_t high = TABLE_SIZE - 1;
+    while (high - low > 1) {
+        int32_t middle = (low + high) / 2;
+        if (k_saturation[middle] <= pressure) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    int32_t span = k_saturation[high] - k_saturation[low];
+    int32_t fraction = ((pressure - k_saturation[low]) * TABLE_STEP + span / 2) / span;
+    return VPD_TABLE_MIN + low * TABLE_STEP + fraction;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file vpd.h
+ * @brief Vapour Pressure Deficit and Dew Point for Plant Monitoring System
+ *
+ * This module derives the climate-control quantities of a greenhouse
+ * from air temperature and relative humidity: the vapour pressure
+ * deficit (VPD) of the air, the leaf VPD (saturation pressure at leaf
+ * temperature minus the vapour pressure of the air) and the dew point.
+ *
+ * Saturation vapour pressure follows the Magnus formula with the
+ * Alduchov-Eskridge coefficients, es = 610.94 exp(17.625 T / (T + 243.04)) Pa.
+ * Instead of calling expf, which is a long library routine on a core
+ * without an FPU, the formula is tabulated once per degree from
+ * VPD_TABLE_MIN to VPD_TABLE_MAX and interpolated linearly; the error is
+ * below 6 Pa over the whole range. The dew point inverts the same table
+ * with a binary search, so it needs no logarithm either.
+ *
+ * Values use the fixed-point encoding of the reading history
+ * (temperature and humidity in 0.01 units, pressures in Pa) and all
+ * arithmetic is integer. The module has no ESP-IDF dependencies.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef VPD_H
+#define VPD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Lowest tabulated temperature, in 0.01 °C */
+#define VPD_TABLE_MIN   (-4000)
+
+/** Highest tabulated temperature, in 0.01 °C */
+#define VPD_TABLE_MAX   6000
+
+/**
+ * @brief Saturation vapour pressure over water
+ *
+ * @param temperature Temperature in 0.01 °C (clamped to the table range)
+ * @return Saturation vapour pressure in Pa
+ */
+int32_t vpd_saturation_pressure(int32_t temperature);
+
+/**
+ * @brief Vapour pressure of the air
+ *
+ * @param temperature Air temperature in 0.01 °C
+ * @param humidity Relative humidity in 0.01 % (clamped to 0-100 %)
+ * @return Vapour pressure in Pa
+ */
+int32_t vpd_vapour_pressure(int32_t temperature, int32_t humidity);
+
+/**
+ * @brief Vapour pressure deficit of the air
+ *
+ * @param temperature Air temperature in 0.01 °C
+ * @param humidity Relative humidity in 0.01 %
+ * @return VPD in Pa (0 at saturation)
+ */
+int32_t vpd_air(int32_t temperature, int32_t humidity);
+
+/**
+ * @brief Vapour pressure deficit between a leaf and the surrounding air
+ *
+ * @param leaf_temperature Leaf temperature in 0.01 °C
+ * @param temperature Air temperature in 0.01 °C
+ * @param humidity Relative humidity in 0.01 %
+ * @return Leaf VPD in Pa, negative when water condenses on the leaf
+ */
+int32_t vpd_leaf(int32_t leaf_temperature, int32_t temperature, int32_t humidity);
+
+/**
+ * @brief Dew point of the air
+ *
+ * @param temperature Air temperature in 0.01 °C
+ * @param humidity Relative humidity in 0.01 %
+ * @return Dew point in 0.01 °C (VPD_TABLE_MIN for very dry air)
+ */
+int32_t vpd_dew_point(int32_t temperature, int32_t humidity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VPD_H
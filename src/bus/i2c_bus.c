@@ -0,0 +1,759 @@
+/**
+ * @file i2c_bus.c
+ * @brief Shared I2C Bus and Device Discovery Implementation
+ *
+ * The I2C bus is serial, so probes cannot overlap. A scan is kept fast by
+ * bounding each probe to a few milliseconds, probing only the requested
+ * addresses and aborting once the bus stops responding.
+ *
+ * Driver transactions go through i2c_bus_cmd_begin(), which bounds each
+ * one by a deadline derived from its length, recovers the bus after a
+ * timeout and quarantines devices that keep failing. A monitoring cycle
+ * therefore costs at most one deadline plus one recovery per device, and
+ * nothing at all for a quarantined device.
+ *
+ * The SCL clock is switched per transaction to the speed negotiated for
+ * the target device. Probes always run at the base bus frequency.
+ *
+ * Devices behind a TCA9548A are reached by selecting their channel first.
+ * The selected channel of every multiplexer is cached, so consecutive
+ * transactions on the same channel cost no extra writes. Clock speeds and
+ * circuit breakers are kept per route (multiplexer channel plus address),
+ * since identical sensors share an address on different channels.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "i2c_bus.h"
+#include "trace.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+static const char *TAG = "I2C_BUS";
+
+// Global variables
+static bool g_initialized = false;
+static uint8_t g_sda_pin = 0;
+static uint8_t g_scl_pin = 0;
+static uint32_t g_freq = 0;
+static uint32_t g_clock = 0;
+static i2c_bus_map_t g_present = {0};
+static i2c_bus_map_t g_stale = {0};
+static bool g_map_valid = false;
+
+// Multiplexer state: control byte last written to each TCA9548A (0x70 + index)
+static uint8_t g_mux_control[I2C_BUS_MUX_COUNT];
+static uint8_t g_mux_known = 0;     /**< Multiplexers whose control byte is known */
+static uint8_t g_mux_open = 0;      /**< Multiplexers with a channel (possibly) enabled */
+static uint8_t g_route = 0;         /**< Current route (see route_key()) */
+
+/**
+ * @brief Circuit breaker state for one device
+ */
+typedef struct {
+    uint16_t key;             /**< Route and device address (0 = unused slot) */
+    uint8_t failures;         /**< Consecutive failed transactions */
+    uint8_t trips;            /**< Consecutive quarantines without a success */
+    int64_t until_us;         /**< Quarantined until this esp_timer time */
+} i2c_breaker_t;
+
+/**
+ * @brief Negotiated clock speed for one device
+ */
+typedef struct {
+    uint16_t key;             /**< Route and device address (0 = unused slot) */
+    uint32_t freq;            /**< SCL frequency in Hz */
+} i2c_speed_t;
+
+static i2c_breaker_t g_breakers[I2C_BUS_MAX_DEVICES];
+static i2c_speed_t g_speeds[I2C_BUS_MAX_DEVICES];
+
+/**
+ * @brief Probe timeout in ticks (at least one tick)
+ */
+static TickType_t probe_timeout_ticks(void)
+{
+    TickType_t ticks = pdMS_TO_TICKS(I2C_SCAN_PROBE_TIMEOUT_MS);
+    return ticks > 0 ? ticks : 1;
+}
+
+/**
+ * @brief Convert milliseconds to ticks, rounding up
+ *
+ * One extra tick covers the partial tick already elapsed when waiting starts.
+ */
+static TickType_t ms_to_ticks_ceil(uint32_t ms)
+{
+    return (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS + 1;
+}
+
+/**
+ * @brief Key identifying a device on the current route
+ *
+ * The high byte is 0 on the main bus, or 0x80 | mux index << 3 | channel
+ * behind a multiplexer.
+ */
+static uint16_t route_key(uint8_t address)
+{
+    return ((uint16_t)g_route << 8) | address;
+}
+
+/**
+ * @brief Find (or allocate) the breaker for an address on the current route
+ *
+ * @return Breaker, or NULL if the address is untracked and allocate is false
+ *         or the table is full
+ */
+static i2c_breaker_t *find_breaker(uint8_t address, bool allocate)
+{
+    uint16_t key = route_key(address);
+    i2c_breaker_t *free_slot = NULL;
+    for (int i = 0; i < I2C_BUS_MAX_DEVICES; i++) {
+        if (g_breakers[i].key == key) {
+            return &g_breakers[i];
+        }
+        if (!free_slot && g_breakers[i].key == 0) {
+            free_slot = &g_breakers[i];
+        }
+    }
+
+    if (allocate && free_slot) {
+        memset(free_slot, 0, sizeof(*free_slot));
+        free_slot->key = key;
+        return free_slot;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Record a failed transaction and quarantine the device if needed
+ */
+static void breaker_record_failure(uint8_t address)
+{
+    i2c_breaker_t *breaker = find_breaker(address, true);
+    if (!breaker) {
+        return;
+    }
+
+    // A device let back in after a quarantine gets a single attempt
+    if (breaker->failures < I2C_BUS_BREAKER_THRESHOLD) {
+        breaker->failures++;
+    }
+    if (breaker->failures < I2C_BUS_BREAKER_THRESHOLD) {
+        return;
+    }
+
+    uint32_t backoff_ms = I2C_BUS_BREAKER_BACKOFF_MS;
+    for (int i = 0; i < breaker->trips && backoff_ms < I2C_BUS_BREAKER_MAX_BACKOFF_MS; i++) {
+        backoff_ms *= 2;
+    }
+    if (backoff_ms > I2C_BUS_BREAKER_MAX_BACKOFF_MS) {
+        backoff_ms = I2C_BUS_BREAKER_MAX_BACKOFF_MS;
+    }
+
+    if (breaker->trips < UINT8_MAX) {
+        breaker->trips++;
+    }
+    breaker->until_us = esp_timer_get_time() + (int64_t)backoff_ms * 1000;
+    ESP_LOGW(TAG, "Device 0x%02X quarantined for %lu ms", address, (unsigned long)backoff_ms);
+}
+
+/**
+ * @brief Record a successful transaction
+ */
+static void breaker_record_success(uint8_t address)
+{
+    i2c_breaker_t *breaker = find_breaker(address, false);
+    if (breaker) {
+        if (breaker->trips > 0) {
+            ESP_LOGI(TAG, "Device 0x%02X recovered", address);
+        }
+        breaker->key = 0;
+    }
+}
+
+/**
+ * @brief Find the speed entry for a key (0 finds a free slot)
+ */
+static i2c_speed_t *find_speed(uint16_t key)
+{
+    for (int i = 0; i < I2C_BUS_MAX_DEVICES; i++) {
+        if (g_speeds[i].key == key) {
+            return &g_speeds[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Configure pins and SCL clock
+ */
+static esp_err_t driver_config(uint32_t freq)
+{
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = g_sda_pin,
+        .scl_io_num = g_scl_pin,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = freq,
+    };
+
+    esp_err_t ret = i2c_param_config(I2C_BUS_PORT, &conf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure I2C: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    g_clock = freq;
+    return ESP_OK;
+}
+
+/**
+ * @brief Switch the SCL clock if it differs from the requested one
+ */
+static esp_err_t set_clock(uint32_t freq)
+{
+    return (freq == g_clock) ? ESP_OK : driver_config(freq);
+}
+
+/**
+ * @brief Install the driver with the current settings
+ */
+static esp_err_t driver_install(void)
+{
+    esp_err_t ret = driver_config(g_freq);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = i2c_driver_install(I2C_BUS_PORT, I2C_MODE_MASTER, 0, 0, 0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Failed to install I2C driver: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Clock a stuck device free
+ *
+ * A slave interrupted mid-byte keeps driving SDA low until it has clocked
+ * out the rest of that byte. Up to nine SCL pulses finish it, and a STOP
+ * condition returns every device to idle.
+ *
+ * @return true if SDA was released
+ */
+static bool clock_out_stuck_device(void)
+{
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << g_sda_pin) | (1ULL << g_scl_pin),
+        .mode = GPIO_MODE_INPUT_OUTPUT_OD,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+    gpio_config(&io_conf);
+    gpio_set_level(g_sda_pin, 1);
+    gpio_set_level(g_scl_pin, 1);
+    esp_rom_delay_us(I2C_BUS_RECOVERY_HALF_PERIOD_US);
+
+    for (int i = 0; i < 9 && gpio_get_level(g_sda_pin) == 0; i++) {
+        gpio_set_level(g_scl_pin, 0);
+        esp_rom_delay_us(I2C_BUS_RECOVERY_HALF_PERIOD_US);
+        gpio_set_level(g_scl_pin, 1);
+        esp_rom_delay_us(I2C_BUS_RECOVERY_HALF_PERIOD_US);
+    }
+
+    // STOP: SDA rises while SCL is high
+    gpio_set_level(g_scl_pin, 0);
+    esp_rom_delay_us(I2C_BUS_RECOVERY_HALF_PERIOD_US);
+    gpio_set_level(g_sda_pin, 0);
+    esp_rom_delay_us(I2C_BUS_RECOVERY_HALF_PERIOD_US);
+    gpio_set_level(g_scl_pin, 1);
+    esp_rom_delay_us(I2C_BUS_RECOVERY_HALF_PERIOD_US);
+    gpio_set_level(g_sda_pin, 1);
+    esp_rom_delay_us(I2C_BUS_RECOVERY_HALF_PERIOD_US);
+
+    return gpio_get_level(g_sda_pin) == 1;
+}
+
+/**
+ * @brief Forget everything known about the devices on the bus
+ */
+static void reset_device_state(void)
+{
+    memset(&g_present, 0, sizeof(g_present));
+    memset(&g_stale, 0, sizeof(g_stale));
+    memset(g_breakers, 0, sizeof(g_breakers));
+    memset(g_speeds, 0, sizeof(g_speeds));
+    g_map_valid = false;
+    g_mux_known = 0;
+    g_mux_open = 0;
+    g_route = 0;
+}
+
+/**
+ * @brief Write the control byte of a multiplexer
+ *
+ * @param index Multiplexer index (address - I2C_BUS_MUX_ADDRESS_FIRST)
+ * @param control Channel enable bits
+ * @return ESP_OK on success, error code on failure
+ */
+static esp_err_t mux_write(uint8_t index, uint8_t control)
+{
+    uint8_t mux_address = I2C_BUS_MUX_ADDRESS_FIRST + index;
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    if (!cmd) {
+        return ESP_ERR_NO_MEM;
+    }
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (mux_address << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(cmd, control, true);
+    i2c_master_stop(cmd);
+
+    // The multiplexer itself sits on the main bus
+    uint8_t route = g_route;
+    g_route = 0;
+    esp_err_t ret = i2c_bus_cmd_begin(mux_address, cmd, 1);
+    g_route = route;
+    i2c_cmd_link_delete(cmd);
+
+    if (ret == ESP_OK) {
+        g_mux_control[index] = control;
+        g_mux_known |= (1 << index);
+        if (control) {
+            g_mux_open |= (1 << index);
+        } else {
+            g_mux_open &= ~(1 << index);
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Probe every address in a set
+ *
+ * @param addresses Addresses to probe
+ * @param found Pointer to store the addresses that acknowledged
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the bus stopped responding
+ */
+static esp_err_t probe_set(const i2c_bus_map_t *addresses, i2c_bus_map_t *found)
+{
+    int timeouts = 0;
+
+    memset(found, 0, sizeof(*found));
+    for (uint8_t address = I2C_BUS_ADDRESS_FIRST; address <= I2C_BUS_ADDRESS_LAST; address++) {
+        if (!i2c_bus_map_has(addresses, address)) {
+            continue;
+        }
+
+        esp_err_t ret = i2c_bus_probe(address);
+        if (ret == ESP_OK) {
+            i2c_bus_map_set(found, address);
+        }
+
+        // A stuck bus times out on every address; stop instead of waiting them all out
+        if (ret == ESP_ERR_TIMEOUT) {
+            if (++timeouts >= I2C_SCAN_MAX_TIMEOUTS) {
+                ESP_LOGE(TAG, "I2C bus not responding, scan aborted at 0x%02X", address);
+                i2c_bus_recover();
+                return ESP_ERR_TIMEOUT;
+            }
+        } else {
+            timeouts = 0;
+        }
+    }
+
+    return ESP_OK;
+}
+
+void i2c_bus_map_add_range(i2c_bus_map_t *map, uint8_t first, uint8_t last)
+{
+    for (unsigned address = first; address <= last && address < 128; address++) {
+        i2c_bus_map_set(map, (uint8_t)address);
+    }
+}
+
+int i2c_bus_map_count(const i2c_bus_map_t *map)
+{
+    int count = 0;
+    for (int i = 0; i < 4; i++) {
+        count += __builtin_popcount(map->bits[i]);
+    }
+    return count;
+}
+
+esp_err_t i2c_bus_init(uint8_t sda_pin, uint8_t scl_pin, uint32_t freq)
+{
+    bool same = (sda_pin == g_sda_pin && scl_pin == g_scl_pin && freq == g_freq);
+    if (g_initialized && same) {
+        return ESP_OK;
+    }
+
+    // Different pins mean different devices; the cached map no longer applies
+    bool pins_changed = g_initialized && (sda_pin != g_sda_pin || scl_pin != g_scl_pin);
+
+    g_sda_pin = sda_pin;
+    g_scl_pin = scl_pin;
+    g_freq = freq;
+
+    esp_err_t ret = driver_install();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (pins_changed) {
+        reset_device_state();
+    }
+
+    g_initialized = true;
+
+    ESP_LOGD(TAG, "I2C bus ready (SDA %d, SCL %d, %lu Hz)", sda_pin, scl_pin, (unsigned long)freq);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_deinit(void)
+{
+    if (!g_initialized) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = i2c_driver_delete(I2C_BUS_PORT);
+
+    g_initialized = false;
+    g_sda_pin = 0;
+    g_scl_pin = 0;
+    g_freq = 0;
+    reset_device_state();
+
+    return ret;
+}
+
+/**
+ * @brief Probe an address at a given clock speed
+ */
+static esp_err_t probe_at(uint8_t address, uint32_t freq)
+{
+    esp_err_t ret = set_clock(freq);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    if (!cmd) {
+        return ESP_ERR_NO_MEM;
+    }
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_stop(cmd);
+
+    ret = i2c_master_cmd_begin(I2C_BUS_PORT, cmd, probe_timeout_ticks());
+    i2c_cmd_link_delete(cmd);
+
+    // The driver reports a missing ACK as ESP_FAIL
+    return (ret == ESP_FAIL) ? ESP_ERR_NOT_FOUND : ret;
+}
+
+esp_err_t i2c_bus_probe(uint8_t address)
+{
+    if (!g_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return probe_at(address, g_freq);
+}
+
+esp_err_t i2c_bus_set_device_speed(uint8_t address, uint32_t max_freq)
+{
+    if (!g_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    i2c_speed_t *speed = find_speed(route_key(address));
+    if (max_freq <= g_freq) {
+        if (speed) {
+            speed->key = 0;
+        }
+        return ESP_OK;
+    }
+
+    if (!speed) {
+        speed = find_speed(0);
+        if (!speed) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    // Step down from the requested speed until the device answers reliably
+    for (uint32_t freq = max_freq; freq > g_freq; freq /= 2) {
+        int acks = 0;
+        while (acks < I2C_BUS_SPEED_PROBES && probe_at(address, freq) == ESP_OK) {
+            acks++;
+        }
+        if (acks == I2C_BUS_SPEED_PROBES) {
+            speed->key = route_key(address);
+            speed->freq = freq;
+            ESP_LOGI(TAG, "Device 0x%02X runs at %lu Hz", address, (unsigned long)freq);
+            return ESP_OK;
+        }
+    }
+
+    speed->key = 0;
+    if (probe_at(address, g_freq) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_LOGW(TAG, "Device 0x%02X limited to %lu Hz", address, (unsigned long)g_freq);
+    return ESP_OK;
+}
+
+uint32_t i2c_bus_get_device_speed(uint8_t address)
+{
+    i2c_speed_t *speed = find_speed(route_key(address));
+    return speed ? speed->freq : g_freq;
+}
+
+esp_err_t i2c_bus_cmd_begin(uint8_t address, i2c_cmd_handle_t cmd, size_t length)
+{
+    if (!g_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (i2c_bus_is_quarantined(address)) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
+
+    i2c_speed_t *speed = find_speed(route_key(address));
+    uint32_t freq = speed ? speed->freq : g_freq;
+    esp_err_t ret = set_clock(freq);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Nine clocks per byte (plus the address byte), with a safety margin
+    uint32_t transfer_ms = (uint32_t)(((uint64_t)(length + 1) * 9 * 1000 * I2C_BUS_DEADLINE_MARGIN +
+                                       freq - 1) / freq);
+    TickType_t deadline = ms_to_ticks_ceil(I2C_BUS_DEADLINE_BASE_MS + transfer_ms);
+
+    ret = i2c_master_cmd_begin(I2C_BUS_PORT, cmd, deadline);
+    if (ret == ESP_OK) {
+        breaker_record_success(address);
+        return ESP_OK;
+    }
+
+    breaker_record_failure(address);
+
+    // Fall back one speed step; the base frequency is the floor
+    if (speed) {
+        speed->freq /= 2;
+        if (speed->freq <= g_freq) {
+            speed->key = 0;
+        }
+        ESP_LOGW(TAG, "Device 0x%02X stepped down to %lu Hz", address,
+                 (unsigned long)i2c_bus_get_device_speed(address));
+    }
+    if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "Transaction with 0x%02X timed out", address);
+        i2c_bus_recover();
+    }
+    return ret;
+}
+
+esp_err_t i2c_bus_recover(void)
+{
+    if (!g_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // A multiplexer write may have been cut off; rewrite before the next use
+    g_mux_known = 0;
+
+    bool stuck = (gpio_get_level(g_sda_pin) == 0 || gpio_get_level(g_scl_pin) == 0);
+
+    i2c_driver_delete(I2C_BUS_PORT);
+
+    bool released = true;
+    if (stuck) {
+        released = clock_out_stuck_device();
+        ESP_LOGW(TAG, "I2C bus stuck low, clock recovery %s", released ? "succeeded" : "failed");
+    }
+
+    esp_err_t ret = driver_install();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return released ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t i2c_bus_select_channel(uint8_t mux_address, uint8_t channel)
+{
+    if (!g_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t target = I2C_BUS_MUX_COUNT;
+    if (mux_address != 0) {
+        if (mux_address < I2C_BUS_MUX_ADDRESS_FIRST ||
+            mux_address >= I2C_BUS_MUX_ADDRESS_FIRST + I2C_BUS_MUX_COUNT ||
+            channel >= I2C_BUS_MUX_CHANNELS) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        target = mux_address - I2C_BUS_MUX_ADDRESS_FIRST;
+    }
+
+    // Close the other multiplexers so identical addresses cannot collide
+    for (uint8_t i = 0; i < I2C_BUS_MUX_COUNT; i++) {
+        if (i != target && (g_mux_open & (1 << i))) {
+            if (mux_write(i, 0) != ESP_OK) {
+                // Unreachable (likely power-cycled, which also closes it); stop retrying
+                ESP_LOGW(TAG, "Multiplexer 0x%02X not responding", I2C_BUS_MUX_ADDRESS_FIRST + i);
+                g_mux_open &= ~(1 << i);
+            }
+        }
+    }
+
+    if (target == I2C_BUS_MUX_COUNT) {
+        g_route = 0;
+        return ESP_OK;
+    }
+
+    uint8_t control = 1 << channel;
+    if (!(g_mux_known & (1 << target)) || g_mux_control[target] != control) {
+        esp_err_t ret = mux_write(target, control);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    g_route = 0x80 | (target << 3) | channel;
+    return ESP_OK;
+}
+
+bool i2c_bus_is_quarantined(uint8_t address)
+{
+    i2c_breaker_t *breaker = find_breaker(address, false);
+    return breaker && breaker->until_us > esp_timer_get_time();
+}
+
+int i2c_bus_scan(const i2c_bus_map_t *candidates)
+{
+    if (!g_initialized) {
+        return -1;
+    }
+
+    i2c_bus_map_t addresses = {0};
+    if (candidates) {
+        addresses = *candidates;
+    } else {
+        i2c_bus_map_add_range(&addresses, I2C_BUS_ADDRESS_FIRST, I2C_BUS_ADDRESS_LAST);
+    }
+
+    TRACE_BEGIN(TRACE_EVT_I2C_SCAN, i2c_bus_map_count(&addresses));
+
+    // The map describes the main bus only
+    i2c_bus_select_channel(0, 0);
+
+    i2c_bus_map_t found;
+    esp_err_t ret = probe_set(&addresses, &found);
+    if (ret != ESP_OK) {
+        TRACE_END(TRACE_EVT_I2C_SCAN, -1);
+        return -1;
+    }
+
+    // Replace the probed part of the map, keep the rest
+    for (int i = 0; i < 4; i++) {
+        g_present.bits[i] = (g_present.bits[i] & ~addresses.bits[i]) | found.bits[i];
+        g_stale.bits[i] &= ~addresses.bits[i];
+    }
+    g_map_valid = true;
+
+    int device_count = i2c_bus_map_count(&found);
+    TRACE_END(TRACE_EVT_I2C_SCAN, device_count);
+    return device_count;
+}
+
+int i2c_bus_rescan(const i2c_bus_map_t *candidates, i2c_bus_map_t *changed)
+{
+    if (!g_initialized || !g_map_valid) {
+        return -1;
+    }
+
+    i2c_bus_map_t addresses = g_stale;
+    if (candidates) {
+        for (int i = 0; i < 4; i++) {
+            addresses.bits[i] |= candidates->bits[i] & ~g_present.bits[i];
+        }
+    }
+
+    TRACE_BEGIN(TRACE_EVT_I2C_SCAN, i2c_bus_map_count(&addresses));
+
+    i2c_bus_select_channel(0, 0);
+
+    i2c_bus_map_t found;
+    esp_err_t ret = probe_set(&addresses, &found);
+    if (ret != ESP_OK) {
+        TRACE_END(TRACE_EVT_I2C_SCAN, -1);
+        return -1;
+    }
+
+    i2c_bus_map_t diff;
+    for (int i = 0; i < 4; i++) {
+        diff.bits[i] = (g_present.bits[i] & addresses.bits[i]) ^ found.bits[i];
+        g_present.bits[i] ^= diff.bits[i];
+        g_stale.bits[i] &= ~addresses.bits[i];
+    }
+
+    if (changed) {
+        *changed = diff;
+    }
+
+    int change_count = i2c_bus_map_count(&diff);
+    TRACE_END(TRACE_EVT_I2C_SCAN, change_count);
+    return change_count;
+}
+
+void i2c_bus_mark_stale(uint8_t address)
+{
+    i2c_bus_map_set(&g_stale, address);
+}
+
+bool i2c_bus_map_is_valid(void)
+{
+    return g_map_valid;
+}
+
+bool i2c_bus_is_present(uint8_t address)
+{
+    return i2c_bus_map_has(&g_present, address);
+}
+
+esp_err_t i2c_bus_get_map(i2c_bus_map_t *map)
+{
+    if (!map) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!g_map_valid) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    *map = g_present;
+    return ESP_OK;
+}
+
+void i2c_bus_set_map(const i2c_bus_map_t *map)
+{
+    if (!map) {
+        return;
+    }
+
+    g_present = *map;
+    memset(&g_stale, 0, sizeof(g_stale));
+    g_map_valid = true;
+}
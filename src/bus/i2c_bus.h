@@ -0,0 +1,291 @@
+/**
+ * @file i2c_bus.h
+ * @brief Shared I2C Bus and Device Discovery for Plant Monitoring System
+ *
+ * This module owns the I2C master driver used by all I2C sensors and
+ * keeps a cached map of the addresses that acknowledged their last probe.
+ *
+ * Probes use a short timeout, and a scan gives up as soon as the bus stops
+ * responding, so a stuck device can no longer stall discovery for seconds.
+ * Scans can be restricted to a candidate set of addresses (for example
+ * the known address ranges of the configured sensor types).
+ *
+ * Driver transactions go through i2c_bus_cmd_begin(), which applies a
+ * deadline derived from the transfer length, recovers a stuck bus (nine
+ * SCL pulses, STOP, driver reinstall) and quarantines an address after
+ * repeated failures, with an exponential backoff.
+ *
+ * Devices that support a faster clock (e.g. Fast-mode 400 kHz) register
+ * it with i2c_bus_set_device_speed(); the bus switches the SCL clock per
+ * transaction and steps a device down again when its transfers fail.
+ *
+ * Sensors behind a TCA9548A multiplexer are reached by calling
+ * i2c_bus_select_channel() before talking to them. The selected channel
+ * is cached so repeated selections of the same channel cost nothing.
+ * Clock speeds and circuit breakers apply to the device on the currently
+ * selected route, so identical sensors on different channels are kept apart.
+ *
+ * Incremental rescans probe only addresses that may have changed state:
+ * addresses flagged stale by a driver whose transaction contradicted the
+ * map, and candidate addresses that are currently absent. They are cheap
+ * enough to run periodically for hot-plug detection.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/i2c.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** I2C port shared by all sensors */
+#define I2C_BUS_PORT             I2C_NUM_0
+
+/** TCA9548A multiplexers: addresses 0x70-0x77, eight channels each */
+#define I2C_BUS_MUX_ADDRESS_FIRST 0x70
+#define I2C_BUS_MUX_COUNT        8
+#define I2C_BUS_MUX_CHANNELS     8
+
+/** Lowest and highest non-reserved 7-bit addresses */
+#define I2C_BUS_ADDRESS_FIRST    0x08
+#define I2C_BUS_ADDRESS_LAST     0x77
+
+/**
+ * @brief Set of 7-bit I2C addresses (bit n of word n/32 = address n)
+ */
+typedef struct {
+    uint32_t bits[4];
+} i2c_bus_map_t;
+
+/**
+ * @brief Add an address to a map
+ */
+static inline void i2c_bus_map_set(i2c_bus_map_t *map, uint8_t address)
+{
+    map->bits[(address & 0x7F) / 32] |= (1UL << (address % 32));
+}
+
+/**
+ * @brief Remove an address from a map
+ */
+static inline void i2c_bus_map_clear(i2c_bus_map_t *map, uint8_t address)
+{
+    map->bits[(address & 0x7F) / 32] &= ~(1UL << (address % 32));
+}
+
+/**
+ * @brief Check whether a map contains an address
+ */
+static inline bool i2c_bus_map_has(const i2c_bus_map_t *map, uint8_t address)
+{
+    return (map->bits[(address & 0x7F) / 32] >> (address % 32)) & 1;
+}
+
+/**
+ * @brief Add an inclusive address range to a map
+ *
+ * @param map Map to update
+ * @param first First address of the range
+ * @param last Last address of the range
+ */
+void i2c_bus_map_add_range(i2c_bus_map_t *map, uint8_t first, uint8_t last);
+
+/**
+ * @brief Count the addresses in a map
+ *
+ * @param map Map to count
+ * @return Number of addresses set
+ */
+int i2c_bus_map_count(const i2c_bus_map_t *map);
+
+/**
+ * @brief Initialize the shared I2C master
+ *
+ * Safe to call from every driver: once installed, further calls with the
+ * same settings return ESP_OK, and different settings reconfigure the bus
+ * (which also discards the cached device map).
+ *
+ * @param sda_pin SDA pin number
+ * @param scl_pin SCL pin number
+ * @param freq I2C frequency in Hz
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t i2c_bus_init(uint8_t sda_pin, uint8_t scl_pin, uint32_t freq);
+
+/**
+ * @brief Uninstall the I2C master and clear the device map
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t i2c_bus_deinit(void);
+
+/**
+ * @brief Probe a single address
+ *
+ * Sends an address-only write and waits at most I2C_SCAN_PROBE_TIMEOUT_MS.
+ * The cached map is not updated.
+ *
+ * @param address 7-bit device address
+ * @return ESP_OK if the device acknowledged, ESP_ERR_NOT_FOUND if not,
+ *         ESP_ERR_TIMEOUT if the bus did not respond, other error code on failure
+ */
+esp_err_t i2c_bus_probe(uint8_t address);
+
+/**
+ * @brief Negotiate the clock speed for a device
+ *
+ * Probes the device at max_freq, halving the speed until it acknowledges
+ * I2C_BUS_SPEED_PROBES probes in a row. The base bus frequency is the
+ * floor and needs no entry. Speeds at or below it clear the entry.
+ *
+ * @param address 7-bit device address
+ * @param max_freq Highest SCL frequency the device supports, in Hz
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the device did not
+ *         answer at any speed, ESP_ERR_NO_MEM if the device table is full
+ */
+esp_err_t i2c_bus_set_device_speed(uint8_t address, uint32_t max_freq);
+
+/**
+ * @brief Get the clock speed used for a device
+ *
+ * @param address 7-bit device address
+ * @return SCL frequency in Hz
+ */
+uint32_t i2c_bus_get_device_speed(uint8_t address);
+
+/**
+ * @brief Execute a driver transaction with a bounded deadline
+ *
+ * The deadline is I2C_BUS_DEADLINE_BASE_MS plus the transfer time of
+ * length bytes (and the address byte) at the bus frequency, times
+ * I2C_BUS_DEADLINE_MARGIN. A timeout triggers i2c_bus_recover(). Any
+ * failure steps a device with a negotiated speed down by half.
+ *
+ * After I2C_BUS_BREAKER_THRESHOLD consecutive failures the address is
+ * quarantined for I2C_BUS_BREAKER_BACKOFF_MS, doubling on each further
+ * quarantine up to I2C_BUS_BREAKER_MAX_BACKOFF_MS. When it expires, one
+ * transaction is let through; a success clears the breaker.
+ *
+ * @param address 7-bit device address (for clock speed and circuit breaker)
+ * @param cmd Command link to execute
+ * @param length Number of data bytes written and read by the command
+ * @return ESP_OK on success, ESP_ERR_NOT_ALLOWED if the device is
+ *         quarantined, driver error code otherwise
+ */
+esp_err_t i2c_bus_cmd_begin(uint8_t address, i2c_cmd_handle_t cmd, size_t length);
+
+/**
+ * @brief Reset the bus after a timeout
+ *
+ * If SDA or SCL is held low, a device is clocked free with up to nine SCL
+ * pulses followed by a STOP condition. The driver is then reinstalled.
+ *
+ * @return ESP_OK if the bus is idle again, ESP_FAIL if SDA is still held
+ *         low, other error code on failure
+ */
+esp_err_t i2c_bus_recover(void);
+
+/**
+ * @brief Route subsequent transactions through a multiplexer channel
+ *
+ * Enables the channel on the given TCA9548A and closes the channels of
+ * any other multiplexer in use. Each multiplexer's control byte is cached,
+ * so nothing is written when the channel is already selected. After a bus
+ * recovery the next selection rewrites the control byte.
+ *
+ * @param mux_address Multiplexer address (0x70-0x77), or 0 for the main bus
+ * @param channel Channel number (0-7), ignored for the main bus
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid
+ *         multiplexer or channel, error code if the multiplexer failed
+ */
+esp_err_t i2c_bus_select_channel(uint8_t mux_address, uint8_t channel);
+
+/**
+ * @brief Check whether an address is currently quarantined
+ *
+ * @param address 7-bit device address on the currently selected route
+ * @return true while the circuit breaker is open
+ */
+bool i2c_bus_is_quarantined(uint8_t address);
+
+/**
+ * @brief Probe a set of addresses and update the cached map
+ *
+ * Only the probed addresses are updated; the rest of the map is kept.
+ * Scans cover the main bus: any open multiplexer channel is closed first.
+ * The scan is aborted after I2C_SCAN_MAX_TIMEOUTS consecutive bus
+ * timeouts, in which case the map is left unchanged.
+ *
+ * @param candidates Addresses to probe, or NULL for the whole
+ *                   I2C_BUS_ADDRESS_FIRST..I2C_BUS_ADDRESS_LAST range
+ * @return Number of probed addresses that acknowledged, -1 on failure
+ */
+int i2c_bus_scan(const i2c_bus_map_t *candidates);
+
+/**
+ * @brief Re-probe only the addresses whose state may have changed
+ *
+ * Probes the addresses marked stale with i2c_bus_mark_stale() plus the
+ * candidates that are currently absent from the map. Requires a previous
+ * scan (or i2c_bus_set_map()).
+ *
+ * @param candidates Addresses where a device may appear, or NULL for none
+ * @param changed Optional pointer to store the addresses that changed state
+ * @return Number of addresses that changed state, -1 on failure
+ */
+int i2c_bus_rescan(const i2c_bus_map_t *candidates, i2c_bus_map_t *changed);
+
+/**
+ * @brief Flag an address for the next incremental rescan
+ *
+ * Drivers call this when a transaction outcome contradicts the map.
+ *
+ * @param address 7-bit device address
+ */
+void i2c_bus_mark_stale(uint8_t address);
+
+/**
+ * @brief Check whether the cached map holds scan results
+ *
+ * @return true after a scan or i2c_bus_set_map()
+ */
+bool i2c_bus_map_is_valid(void);
+
+/**
+ * @brief Check whether an address acknowledged its last probe
+ *
+ * @param address 7-bit device address
+ * @return true if present in the cached map
+ */
+bool i2c_bus_is_present(uint8_t address);
+
+/**
+ * @brief Get the cached device map
+ *
+ * @param map Pointer to store the map
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no scan has run
+ */
+esp_err_t i2c_bus_get_map(i2c_bus_map_t *map);
+
+/**
+ * @brief Replace the cached device map (e.g. with a persisted one)
+ *
+ * @param map Map to install
+ */
+void i2c_bus_set_map(const i2c_bus_map_t *map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // I2C_BUS_H
@@ -0,0 +1,222 @@
+/**
+ * @file irrigation.c
+ * @brief Irrigation Control Task Implementation
+ *
+ * The control task is the only user of the controller state and the
+ * outputs. The moisture hand-over and the status are the only state
+ * shared with other tasks; both are plain copies under a spinlock, so
+ * neither side can be held up by the other for more than a few
+ * instructions.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "irrigation.h"
+#include "irrigation_controller.h"
+#include "dlog.h"
+#include "trace.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char *TAG = "IRRIGATION";
+
+/** Control period in ticks (at least one) */
+#define IRRIGATION_PERIOD_TICKS  (pdMS_TO_TICKS(IRRIGATION_PERIOD_MS) > 0 ? pdMS_TO_TICKS(IRRIGATION_PERIOD_MS) : 1)
+
+// Global variables
+static irrigation_controller_t g_controller;
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static int16_t g_moisture = 0;             /**< Newest estimate (guarded by g_lock) */
+static int64_t g_moisture_us = -1;         /**< Time of the newest estimate, -1 = none (guarded by g_lock) */
+static bool g_reset_requested = false;     /**< Guarded by g_lock */
+static irrigation_status_t g_status;       /**< Guarded by g_lock */
+static bool g_initialized = false;
+
+/**
+ * @brief Switch the pump and valve outputs
+ */
+static void irrigation_set_outputs(bool on)
+{
+    int level = on ? IRRIGATION_ACTIVE_LEVEL : !IRRIGATION_ACTIVE_LEVEL;
+    gpio_set_level(IRRIGATION_PUMP_GPIO, level);
+#if IRRIGATION_VALVE_GPIO >= 0
+    gpio_set_level(IRRIGATION_VALVE_GPIO, level);
+#endif
+}
+
+/**
+ * @brief Controller parameters from config.h
+ */
+static void irrigation_load_params(irrigation_params_t *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->mode = IRRIGATION_MODE;
+    params->setpoint = IRRIGATION_SETPOINT;
+    params->hysteresis = IRRIGATION_HYSTERESIS;
+    params->kp_permille = IRRIGATION_KP_PERMILLE;
+    params->ki_permille_per_hour = IRRIGATION_KI_PERMILLE_PER_HOUR;
+    params->window_ms = IRRIGATION_WINDOW_S * 1000UL;
+    params->min_on_ms = IRRIGATION_MIN_ON_S * 1000UL;
+    params->min_off_ms = IRRIGATION_MIN_OFF_S * 1000UL;
+    params->max_pulse_ms = IRRIGATION_MAX_PULSE_S * 1000UL;
+    params->max_daily_ms = (uint32_t)((uint64_t)IRRIGATION_MAX_DAILY_ML * 60000ULL / IRRIGATION_PUMP_ML_PER_MIN);
+    params->dry_run_ms = IRRIGATION_DRY_RUN_S * 1000UL;
+    params->response_ms = IRRIGATION_RESPONSE_S * 1000UL;
+    params->response_rise = IRRIGATION_RESPONSE_RISE;
+    params->max_age_ms = IRRIGATION_MAX_AGE_S * 1000UL;
+}
+
+/**
+ * @brief Fixed-period control loop
+ */
+static void irrigation_task(void *pvParameters)
+{
+    const TickType_t period = IRRIGATION_PERIOD_TICKS;
+    const int64_t period_us = (int64_t)pdTICKS_TO_MS(period) * 1000;
+    TickType_t wake = xTaskGetTickCount();
+    int64_t last_start_us = esp_timer_get_time();
+    bool pump_on = false;
+    uint8_t faults = 0;
+
+    while (1) {
+        // Returns pdFALSE when the wake-up time had already passed
+        bool late = xTaskDelayUntil(&wake, period) == pdFALSE;
+        int64_t start_us = esp_timer_get_time();
+        TRACE_BEGIN(TRACE_EVT_IRRIGATION, pump_on);
+
+        portENTER_CRITICAL(&g_lock);
+        int16_t moisture = g_moisture;
+        int64_t moisture_us = g_moisture_us;
+        bool reset = g_reset_requested;
+        g_reset_requested = false;
+        portEXIT_CRITICAL(&g_lock);
+
+        if (reset) {
+            irrigation_controller_reset_fault(&g_controller);
+        }
+
+        int64_t age_us = moisture_us < 0 ? INT64_MAX : start_us - moisture_us;
+        uint32_t age_ms = age_us / 1000 > UINT32_MAX ? UINT32_MAX : (uint32_t)(age_us / 1000);
+        bool on = irrigation_controller_step(&g_controller, moisture, age_ms, (uint32_t)(start_us / 1000));
+        bool switched = on != pump_on;
+        if (switched) {
+            irrigation_set_outputs(on);
+            pump_on = on;
+        }
+        int64_t end_us = esp_timer_get_time();
+
+        // Log after the outputs are set; the deferred log never blocks
+        if (switched) {
+            DLOG(DLOG_IRR_PUMP, pump_on ? "on" : "off", moisture, (unsigned)(g_controller.dose_today_ms / 1000));
+        }
+        if (g_controller.faults != faults) {
+            DLOG(DLOG_IRR_INTERLOCK, g_controller.faults, moisture, (unsigned)(g_controller.dose_today_ms / 1000));
+            faults = g_controller.faults;
+        }
+
+        int64_t jitter_us = start_us - last_start_us - period_us;
+        jitter_us = jitter_us < 0 ? -jitter_us : jitter_us;
+        last_start_us = start_us;
+
+        portENTER_CRITICAL(&g_lock);
+        g_status.pump_on = pump_on;
+        g_status.faults = faults;
+        g_status.dose_today_ms = g_controller.dose_today_ms;
+        g_status.cycles++;
+        if (late) {
+            g_status.overruns++;
+        }
+        if (g_status.cycles > 1 && jitter_us > g_status.max_jitter_us) {
+            g_status.max_jitter_us = (uint32_t)jitter_us;
+        }
+        if (end_us - start_us > g_status.max_step_us) {
+            g_status.max_step_us = (uint32_t)(end_us - start_us);
+        }
+        portEXIT_CRITICAL(&g_lock);
+
+        TRACE_END(TRACE_EVT_IRRIGATION, pump_on);
+    }
+}
+
+esp_err_t irrigation_init(void)
+{
+    if (g_initialized) {
+        ESP_LOGW(TAG, "Irrigation already initialized");
+        return ESP_OK;
+    }
+
+    // Drive the outputs to off before enabling them, so the pump cannot
+    // glitch on at boot
+    uint64_t mask = 1ULL << IRRIGATION_PUMP_GPIO;
+#if IRRIGATION_VALVE_GPIO >= 0
+    mask |= 1ULL << IRRIGATION_VALVE_GPIO;
+#endif
+    irrigation_set_outputs(false);
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = mask,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure outputs: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    irrigation_set_outputs(false);
+
+    irrigation_params_t params;
+    irrigation_load_params(&params);
+    irrigation_controller_init(&g_controller, &params);
+
+    if (xTaskCreate(&irrigation_task, "irrigation", 3072, NULL, IRRIGATION_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create irrigation task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    g_initialized = true;
+    ESP_LOGI(TAG, "Irrigation control started (mode %d, setpoint %d, every %d ms)",
+             IRRIGATION_MODE, IRRIGATION_SETPOINT, IRRIGATION_PERIOD_MS);
+    return ESP_OK;
+}
+
+void irrigation_feed_moisture(float moisture)
+{
+    int16_t value = (int16_t)(moisture <= 0.0f ? 0 : (moisture >= INT16_MAX ? INT16_MAX : moisture + 0.5f));
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&g_lock);
+    g_moisture = value;
+    g_moisture_us = now_us;
+    portEXIT_CRITICAL(&g_lock);
+}
+
+void irrigation_reset_fault(void)
+{
+    portENTER_CRITICAL(&g_lock);
+    g_reset_requested = true;
+    portEXIT_CRITICAL(&g_lock);
+}
+
+esp_err_t irrigation_get_status(irrigation_status_t *status)
+{
+    if (!status) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!g_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&g_lock);
+    *status = g_status;
+    portEXIT_CRITICAL(&g_lock);
+    return ESP_OK;
+}
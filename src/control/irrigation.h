@@ -0,0 +1,82 @@
+/**
+ * @file irrigation.h
+ * @brief Irrigation Control Task for Plant Monitoring System
+ *
+ * Runs the irrigation control law (see irrigation_controller.h) in a
+ * FreeRTOS task of its own, at IRRIGATION_TASK_PRIORITY and a fixed
+ * IRRIGATION_PERIOD_MS, and drives the pump and valve GPIOs from it.
+ *
+ * The loop never waits on the sensors, the display or the network: the
+ * monitoring task hands over each fused soil moisture estimate with
+ * irrigation_feed_moisture(), which only copies it under a spinlock, and
+ * the control task reads the newest copy every period. Logging goes
+ * through the deferred log. A step therefore takes a bounded time, and
+ * its wake-up jitter and duration are measured (see
+ * irrigation_get_status()). An estimate older than IRRIGATION_MAX_AGE_S,
+ * for instance while the monitoring task is stuck, stops the pump.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef IRRIGATION_H
+#define IRRIGATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Irrigation status
+ */
+typedef struct {
+    bool pump_on;             /**< Current pump output */
+    uint8_t faults;           /**< IRRIGATION_FAULT_* interlocks holding */
+    uint32_t dose_today_ms;   /**< Pump time in the current 24-hour period */
+    uint32_t cycles;          /**< Control periods run */
+    uint32_t overruns;        /**< Periods that started late by a full period or more */
+    uint32_t max_jitter_us;   /**< Largest deviation of a wake-up from the period */
+    uint32_t max_step_us;     /**< Longest control step, from wake-up to output */
+} irrigation_status_t;
+
+/**
+ * @brief Configure the outputs (pump off) and start the control task
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t irrigation_init(void);
+
+/**
+ * @brief Hand over the latest fused soil moisture estimate
+ *
+ * Safe to call from any task; does not block.
+ *
+ * @param moisture Soil moisture (raw ADC counts)
+ */
+void irrigation_feed_moisture(float moisture);
+
+/**
+ * @brief Clear a latched dry-run fault (applied at the next control period)
+ */
+void irrigation_reset_fault(void);
+
+/**
+ * @brief Get the irrigation status
+ *
+ * @param status Pointer to store the status
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if status is NULL,
+ *         ESP_ERR_INVALID_STATE if the task is not running
+ */
+esp_err_t irrigation_get_status(irrigation_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IRRIGATION_H
@@ -0,0 +1,372 @@
+/**
+ * @file dlog.c
+ * @brief Deferred (Tokenized) Logging Implementation
+ *
+ * Records are a small header (timestamp, format token, argument count)
+ * followed by one machine word per argument. Writing a record costs a
+ * handful of word copies and one ring buffer send; all formatting and
+ * UART traffic happen in the drain task at idle+1 priority.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "dlog.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/ringbuf.h"
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "DLOG";
+
+/** Maximum number of arguments per format */
+#define DLOG_MAX_ARGS        8
+
+/** Maximum formatted message length */
+#define DLOG_MESSAGE_MAX     192
+
+/** Maximum length of a single conversion specification */
+#define DLOG_SPEC_MAX        16
+
+/**
+ * @brief Argument kinds derived from the conversion characters
+ */
+typedef enum {
+    DLOG_ARG_INT = 0,         /**< d, i, u, x, X, c */
+    DLOG_ARG_FLOAT,           /**< f, e, g (stored as float bits) */
+    DLOG_ARG_STRING           /**< s (stored as pointer) */
+} dlog_arg_kind_t;
+
+/**
+ * @brief Parsed format table entry
+ */
+typedef struct {
+    esp_log_level_t level;            /**< Log level */
+    const char *tag;                  /**< Log tag */
+    const char *format;               /**< printf-style format */
+    uint8_t nargs;                    /**< Number of arguments */
+    uint8_t kinds[DLOG_MAX_ARGS];     /**< Argument kinds */
+} dlog_format_t;
+
+/**
+ * @brief Record header as stored in the ring
+ */
+typedef struct {
+    uint32_t timestamp_ms;    /**< esp_log_timestamp() at write time */
+    uint16_t id;              /**< dlog_id_t token */
+    uint8_t nargs;            /**< Number of argument words that follow */
+    uint8_t reserved;         /**< Padding */
+} dlog_record_t;
+
+// Global variables
+static dlog_format_t g_formats[DLOG_ID_MAX] = {
+#define DLOG_FORMAT(id, level, tag, format) [id] = { level, tag, format, 0, {0} },
+#include "dlog_formats.h"
+#undef DLOG_FORMAT
+};
+static bool g_formats_parsed = false;
+static RingbufHandle_t g_ring = NULL;
+static dlog_stats_t g_stats = {0};       /**< Updated atomically: any task may log */
+
+/**
+ * @brief Find the conversion character of a specification
+ *
+ * @param spec Pointer to the character following '%'
+ * @return Pointer to the conversion character, or to the terminator
+ */
+static const char *dlog_find_conversion(const char *spec)
+{
+    while (*spec && strchr("-+ #0123456789.hlzjt", *spec)) {
+        spec++;
+    }
+    return spec;
+}
+
+/**
+ * @brief Derive argument counts and kinds from the format strings
+ */
+static void dlog_parse_formats(void)
+{
+    for (int id = 0; id < DLOG_ID_MAX; id++) {
+        dlog_format_t *fmt = &g_formats[id];
+        fmt->nargs = 0;
+
+        for (const char *p = fmt->format; *p; p++) {
+            if (*p != '%') {
+                continue;
+            }
+            if (p[1] == '%') {
+                p++;
+                continue;
+            }
+
+            p = dlog_find_conversion(p + 1);
+            if (!*p) {
+                break;
+            }
+            if (fmt->nargs >= DLOG_MAX_ARGS) {
+                ESP_LOGW(TAG, "Format %d has more than %d arguments", id, DLOG_MAX_ARGS);
+                break;
+            }
+
+            dlog_arg_kind_t kind = DLOG_ARG_INT;
+            if (strchr("feEgG", *p)) {
+                kind = DLOG_ARG_FLOAT;
+            } else if (*p == 's') {
+                kind = DLOG_ARG_STRING;
+            }
+            fmt->kinds[fmt->nargs++] = (uint8_t)kind;
+        }
+    }
+
+    g_formats_parsed = true;
+}
+
+/**
+ * @brief Format a record into text
+ *
+ * Length modifiers are stripped because every integer argument is
+ * stored as a 32-bit word.
+ *
+ * @param fmt Format table entry
+ * @param words Argument words
+ * @param out Output buffer
+ * @param out_len Output buffer size
+ */
+static void dlog_format_message(const dlog_format_t *fmt, const uintptr_t *words,
+                                char *out, size_t out_len)
+{
+    size_t pos = 0;
+    int arg = 0;
+
+    for (const char *p = fmt->format; *p && pos + 1 < out_len; p++) {
+        if (*p != '%') {
+            out[pos++] = *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[pos++] = '%';
+            p++;
+            continue;
+        }
+
+        const char *conv = dlog_find_conversion(p + 1);
+        if (!*conv || arg >= fmt->nargs) {
+            break;
+        }
+
+        char spec[DLOG_SPEC_MAX];
+        size_t len = 0;
+        for (const char *s = p; s <= conv && len < sizeof(spec) - 1; s++) {
+            if (!strchr("hlzjt", *s)) {
+                spec[len++] = *s;
+            }
+        }
+        spec[len] = '\0';
+
+        int written = 0;
+        switch (fmt->kinds[arg]) {
+            case DLOG_ARG_FLOAT: {
+                uint32_t bits = (uint32_t)words[arg];
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                written = snprintf(out + pos, out_len - pos, spec, (double)value);
+                break;
+            }
+            case DLOG_ARG_STRING:
+                written = snprintf(out + pos, out_len - pos, spec,
+                                   words[arg] ? (const char *)words[arg] : "(null)");
+                break;
+            default:
+                written = snprintf(out + pos, out_len - pos, spec, (int)(uint32_t)words[arg]);
+                break;
+        }
+
+        if (written > 0) {
+            pos += (size_t)written;
+            if (pos >= out_len) {
+                pos = out_len - 1;
+            }
+        }
+        arg++;
+        p = conv;
+    }
+
+    out[pos] = '\0';
+}
+
+/**
+ * @brief Emit a record as formatted text
+ *
+ * @param record Record header (argument words follow it)
+ */
+static void dlog_emit_text(const dlog_record_t *record)
+{
+    static const char level_letters[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+    const dlog_format_t *fmt = &g_formats[record->id];
+    const uintptr_t *words = (const uintptr_t *)(record + 1);
+    char message[DLOG_MESSAGE_MAX];
+
+    dlog_format_message(fmt, words, message, sizeof(message));
+    esp_log_write(fmt->level, fmt->tag, "%c (%" PRIu32 ") %s: %s\n",
+                  level_letters[fmt->level], record->timestamp_ms, fmt->tag, message);
+}
+
+/**
+ * @brief Emit a record as a token line for tools/dlog_decode.py
+ *
+ * Line format: DLOG:<timestamp hex>:<id>[:<word hex>|:s<string hex>]...
+ *
+ * @param record Record header (argument words follow it)
+ */
+static void dlog_emit_tokens(const dlog_record_t *record)
+{
+    const dlog_format_t *fmt = &g_formats[record->id];
+    const uintptr_t *words = (const uintptr_t *)(record + 1);
+
+    printf("DLOG:%" PRIx32 ":%u", record->timestamp_ms, (unsigned)record->id);
+    for (int i = 0; i < record->nargs; i++) {
+        if (fmt->kinds[i] == DLOG_ARG_STRING) {
+            printf(":s");
+            for (const char *s = (const char *)words[i]; s && *s; s++) {
+                printf("%02x", (uint8_t)*s);
+            }
+        } else {
+            printf(":%08" PRIx32, (uint32_t)words[i]);
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Low-priority task that drains and emits records
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+static void dlog_drain_task(void *pvParameters)
+{
+    while (1) {
+        size_t size = 0;
+        dlog_record_t *record = (dlog_record_t *)xRingbufferReceive(g_ring, &size, portMAX_DELAY);
+        if (!record) {
+            continue;
+        }
+
+        if (DLOG_BINARY_OUTPUT) {
+            dlog_emit_tokens(record);
+        } else {
+            dlog_emit_text(record);
+        }
+
+        vRingbufferReturnItem(g_ring, record);
+    }
+}
+
+esp_err_t dlog_init(void)
+{
+    if (!g_formats_parsed) {
+        dlog_parse_formats();
+    }
+
+    if (!DLOG_ENABLED) {
+        ESP_LOGI(TAG, "Deferred logging disabled, formatting synchronously");
+        return ESP_OK;
+    }
+
+    if (g_ring) {
+        ESP_LOGW(TAG, "Deferred logging already initialized");
+        return ESP_OK;
+    }
+
+    g_ring = xRingbufferCreate(DLOG_BUFFER_SIZE, RINGBUF_TYPE_NOSPLIT);
+    if (!g_ring) {
+        ESP_LOGE(TAG, "Failed to allocate %d byte log ring", DLOG_BUFFER_SIZE);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(&dlog_drain_task, "dlog_drain", 3072, NULL, DLOG_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create drain task");
+        vRingbufferDelete(g_ring);
+        g_ring = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Deferred logging initialized (%d formats, %d byte ring, %s output)",
+             DLOG_ID_MAX, DLOG_BUFFER_SIZE, DLOG_BINARY_OUTPUT ? "token" : "text");
+    return ESP_OK;
+}
+
+void dlog_write(dlog_id_t id, ...)
+{
+    if ((unsigned)id >= DLOG_ID_MAX) {
+        return;
+    }
+
+    if (!g_formats_parsed) {
+        dlog_parse_formats();
+    }
+
+    const dlog_format_t *fmt = &g_formats[id];
+    if (esp_log_level_get(fmt->tag) < fmt->level) {
+        return;
+    }
+
+    struct {
+        dlog_record_t header;
+        uintptr_t words[DLOG_MAX_ARGS];
+    } record;
+
+    record.header.timestamp_ms = esp_log_timestamp();
+    record.header.id = (uint16_t)id;
+    record.header.nargs = fmt->nargs;
+    record.header.reserved = 0;
+
+    va_list args;
+    va_start(args, id);
+    for (int i = 0; i < fmt->nargs; i++) {
+        switch (fmt->kinds[i]) {
+            case DLOG_ARG_FLOAT: {
+                float value = (float)va_arg(args, double);
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                record.words[i] = bits;
+                break;
+            }
+            case DLOG_ARG_STRING:
+                record.words[i] = (uintptr_t)va_arg(args, const char *);
+                break;
+            default:
+                record.words[i] = (uint32_t)va_arg(args, int);
+                break;
+        }
+    }
+    va_end(args);
+
+    if (!g_ring) {
+        dlog_emit_text(&record.header);
+        return;
+    }
+
+    size_t size = sizeof(record.header) + fmt->nargs * sizeof(uintptr_t);
+    if (xRingbufferSend(g_ring, &record, size, 0) == pdTRUE) {
+        __atomic_fetch_add(&g_stats.written, 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_add(&g_stats.dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+esp_err_t dlog_get_stats(dlog_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stats->written = __atomic_load_n(&g_stats.written, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&g_stats.dropped, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
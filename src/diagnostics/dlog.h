@@ -0,0 +1,87 @@
+/**
+ * @file dlog.h
+ * @brief Deferred (Tokenized) Logging for Plant Monitoring System
+ *
+ * This module moves log formatting and UART output off the sampling
+ * path. Callers write a format token plus raw argument words into a ring
+ * buffer; a low-priority task formats the records later, or emits them
+ * as compact tokens for tools/dlog_decode.py to format on the host.
+ *
+ * Formats are declared in dlog_formats.h. Before dlog_init() has been
+ * called, or when DLOG_ENABLED is 0, DLOG() formats synchronously like a
+ * regular ESP_LOGx call.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Deferred log message identifiers
+ */
+typedef enum {
+#define DLOG_FORMAT(id, level, tag, format) id,
+#include "dlog_formats.h"
+#undef DLOG_FORMAT
+    DLOG_ID_MAX               /**< Number of declared formats */
+} dlog_id_t;
+
+/**
+ * @brief Deferred logging statistics
+ */
+typedef struct {
+    uint32_t written;         /**< Records accepted into the ring */
+    uint32_t dropped;         /**< Records dropped because the ring was full */
+} dlog_stats_t;
+
+/**
+ * @brief Initialize deferred logging
+ *
+ * Parses the format table, allocates the ring buffer and starts the
+ * low-priority drain task.
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t dlog_init(void);
+
+/**
+ * @brief Write a deferred log record
+ *
+ * Arguments must match the conversions of the format declared for the
+ * identifier. Must not be called from an ISR.
+ *
+ * @param id Format identifier
+ * @param ... Format arguments
+ */
+void dlog_write(dlog_id_t id, ...);
+
+/**
+ * @brief Get deferred logging statistics
+ *
+ * @param stats Pointer to store the statistics
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t dlog_get_stats(dlog_stats_t *stats);
+
+/**
+ * @brief Log a message declared in dlog_formats.h
+ */
+#define DLOG(id, ...) dlog_write((id), ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DLOG_H
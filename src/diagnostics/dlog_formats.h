@@ -0,0 +1,63 @@
+/**
+ * @file dlog_formats.h
+ * @brief Deferred Log Format Table
+ *
+ * Every deferred log message is listed here once as
+ * DLOG_FORMAT(id, level, tag, format). The position in this list is the
+ * token written to the log ring, and tools/dlog_decode.py parses this
+ * file to turn binary records back into text, so entries must only be
+ * appended (or the host decoder updated together with the firmware).
+ *
+ * Format strings support the d/i/u/x/X/c, f/e/g and s conversions. String
+ * arguments are stored by pointer and must refer to static storage such
+ * as string literals.
+ *
+ * This file is intentionally included multiple times.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+// Monitoring task (main.cpp)
+DLOG_FORMAT(DLOG_MON_READ_COUNT,       ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Read %d sensor readings")
+DLOG_FORMAT(DLOG_MON_SUMMARY_BEGIN,    ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "=== Plant Monitor Summary ===")
+DLOG_FORMAT(DLOG_MON_VALID_SENSORS,    ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Valid sensors: %d/%d")
+DLOG_FORMAT(DLOG_MON_TEMPERATURE,      ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Temperature: %.2f°C")
+DLOG_FORMAT(DLOG_MON_HUMIDITY,         ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Humidity: %.2f%%")
+DLOG_FORMAT(DLOG_MON_SOIL_MOISTURE,    ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Soil Moisture: %d")
+DLOG_FORMAT(DLOG_MON_LIGHT_LEVEL,      ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Light Level: %d")
+DLOG_FORMAT(DLOG_MON_LUX,              ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Light Intensity: %.1f lux")
+DLOG_FORMAT(DLOG_MON_HEALTH,           ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Plant Health: %s %s (Score: %.1f)")
+DLOG_FORMAT(DLOG_MON_RECOMMENDATION,   ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Recommendation: %s")
+DLOG_FORMAT(DLOG_MON_SUMMARY_END,      ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "================================")
+
+// Unified plant monitor library (plant_monitor.c)
+DLOG_FORMAT(DLOG_PM_SENSOR_READINGS,   ESP_LOG_INFO, "PLANT_MONITOR", "Sensor readings: T1=%.2f°C, H1=%.2f%%, T2=%.2f°C, H2=%.2f%%, Avg T=%.2f°C, Avg H=%.2f%%, Soil=%d, Light=%d")
+DLOG_FORMAT(DLOG_PM_HEALTH,            ESP_LOG_INFO, "PLANT_MONITOR", "Plant health: %s %s (Score: %.1f) - %s")
+
+// Sensor self-diagnostics (main.cpp)
+DLOG_FORMAT(DLOG_MON_SENSOR_SUSPECT,   ESP_LOG_WARN, "PLANT_MONITOR_MODULAR", "Sensor %s failed self-diagnostics:%s%s%s")
+
+// Rolling window statistics (main.cpp)
+DLOG_FORMAT(DLOG_MON_STATISTICS,       ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Stats %s %s over %us: n=%u mean=%.2f sd=%.2f min=%.2f max=%.2f")
+
+// Time-to-dry prediction (main.cpp)
+DLOG_FORMAT(DLOG_MON_DRY_FORECAST,     ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Soil drying at %.1f/h, dry in %.1f h")
+
+// Daily light integral (main.cpp)
+DLOG_FORMAT(DLOG_MON_LIGHT_INTEGRAL,   ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "PPFD: %.1f µmol/m²/s, DLI today: %.2f mol/m² (%.1f h lit, %.1f h covered)")
+
+// Vapour pressure deficit (main.cpp)
+DLOG_FORMAT(DLOG_MON_VPD,              ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "VPD: %.2f kPa, leaf VPD: %.2f kPa, dew point: %.1f°C")
+
+// Anomaly detection (main.cpp)
+DLOG_FORMAT(DLOG_MON_ANOMALY,          ESP_LOG_WARN, "PLANT_MONITOR_MODULAR", "Anomalous %s %s: %.2f (average %.2f, z %.1f)")
+
+// Threshold alerts (main.cpp)
+DLOG_FORMAT(DLOG_MON_ALERT_RAISED,     ESP_LOG_WARN, "PLANT_MONITOR_MODULAR", "Alert %s raised (%s): %.2f past %.2f")
+DLOG_FORMAT(DLOG_MON_ALERT_CLEARED,    ESP_LOG_INFO, "PLANT_MONITOR_MODULAR", "Alert %s cleared: %.2f (peak %.2f)")
+
+// Irrigation control (irrigation.c)
+DLOG_FORMAT(DLOG_IRR_PUMP,             ESP_LOG_INFO, "IRRIGATION", "Pump %s (moisture %d, %u s today)")
+DLOG_FORMAT(DLOG_IRR_INTERLOCK,        ESP_LOG_WARN, "IRRIGATION", "Interlocks 0x%02x (moisture %d, %u s today)")
@@ -0,0 +1,165 @@
+/**
+ * @file trace.c
+ * @brief Binary Event Trace Implementation
+ *
+ * This module implements the trace ring used to build timeline views of
+ * the monitoring cycle. Events are 8 bytes each and are written under a
+ * spinlock, so recording costs a few hundred nanoseconds and is safe
+ * from both tasks and interrupt handlers.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "trace.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "TRACE";
+
+/** Maximum number of task tracks (track 63 is reserved for ISRs) */
+#define TRACE_MAX_TRACKS   8
+#define TRACE_TRACK_ISR    63
+
+/** Events per dump line (8 events = 128 hex characters) */
+#define TRACE_EVENTS_PER_LINE 8
+
+// Global variables
+static trace_event_t g_ring[TRACE_BUFFER_EVENTS];
+static uint32_t g_written = 0;
+static TaskHandle_t g_tracks[TRACE_MAX_TRACKS];
+static uint8_t g_track_count = 0;
+static volatile bool g_enabled = false;
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Event names, indexed by trace_event_id_t
+ */
+static const char *const g_event_names[TRACE_EVT_MAX] = {
+    [TRACE_EVT_MONITOR_CYCLE]   = "monitor_cycle",
+    [TRACE_EVT_SENSOR_READ_ALL] = "sensor_read_all",
+    [TRACE_EVT_SENSOR_READ]     = "sensor_read",
+    [TRACE_EVT_AHT10_READ]      = "aht10_read",
+    [TRACE_EVT_ONEWIRE_RESET]   = "onewire_reset",
+    [TRACE_EVT_DS18B20_CONVERT] = "ds18b20_convert",
+    [TRACE_EVT_GY302_READ]      = "gy302_read",
+    [TRACE_EVT_HEALTH]          = "health",
+    [TRACE_EVT_DISPLAY_UPDATE]  = "display_update",
+    [TRACE_EVT_TRANSMIT]        = "transmit",
+    [TRACE_EVT_I2C_SCAN]        = "i2c_scan",
+    [TRACE_EVT_IRRIGATION]      = "irrigation",
+};
+
+/**
+ * @brief Map the calling context to a track number
+ *
+ * Must be called with g_lock held.
+ *
+ * @return Track number (0-62 for tasks, 63 for ISRs)
+ */
+static uint8_t trace_current_track(void)
+{
+    if (xPortInIsrContext()) {
+        return TRACE_TRACK_ISR;
+    }
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < g_track_count; i++) {
+        if (g_tracks[i] == task) {
+            return i;
+        }
+    }
+
+    if (g_track_count < TRACE_MAX_TRACKS) {
+        g_tracks[g_track_count] = task;
+        return g_track_count++;
+    }
+
+    // Out of tracks; share the last one rather than dropping the event
+    return TRACE_MAX_TRACKS - 1;
+}
+
+esp_err_t trace_init(void)
+{
+    portENTER_CRITICAL(&g_lock);
+    memset(g_ring, 0, sizeof(g_ring));
+    g_written = 0;
+    g_track_count = 0;
+    g_enabled = true;
+    portEXIT_CRITICAL(&g_lock);
+
+    ESP_LOGI(TAG, "Trace ring initialized (%d events, %d bytes)",
+             TRACE_BUFFER_EVENTS, (int)sizeof(g_ring));
+    return ESP_OK;
+}
+
+void trace_record(trace_phase_t phase, trace_event_id_t event_id, uint16_t arg)
+{
+    if (!g_enabled) {
+        return;
+    }
+
+    uint32_t now = (uint32_t)esp_timer_get_time();
+
+    portENTER_CRITICAL_SAFE(&g_lock);
+    // A dump may have paused tracing since the check above
+    if (!g_enabled) {
+        portEXIT_CRITICAL_SAFE(&g_lock);
+        return;
+    }
+    trace_event_t *event = &g_ring[g_written % TRACE_BUFFER_EVENTS];
+    event->timestamp_us = now;
+    event->event_id = (uint8_t)event_id;
+    event->phase_track = (uint8_t)((phase & 0x03) | (trace_current_track() << 2));
+    event->arg = arg;
+    g_written++;
+    portEXIT_CRITICAL_SAFE(&g_lock);
+}
+
+esp_err_t trace_dump(bool clear)
+{
+    // Pause recording so that no event lands in the ring while it is printed
+    portENTER_CRITICAL_SAFE(&g_lock);
+    bool was_enabled = g_enabled;
+    g_enabled = false;
+    uint32_t written = g_written;
+    portEXIT_CRITICAL_SAFE(&g_lock);
+
+    uint32_t count = written < TRACE_BUFFER_EVENTS ? written : TRACE_BUFFER_EVENTS;
+    uint32_t first = written - count;
+
+    printf("TRACE:BEGIN 1 %lu %lu\n", (unsigned long)count, (unsigned long)first);
+    for (int i = 0; i < TRACE_EVT_MAX; i++) {
+        printf("TRACE:NAME %d %s\n", i, g_event_names[i]);
+    }
+    for (int i = 0; i < g_track_count; i++) {
+        printf("TRACE:TRACK %d %s\n", i, pcTaskGetName(g_tracks[i]));
+    }
+    printf("TRACE:TRACK %d isr\n", TRACE_TRACK_ISR);
+
+    // Events are written little-endian, exactly as they sit in RAM
+    for (uint32_t i = 0; i < count; i += TRACE_EVENTS_PER_LINE) {
+        printf("TRACE:DATA ");
+        for (uint32_t j = i; j < count && j < i + TRACE_EVENTS_PER_LINE; j++) {
+            const uint8_t *bytes = (const uint8_t *)&g_ring[(first + j) % TRACE_BUFFER_EVENTS];
+            for (size_t k = 0; k < sizeof(trace_event_t); k++) {
+                printf("%02x", bytes[k]);
+            }
+        }
+        printf("\n");
+    }
+    printf("TRACE:END\n");
+
+    portENTER_CRITICAL_SAFE(&g_lock);
+    if (clear) {
+        g_written = 0;
+    }
+    g_enabled = was_enabled;
+    portEXIT_CRITICAL_SAFE(&g_lock);
+    return ESP_OK;
+}
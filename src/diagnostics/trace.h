@@ -0,0 +1,113 @@
+/**
+ * @file trace.h
+ * @brief Binary Event Trace for Plant Monitoring System
+ *
+ * This module provides a compact on-device trace facility. Begin, end and
+ * instant events are timestamped and stored in a fixed-size RAM ring at
+ * 8 bytes per event. The ring can be dumped over the console and turned
+ * into Chrome/Perfetto trace JSON with tools/trace_to_chrome.py.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Trace event identifiers
+ *
+ * The names for these identifiers are emitted in the dump header, so the
+ * host converter does not need a copy of this table.
+ */
+typedef enum {
+    TRACE_EVT_MONITOR_CYCLE = 0,  /**< One monitoring task iteration */
+    TRACE_EVT_SENSOR_READ_ALL,    /**< sensor_interface_read_all() */
+    TRACE_EVT_SENSOR_READ,        /**< Single sensor read (arg: sensor index) */
+    TRACE_EVT_AHT10_READ,         /**< aht10_read() (arg: I2C address) */
+    TRACE_EVT_ONEWIRE_RESET,      /**< onewire_reset() (arg: GPIO pin) */
+    TRACE_EVT_DS18B20_CONVERT,    /**< DS18B20 conversion window */
+    TRACE_EVT_GY302_READ,         /**< gy302_read() (arg: I2C address) */
+    TRACE_EVT_HEALTH,             /**< Plant health calculation */
+    TRACE_EVT_DISPLAY_UPDATE,     /**< Display update */
+    TRACE_EVT_TRANSMIT,           /**< Data transmission */
+    TRACE_EVT_I2C_SCAN,           /**< I2C scan or rescan (arg: addresses probed) */
+    TRACE_EVT_IRRIGATION,         /**< Irrigation control step (arg: pump on) */
+    TRACE_EVT_MAX                 /**< Maximum event identifier */
+} trace_event_id_t;
+
+/**
+ * @brief Trace event phases
+ */
+typedef enum {
+    TRACE_PHASE_BEGIN = 0,        /**< Start of a duration event */
+    TRACE_PHASE_END,              /**< End of a duration event */
+    TRACE_PHASE_INSTANT           /**< Instant event */
+} trace_phase_t;
+
+/**
+ * @brief Packed trace event as stored in the ring
+ */
+typedef struct {
+    uint32_t timestamp_us;        /**< Low 32 bits of esp_timer time */
+    uint8_t event_id;             /**< trace_event_id_t */
+    uint8_t phase_track;          /**< Phase in bits 0-1, task track in bits 2-7 */
+    uint16_t arg;                 /**< Event argument */
+} trace_event_t;
+
+/**
+ * @brief Initialize the trace ring
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t trace_init(void);
+
+/**
+ * @brief Record a trace event
+ *
+ * Safe to call from tasks and ISRs. Oldest events are overwritten when
+ * the ring is full.
+ *
+ * @param phase Event phase
+ * @param event_id Event identifier
+ * @param arg Event argument
+ */
+void trace_record(trace_phase_t phase, trace_event_id_t event_id, uint16_t arg);
+
+/**
+ * @brief Dump the trace ring to the console
+ *
+ * Recording is paused while the dump is in progress and then returns to
+ * its previous state. Each line starts with "TRACE:" so the dump can be
+ * extracted from a mixed serial log.
+ *
+ * @param clear Whether to clear the ring after dumping
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t trace_dump(bool clear);
+
+#if TRACE_ENABLED
+#define TRACE_BEGIN(id, arg)   trace_record(TRACE_PHASE_BEGIN, (id), (uint16_t)(arg))
+#define TRACE_END(id, arg)     trace_record(TRACE_PHASE_END, (id), (uint16_t)(arg))
+#define TRACE_INSTANT(id, arg) trace_record(TRACE_PHASE_INSTANT, (id), (uint16_t)(arg))
+#else
+#define TRACE_BEGIN(id, arg)   do { } while (0)
+#define TRACE_END(id, arg)     do { } while (0)
+#define TRACE_INSTANT(id, arg) do { } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_H
@@ -12,6 +12,7 @@
  */
 
 #include "display_interface.h"
+#include "i2c_bus.h"
 #include <string.h>
 #include <esp_log.h>
 #include <stdio.h>
@@ -45,7 +46,16 @@ static esp_err_t console_display_update(const sensor_data_t *sensor_data, const
     printf("│                         │\n");
     printf("│  T: %.1f°C  H: %.1f%%   │\n", sensor_data->temperature, sensor_data->humidity);
     printf("│  Soil: %d  Light: %d │\n", sensor_data->soil_moisture, sensor_data->light_level);
+    if (sensor_data->dli > 0.0f) {
+        printf("│  DLI: %.2f mol/m²       │\n", sensor_data->dli);
+    }
+    if (sensor_data->has_vpd) {
+        printf("│  VPD: %.2f kPa  Dew: %.1f°C │\n", sensor_data->vpd, sensor_data->dew_point);
+    }
     printf("│  Health: %.1f%%         │\n", health->health_score);
+    if (health->hours_to_dry >= 0.0f) {
+        printf("│  Dry in: %.0f h          │\n", health->hours_to_dry);
+    }
     printf("│  Uptime: %02d:%02d:%02d       │\n", 
            (int)(sensor_data->uptime_seconds / 3600),
            (int)((sensor_data->uptime_seconds % 3600) / 60),
@@ -60,7 +70,7 @@ static esp_err_t console_display_update(const sensor_data_t *sensor_data, const
 
 esp_err_t display_interface_init(const display_interface_config_t *config)
 {
-    if (!config) {
+    if (!config || (config->display_count > 0 && !config->displays)) {
         return ESP_ERR_INVALID_ARG;
     }
     
@@ -74,6 +84,16 @@ esp_err_t display_interface_init(const display_interface_config_t *config)
         if (g_config.displays[i].enabled) {
             ESP_LOGI(TAG, "Initializing display: %s", g_config.displays[i].name);
             
+            // I2C displays share the sensor bus; register their clock speed with it
+            if (g_config.displays[i].i2c_address != 0 && g_config.displays[i].i2c_freq > 0) {
+                esp_err_t ret = i2c_bus_set_device_speed(g_config.displays[i].i2c_address,
+                                                         g_config.displays[i].i2c_freq);
+                if (ret != ESP_OK) {
+                    ESP_LOGD(TAG, "No speed negotiated for %s: %s",
+                             g_config.displays[i].name, esp_err_to_name(ret));
+                }
+            }
+            
             switch (g_config.displays[i].type) {
                 case DISPLAY_TYPE_CONSOLE:
                     ESP_LOGI(TAG, "Console display initialized");
@@ -45,6 +45,7 @@ typedef struct {
     uint8_t i2c_address;     /**< I2C address (for I2C displays) */
     uint8_t sda_pin;         /**< SDA pin (for I2C displays) */
     uint8_t scl_pin;         /**< SCL pin (for I2C displays) */
+    uint32_t i2c_freq;       /**< Fastest I2C clock in Hz (0 = bus frequency) */
     uint8_t spi_cs_pin;      /**< SPI CS pin (for SPI displays) */
     uint8_t spi_dc_pin;      /**< SPI DC pin (for SPI displays) */
     uint8_t spi_rst_pin;     /**< SPI RST pin (for SPI displays) */
@@ -52,7 +53,7 @@ typedef struct {
     uint8_t spi_sck_pin;     /**< SPI SCK pin (for SPI displays) */
     uint8_t spi_busy_pin;    /**< SPI BUSY pin (for E-paper) */
     bool enabled;             /**< Whether display is enabled */
-    char name[32];            /**< Human-readable display name */
+    const char *name;         /**< Human-readable display name */
 } display_config_t;
 
 /**
@@ -63,6 +64,7 @@ typedef struct {
     const char *health_text; /**< Health status text */
     const char *emoji;       /**< Health emoji */
     const char *recommendation; /**< Care recommendation */
+    float hours_to_dry;      /**< Predicted hours until the soil is dry (negative = no prediction) */
 } plant_health_t;
 
 /**
@@ -75,14 +77,19 @@ typedef struct {
     uint16_t light_level;   /**< Light level value */
     float lux;              /**< Light intensity in lux */
     uint32_t uptime_seconds; /**< System uptime in seconds */
+    float dli;              /**< Daily light integral so far today (mol/m²/d) */
+    bool has_vpd;           /**< vpd, leaf_vpd and dew_point are set */
+    float vpd;              /**< Vapour pressure deficit of the air (kPa) */
+    float leaf_vpd;         /**< Leaf vapour pressure deficit (kPa) */
+    float dew_point;        /**< Dew point in Celsius */
 } sensor_data_t;
 
 /**
  * @brief Display interface configuration
  */
 typedef struct {
-    display_config_t displays[4];  /**< Array of display configurations */
-    uint8_t display_count;         /**< Number of configured displays */
+    const display_config_t *displays;  /**< Array of display configurations (must stay valid) */
+    uint8_t display_count;         /**< Number of entries in displays */
     bool enable_backlight;         /**< Enable display backlight */
     uint8_t brightness;            /**< Display brightness (0-255) */
     bool enable_auto_off;          /**< Enable auto power off */
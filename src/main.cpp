@@ -13,23 +13,95 @@
  */
 
 #include <stdio.h>
+#include <time.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <esp_log.h>
 #include <esp_timer.h>
 #include "sensor_interface.h"
+#include "sensor_registry.h"
+#include "sensor_topology.h"
+#include "reading_history.h"
+#include "outlier_filter.h"
+#include "sensor_fusion.h"
+#include "sensor_diagnostics.h"
+#include "health_engine.h"
+#include "rolling_stats.h"
+#include "dry_predictor.h"
+#include "light_integral.h"
+#include "vpd.h"
+#include "anomaly_detector.h"
+#include "alert_engine.h"
+#include "irrigation.h"
 #include "display_interface.h"
+#include "trace.h"
+#include "dlog.h"
+#include "power_manager.h"
+#include "duty_cycle.h"
+#include "boot_record.h"
+#include "uplink.h"
 
 static const char *TAG = "PLANT_MONITOR_MODULAR";
 
 // Global variables for sensor data and health
-static sensor_reading_t sensor_readings[8];
-static plant_health_t plant_health;
+static sensor_reading_t sensor_readings[SENSOR_INTERFACE_MAX_SENSORS];
+static plant_health_t plant_health = {
+    .health_score = 0.0f,
+    .health_text = NULL,
+    .emoji = NULL,
+    .recommendation = NULL,
+    .hours_to_dry = DRY_PREDICTOR_NONE
+};
+
+#if SENSOR_TOPOLOGY_STATIC
+// The node's sensors as a compile-time topology, in registry order
+static constexpr char k_aht10_1_name[] = "AHT10-1";
+static constexpr char k_aht10_2_name[] = "AHT10-2";
+static constexpr char k_ds18b20_name[] = "DS18B20-Waterproof";
+static constexpr char k_gy302_name[] = "GY-302-Light";
+static constexpr char k_soil_name[] = "Soil-Moisture";
+static constexpr char k_light_name[] = "Light-Sensor";
+
+using node_topology = sensor_topology::topology<
+    sensor_topology::aht10<0x38, k_aht10_1_name>,
+    sensor_topology::aht10<0x39, k_aht10_2_name>,
+    sensor_topology::ds18b20<4, k_ds18b20_name>,      // One-Wire pin
+    sensor_topology::gy302<0x23, k_gy302_name>,
+    sensor_topology::soil_moisture<k_soil_name>,
+    sensor_topology::light<k_light_name>>;
+#endif
+
+// Hash of the sensor configuration the boot record is tied to
+static uint32_t g_config_hash = 0;
+
+// Fusion sources per sensor (-1 = none) and time of the last predict step
+static int8_t g_temperature_source[SENSOR_INTERFACE_MAX_SENSORS];
+static int8_t g_humidity_source[SENSOR_INTERFACE_MAX_SENSORS];
+static int8_t g_soil_source[SENSOR_INTERFACE_MAX_SENSORS];
+static int64_t g_last_fusion_us = 0;
+
+// Health scoring state of the monitored plant
+static health_context_t g_health;
+
+// Rolling window statistics per reading history channel
+static rolling_stats_t g_stats[READING_HISTORY_CHANNELS];
+
+// Anomaly detector per reading history channel
+static anomaly_detector_t g_anomaly[READING_HISTORY_CHANNELS];
+
+// Threshold alert state per rule
+static alert_engine_t g_alerts;
+
+// Soil drying trend of the monitored pot
+static dry_predictor_t g_dry;
+
+// Daily light integral at the GY-302 location
+static light_integral_t g_light;
 
 /**
  * @brief Calculate plant health based on sensor readings
  * 
- * @param readings Array of sensor readings
+ * @param readings Array of sensor readings, indexed like the sensor registry
  * @param reading_count Number of readings
  * @param health Pointer to store health status
  * @return ESP_OK on success, error code on failure
@@ -40,34 +112,75 @@ esp_err_t calculate_plant_health(const sensor_reading_t *readings, int reading_c
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Calculate average temperature and humidity
-    float avg_temp = 0.0f;
-    float avg_humidity = 0.0f;
-    float avg_lux = 0.0f;
-    int valid_readings = 0;
-    int temp_readings = 0;
-    int humidity_readings = 0;
-    int lux_readings = 0;
-    
-    for (int i = 0; i < reading_count; i++) {
-        if (readings[i].valid) {
-            if (readings[i].temperature > -50.0f && readings[i].temperature < 150.0f) {
-                avg_temp += readings[i].temperature;
-                temp_readings++;
-            }
-            if (readings[i].humidity >= 0.0f && readings[i].humidity <= 100.0f) {
-                avg_humidity += readings[i].humidity;
-                humidity_readings++;
-            }
-            if (readings[i].lux >= 0.0f) {
-                avg_lux += readings[i].lux;
-                lux_readings++;
-            }
-            valid_readings++;
+    // Average every quantity over the sensors that measure it. DS18B20
+    // probes measure soil temperature, which the profiles do not score.
+    health_inputs_t inputs = {};
+#if SENSOR_TOPOLOGY_STATIC
+    node_topology::score(readings, &inputs);
+#else
+    const sensor_registry_t *registry = sensor_registry_get();
+    int counts[HISTORY_QTY_COUNT] = {0};
+    
+    for (int i = 0; i < reading_count && i < registry->count; i++) {
+        const sensor_reading_t *reading = &readings[i];
+        if (!reading->valid || (reading->quality_flags & SENSOR_QUALITY_SUSPECT)) {
+            continue;
+        }
+        
+        switch (registry->type[i]) {
+            case SENSOR_TYPE_AHT10:
+            case SENSOR_TYPE_DHT11:
+            case SENSOR_TYPE_DHT22:
+                inputs.value[HISTORY_QTY_TEMPERATURE] += reading_history_encode(HISTORY_QTY_TEMPERATURE, reading->temperature);
+                inputs.value[HISTORY_QTY_HUMIDITY] += reading_history_encode(HISTORY_QTY_HUMIDITY, reading->humidity);
+                counts[HISTORY_QTY_TEMPERATURE]++;
+                counts[HISTORY_QTY_HUMIDITY]++;
+                break;
+            case SENSOR_TYPE_GY302:
+                inputs.value[HISTORY_QTY_LUX] += reading_history_encode(HISTORY_QTY_LUX, reading->lux);
+                counts[HISTORY_QTY_LUX]++;
+                break;
+            case SENSOR_TYPE_SOIL_MOISTURE:
+                inputs.value[HISTORY_QTY_SOIL_MOISTURE] += reading->soil_moisture;
+                counts[HISTORY_QTY_SOIL_MOISTURE]++;
+                break;
+            case SENSOR_TYPE_LIGHT:
+                inputs.value[HISTORY_QTY_LIGHT_LEVEL] += reading->light_level;
+                counts[HISTORY_QTY_LIGHT_LEVEL]++;
+                break;
+            default:
+                break;
+        }
+    }
+    
+    for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+        if (counts[q] > 0) {
+            inputs.value[q] /= counts[q];
+            inputs.present |= (uint8_t)(1 << q);
         }
     }
+#endif
     
-    if (valid_readings == 0) {
+    // Prefer the fused air estimates: they weight sensors by their noise
+    // models and leave failed sensors out
+    fusion_estimate_t estimate;
+    if (sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate) && estimate.sources > 0) {
+        inputs.value[HISTORY_QTY_TEMPERATURE] = reading_history_encode(HISTORY_QTY_TEMPERATURE, estimate.value);
+        inputs.present |= (uint8_t)(1 << HISTORY_QTY_TEMPERATURE);
+    }
+    if (sensor_fusion_get(FUSION_AIR_HUMIDITY, &estimate) && estimate.sources > 0) {
+        inputs.value[HISTORY_QTY_HUMIDITY] = reading_history_encode(HISTORY_QTY_HUMIDITY, estimate.value);
+        inputs.present |= (uint8_t)(1 << HISTORY_QTY_HUMIDITY);
+    }
+    
+    // VPD follows from whichever air temperature and humidity were chosen
+    const uint8_t air = (uint8_t)((1 << HISTORY_QTY_TEMPERATURE) | (1 << HISTORY_QTY_HUMIDITY));
+    if ((inputs.present & air) == air) {
+        inputs.value[HISTORY_QTY_VPD] = vpd_air(inputs.value[HISTORY_QTY_TEMPERATURE], inputs.value[HISTORY_QTY_HUMIDITY]);
+        inputs.present |= (uint8_t)(1 << HISTORY_QTY_VPD);
+    }
+    
+    if (inputs.present == 0) {
         health->health_score = 0.0f;
         health->health_text = "Unknown";
         health->emoji = "❓";
@@ -75,81 +188,622 @@ esp_err_t calculate_plant_health(const sensor_reading_t *readings, int reading_c
         return ESP_OK;
     }
     
-    if (temp_readings > 0) avg_temp /= temp_readings;
-    if (humidity_readings > 0) avg_humidity /= humidity_readings;
-    if (lux_readings > 0) avg_lux /= lux_readings;
-    
-    // Calculate health score based on optimal ranges
-    float temp_score = 100.0f;
-    float humidity_score = 100.0f;
-    float light_score = 100.0f;
-    
-    // Temperature scoring (optimal: 18-28°C, acceptable: 10-35°C)
-    if (avg_temp < 10.0f || avg_temp > 35.0f) {
-        temp_score = 0.0f;
-    } else if (avg_temp < 18.0f || avg_temp > 28.0f) {
-        temp_score = 50.0f;
-    }
-    
-    // Humidity scoring (optimal: 40-70%, acceptable: 30-80%)
-    if (avg_humidity < 30.0f || avg_humidity > 80.0f) {
-        humidity_score = 0.0f;
-    } else if (avg_humidity < 40.0f || avg_humidity > 70.0f) {
-        humidity_score = 50.0f;
-    }
-    
-    // Light scoring (optimal: 1000-10000 lux, acceptable: 100-50000 lux)
-    if (avg_lux < 100.0f || avg_lux > 50000.0f) {
-        light_score = 0.0f;
-    } else if (avg_lux < 1000.0f || avg_lux > 10000.0f) {
-        light_score = 50.0f;
-    }
-    
-    // Calculate overall health score
-    int score_count = 0;
-    float total_score = 0.0f;
-    
-    if (temp_readings > 0) {
-        total_score += temp_score;
-        score_count++;
-    }
-    if (humidity_readings > 0) {
-        total_score += humidity_score;
-        score_count++;
-    }
-    if (lux_readings > 0) {
-        total_score += light_score;
-        score_count++;
-    }
-    
-    health->health_score = score_count > 0 ? total_score / score_count : 0.0f;
-    
-    // Set health status and emoji
-    if (health->health_score >= 90.0f) {
-        health->health_text = "Excellent";
-        health->emoji = "😊";
-        health->recommendation = "Perfect conditions! Keep it up.";
-    } else if (health->health_score >= 70.0f) {
-        health->health_text = "Good";
-        health->emoji = "🙂";
-        health->recommendation = "Good conditions, monitor regularly.";
-    } else if (health->health_score >= 50.0f) {
-        health->health_text = "Fair";
-        health->emoji = "😐";
-        health->recommendation = "Acceptable conditions, consider adjustments.";
-    } else if (health->health_score >= 30.0f) {
-        health->health_text = "Poor";
-        health->emoji = "😟";
-        health->recommendation = "Needs attention, check environment.";
-    } else {
-        health->health_text = "Critical";
-        health->emoji = "😱";
-        health->recommendation = "Immediate attention required!";
-    }
+    // Score against the plant's species profile
+    health_result_t result;
+    health_engine_evaluate(&g_health, &inputs, &result);
+    const health_level_info_t *level = health_engine_level_info(result.level);
+    
+    health->health_score = result.score / 100.0f;
+    health->health_text = level->text;
+    health->emoji = level->emoji;
+    health->recommendation = level->recommendation;
     
     return ESP_OK;
 }
 
+/**
+ * @brief Read all sensors into sensor_readings
+ * 
+ * @return Number of valid readings, negative on error
+ */
+static int read_sensors(void)
+{
+#if SENSOR_TOPOLOGY_STATIC
+    return node_topology::read_all(sensor_readings);
+#else
+    return sensor_interface_read_all(sensor_readings, SENSOR_INTERFACE_MAX_SENSORS);
+#endif
+}
+
+/**
+ * @brief Persist the sensor bring-up state for the next boot
+ * 
+ * Saves the current discovery map and sensor ready state. When a sensor
+ * contradicted the map, the affected addresses are re-probed first; if
+ * that fails the boot record is invalidated so that the next boot runs
+ * full discovery again.
+ */
+static void update_boot_record(void)
+{
+    boot_record_t record = {
+        .config_hash = g_config_hash
+    };
+    
+    if (sensor_interface_get_boot_state(&record.sensors) != ESP_OK) {
+        return;
+    }
+    
+    if (record.sensors.mismatch_mask != 0) {
+        ESP_LOGW(TAG, "Sensors disagree with boot record (mask 0x%08lx)",
+                 (unsigned long)record.sensors.mismatch_mask);
+        if (sensor_interface_rescan_i2c() < 0 ||
+            sensor_interface_get_boot_state(&record.sensors) != ESP_OK) {
+            boot_record_invalidate();
+            return;
+        }
+    }
+    
+    boot_record_save(&record);
+}
+
+/**
+ * @brief Check a raw value against the recent behaviour of its channel
+ * 
+ * There is no uplink in continuous mode, so anomalies are logged; in
+ * duty-cycle mode they are sent at once (see duty_cycle_send_urgent()).
+ * 
+ * @param sensor Sensor index
+ * @param channel Reading history channel
+ * @param quantity Measured quantity
+ * @param raw Fixed-point value as read
+ */
+static void detect_anomaly(int sensor, int channel, history_quantity_t quantity, int16_t raw)
+{
+    anomaly_detector_t *detector = &g_anomaly[channel];
+    if (detector->samples == 0) {
+        anomaly_detector_init(detector, quantity);
+    }
+    
+    anomaly_event_t event;
+    if (anomaly_detector_update(detector, raw, &event)) {
+        DLOG(DLOG_MON_ANOMALY, sensor_registry_get()->name[sensor], reading_history_quantity_name(quantity),
+             reading_history_decode(quantity, event.value), reading_history_decode(quantity, event.mean),
+             event.z / 100.0f);
+    }
+}
+
+/**
+ * @brief Filter one value of a reading and append it to the reading history
+ * 
+ * @param sensor Sensor index
+ * @param quantity Measured quantity
+ * @param value Value as read
+ * @param flag Quality flag to set when the value is rejected as an outlier
+ * @param now_us Time of the reading in microseconds since boot
+ * @param quality_flags Quality flags of the reading
+ * @return Value to use for analysis
+ */
+static float filter_and_record(int sensor, history_quantity_t quantity, float value,
+                               uint8_t flag, int64_t now_us, uint8_t *quality_flags)
+{
+    int channel = reading_history_attach((uint8_t)sensor, quantity);
+    if (channel < 0) {
+        ESP_LOGD(TAG, "No history channel left for sensor %d", sensor);
+        return value;
+    }
+    
+    int16_t raw = reading_history_encode(quantity, value);
+    detect_anomaly(sensor, channel, quantity, raw);
+    uint8_t diag = sensor_diagnostics_check(channel, raw, (uint32_t)(now_us / 1000));
+    if (diag & SENSOR_DIAG_STUCK) {
+        *quality_flags |= SENSOR_QUALITY_STUCK;
+    }
+    if (diag & SENSOR_DIAG_RATE) {
+        *quality_flags |= SENSOR_QUALITY_RATE;
+    }
+    
+    outlier_filter_result_t result = outlier_filter_apply(channel, raw);
+    reading_history_push_raw(channel, result.value);
+    rolling_stats_update(&g_stats[channel], result.value, (uint32_t)(now_us / 1000000));
+    
+    if (result.rejected) {
+        *quality_flags |= flag;
+    }
+    return (result.value == raw) ? value : reading_history_decode(quantity, result.value);
+}
+
+/**
+ * @brief Pass this cycle's valid readings through the outlier filter
+ * 
+ * Only the quantities a sensor type measures are filtered and recorded
+ * in the reading history. Rejected values are replaced by the window
+ * median in sensor_readings and the sensor registry, and flagged. The
+ * raw values also go through the stuck-value and rate-limit detectors,
+ * and the filtered ones into the rolling statistics.
+ */
+static void filter_readings(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    const sensor_registry_t *registry = sensor_registry_get();
+    for (int i = 0; i < registry->count; i++) {
+        if (!((registry->valid_mask >> i) & 1)) {
+            continue;
+        }
+        
+        sensor_reading_t *reading = &sensor_readings[i];
+        uint8_t *flags = &reading->quality_flags;
+        switch (registry->type[i]) {
+            case SENSOR_TYPE_AHT10:
+            case SENSOR_TYPE_DHT11:
+            case SENSOR_TYPE_DHT22:
+                reading->temperature = filter_and_record(i, HISTORY_QTY_TEMPERATURE, reading->temperature,
+                                                         SENSOR_QUALITY_TEMPERATURE_OUTLIER, now_us, flags);
+                reading->humidity = filter_and_record(i, HISTORY_QTY_HUMIDITY, reading->humidity,
+                                                      SENSOR_QUALITY_HUMIDITY_OUTLIER, now_us, flags);
+                break;
+            case SENSOR_TYPE_DS18B20:
+                reading->temperature = filter_and_record(i, HISTORY_QTY_TEMPERATURE, reading->temperature,
+                                                         SENSOR_QUALITY_TEMPERATURE_OUTLIER, now_us, flags);
+                break;
+            case SENSOR_TYPE_GY302:
+                reading->lux = filter_and_record(i, HISTORY_QTY_LUX, reading->lux,
+                                                 SENSOR_QUALITY_LUX_OUTLIER, now_us, flags);
+                break;
+            case SENSOR_TYPE_SOIL_MOISTURE:
+                reading->soil_moisture = (uint16_t)filter_and_record(i, HISTORY_QTY_SOIL_MOISTURE,
+                                                                     reading->soil_moisture,
+                                                                     SENSOR_QUALITY_SOIL_OUTLIER, now_us, flags);
+                break;
+            case SENSOR_TYPE_LIGHT:
+                reading->light_level = (uint16_t)filter_and_record(i, HISTORY_QTY_LIGHT_LEVEL,
+                                                                   reading->light_level,
+                                                                   SENSOR_QUALITY_LIGHT_OUTLIER, now_us, flags);
+                break;
+            default:
+                break;
+        }
+        
+        if (*flags & SENSOR_QUALITY_OUTLIER_MASK) {
+            ESP_LOGW(TAG, "Sensor %s: outlier replaced (flags 0x%02x)", registry->name[i], *flags);
+        }
+        if (*flags != 0) {
+            sensor_registry_set_reading(i, reading);
+        }
+    }
+}
+
+/**
+ * @brief Attach a history channel and set its diagnostic limits
+ * 
+ * @param sensor Sensor index
+ * @param quantity Measured quantity
+ * @param stuck_samples Identical samples that mark the sensor stuck
+ * @param max_rate Largest change per minute, in the quantity's unit (0 = off)
+ * @param max_divergence Largest mean offset from sibling sensors (0 = off)
+ */
+static void configure_diagnostics(int sensor, history_quantity_t quantity, uint16_t stuck_samples,
+                                  float max_rate, float max_divergence)
+{
+    int channel = reading_history_attach((uint8_t)sensor, quantity);
+    if (channel < 0) {
+        ESP_LOGW(TAG, "No history channel left for sensor %d", sensor);
+        return;
+    }
+    
+    sensor_diag_limits_t limits = {
+        .stuck_samples = stuck_samples,
+        .max_rate = reading_history_encode(quantity, max_rate),
+        .max_divergence = reading_history_encode(quantity, max_divergence),
+        .zero_may_stick = (quantity == HISTORY_QTY_LUX || quantity == HISTORY_QTY_LIGHT_LEVEL),
+    };
+    sensor_diagnostics_configure(channel, &limits);
+}
+
+/**
+ * @brief Set up self-diagnostics for the configured sensors
+ * 
+ * Soil moisture and light jump legitimately (watering, lamps switching),
+ * so only temperature and humidity are rate-limited. Sibling comparison
+ * covers the air sensors, which share one location.
+ */
+static void register_diagnostics(void)
+{
+    sensor_diagnostics_init();
+    
+    const sensor_registry_t *registry = sensor_registry_get();
+    for (int i = 0; i < registry->count; i++) {
+        switch (registry->type[i]) {
+            case SENSOR_TYPE_AHT10:
+            case SENSOR_TYPE_DHT11:
+            case SENSOR_TYPE_DHT22:
+                configure_diagnostics(i, HISTORY_QTY_TEMPERATURE, SENSOR_DIAG_STUCK_SAMPLES,
+                                      SENSOR_DIAG_AIR_TEMP_RATE, SENSOR_DIAG_TEMP_DIVERGENCE);
+                configure_diagnostics(i, HISTORY_QTY_HUMIDITY, SENSOR_DIAG_STUCK_SAMPLES,
+                                      SENSOR_DIAG_HUMIDITY_RATE, SENSOR_DIAG_HUMIDITY_DIVERGENCE);
+                break;
+            case SENSOR_TYPE_DS18B20:
+                configure_diagnostics(i, HISTORY_QTY_TEMPERATURE, SENSOR_DIAG_COARSE_STUCK_SAMPLES,
+                                      SENSOR_DIAG_SOIL_TEMP_RATE, 0.0f);
+                break;
+            case SENSOR_TYPE_GY302:
+                configure_diagnostics(i, HISTORY_QTY_LUX, SENSOR_DIAG_COARSE_STUCK_SAMPLES, 0.0f, 0.0f);
+                break;
+            case SENSOR_TYPE_SOIL_MOISTURE:
+                configure_diagnostics(i, HISTORY_QTY_SOIL_MOISTURE, SENSOR_DIAG_STUCK_SAMPLES, 0.0f, 0.0f);
+                break;
+            case SENSOR_TYPE_LIGHT:
+                configure_diagnostics(i, HISTORY_QTY_LIGHT_LEVEL, SENSOR_DIAG_COARSE_STUCK_SAMPLES, 0.0f, 0.0f);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Log the sensors that failed self-diagnostics this cycle
+ * 
+ * Their flagged readings are also stored in the sensor registry.
+ */
+static void report_diagnostics(void)
+{
+    const sensor_registry_t *registry = sensor_registry_get();
+    for (int i = 0; i < registry->count; i++) {
+        uint8_t flags = sensor_readings[i].quality_flags;
+        if (!(flags & (SENSOR_QUALITY_SUSPECT | SENSOR_QUALITY_DIVERGENT))) {
+            continue;
+        }
+        DLOG(DLOG_MON_SENSOR_SUSPECT, registry->name[i],
+             (flags & SENSOR_QUALITY_STUCK) ? " stuck" : "",
+             (flags & SENSOR_QUALITY_RATE) ? " rate" : "",
+             (flags & SENSOR_QUALITY_DIVERGENT) ? " divergent" : "");
+        sensor_registry_set_reading(i, &sensor_readings[i]);
+    }
+}
+
+/**
+ * @brief Compare the air sensors with each other and report failed diagnostics
+ * 
+ * Uses the filtered samples just recorded in the reading history. A
+ * sensor that drifted away from its siblings is flagged divergent; it
+ * stays in the fused estimate, where its learned bias down-weights it.
+ * With only two air sensors, as on the default node, both are flagged
+ * when they drift apart, since neither can be singled out.
+ */
+static void diagnose_readings(void)
+{
+    const sensor_registry_t *registry = sensor_registry_get();
+    
+    for (int q = 0; q < 2; q++) {
+        history_quantity_t quantity = (q == 0) ? HISTORY_QTY_TEMPERATURE : HISTORY_QTY_HUMIDITY;
+        int sensors[READING_HISTORY_CHANNELS];
+        int channels[READING_HISTORY_CHANNELS];
+        int16_t samples[READING_HISTORY_CHANNELS];
+        uint8_t flags[READING_HISTORY_CHANNELS];
+        int count = 0;
+        
+        for (int i = 0; i < registry->count && count < READING_HISTORY_CHANNELS; i++) {
+            bool air = registry->type[i] == SENSOR_TYPE_AHT10 || registry->type[i] == SENSOR_TYPE_DHT11 ||
+                       registry->type[i] == SENSOR_TYPE_DHT22;
+            int channel = reading_history_find((uint8_t)i, quantity);
+            if (!air || channel < 0 || !((registry->valid_mask >> i) & 1)) {
+                continue;
+            }
+            sensors[count] = i;
+            channels[count] = channel;
+            samples[count] = reading_history_raw(channel, 0);
+            flags[count] = 0;
+            count++;
+        }
+        
+        sensor_diagnostics_compare(channels, samples, count, flags);
+        for (int k = 0; k < count; k++) {
+            if (flags[k] & SENSOR_DIAG_DIVERGENT) {
+                sensor_readings[sensors[k]].quality_flags |= SENSOR_QUALITY_DIVERGENT;
+            }
+        }
+    }
+    
+    report_diagnostics();
+}
+
+/**
+ * @brief Register the fusion sources of the configured sensors
+ * 
+ * AHT10s feed air temperature and humidity; DS18B20 probes sit in the
+ * soil and feed soil temperature, or leaf temperature when VPD_LEAF_PROBE
+ * says they are clipped to a leaf. Soil moisture probes feed soil
+ * moisture, the input of the irrigation control.
+ */
+static void register_fusion_sources(void)
+{
+    sensor_fusion_init();
+    g_last_fusion_us = esp_timer_get_time();
+    
+    const sensor_registry_t *registry = sensor_registry_get();
+    for (int i = 0; i < SENSOR_INTERFACE_MAX_SENSORS; i++) {
+        g_temperature_source[i] = -1;
+        g_humidity_source[i] = -1;
+        g_soil_source[i] = -1;
+        if (i >= registry->count) {
+            continue;
+        }
+        switch (registry->type[i]) {
+            case SENSOR_TYPE_AHT10:
+                g_temperature_source[i] = sensor_fusion_add_source(FUSION_AIR_TEMPERATURE, FUSION_AHT10_TEMP_SIGMA);
+                g_humidity_source[i] = sensor_fusion_add_source(FUSION_AIR_HUMIDITY, FUSION_AHT10_HUMIDITY_SIGMA);
+                break;
+            case SENSOR_TYPE_DS18B20:
+                g_temperature_source[i] = sensor_fusion_add_source(
+                    VPD_LEAF_PROBE ? FUSION_LEAF_TEMPERATURE : FUSION_SOIL_TEMPERATURE, FUSION_DS18B20_TEMP_SIGMA);
+                break;
+            case SENSOR_TYPE_SOIL_MOISTURE:
+                g_soil_source[i] = sensor_fusion_add_source(FUSION_SOIL_MOISTURE, FUSION_SOIL_MOISTURE_SIGMA);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Feed this cycle's readings to the fusion filters
+ * 
+ * Invalid readings, values rejected by the outlier filter and sensors
+ * that look stuck or moved impossibly fast count as misses, which
+ * down-weights the sensor.
+ */
+static void fuse_readings(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    sensor_fusion_predict((now_us - g_last_fusion_us) / 1e6f);
+    g_last_fusion_us = now_us;
+    
+    const sensor_registry_t *registry = sensor_registry_get();
+    for (int i = 0; i < registry->count; i++) {
+        const sensor_reading_t *reading = &sensor_readings[i];
+        bool valid = (registry->valid_mask >> i) & 1;
+        
+        if (g_temperature_source[i] >= 0) {
+            if (valid && !(reading->quality_flags & (SENSOR_QUALITY_TEMPERATURE_OUTLIER | SENSOR_QUALITY_SUSPECT))) {
+                sensor_fusion_update(g_temperature_source[i], reading->temperature);
+            } else {
+                sensor_fusion_miss(g_temperature_source[i]);
+            }
+        }
+        if (g_humidity_source[i] >= 0) {
+            if (valid && !(reading->quality_flags & (SENSOR_QUALITY_HUMIDITY_OUTLIER | SENSOR_QUALITY_SUSPECT))) {
+                sensor_fusion_update(g_humidity_source[i], reading->humidity);
+            } else {
+                sensor_fusion_miss(g_humidity_source[i]);
+            }
+        }
+        if (g_soil_source[i] >= 0) {
+            if (valid && !(reading->quality_flags & (SENSOR_QUALITY_SOIL_OUTLIER | SENSOR_QUALITY_SUSPECT))) {
+                sensor_fusion_update(g_soil_source[i], reading->soil_moisture);
+            } else {
+                sensor_fusion_miss(g_soil_source[i]);
+            }
+        }
+    }
+    
+    // Only a fresh estimate is handed over, so that the irrigation task
+    // stops the pump when every soil probe fails
+    fusion_estimate_t soil;
+    if (IRRIGATION_ENABLED && sensor_fusion_get(FUSION_SOIL_MOISTURE, &soil) && soil.sources > 0) {
+        irrigation_feed_moisture(soil.value);
+    }
+    
+    fusion_estimate_t air;
+    if (sensor_fusion_get(FUSION_AIR_TEMPERATURE, &air)) {
+        ESP_LOGD(TAG, "Fused air temperature %.2f ± %.2f °C (%d sensors)", air.value, air.sigma, air.sources);
+    }
+}
+
+/**
+ * @brief Log the rolling window statistics of every history channel
+ */
+static void log_statistics(void)
+{
+    uint32_t now_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    const sensor_registry_t *registry = sensor_registry_get();
+    
+    for (int i = 0; i < registry->count; i++) {
+        for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+            history_quantity_t quantity = (history_quantity_t)q;
+            int channel = reading_history_find((uint8_t)i, quantity);
+            if (channel < 0) {
+                continue;
+            }
+            
+            float scale = reading_history_scale(quantity);
+            for (int w = 0; w < ROLLING_STATS_WINDOWS; w++) {
+                rolling_summary_t summary;
+                if (!rolling_stats_summary(&g_stats[channel], w, now_s, &summary)) {
+                    continue;
+                }
+                DLOG(DLOG_MON_STATISTICS, registry->name[i], reading_history_quantity_name(quantity),
+                     (unsigned)rolling_stats_window_seconds(w), (unsigned)summary.count,
+                     summary.mean / scale, summary.stddev / scale, summary.min / scale, summary.max / scale);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Update the soil drying trend and predict when the pot is dry
+ * 
+ * Uses the mean of the soil sensors that passed this cycle's checks.
+ * 
+ * @param health Health status to store the prediction in
+ */
+static void predict_drying(plant_health_t *health)
+{
+    const sensor_registry_t *registry = sensor_registry_get();
+    int32_t sum = 0;
+    int count = 0;
+    
+    for (int i = 0; i < registry->count; i++) {
+        const sensor_reading_t *reading = &sensor_readings[i];
+        if (registry->type[i] != SENSOR_TYPE_SOIL_MOISTURE || !((registry->valid_mask >> i) & 1) ||
+            (reading->quality_flags & SENSOR_QUALITY_SUSPECT)) {
+            continue;
+        }
+        sum += reading->soil_moisture;
+        count++;
+    }
+    
+    uint32_t now_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    if (count > 0) {
+        dry_predictor_update(&g_dry, (int16_t)(sum / count), now_s);
+    }
+    health->hours_to_dry = dry_predictor_hours(&g_dry, DRY_PREDICTOR_THRESHOLD, now_s);
+    
+    float slope;
+    if (health->hours_to_dry >= 0.0f && dry_predictor_slope(&g_dry, &slope)) {
+        DLOG(DLOG_MON_DRY_FORECAST, slope, health->hours_to_dry);
+    }
+}
+
+/**
+ * @brief Integrate this cycle's illuminance into the daily light integral
+ * 
+ * Uses the mean of the GY-302 readings that passed this cycle's checks,
+ * timed by the system clock. Once the clock has been set, the DLI is
+ * today's, from local midnight; until then midnight is unknown and the
+ * DLI covers a rolling 24 h window instead.
+ * 
+ * @param display_data Display data to store today's DLI in
+ */
+static void integrate_light(sensor_data_t *display_data)
+{
+    const sensor_registry_t *registry = sensor_registry_get();
+    float sum = 0.0f;
+    int count = 0;
+    
+    for (int i = 0; i < registry->count; i++) {
+        const sensor_reading_t *reading = &sensor_readings[i];
+        if (registry->type[i] != SENSOR_TYPE_GY302 || !((registry->valid_mask >> i) & 1) ||
+            (reading->quality_flags & SENSOR_QUALITY_SUSPECT)) {
+            continue;
+        }
+        sum += reading->lux;
+        count++;
+    }
+    if (count == 0) {
+        return;
+    }
+    
+    float lux = sum / count;
+    light_integral_update(&g_light, lux, (uint32_t)time(NULL));
+    
+    light_summary_t today;
+    bool has_today = uplink_clock_is_valid() ? light_integral_today(&g_light, &today)
+                                             : light_integral_rolling(&g_light, &today);
+    if (has_today) {
+        display_data->dli = today.dli;
+        DLOG(DLOG_MON_LIGHT_INTEGRAL, light_integral_ppfd(&g_light, lux), today.dli,
+             today.photoperiod_h, today.covered_h);
+    }
+}
+
+/**
+ * @brief Derive VPD, leaf VPD and dew point from the fused air estimates
+ * 
+ * The leaf temperature is the fused leaf probe temperature when
+ * VPD_LEAF_PROBE is set, otherwise VPD_LEAF_OFFSET below the air.
+ * 
+ * @param display_data Display data to store the results in
+ */
+static void compute_vpd(sensor_data_t *display_data)
+{
+    fusion_estimate_t air;
+    fusion_estimate_t humidity;
+    if (!sensor_fusion_get(FUSION_AIR_TEMPERATURE, &air) || air.sources == 0 ||
+        !sensor_fusion_get(FUSION_AIR_HUMIDITY, &humidity) || humidity.sources == 0) {
+        return;
+    }
+    
+    int32_t temperature = reading_history_encode(HISTORY_QTY_TEMPERATURE, air.value);
+    int32_t relative = reading_history_encode(HISTORY_QTY_HUMIDITY, humidity.value);
+    int32_t leaf = reading_history_encode(HISTORY_QTY_TEMPERATURE, air.value - VPD_LEAF_OFFSET);
+    fusion_estimate_t probe;
+    if (VPD_LEAF_PROBE && sensor_fusion_get(FUSION_LEAF_TEMPERATURE, &probe) && probe.sources > 0) {
+        leaf = reading_history_encode(HISTORY_QTY_TEMPERATURE, probe.value);
+    }
+    
+    display_data->has_vpd = true;
+    display_data->vpd = reading_history_decode(HISTORY_QTY_VPD, vpd_air(temperature, relative));
+    display_data->leaf_vpd = reading_history_decode(HISTORY_QTY_VPD, vpd_leaf(leaf, temperature, relative));
+    display_data->dew_point = reading_history_decode(HISTORY_QTY_TEMPERATURE, vpd_dew_point(temperature, relative));
+    DLOG(DLOG_MON_VPD, display_data->vpd, display_data->leaf_vpd, display_data->dew_point);
+}
+
+/**
+ * @brief Run this cycle's values through the alert engine
+ * 
+ * Uses the fused air estimates and the mean of the soil and light
+ * sensors that passed this cycle's checks. There is no uplink in
+ * continuous mode, so only alerts raised or cleared are logged; in
+ * duty-cycle mode they are sent at once (see duty_cycle_send_urgent()).
+ */
+static void evaluate_alerts(void)
+{
+    const sensor_registry_t *registry = sensor_registry_get();
+    int32_t value[HISTORY_QTY_COUNT] = {0};
+    int count[HISTORY_QTY_COUNT] = {0};
+    
+    for (int i = 0; i < registry->count; i++) {
+        const sensor_reading_t *reading = &sensor_readings[i];
+        if (!((registry->valid_mask >> i) & 1) || (reading->quality_flags & SENSOR_QUALITY_SUSPECT)) {
+            continue;
+        }
+        if (registry->type[i] == SENSOR_TYPE_SOIL_MOISTURE) {
+            value[HISTORY_QTY_SOIL_MOISTURE] += reading->soil_moisture;
+            count[HISTORY_QTY_SOIL_MOISTURE]++;
+        } else if (registry->type[i] == SENSOR_TYPE_LIGHT) {
+            value[HISTORY_QTY_LIGHT_LEVEL] += reading->light_level;
+            count[HISTORY_QTY_LIGHT_LEVEL]++;
+        }
+    }
+    
+    fusion_estimate_t estimate;
+    if (sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate) && estimate.sources > 0) {
+        value[HISTORY_QTY_TEMPERATURE] = reading_history_encode(HISTORY_QTY_TEMPERATURE, estimate.value);
+        count[HISTORY_QTY_TEMPERATURE] = 1;
+    }
+    if (sensor_fusion_get(FUSION_AIR_HUMIDITY, &estimate) && estimate.sources > 0) {
+        value[HISTORY_QTY_HUMIDITY] = reading_history_encode(HISTORY_QTY_HUMIDITY, estimate.value);
+        count[HISTORY_QTY_HUMIDITY] = 1;
+    }
+    
+    int rule_count = 0;
+    const alert_rule_t *rules = alert_engine_default_rules(&rule_count);
+    uint32_t now_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    
+    for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+        if (count[q] == 0) {
+            continue;
+        }
+        
+        history_quantity_t quantity = (history_quantity_t)q;
+        alert_transition_t transitions[ALERT_ENGINE_MAX_RULES];
+        int fired = alert_engine_update(&g_alerts, rules, rule_count, quantity, (int16_t)(value[q] / count[q]),
+                                        now_s, transitions, ALERT_ENGINE_MAX_RULES);
+        for (int i = 0; i < fired && i < ALERT_ENGINE_MAX_RULES; i++) {
+            const alert_rule_t *rule = &rules[transitions[i].rule];
+            if (transitions[i].raised) {
+                DLOG(DLOG_MON_ALERT_RAISED, rule->name, alert_engine_severity_name((alert_severity_t)rule->severity),
+                     reading_history_decode(quantity, transitions[i].value),
+                     reading_history_decode(quantity, rule->threshold));
+            } else {
+                DLOG(DLOG_MON_ALERT_CLEARED, rule->name, reading_history_decode(quantity, transitions[i].value),
+                     reading_history_decode(quantity, transitions[i].peak));
+            }
+        }
+    }
+}
+
 /**
  * @brief Main monitoring task
  * 
@@ -161,23 +815,42 @@ esp_err_t calculate_plant_health(const sensor_reading_t *readings, int reading_c
 void monitoring_task(void *pvParameters) 
 {
     ESP_LOGI(TAG, "Plant monitoring task started");
+    uint32_t cycle = 0;
     
     while (1) {
+        TRACE_BEGIN(TRACE_EVT_MONITOR_CYCLE, cycle);
+        
         // Read all sensors
-        int reading_count = sensor_interface_read_all(sensor_readings, 8);
+        int reading_count = read_sensors();
         if (reading_count < 0) {
             ESP_LOGE(TAG, "Failed to read sensors");
+            TRACE_END(TRACE_EVT_MONITOR_CYCLE, cycle);
             vTaskDelay(pdMS_TO_TICKS(5000));
             continue;
         }
         
-        ESP_LOGI(TAG, "Read %d sensor readings", reading_count);
+        DLOG(DLOG_MON_READ_COUNT, reading_count);
+        filter_readings();
+        diagnose_readings();
+        fuse_readings();
+        
+#if I2C_HOTPLUG_RESCAN_CYCLES > 0
+        // Pick up hot-plugged or removed I2C sensors
+        if (cycle % I2C_HOTPLUG_RESCAN_CYCLES == I2C_HOTPLUG_RESCAN_CYCLES - 1) {
+            sensor_interface_rescan_i2c();
+        }
+#endif
+        update_boot_record();
         
         // Calculate plant health
-        esp_err_t ret = calculate_plant_health(sensor_readings, reading_count, &plant_health);
+        TRACE_BEGIN(TRACE_EVT_HEALTH, reading_count);
+        esp_err_t ret = calculate_plant_health(sensor_readings, sensor_registry_count(), &plant_health);
+        TRACE_END(TRACE_EVT_HEALTH, (int)plant_health.health_score);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to calculate health: %s", esp_err_to_name(ret));
         }
+        predict_drying(&plant_health);
+        evaluate_alerts();
         
         // Update displays
         sensor_data_t display_data = {
@@ -201,29 +874,118 @@ void monitoring_task(void *pvParameters)
             }
         }
         
+        fusion_estimate_t estimate;
+        if (sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate) && estimate.sources > 0) {
+            display_data.temperature = estimate.value;
+        }
+        if (sensor_fusion_get(FUSION_AIR_HUMIDITY, &estimate) && estimate.sources > 0) {
+            display_data.humidity = estimate.value;
+        }
+        integrate_light(&display_data);
+        compute_vpd(&display_data);
+        
+        TRACE_BEGIN(TRACE_EVT_DISPLAY_UPDATE, 0);
         ret = display_interface_update(&display_data, &plant_health);
+        TRACE_END(TRACE_EVT_DISPLAY_UPDATE, ret);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to update display: %s", esp_err_to_name(ret));
         }
         
         // Log summary
-        ESP_LOGI(TAG, "=== Plant Monitor Summary ===");
-        ESP_LOGI(TAG, "Valid sensors: %d/%d", reading_count, 8);
-        ESP_LOGI(TAG, "Temperature: %.2f°C", display_data.temperature);
-        ESP_LOGI(TAG, "Humidity: %.2f%%", display_data.humidity);
-        ESP_LOGI(TAG, "Soil Moisture: %d", display_data.soil_moisture);
-        ESP_LOGI(TAG, "Light Level: %d", display_data.light_level);
-        ESP_LOGI(TAG, "Light Intensity: %.1f lux", display_data.lux);
-        ESP_LOGI(TAG, "Plant Health: %s %s (Score: %.1f)", 
-                 plant_health.health_text, plant_health.emoji, plant_health.health_score);
-        ESP_LOGI(TAG, "Recommendation: %s", plant_health.recommendation);
-        ESP_LOGI(TAG, "================================");
+        DLOG(DLOG_MON_SUMMARY_BEGIN);
+        DLOG(DLOG_MON_VALID_SENSORS, reading_count, SENSOR_INTERFACE_MAX_SENSORS);
+        DLOG(DLOG_MON_TEMPERATURE, display_data.temperature);
+        DLOG(DLOG_MON_HUMIDITY, display_data.humidity);
+        DLOG(DLOG_MON_SOIL_MOISTURE, display_data.soil_moisture);
+        DLOG(DLOG_MON_LIGHT_LEVEL, display_data.light_level);
+        DLOG(DLOG_MON_LUX, display_data.lux);
+        DLOG(DLOG_MON_HEALTH, plant_health.health_text, plant_health.emoji, plant_health.health_score);
+        DLOG(DLOG_MON_RECOMMENDATION, plant_health.recommendation);
+        DLOG(DLOG_MON_SUMMARY_END);
+        
+#if ROLLING_STATS_LOG_CYCLES > 0
+        if ((cycle + 1) % ROLLING_STATS_LOG_CYCLES == 0) {
+            log_statistics();
+        }
+#endif
+        
+        TRACE_END(TRACE_EVT_MONITOR_CYCLE, cycle);
+        
+#if TRACE_ENABLED && TRACE_DUMP_INTERVAL_CYCLES > 0
+        if ((cycle + 1) % TRACE_DUMP_INTERVAL_CYCLES == 0) {
+            trace_dump(true);
+        }
+#endif
+        cycle++;
         
         // Wait for next reading
         vTaskDelay(pdMS_TO_TICKS(30000)); // 30 seconds
     }
 }
 
+/**
+ * @brief Take one sample, buffer it in RTC memory and deep-sleep
+ * 
+ * Used instead of monitoring_task() when DUTY_CYCLE_ENABLED is set. The
+ * buffered records are uploaded when enough have accumulated (fewer as
+ * the soil nears dry). Anomalies and alerts raised or cleared are
+ * reported at once in a small message of their own. As in the
+ * continuous loop, the readings go through the self-diagnostics first,
+ * so sensor fusion and the health score see their quality flags; the
+ * outlier filter is left out, since its windows do not survive deep
+ * sleep. Fusion state is kept in RTC memory by duty_cycle_enter_sleep(),
+ * so the record holds the fused air estimates.
+ * 
+ * @param config Sensor interface configuration (for the sensor types)
+ * @param update_display Whether to refresh the displays with this sample
+ */
+static void duty_cycle_sample_and_sleep(const sensor_interface_config_t *config, bool update_display)
+{
+    int reading_count = read_sensors();
+    if (reading_count < 0) {
+        ESP_LOGE(TAG, "Failed to read sensors");
+        duty_cycle_enter_sleep();
+    }
+    
+    duty_cycle_diagnose(config->sensors, sensor_readings, config->sensor_count);
+    report_diagnostics();
+    fuse_readings();
+    update_boot_record();
+    calculate_plant_health(sensor_readings, sensor_registry_count(), &plant_health);
+    
+    duty_cycle_record_t record;
+    bool flush_due = false;
+    bool urgent_due = false;
+    duty_cycle_pack_record(config->sensors, sensor_readings, config->sensor_count,
+                           plant_health.health_score, &record);
+    duty_cycle_append(&record, &flush_due, &urgent_due);
+    plant_health.hours_to_dry = duty_cycle_hours_to_dry();
+    
+    if (update_display) {
+        sensor_data_t display_data = {0};
+        for (int i = 0; i < reading_count; i++) {
+            if (sensor_readings[i].valid) {
+                display_data.temperature = sensor_readings[i].temperature;
+                display_data.humidity = sensor_readings[i].humidity;
+                display_data.soil_moisture = sensor_readings[i].soil_moisture;
+                display_data.light_level = sensor_readings[i].light_level;
+                display_data.lux = sensor_readings[i].lux;
+                break;
+            }
+        }
+        display_interface_update(&display_data, &plant_health);
+    }
+    
+    // A due batch carries the anomalies and alerts too; otherwise they go out alone
+    if (flush_due) {
+        duty_cycle_flush();
+    } else if (urgent_due) {
+        duty_cycle_send_urgent();
+    }
+    
+    duty_cycle_enter_sleep();
+}
+
 /**
  * @brief Main application entry point
  * 
@@ -234,60 +996,109 @@ void monitoring_task(void *pvParameters)
  */
 extern "C" void app_main(void) 
 {
-    ESP_LOGI(TAG, "Plant Monitor System Starting...");
-    ESP_LOGI(TAG, "==================================");
+    // Timer wakeups in duty-cycle mode take the short path: no banner,
+    // diagnostics, displays or I2C scan, and only warnings on the console
+    bool quick_wakeup = DUTY_CYCLE_ENABLED && duty_cycle_is_timer_wakeup();
+    
+    if (quick_wakeup) {
+        esp_log_level_set("*", ESP_LOG_WARN);
+    } else {
+        ESP_LOGI(TAG, "Plant Monitor System Starting...");
+        ESP_LOGI(TAG, "==================================");
+        
+#if TRACE_ENABLED
+        trace_init();
+#endif
+        dlog_init();
+    }
+    power_manager_init();
+    reading_history_init();
+    outlier_filter_init((outlier_filter_mode_t)OUTLIER_FILTER_MODE);
+    for (int i = 0; i < READING_HISTORY_CHANNELS; i++) {
+        rolling_stats_init(&g_stats[i]);
+    }
+    dry_predictor_init(&g_dry);
     
+    const light_spectrum_t *spectrum = light_integral_find_spectrum(LIGHT_SPECTRUM);
+    if (!spectrum) {
+        ESP_LOGW(TAG, "Unknown light spectrum '%s', using sunlight", LIGHT_SPECTRUM);
+    }
+    light_integral_init(&g_light, spectrum, LIGHT_UTC_OFFSET_MIN * 60);
+    
+    const health_profile_t *profile = health_engine_find_profile(HEALTH_PROFILE);
+    if (!profile) {
+        ESP_LOGW(TAG, "Unknown health profile '%s', using default", HEALTH_PROFILE);
+    }
+    health_engine_set_profile(&g_health, profile);
+    
+    if (DUTY_CYCLE_ENABLED) {
+        duty_cycle_init();
+    }
+    
+#if SENSOR_TOPOLOGY_STATIC
+    // The sensor table is generated from node_topology
+    const sensor_config_t *sensors = node_topology::sensors;
+    const uint8_t sensor_count = node_topology::count;
+#else
     // Configure sensor interface with all available sensors
-    sensor_interface_config_t sensor_config = {
-        .sensors = {
-            // AHT10 Sensors
-            {
-                .type = SENSOR_TYPE_AHT10,
-                .address = 0x38,
-                .pin = 0,
-                .enabled = true,
-                .name = "AHT10-1"
-            },
-            {
-                .type = SENSOR_TYPE_AHT10,
-                .address = 0x39,
-                .pin = 0,
-                .enabled = true,
-                .name = "AHT10-2"
-            },
-            // DS18B20 Waterproof Temperature Sensor
-            {
-                .type = SENSOR_TYPE_DS18B20,
-                .address = 0,
-                .pin = 4,  // One-Wire pin
-                .enabled = true,
-                .name = "DS18B20-Waterproof"
-            },
-            // GY-302 Digital Light Sensor
-            {
-                .type = SENSOR_TYPE_GY302,
-                .address = 0x23,
-                .pin = 0,
-                .enabled = true,
-                .name = "GY-302-Light"
-            },
-            // Analog Sensors
-            {
-                .type = SENSOR_TYPE_SOIL_MOISTURE,
-                .address = 0,
-                .pin = 1,
-                .enabled = true,
-                .name = "Soil-Moisture"
-            },
-            {
-                .type = SENSOR_TYPE_LIGHT,
-                .address = 0,
-                .pin = 2,
-                .enabled = true,
-                .name = "Light-Sensor"
-            }
+    // (static: names are referenced by the sensor registry)
+    static const sensor_config_t sensors[] = {
+        // AHT10 Sensors (a pair: a divergence flags both, see diagnose_readings())
+        {
+            .type = SENSOR_TYPE_AHT10,
+            .address = 0x38,
+            .i2c_freq = I2C_FAST_MODE_FREQ_HZ,
+            .pin = 0,
+            .enabled = true,
+            .name = "AHT10-1"
+        },
+        {
+            .type = SENSOR_TYPE_AHT10,
+            .address = 0x39,
+            .i2c_freq = I2C_FAST_MODE_FREQ_HZ,
+            .pin = 0,
+            .enabled = true,
+            .name = "AHT10-2"
+        },
+        // DS18B20 Waterproof Temperature Sensor
+        {
+            .type = SENSOR_TYPE_DS18B20,
+            .address = 0,
+            .pin = 4,  // One-Wire pin
+            .enabled = true,
+            .name = "DS18B20-Waterproof"
         },
-        .sensor_count = 6,
+        // GY-302 Digital Light Sensor
+        {
+            .type = SENSOR_TYPE_GY302,
+            .address = 0x23,
+            .i2c_freq = I2C_FAST_MODE_FREQ_HZ,
+            .pin = 0,
+            .enabled = true,
+            .name = "GY-302-Light"
+        },
+        // Analog Sensors
+        {
+            .type = SENSOR_TYPE_SOIL_MOISTURE,
+            .address = 0,
+            .pin = 1,
+            .enabled = true,
+            .name = "Soil-Moisture"
+        },
+        {
+            .type = SENSOR_TYPE_LIGHT,
+            .address = 0,
+            .pin = 2,
+            .enabled = true,
+            .name = "Light-Sensor"
+        }
+    };
+    const uint8_t sensor_count = sizeof(sensors) / sizeof(sensors[0]);
+#endif
+    
+    sensor_interface_config_t sensor_config = {
+        .sensors = sensors,
+        .sensor_count = sensor_count,
         .i2c_sda_pin = 21,
         .i2c_scl_pin = 22,
         .i2c_frequency = 100000,
@@ -297,55 +1108,59 @@ extern "C" void app_main(void)
     };
     
     // Configure display interface with multiple displays
-    display_interface_config_t display_config = {
-        .displays = {
-            // Console Display (for debugging)
-            {
-                .type = DISPLAY_TYPE_CONSOLE,
-                .i2c_address = 0,
-                .sda_pin = 0,
-                .scl_pin = 0,
-                .spi_cs_pin = 0,
-                .spi_dc_pin = 0,
-                .spi_rst_pin = 0,
-                .spi_mosi_pin = 0,
-                .spi_sck_pin = 0,
-                .spi_busy_pin = 0,
-                .enabled = true,
-                .name = "Console Display"
-            },
-            // Built-in SSD1306 (ESP32 DevKit)
-            {
-                .type = DISPLAY_TYPE_BUILTIN_SSD1306,
-                .i2c_address = 0x3C,
-                .sda_pin = 21,
-                .scl_pin = 22,
-                .spi_cs_pin = 0,
-                .spi_dc_pin = 0,
-                .spi_rst_pin = 0,
-                .spi_mosi_pin = 0,
-                .spi_sck_pin = 0,
-                .spi_busy_pin = 0,
-                .enabled = true,
-                .name = "Built-in OLED"
-            },
-            // E-paper Display (SPI)
-            {
-                .type = DISPLAY_TYPE_EPAPER_SPI,
-                .i2c_address = 0,
-                .sda_pin = 0,
-                .scl_pin = 0,
-                .spi_cs_pin = 5,
-                .spi_dc_pin = 17,
-                .spi_rst_pin = 16,
-                .spi_mosi_pin = 23,
-                .spi_sck_pin = 18,
-                .spi_busy_pin = 4,
-                .enabled = true,
-                .name = "E-paper Display"
-            }
+    // (static: the display interface keeps using this table)
+    static const display_config_t displays[] = {
+        // Console Display (for debugging)
+        {
+            .type = DISPLAY_TYPE_CONSOLE,
+            .i2c_address = 0,
+            .sda_pin = 0,
+            .scl_pin = 0,
+            .spi_cs_pin = 0,
+            .spi_dc_pin = 0,
+            .spi_rst_pin = 0,
+            .spi_mosi_pin = 0,
+            .spi_sck_pin = 0,
+            .spi_busy_pin = 0,
+            .enabled = true,
+            .name = "Console Display"
+        },
+        // Built-in SSD1306 (ESP32 DevKit)
+        {
+            .type = DISPLAY_TYPE_BUILTIN_SSD1306,
+            .i2c_address = 0x3C,
+            .sda_pin = 21,
+            .scl_pin = 22,
+            .i2c_freq = I2C_FAST_MODE_FREQ_HZ,
+            .spi_cs_pin = 0,
+            .spi_dc_pin = 0,
+            .spi_rst_pin = 0,
+            .spi_mosi_pin = 0,
+            .spi_sck_pin = 0,
+            .spi_busy_pin = 0,
+            .enabled = true,
+            .name = "Built-in OLED"
         },
-        .display_count = 3,
+        // E-paper Display (SPI)
+        {
+            .type = DISPLAY_TYPE_EPAPER_SPI,
+            .i2c_address = 0,
+            .sda_pin = 0,
+            .scl_pin = 0,
+            .spi_cs_pin = 5,
+            .spi_dc_pin = 17,
+            .spi_rst_pin = 16,
+            .spi_mosi_pin = 23,
+            .spi_sck_pin = 18,
+            .spi_busy_pin = 4,
+            .enabled = true,
+            .name = "E-paper Display"
+        }
+    };
+    
+    display_interface_config_t display_config = {
+        .displays = displays,
+        .display_count = sizeof(displays) / sizeof(displays[0]),
         .enable_backlight = true,
         .brightness = 128,
         .enable_auto_off = false,
@@ -359,6 +1174,32 @@ extern "C" void app_main(void)
         return;
     }
     
+    register_fusion_sources();
+    register_diagnostics();
+    if (DUTY_CYCLE_ENABLED && duty_cycle_restore_fusion()) {
+        ESP_LOGD(TAG, "Fusion state restored from RTC memory");
+    }
+    
+    // Reuse the previous discovery result when the configuration is unchanged
+    g_config_hash = boot_record_config_hash(&sensor_config);
+    boot_record_t boot_record;
+    if (boot_record_load(g_config_hash, &boot_record) == ESP_OK &&
+        boot_record.sensors.i2c_map_valid) {
+        sensor_interface_restore_boot_state(&boot_record.sensors);
+    } else {
+        ESP_LOGI(TAG, "Scanning for I2C devices...");
+        int device_count = sensor_interface_scan_i2c();
+        if (device_count < 0) {
+            ESP_LOGW(TAG, "I2C scan failed, continuing without a device map");
+        } else {
+            ESP_LOGI(TAG, "Found %d I2C devices", device_count);
+        }
+    }
+    
+    if (quick_wakeup) {
+        duty_cycle_sample_and_sleep(&sensor_config, false);
+    }
+    
     // Initialize display interface
     ret = display_interface_init(&display_config);
     if (ret != ESP_OK) {
@@ -366,11 +1207,6 @@ extern "C" void app_main(void)
         return;
     }
     
-    // Scan for I2C devices
-    ESP_LOGI(TAG, "Scanning for I2C devices...");
-    int device_count = sensor_interface_scan_i2c();
-    ESP_LOGI(TAG, "Found %d I2C devices", device_count);
-    
     // Get system status
     int working_sensors, total_sensors;
     sensor_interface_get_status(&working_sensors, &total_sensors);
@@ -392,6 +1228,21 @@ extern "C" void app_main(void)
     // Show welcome message
     display_interface_show_welcome();
     
+    if (DUTY_CYCLE_ENABLED) {
+        ESP_LOGI(TAG, "Duty-cycle mode: sampling every %d s with deep sleep in between",
+                 DUTY_CYCLE_SLEEP_SECONDS);
+        duty_cycle_sample_and_sleep(&sensor_config, true);
+    }
+    
+    // The irrigation loop runs in its own higher-priority task, so the
+    // monitoring cycle's sensor, display and upload delays do not reach it
+    if (IRRIGATION_ENABLED) {
+        ret = irrigation_init();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to start irrigation control: %s", esp_err_to_name(ret));
+        }
+    }
+    
     // Create monitoring task
     xTaskCreate(&monitoring_task, "monitoring_task", 4096, NULL, 5, NULL);
     
@@ -0,0 +1,227 @@
+/**
+ * @file uplink.c
+ * @brief On-Demand WiFi Uplink Implementation
+ *
+ * WiFi credentials are kept in RAM only (no NVS writes per wakeup) and the
+ * driver is stopped again after every upload, so a wakeup that does not
+ * upload never touches the radio.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "uplink.h"
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_netif_sntp.h"
+#include "esp_http_client.h"
+#include "nvs_flash.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include <string.h>
+#include <time.h>
+
+static const char *TAG = "UPLINK";
+
+/** Event group bits */
+#define UPLINK_CONNECTED_BIT     (1 << 0)
+#define UPLINK_FAIL_BIT          (1 << 1)
+
+// Global variables
+static EventGroupHandle_t g_events = NULL;
+static bool g_initialized = false;
+static bool g_started = false;
+static int g_retry_count = 0;
+
+/**
+ * @brief WiFi and IP event handler
+ */
+static void uplink_event_handler(void *arg, esp_event_base_t event_base,
+                                 int32_t event_id, void *event_data)
+{
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        if (!g_started) {
+            return;
+        }
+        if (g_retry_count < MAX_RETRY_ATTEMPTS) {
+            g_retry_count++;
+            esp_wifi_connect();
+        } else {
+            xEventGroupSetBits(g_events, UPLINK_FAIL_BIT);
+        }
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        g_retry_count = 0;
+        xEventGroupSetBits(g_events, UPLINK_CONNECTED_BIT);
+    }
+}
+
+/**
+ * @brief One-time NVS, netif and WiFi driver setup
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+static esp_err_t uplink_init(void)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        ret = nvs_flash_init();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "NVS init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    g_events = xEventGroupCreate();
+    if (!g_events) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_ERROR_CHECK(esp_netif_init());
+    ret = esp_event_loop_create_default();
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Event loop creation failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    esp_netif_create_default_wifi_sta();
+
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ret = esp_wifi_init(&cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "WiFi init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &uplink_event_handler, NULL, NULL);
+    esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &uplink_event_handler, NULL, NULL);
+
+    wifi_config_t wifi_config = {0};
+    strncpy((char *)wifi_config.sta.ssid, GET_WIFI_SSID(), sizeof(wifi_config.sta.ssid) - 1);
+    strncpy((char *)wifi_config.sta.password, GET_WIFI_PASS(), sizeof(wifi_config.sta.password) - 1);
+
+    ret = esp_wifi_set_mode(WIFI_MODE_STA);
+    if (ret == ESP_OK) {
+        ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "WiFi configuration failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    g_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t uplink_connect(uint32_t timeout_ms)
+{
+    if (!g_initialized) {
+        esp_err_t ret = uplink_init();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    if (g_started) {
+        return ESP_OK;
+    }
+
+    xEventGroupClearBits(g_events, UPLINK_CONNECTED_BIT | UPLINK_FAIL_BIT);
+    g_retry_count = 0;
+    g_started = true;
+
+    esp_err_t ret = esp_wifi_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "WiFi start failed: %s", esp_err_to_name(ret));
+        g_started = false;
+        return ret;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(g_events, UPLINK_CONNECTED_BIT | UPLINK_FAIL_BIT,
+                                           pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+    if (!(bits & UPLINK_CONNECTED_BIT)) {
+        ESP_LOGW(TAG, "WiFi connection to %s failed", GET_WIFI_SSID());
+        uplink_disconnect();
+        return (bits & UPLINK_FAIL_BIT) ? ESP_FAIL : ESP_ERR_TIMEOUT;
+    }
+
+    ESP_LOGI(TAG, "WiFi connected");
+    return ESP_OK;
+}
+
+esp_err_t uplink_sync_time(uint32_t timeout_ms)
+{
+    esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG(NTP_SERVER);
+    esp_err_t ret = esp_netif_sntp_init(&config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SNTP init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = esp_netif_sntp_sync_wait(pdMS_TO_TICKS(timeout_ms));
+    esp_netif_sntp_deinit();
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Time synchronization failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Time synchronized");
+    return ESP_OK;
+}
+
+bool uplink_clock_is_valid(void)
+{
+    return time(NULL) >= UPLINK_MIN_VALID_EPOCH;
+}
+
+esp_err_t uplink_post_json(const char *url, const char *json)
+{
+    if (!url || !json) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_http_client_config_t config = {
+        .url = url,
+        .method = HTTP_METHOD_POST,
+        .timeout_ms = DATA_TRANSMISSION_TIMEOUT_MS
+    };
+
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (!client) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_http_client_set_header(client, "Content-Type", "application/json");
+    esp_http_client_set_post_field(client, json, strlen(json));
+
+    esp_err_t ret = esp_http_client_perform(client);
+    if (ret == ESP_OK) {
+        int status = esp_http_client_get_status_code(client);
+        if (status < 200 || status >= 300) {
+            ESP_LOGW(TAG, "Server returned HTTP %d", status);
+            ret = ESP_ERR_INVALID_RESPONSE;
+        }
+    } else {
+        ESP_LOGW(TAG, "HTTP POST failed: %s", esp_err_to_name(ret));
+    }
+
+    esp_http_client_cleanup(client);
+    return ret;
+}
+
+esp_err_t uplink_disconnect(void)
+{
+    if (!g_started) {
+        return ESP_OK;
+    }
+
+    g_started = false;
+    esp_wifi_disconnect();
+    return esp_wifi_stop();
+}
@@ -0,0 +1,79 @@
+/**
+ * @file uplink.h
+ * @brief On-Demand WiFi Uplink for Plant Monitoring System
+ *
+ * This module brings WiFi up only for the duration of an upload: connect,
+ * optionally synchronize the clock over SNTP, POST a JSON body to the
+ * server and shut the radio down again. It is used by the duty-cycle mode,
+ * where the radio is by far the largest consumer of each wakeup.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Any time before this (2024-01-01) means the clock was never synchronized */
+#define UPLINK_MIN_VALID_EPOCH   1704067200
+
+/**
+ * @brief Connect to the configured WiFi network
+ *
+ * Initializes NVS, netif and the WiFi driver on first use and blocks
+ * until an IP address has been obtained.
+ *
+ * @param timeout_ms Maximum time to wait for the connection
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if no connection, other error code on failure
+ */
+esp_err_t uplink_connect(uint32_t timeout_ms);
+
+/**
+ * @brief Synchronize the system clock over SNTP
+ *
+ * The clock is kept by the RTC across deep sleep, so this only needs to
+ * run when uplink_clock_is_valid() returns false.
+ *
+ * @param timeout_ms Maximum time to wait for synchronization
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t uplink_sync_time(uint32_t timeout_ms);
+
+/**
+ * @brief Check whether the system clock holds a plausible wall-clock time
+ *
+ * @return true if the clock has been synchronized at some point
+ */
+bool uplink_clock_is_valid(void);
+
+/**
+ * @brief POST a JSON document to the server
+ *
+ * @param url Endpoint URL
+ * @param json NUL-terminated JSON body
+ * @return ESP_OK if the server answered with a 2xx status, error code otherwise
+ */
+esp_err_t uplink_post_json(const char *url, const char *json);
+
+/**
+ * @brief Disconnect and stop the WiFi driver
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t uplink_disconnect(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UPLINK_H
@@ -12,6 +12,13 @@
  */
 
 #include "plant_monitor.h"
+#include "i2c_bus.h"
+#include "sensor_fusion.h"
+#include "health_engine.h"
+#include "dry_predictor.h"
+#include "vpd.h"
+#include "trace.h"
+#include "dlog.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
@@ -42,6 +49,8 @@ typedef struct {
     float temperature;
     float humidity;
     bool valid;
+    int temperature_source;
+    int humidity_source;
 } aht10_sensor_t;
 
 /** System state */
@@ -53,6 +62,9 @@ typedef struct {
     bool wifi_initialized;
     bool display_initialized;
     uint32_t start_time;
+    int64_t last_fusion_us;
+    health_context_t health;
+    dry_predictor_t dry;
 } plant_monitor_state_t;
 
 static plant_monitor_state_t g_state = {0};
@@ -72,26 +84,10 @@ static esp_err_t i2c_init(void)
         return ESP_OK;
     }
     
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = g_state.config.sda_pin,
-        .scl_io_num = g_state.config.scl_pin,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master = {
-            .clk_speed = g_state.config.i2c_freq_hz,
-        },
-    };
-    
-    esp_err_t ret = i2c_param_config(I2C_NUM_0, &conf);
+    esp_err_t ret = i2c_bus_init(g_state.config.sda_pin, g_state.config.scl_pin,
+                                 g_state.config.i2c_freq_hz);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "I2C parameter config failed: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    ret = i2c_driver_install(I2C_NUM_0, conf.mode, 0, 0, 0);
-    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-        ESP_LOGE(TAG, "I2C driver install failed: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "I2C bus init failed: %s", esp_err_to_name(ret));
         return ret;
     }
     
@@ -121,7 +117,7 @@ static esp_err_t aht10_init_sensor(aht10_sensor_t* sensor)
     i2c_master_write_byte(cmd, (sensor->addr << 1) | I2C_MASTER_WRITE, true);
     i2c_master_write(cmd, reset_cmd, 1, true);
     i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, 1000 / portTICK_PERIOD_MS);
+    esp_err_t ret = i2c_bus_cmd_begin(sensor->addr, cmd, sizeof(reset_cmd));
     i2c_cmd_link_delete(cmd);
     
     if (ret != ESP_OK) {
@@ -138,7 +134,7 @@ static esp_err_t aht10_init_sensor(aht10_sensor_t* sensor)
     i2c_master_write_byte(cmd, (sensor->addr << 1) | I2C_MASTER_WRITE, true);
     i2c_master_write(cmd, init_cmd, 3, true);
     i2c_master_stop(cmd);
-    ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, 1000 / portTICK_PERIOD_MS);
+    ret = i2c_bus_cmd_begin(sensor->addr, cmd, sizeof(init_cmd));
     i2c_cmd_link_delete(cmd);
     
     if (ret != ESP_OK) {
@@ -172,7 +168,7 @@ static esp_err_t aht10_read_sensor(aht10_sensor_t* sensor)
     i2c_master_write_byte(cmd, (sensor->addr << 1) | I2C_MASTER_WRITE, true);
     i2c_master_write(cmd, measure_cmd, 3, true);
     i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, 1000 / portTICK_PERIOD_MS);
+    esp_err_t ret = i2c_bus_cmd_begin(sensor->addr, cmd, sizeof(measure_cmd));
     i2c_cmd_link_delete(cmd);
     
     if (ret != ESP_OK) {
@@ -190,7 +186,7 @@ static esp_err_t aht10_read_sensor(aht10_sensor_t* sensor)
     i2c_master_write_byte(cmd, (sensor->addr << 1) | I2C_MASTER_READ, true);
     i2c_master_read(cmd, sensor_data, 6, I2C_MASTER_LAST_NACK);
     i2c_master_stop(cmd);
-    ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, 1000 / portTICK_PERIOD_MS);
+    ret = i2c_bus_cmd_begin(sensor->addr, cmd, sizeof(sensor_data));
     i2c_cmd_link_delete(cmd);
     
     if (ret != ESP_OK) {
@@ -346,14 +342,7 @@ esp_err_t plant_monitor_get_default_config(plant_monitor_config_t* config)
     config->display_addr = PLANT_MONITOR_DEFAULT_DISPLAY_ADDR;
     config->display_width = 128;
     config->display_height = 64;
-    config->temp_min = 10.0f;
-    config->temp_max = 35.0f;
-    config->temp_optimal_min = 18.0f;
-    config->temp_optimal_max = 28.0f;
-    config->humidity_min = 30.0f;
-    config->humidity_max = 80.0f;
-    config->humidity_optimal_min = 40.0f;
-    config->humidity_optimal_max = 70.0f;
+    config->health_profile = "default";
     config->data_interval_ms = PLANT_MONITOR_DEFAULT_DATA_INTERVAL_MS;
     config->enable_wifi = false;
     config->wifi_ssid = "";
@@ -375,6 +364,15 @@ esp_err_t plant_monitor_init(const plant_monitor_config_t* config)
     // Copy configuration
     memcpy(&g_state.config, config, sizeof(plant_monitor_config_t));
     
+    // Select the species profile
+    const health_profile_t *profile = health_engine_find_profile(config->health_profile);
+    if (profile == NULL) {
+        ESP_LOGE(TAG, "Unknown health profile '%s'", config->health_profile ? config->health_profile : "");
+        return ESP_ERR_INVALID_ARG;
+    }
+    health_engine_set_profile(&g_state.health, profile);
+    dry_predictor_init(&g_state.dry);
+    
     // Initialize I2C
     esp_err_t ret = i2c_init();
     if (ret != ESP_OK) {
@@ -398,6 +396,18 @@ esp_err_t plant_monitor_init(const plant_monitor_config_t* config)
     g_state.sensor2.initialized = false;
     g_state.sensor2.valid = false;
     
+    // Fuse the two AHT10s instead of averaging them
+    sensor_fusion_init();
+    g_state.sensor1.temperature_source = sensor_fusion_add_source(FUSION_AIR_TEMPERATURE, FUSION_AHT10_TEMP_SIGMA);
+    g_state.sensor1.humidity_source = sensor_fusion_add_source(FUSION_AIR_HUMIDITY, FUSION_AHT10_HUMIDITY_SIGMA);
+    g_state.sensor2.temperature_source = sensor_fusion_add_source(FUSION_AIR_TEMPERATURE, FUSION_AHT10_TEMP_SIGMA);
+    g_state.sensor2.humidity_source = sensor_fusion_add_source(FUSION_AIR_HUMIDITY, FUSION_AHT10_HUMIDITY_SIGMA);
+    g_state.last_fusion_us = esp_timer_get_time();
+    
+    // Run the AHT10s in Fast-mode when they answer reliably at that speed
+    i2c_bus_set_device_speed(g_state.sensor1.addr, PLANT_MONITOR_AHT10_I2C_FREQ_HZ);
+    i2c_bus_set_device_speed(g_state.sensor2.addr, PLANT_MONITOR_AHT10_I2C_FREQ_HZ);
+    
     ret = aht10_init_sensor(&g_state.sensor1);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "AHT10 sensor 1 initialization failed");
@@ -437,7 +447,7 @@ esp_err_t plant_monitor_deinit(void)
     
     // Clean up I2C
     if (g_state.i2c_initialized) {
-        i2c_driver_delete(I2C_NUM_0);
+        i2c_bus_deinit();
         g_state.i2c_initialized = false;
     }
     
@@ -462,6 +472,8 @@ esp_err_t plant_monitor_read_sensors(plant_monitor_data_t* data)
         return ESP_ERR_INVALID_ARG;
     }
     
+    TRACE_BEGIN(TRACE_EVT_SENSOR_READ_ALL, 2);
+    
     // Read AHT10 sensors
     esp_err_t ret1 = aht10_read_sensor(&g_state.sensor1);
     esp_err_t ret2 = aht10_read_sensor(&g_state.sensor2);
@@ -483,30 +495,30 @@ esp_err_t plant_monitor_read_sensors(plant_monitor_data_t* data)
         data->humidity_2 = 0.0f;
     }
     
-    // Calculate averages
-    int valid_sensors = 0;
-    float temp_sum = 0.0f;
-    float hum_sum = 0.0f;
-    
-    if (g_state.sensor1.valid) {
-        temp_sum += data->temperature_1;
-        hum_sum += data->humidity_1;
-        valid_sensors++;
-    }
+    // Fuse the sensors, weighting each by its noise model
+    int64_t now_us = esp_timer_get_time();
+    sensor_fusion_predict((now_us - g_state.last_fusion_us) / 1e6f);
+    g_state.last_fusion_us = now_us;
     
-    if (g_state.sensor2.valid) {
-        temp_sum += data->temperature_2;
-        hum_sum += data->humidity_2;
-        valid_sensors++;
+    int valid_sensors = 0;
+    const aht10_sensor_t *sensors[] = { &g_state.sensor1, &g_state.sensor2 };
+    for (int i = 0; i < 2; i++) {
+        if (sensors[i]->valid) {
+            sensor_fusion_update(sensors[i]->temperature_source, sensors[i]->temperature);
+            sensor_fusion_update(sensors[i]->humidity_source, sensors[i]->humidity);
+            valid_sensors++;
+        } else {
+            sensor_fusion_miss(sensors[i]->temperature_source);
+            sensor_fusion_miss(sensors[i]->humidity_source);
+        }
     }
     
-    if (valid_sensors > 0) {
-        data->temperature_avg = temp_sum / valid_sensors;
-        data->humidity_avg = hum_sum / valid_sensors;
-    } else {
-        data->temperature_avg = 0.0f;
-        data->humidity_avg = 0.0f;
-    }
+    fusion_estimate_t temperature;
+    fusion_estimate_t humidity;
+    bool fused = sensor_fusion_get(FUSION_AIR_TEMPERATURE, &temperature) && temperature.sources > 0 &&
+                 sensor_fusion_get(FUSION_AIR_HUMIDITY, &humidity) && humidity.sources > 0;
+    data->temperature_avg = fused ? temperature.value : 0.0f;
+    data->humidity_avg = fused ? humidity.value : 0.0f;
     
     // Read analog sensors
     read_analog_sensors(&data->soil_moisture, &data->light_level);
@@ -517,9 +529,11 @@ esp_err_t plant_monitor_read_sensors(plant_monitor_data_t* data)
     data->data_sent = false; // Will be set by transmit function
     data->timestamp = esp_timer_get_time() / 1000; // Convert to milliseconds
     
-    ESP_LOGI(TAG, "Sensor readings: T1=%.2f°C, H1=%.2f%%, T2=%.2f°C, H2=%.2f%%, Avg T=%.2f°C, Avg H=%.2f%%, Soil=%d, Light=%d",
-             data->temperature_1, data->humidity_1, data->temperature_2, data->humidity_2,
-             data->temperature_avg, data->humidity_avg, data->soil_moisture, data->light_level);
+    TRACE_END(TRACE_EVT_SENSOR_READ_ALL, valid_sensors);
+    
+    DLOG(DLOG_PM_SENSOR_READINGS,
+         data->temperature_1, data->humidity_1, data->temperature_2, data->humidity_2,
+         data->temperature_avg, data->humidity_avg, data->soil_moisture, data->light_level);
     
     return ESP_OK;
 }
@@ -530,65 +544,35 @@ esp_err_t plant_monitor_calculate_health(const plant_monitor_data_t* data, plant
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Calculate health score based on temperature and humidity
-    float temp_score = 0.0f;
-    float hum_score = 0.0f;
-    
-    // Temperature scoring
-    if (data->temperature_avg >= g_state.config.temp_optimal_min && 
-        data->temperature_avg <= g_state.config.temp_optimal_max) {
-        temp_score = 100.0f; // Optimal range
-    } else if (data->temperature_avg >= g_state.config.temp_min && 
-               data->temperature_avg <= g_state.config.temp_max) {
-        temp_score = 50.0f; // Acceptable range
-    } else {
-        temp_score = 0.0f; // Outside range
-    }
-    
-    // Humidity scoring
-    if (data->humidity_avg >= g_state.config.humidity_optimal_min && 
-        data->humidity_avg <= g_state.config.humidity_optimal_max) {
-        hum_score = 100.0f; // Optimal range
-    } else if (data->humidity_avg >= g_state.config.humidity_min && 
-               data->humidity_avg <= g_state.config.humidity_max) {
-        hum_score = 50.0f; // Acceptable range
-    } else {
-        hum_score = 0.0f; // Outside range
-    }
-    
-    // Calculate overall health score
-    health->health_score = (temp_score + hum_score) / 2.0f;
-    
-    // Determine health level and emoji
-    if (health->health_score >= 90.0f) {
-        health->health_level = PLANT_HEALTH_EXCELLENT;
-        health->health_text = "Excellent";
-        health->emoji = "😊";
-        health->recommendation = "Perfect conditions! Keep it up.";
-    } else if (health->health_score >= 70.0f) {
-        health->health_level = PLANT_HEALTH_GOOD;
-        health->health_text = "Good";
-        health->emoji = "🙂";
-        health->recommendation = "Good conditions. Monitor regularly.";
-    } else if (health->health_score >= 50.0f) {
-        health->health_level = PLANT_HEALTH_FAIR;
-        health->health_text = "Fair";
-        health->emoji = "😐";
-        health->recommendation = "Conditions are acceptable but could be better.";
-    } else if (health->health_score >= 30.0f) {
-        health->health_level = PLANT_HEALTH_POOR;
-        health->health_text = "Poor";
-        health->emoji = "😟";
-        health->recommendation = "Conditions need improvement. Check temperature and humidity.";
-    } else {
-        health->health_level = PLANT_HEALTH_CRITICAL;
-        health->health_text = "Critical";
-        health->emoji = "😱";
-        health->recommendation = "Immediate attention required! Check all conditions.";
-    }
-    
-    ESP_LOGI(TAG, "Plant health: %s %s (Score: %.1f) - %s",
-             health->health_text, health->emoji, health->health_score, health->recommendation);
+    // Score against the profile of the configured species
+    health_inputs_t inputs = {0};
+    inputs.value[HISTORY_QTY_TEMPERATURE] = reading_history_encode(HISTORY_QTY_TEMPERATURE, data->temperature_avg);
+    inputs.value[HISTORY_QTY_HUMIDITY] = reading_history_encode(HISTORY_QTY_HUMIDITY, data->humidity_avg);
+    inputs.value[HISTORY_QTY_SOIL_MOISTURE] = data->soil_moisture;
+    inputs.value[HISTORY_QTY_LIGHT_LEVEL] = data->light_level;
+    inputs.value[HISTORY_QTY_VPD] = vpd_air(inputs.value[HISTORY_QTY_TEMPERATURE], inputs.value[HISTORY_QTY_HUMIDITY]);
+    inputs.present = (1 << HISTORY_QTY_TEMPERATURE) | (1 << HISTORY_QTY_HUMIDITY) |
+                     (1 << HISTORY_QTY_SOIL_MOISTURE) | (1 << HISTORY_QTY_LIGHT_LEVEL) |
+                     (1 << HISTORY_QTY_VPD);
+    
+    health_result_t result;
+    health_engine_evaluate(&g_state.health, &inputs, &result);
+    const health_level_info_t *level = health_engine_level_info(result.level);
+    
+    // The level enums share their order
+    health->health_level = (int)result.level;
+    health->health_score = result.score / 100.0f;
+    health->health_text = level->text;
+    health->emoji = level->emoji;
+    health->recommendation = level->recommendation;
+    
+    // Soil drying trend, on the reading timestamps (milliseconds since boot)
+    uint32_t now_s = data->timestamp / 1000;
+    dry_predictor_update(&g_state.dry, (int16_t)data->soil_moisture, now_s);
+    health->hours_to_dry = dry_predictor_hours(&g_state.dry, DRY_PREDICTOR_THRESHOLD, now_s);
+    
+    DLOG(DLOG_PM_HEALTH,
+         health->health_text, health->emoji, health->health_score, health->recommendation);
     
     return ESP_OK;
 }
@@ -625,6 +609,8 @@ esp_err_t plant_monitor_transmit_data(const plant_monitor_data_t* data, const pl
         return ESP_OK; // WiFi not enabled
     }
     
+    TRACE_BEGIN(TRACE_EVT_TRANSMIT, 0);
+    
     // Create JSON payload
     cJSON* root = cJSON_CreateObject();
     cJSON* sensors = cJSON_CreateArray();
@@ -660,6 +646,9 @@ esp_err_t plant_monitor_transmit_data(const plant_monitor_data_t* data, const pl
     cJSON_AddStringToObject(health_obj, "emoji", health->emoji);
     cJSON_AddStringToObject(health_obj, "recommendation", health->recommendation);
     cJSON_AddNumberToObject(health_obj, "score", health->health_score);
+    if (health->hours_to_dry >= 0.0f) {
+        cJSON_AddNumberToObject(health_obj, "hours_to_dry", health->hours_to_dry);
+    }
     cJSON_AddItemToObject(root, "health", health_obj);
     
     char* json_string = cJSON_Print(root);
@@ -672,6 +661,7 @@ esp_err_t plant_monitor_transmit_data(const plant_monitor_data_t* data, const pl
     free(json_string);
     cJSON_Delete(root);
     
+    TRACE_END(TRACE_EVT_TRANSMIT, 0);
     return ESP_OK;
 }
 
@@ -679,20 +669,15 @@ esp_err_t plant_monitor_scan_i2c_devices(void)
 {
     ESP_LOGI(TAG, "Scanning I2C bus for devices...");
     
-    int found_devices = 0;
-    
-    for (int i = 0; i < 128; i++) {
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (i << 1) | I2C_MASTER_WRITE, true);
-        i2c_master_stop(cmd);
-        
-        esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, 1000 / portTICK_PERIOD_MS);
-        i2c_cmd_link_delete(cmd);
-        
-        if (ret == ESP_OK) {
+    int found_devices = i2c_bus_scan(NULL);
+    if (found_devices < 0) {
+        ESP_LOGE(TAG, "I2C scan failed");
+        return ESP_FAIL;
+    }
+    
+    for (int i = I2C_BUS_ADDRESS_FIRST; i <= I2C_BUS_ADDRESS_LAST; i++) {
+        if (i2c_bus_is_present(i)) {
             ESP_LOGI(TAG, "Found I2C device at address: 0x%02X", i);
-            found_devices++;
             
             if (i == PLANT_MONITOR_AHT10_ADDR_1 || i == PLANT_MONITOR_AHT10_ADDR_2) {
                 ESP_LOGI(TAG, "  -> This looks like an AHT10 sensor!");
@@ -52,14 +52,7 @@ typedef struct {
     int display_height;             /**< Display height in pixels */
     
     // Plant Health Configuration
-    float temp_min;                 /**< Minimum temperature (°C) */
-    float temp_max;                 /**< Maximum temperature (°C) */
-    float temp_optimal_min;         /**< Optimal temperature minimum (°C) */
-    float temp_optimal_max;         /**< Optimal temperature maximum (°C) */
-    float humidity_min;             /**< Minimum humidity (%) */
-    float humidity_max;             /**< Maximum humidity (%) */
-    float humidity_optimal_min;     /**< Optimal humidity minimum (%) */
-    float humidity_optimal_max;     /**< Optimal humidity maximum (%) */
+    const char* health_profile;     /**< Species profile name (see health_engine.h) */
     
     // System Configuration
     int data_interval_ms;           /**< Data transmission interval (ms) */
@@ -112,6 +105,7 @@ typedef struct {
     const char* emoji;              /**< Emoji representation */
     const char* recommendation;     /**< Care recommendation */
     float health_score;             /**< Health score (0.0-100.0) */
+    float hours_to_dry;             /**< Predicted hours until the soil is dry (negative = no prediction) */
 } plant_health_t;
 
 // ============================================================================
@@ -243,6 +237,9 @@ esp_err_t plant_monitor_get_status(int* sensors_working, bool* display_working,
 /** Default I2C frequency in Hz */
 #define PLANT_MONITOR_DEFAULT_I2C_FREQ_HZ    100000
 
+/** Fastest I2C clock the AHT10 supports, in Hz */
+#define PLANT_MONITOR_AHT10_I2C_FREQ_HZ      400000
+
 /** Default AHT10 sensor addresses */
 #define PLANT_MONITOR_AHT10_ADDR_1           0x38
 #define PLANT_MONITOR_AHT10_ADDR_2           0x39
@@ -0,0 +1,285 @@
+/**
+ * @file boot_record.c
+ * @brief Persisted Boot Record Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "boot_record.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include <stddef.h>
+#include <string.h>
+
+static const char *TAG = "BOOT_RECORD";
+
+/** Marks a stored record ("BOOT") */
+#define BOOT_RECORD_MAGIC        0x544F4F42
+
+/** Bump when boot_record_t changes layout */
+#define BOOT_RECORD_VERSION      1
+
+/** NVS namespace and key */
+#define BOOT_RECORD_NAMESPACE    "boot"
+#define BOOT_RECORD_KEY          "record"
+
+/**
+ * @brief Stored form of a boot record
+ */
+typedef struct {
+    uint32_t magic;           /**< BOOT_RECORD_MAGIC */
+    uint16_t version;         /**< BOOT_RECORD_VERSION */
+    uint16_t length;          /**< sizeof(boot_record_t) */
+    boot_record_t record;     /**< Record contents */
+    uint32_t crc;             /**< CRC-32 over all preceding fields */
+} boot_record_image_t;
+
+// Global variables
+RTC_NOINIT_ATTR static boot_record_image_t g_rtc_image;
+static boot_record_t g_nvs_record;
+static bool g_nvs_record_valid = false;
+
+/**
+ * @brief Fold bytes into an FNV-1a hash
+ */
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t length)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Compute the CRC of an image
+ */
+static uint32_t boot_record_crc(const boot_record_image_t *image)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)image, offsetof(boot_record_image_t, crc));
+}
+
+/**
+ * @brief Wrap a record into a stored image
+ */
+static void boot_record_pack(const boot_record_t *record, boot_record_image_t *image)
+{
+    memset(image, 0, sizeof(*image));
+    image->magic = BOOT_RECORD_MAGIC;
+    image->version = BOOT_RECORD_VERSION;
+    image->length = sizeof(boot_record_t);
+    memcpy(&image->record, record, sizeof(*record));
+    image->crc = boot_record_crc(image);
+}
+
+/**
+ * @brief Validate a stored image against the current configuration
+ *
+ * @return ESP_OK if valid, error code describing the mismatch otherwise
+ */
+static esp_err_t boot_record_check(const boot_record_image_t *image, uint32_t config_hash)
+{
+    if (image->magic != BOOT_RECORD_MAGIC) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (image->crc != boot_record_crc(image)) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    if (image->version != BOOT_RECORD_VERSION || image->length != sizeof(boot_record_t) ||
+        image->record.config_hash != config_hash) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Read the NVS copy
+ */
+static esp_err_t boot_record_read_nvs(boot_record_image_t *image)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    nvs_handle_t handle;
+    ret = nvs_open(BOOT_RECORD_NAMESPACE, NVS_READONLY, &handle);
+    if (ret != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t length = sizeof(*image);
+    ret = nvs_get_blob(handle, BOOT_RECORD_KEY, image, &length);
+    nvs_close(handle);
+
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (ret == ESP_OK && length != sizeof(*image)) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    return ret;
+}
+
+/**
+ * @brief Write (or erase, if image is NULL) the NVS copy
+ */
+static esp_err_t boot_record_write_nvs(const boot_record_image_t *image)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    nvs_handle_t handle;
+    ret = nvs_open(BOOT_RECORD_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (image) {
+        ret = nvs_set_blob(handle, BOOT_RECORD_KEY, image, sizeof(*image));
+    } else {
+        ret = nvs_erase_key(handle, BOOT_RECORD_KEY);
+        if (ret == ESP_ERR_NVS_NOT_FOUND) {
+            ret = ESP_OK;
+        }
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+
+    nvs_close(handle);
+    return ret;
+}
+
+bool boot_record_is_warm_boot(void)
+{
+    switch (esp_reset_reason()) {
+        case ESP_RST_DEEPSLEEP:
+        case ESP_RST_SW:
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t boot_record_config_hash(const sensor_interface_config_t *config)
+{
+    if (!config) {
+        return 0;
+    }
+
+    // FNV-1a over the fields that decide which devices exist where
+    uint32_t hash = fnv1a(2166136261u, &config->sensor_count, sizeof(config->sensor_count));
+    for (int i = 0; i < config->sensor_count; i++) {
+        const sensor_config_t *sensor = &config->sensors[i];
+        uint8_t fields[] = { (uint8_t)sensor->type, sensor->address, sensor->pin, sensor->enabled,
+                             sensor->mux_address, sensor->mux_channel };
+        hash = fnv1a(hash, fields, sizeof(fields));
+    }
+
+    uint8_t pins[] = { config->i2c_sda_pin, config->i2c_scl_pin, config->onewire_pin };
+    hash = fnv1a(hash, pins, sizeof(pins));
+    return fnv1a(hash, &config->i2c_frequency, sizeof(config->i2c_frequency));
+}
+
+esp_err_t boot_record_load(uint32_t config_hash, boot_record_t *record)
+{
+    if (!record) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // NVS copy: remembered so boot_record_save() can skip identical writes
+    boot_record_image_t image;
+    esp_err_t nvs_ret = boot_record_read_nvs(&image);
+    if (nvs_ret == ESP_OK) {
+        nvs_ret = boot_record_check(&image, config_hash);
+    }
+    if (nvs_ret == ESP_OK) {
+        g_nvs_record = image.record;
+        g_nvs_record_valid = true;
+    }
+
+    if (boot_record_is_warm_boot()) {
+        esp_err_t ret = boot_record_check(&g_rtc_image, config_hash);
+        if (ret == ESP_OK) {
+            *record = g_rtc_image.record;
+            ESP_LOGI(TAG, "Warm boot: using RTC boot record");
+            return ESP_OK;
+        }
+        ESP_LOGD(TAG, "RTC boot record unusable: %s", esp_err_to_name(ret));
+    }
+
+    if (nvs_ret != ESP_OK) {
+        ESP_LOGI(TAG, "No usable boot record (%s), running discovery", esp_err_to_name(nvs_ret));
+        return nvs_ret;
+    }
+
+    // Sensors were power-cycled: keep the topology, rebuild driver state
+    *record = g_nvs_record;
+    record->sensors.ready_mask = 0;
+    record->sensors.mismatch_mask = 0;
+    ESP_LOGI(TAG, "Using stored boot record");
+    return ESP_OK;
+}
+
+esp_err_t boot_record_save(const boot_record_t *record)
+{
+    if (!record) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    boot_record_pack(record, &g_rtc_image);
+
+    // NVS keeps topology only; skip the flash write when it is unchanged
+    if (g_nvs_record_valid && g_nvs_record.config_hash == record->config_hash &&
+        g_nvs_record.sensors.i2c_map_valid == record->sensors.i2c_map_valid &&
+        memcmp(&g_nvs_record.sensors.i2c_map, &record->sensors.i2c_map,
+               sizeof(record->sensors.i2c_map)) == 0) {
+        return ESP_OK;
+    }
+
+    boot_record_t topology = *record;
+    topology.sensors.ready_mask = 0;
+    topology.sensors.mismatch_mask = 0;
+
+    boot_record_image_t image;
+    boot_record_pack(&topology, &image);
+
+    esp_err_t ret = boot_record_write_nvs(&image);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to store boot record: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    g_nvs_record = topology;
+    g_nvs_record_valid = true;
+    ESP_LOGI(TAG, "Boot record stored");
+    return ESP_OK;
+}
+
+esp_err_t boot_record_invalidate(void)
+{
+    memset(&g_rtc_image, 0, sizeof(g_rtc_image));
+    g_nvs_record_valid = false;
+
+    esp_err_t ret = boot_record_write_nvs(NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to erase boot record: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Boot record invalidated, next boot runs discovery");
+    return ESP_OK;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file boot_record.h
+ * @brief Persisted Boot Record for Plant Monitoring System
+ *
+ * This module keeps the result of sensor discovery and bring-up across
+ * reboots so warm boots can skip the I2C scan and sensor settle delays.
+ *
+ * The record is stored twice:
+ * - in RTC memory, surviving deep sleep, watchdog and software resets,
+ *   together with the per-sensor driver state (sensors stay powered);
+ * - in NVS, surviving power cycles, with the I2C map only (the sensors
+ *   lost power, so their driver state must be rebuilt).
+ *
+ * Both copies carry a magic word, a version, a CRC and a hash of the
+ * sensor configuration. A record that fails any of these checks is
+ * ignored and full discovery runs.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef BOOT_RECORD_H
+#define BOOT_RECORD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sensor_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Boot record contents
+ */
+typedef struct {
+    uint32_t config_hash;         /**< boot_record_config_hash() of the sensor configuration */
+    sensor_boot_state_t sensors;  /**< Discovery map and sensor bring-up state */
+} boot_record_t;
+
+/**
+ * @brief Check whether the sensors kept power through the last reset
+ *
+ * @return true after deep sleep, watchdog, panic or software resets
+ */
+bool boot_record_is_warm_boot(void);
+
+/**
+ * @brief Hash the parts of a sensor configuration that affect discovery
+ *
+ * @param config Sensor interface configuration
+ * @return 32-bit configuration hash
+ */
+uint32_t boot_record_config_hash(const sensor_interface_config_t *config);
+
+/**
+ * @brief Load the boot record
+ *
+ * On a warm boot the RTC copy is preferred; otherwise the NVS copy is
+ * used with the driver state cleared.
+ *
+ * @param config_hash Hash of the current sensor configuration
+ * @param record Pointer to store the record
+ * @return ESP_OK if a valid record was found, ESP_ERR_NOT_FOUND if none
+ *         exists, ESP_ERR_INVALID_VERSION if it was made for another
+ *         configuration or firmware, ESP_ERR_INVALID_CRC if corrupted
+ */
+esp_err_t boot_record_load(uint32_t config_hash, boot_record_t *record);
+
+/**
+ * @brief Save the boot record
+ *
+ * The RTC copy is always updated. NVS is only written when the
+ * configuration hash or the I2C map changed, to limit flash wear.
+ *
+ * @param record Record to save
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t boot_record_save(const boot_record_t *record);
+
+/**
+ * @brief Invalidate both copies so the next boot runs full discovery
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t boot_record_invalidate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_RECORD_H
@@ -0,0 +1,974 @@
+/**
+ * @file duty_cycle.c
+ * @brief Deep-Sleep Duty-Cycle Mode Implementation
+ *
+ * The record ring lives in RTC slow memory together with a magic word, so
+ * a cold boot (which reloads RTC data from flash) starts with an empty
+ * buffer while deep-sleep wakeups keep appending to it. The rolling
+ * statistics of the buffered quantities, the soil drying trend and the
+ * daily light integral live there too, so they span many uploads, and
+ * so does the sensor fusion state, saved just before each deep sleep.
+ *
+ * Every sample also goes through an anomaly detector per quantity and
+ * the alert engine. Anomalies and alerts raised or cleared are reported
+ * at once in a small message of their own; the readings stay in the
+ * buffer until the batch is due. Each sensor keeps its own stuck-value,
+ * rate-limit and divergence state here as well; a field that only
+ * flagged sensors contributed to is uploaded with its quality but kept
+ * out of all of the above.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "duty_cycle.h"
+#include "uplink.h"
+#include "reading_history.h"
+#include "rolling_stats.h"
+#include "dry_predictor.h"
+#include "light_integral.h"
+#include "vpd.h"
+#include "anomaly_detector.h"
+#include "alert_engine.h"
+#include "sensor_diagnostics.h"
+#include "sensor_fusion.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "cJSON.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *TAG = "DUTY_CYCLE";
+
+/** Marks the RTC state as initialized ("DCYC") */
+#define DUTY_CYCLE_MAGIC         0x44435943
+
+/** Unreported alert transitions kept; the oldest are dropped beyond this */
+#define DUTY_CYCLE_MAX_TRANSITIONS  8
+
+/** Quantity of each record field, in DUTY_CYCLE_HAS_* bit order */
+static const history_quantity_t k_field_quantity[DUTY_CYCLE_FIELDS] = {
+    HISTORY_QTY_TEMPERATURE,
+    HISTORY_QTY_HUMIDITY,
+    HISTORY_QTY_SOIL_MOISTURE,
+    HISTORY_QTY_LIGHT_LEVEL,
+    HISTORY_QTY_LUX,
+};
+
+/**
+ * @brief Duty-cycle state kept in RTC memory across deep sleep
+ */
+typedef struct {
+    uint32_t magic;           /**< DUTY_CYCLE_MAGIC once initialized */
+    uint16_t head;            /**< Index of the oldest record */
+    uint16_t count;           /**< Number of buffered records */
+    uint16_t retry_countdown; /**< Samples left before retrying a failed upload */
+    uint8_t transition_count; /**< Number of unreported alert transitions */
+    uint8_t anomaly_mask;     /**< Quantities with an unreported anomaly */
+    uint32_t wakeups;         /**< Timer wakeups since the last cold boot */
+    uint32_t overwritten;     /**< Records lost because the buffer was full */
+    uint32_t stats_time;      /**< Timestamp of the newest record in the statistics */
+    duty_cycle_record_t records[DUTY_CYCLE_BUFFER_RECORDS]; /**< Record ring */
+    rolling_stats_t stats[HISTORY_QTY_COUNT]; /**< Rolling statistics per quantity */
+    dry_predictor_t dry;      /**< Soil drying trend */
+    light_integral_t light;   /**< Daily light integral */
+    anomaly_detector_t detectors[HISTORY_QTY_COUNT]; /**< Anomaly detector per quantity */
+    anomaly_event_t anomalies[HISTORY_QTY_COUNT];    /**< Newest unreported anomaly per quantity */
+    uint32_t anomaly_time[HISTORY_QTY_COUNT];        /**< Timestamps of the unreported anomalies */
+    alert_engine_t alerts;    /**< Alert state per rule */
+    alert_transition_t transitions[DUTY_CYCLE_MAX_TRANSITIONS]; /**< Unreported alert transitions, oldest first */
+    sensor_diag_state_t diagnostics[SENSOR_INTERFACE_MAX_SENSORS][2]; /**< Detector state per sensor and measured quantity */
+    uint8_t diagnostics_type[SENSOR_INTERFACE_MAX_SENSORS]; /**< Sensor type the detector state is for (SENSOR_TYPE_MAX = none) */
+    sensor_fusion_state_t fusion; /**< Fusion filters as of the last deep sleep */
+    uint32_t fusion_time;     /**< Time the fusion state was saved */
+    bool fusion_saved;        /**< fusion holds a saved state */
+    int32_t time_offset;      /**< Clock correction at the first time sync, for older timestamps */
+} duty_cycle_state_t;
+
+// Global variables
+RTC_DATA_ATTR static duty_cycle_state_t g_state;
+static bool g_initialized = false;
+
+/**
+ * @brief Convert a float to a saturated integer in the given range
+ */
+static int32_t clamp_round(float value, int32_t min, int32_t max)
+{
+    if (value <= (float)min) {
+        return min;
+    }
+    if (value >= (float)max) {
+        return max;
+    }
+    return (int32_t)(value + (value >= 0.0f ? 0.5f : -0.5f));
+}
+
+/**
+ * @brief Get the values of a record in the fixed-point encoding of the reading history
+ *
+ * Fields flagged stuck or rate-limited are left out, and so is the VPD
+ * when either of its inputs is.
+ *
+ * @param record Record to decode
+ * @param value Array to store the value per quantity in
+ * @return Quantities present in the record (bit n = quantity n)
+ */
+static uint8_t duty_cycle_record_values(const duty_cycle_record_t *record, int16_t value[HISTORY_QTY_COUNT])
+{
+    uint8_t good = record->flags & (uint8_t)~(record->stuck | record->rate);
+    uint8_t present = 0;
+    if (good & DUTY_CYCLE_HAS_TEMPERATURE) {
+        value[HISTORY_QTY_TEMPERATURE] = record->temperature_c100;
+        present |= 1 << HISTORY_QTY_TEMPERATURE;
+    }
+    if (good & DUTY_CYCLE_HAS_HUMIDITY) {
+        value[HISTORY_QTY_HUMIDITY] = (int16_t)record->humidity_c100;
+        present |= 1 << HISTORY_QTY_HUMIDITY;
+    }
+    if ((good & DUTY_CYCLE_HAS_TEMPERATURE) && (good & DUTY_CYCLE_HAS_HUMIDITY)) {
+        value[HISTORY_QTY_VPD] = (int16_t)vpd_air(record->temperature_c100, record->humidity_c100);
+        present |= 1 << HISTORY_QTY_VPD;
+    }
+    if (good & DUTY_CYCLE_HAS_SOIL_MOISTURE) {
+        value[HISTORY_QTY_SOIL_MOISTURE] = (int16_t)record->soil_moisture;
+        present |= 1 << HISTORY_QTY_SOIL_MOISTURE;
+    }
+    if (good & DUTY_CYCLE_HAS_LIGHT_LEVEL) {
+        value[HISTORY_QTY_LIGHT_LEVEL] = (int16_t)record->light_level;
+        present |= 1 << HISTORY_QTY_LIGHT_LEVEL;
+    }
+    if (good & DUTY_CYCLE_HAS_LUX) {
+        value[HISTORY_QTY_LUX] = reading_history_encode(HISTORY_QTY_LUX, record->lux);
+        present |= 1 << HISTORY_QTY_LUX;
+    }
+    return present;
+}
+
+/**
+ * @brief Add the values of a record to the rolling statistics
+ */
+static void duty_cycle_update_stats(const duty_cycle_record_t *record, const int16_t *value, uint8_t present)
+{
+    uint32_t time_s = record->timestamp;
+    for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+        if ((present >> q) & 1) {
+            rolling_stats_update(&g_state.stats[q], value[q], time_s);
+        }
+    }
+    if ((present >> HISTORY_QTY_SOIL_MOISTURE) & 1) {
+        dry_predictor_update(&g_state.dry, (int16_t)record->soil_moisture, time_s);
+    }
+    if ((present >> HISTORY_QTY_LUX) & 1) {
+        light_integral_update(&g_state.light, record->lux, time_s);
+    }
+    g_state.stats_time = time_s;
+}
+
+/**
+ * @brief Run the values of a record through the anomaly detectors
+ *
+ * @return true if a quantity fired
+ */
+static bool duty_cycle_check_anomalies(const duty_cycle_record_t *record, const int16_t *value, uint8_t present)
+{
+    bool fired = false;
+    for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+        if (!((present >> q) & 1) ||
+            !anomaly_detector_update(&g_state.detectors[q], value[q], &g_state.anomalies[q])) {
+            continue;
+        }
+        g_state.anomaly_time[q] = record->timestamp;
+        g_state.anomaly_mask |= (uint8_t)(1 << q);
+        fired = true;
+        ESP_LOGW(TAG, "Anomalous %s: %.2f (average %.2f, z %.1f)",
+                 reading_history_quantity_name((history_quantity_t)q),
+                 reading_history_decode((history_quantity_t)q, value[q]),
+                 reading_history_decode((history_quantity_t)q, g_state.anomalies[q].mean),
+                 g_state.anomalies[q].z / 100.0f);
+    }
+    return fired;
+}
+
+/**
+ * @brief Run the values of a record through the alert engine
+ *
+ * @return true if an alert was raised or cleared
+ */
+static bool duty_cycle_check_alerts(const duty_cycle_record_t *record, const int16_t *value, uint8_t present)
+{
+    int rule_count = 0;
+    const alert_rule_t *rules = alert_engine_default_rules(&rule_count);
+    alert_transition_t transitions[ALERT_ENGINE_MAX_RULES];
+    int count = 0;
+
+    for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+        if ((present >> q) & 1) {
+            count += alert_engine_update(&g_state.alerts, rules, rule_count, (history_quantity_t)q, value[q],
+                                         record->timestamp, &transitions[count], ALERT_ENGINE_MAX_RULES - count);
+        }
+    }
+
+    for (int i = 0; i < count && i < ALERT_ENGINE_MAX_RULES; i++) {
+        const alert_rule_t *rule = &rules[transitions[i].rule];
+        ESP_LOGW(TAG, "Alert %s %s: %.2f", rule->name, transitions[i].raised ? "raised" : "cleared",
+                 reading_history_decode((history_quantity_t)rule->quantity, transitions[i].value));
+
+        if (g_state.transition_count == DUTY_CYCLE_MAX_TRANSITIONS) {
+            memmove(&g_state.transitions[0], &g_state.transitions[1],
+                    (DUTY_CYCLE_MAX_TRANSITIONS - 1) * sizeof(g_state.transitions[0]));
+            g_state.transition_count--;
+        }
+        g_state.transitions[g_state.transition_count++] = transitions[i];
+    }
+    return count > 0;
+}
+
+/**
+ * @brief Timestamp in wall-clock seconds, correcting ones taken before the clock was set
+ */
+static int64_t duty_cycle_wall_time(uint32_t timestamp)
+{
+    return timestamp < UPLINK_MIN_VALID_EPOCH ? (int64_t)timestamp + g_state.time_offset : timestamp;
+}
+
+/**
+ * @brief Add the unreported anomalies to a document
+ *
+ * @param root Batch or urgent document
+ */
+static void duty_cycle_add_anomalies(cJSON *root)
+{
+    if (g_state.anomaly_mask == 0) {
+        return;
+    }
+
+    cJSON *anomalies = cJSON_AddArrayToObject(root, "anomalies");
+    for (int q = 0; anomalies && q < HISTORY_QTY_COUNT; q++) {
+        if (!((g_state.anomaly_mask >> q) & 1)) {
+            continue;
+        }
+
+        const anomaly_event_t *event = &g_state.anomalies[q];
+        history_quantity_t quantity = (history_quantity_t)q;
+        cJSON *item = cJSON_CreateObject();
+        if (!item) {
+            return;
+        }
+        cJSON_AddStringToObject(item, "quantity", reading_history_quantity_name(quantity));
+        cJSON_AddNumberToObject(item, "timestamp", (double)duty_cycle_wall_time(g_state.anomaly_time[q]));
+        cJSON_AddNumberToObject(item, "value", reading_history_decode(quantity, event->value));
+        cJSON_AddNumberToObject(item, "mean", reading_history_decode(quantity, event->mean));
+        cJSON_AddNumberToObject(item, "z", event->z / 100.0);
+        cJSON_AddItemToArray(anomalies, item);
+    }
+}
+
+/**
+ * @brief Add the unreported alert transitions to a document
+ *
+ * @param root Batch or urgent document
+ */
+static void duty_cycle_add_alerts(cJSON *root)
+{
+    if (g_state.transition_count == 0) {
+        return;
+    }
+
+    int rule_count = 0;
+    const alert_rule_t *rules = alert_engine_default_rules(&rule_count);
+    cJSON *alerts = cJSON_AddArrayToObject(root, "alerts");
+    for (int i = 0; alerts && i < g_state.transition_count; i++) {
+        const alert_transition_t *transition = &g_state.transitions[i];
+        if (transition->rule >= rule_count) {
+            continue;
+        }
+
+        const alert_rule_t *rule = &rules[transition->rule];
+        history_quantity_t quantity = (history_quantity_t)rule->quantity;
+        cJSON *item = cJSON_CreateObject();
+        if (!item) {
+            return;
+        }
+        cJSON_AddStringToObject(item, "type", rule->name);
+        cJSON_AddStringToObject(item, "quantity", reading_history_quantity_name(quantity));
+        cJSON_AddStringToObject(item, "state", transition->raised ? "raised" : "cleared");
+        cJSON_AddStringToObject(item, "severity", alert_engine_severity_name((alert_severity_t)rule->severity));
+        cJSON_AddNumberToObject(item, "timestamp", (double)duty_cycle_wall_time(transition->timestamp));
+        cJSON_AddNumberToObject(item, "value", reading_history_decode(quantity, transition->value));
+        cJSON_AddNumberToObject(item, "threshold", reading_history_decode(quantity, rule->threshold));
+        cJSON_AddNumberToObject(item, "peak", reading_history_decode(quantity, transition->peak));
+        cJSON_AddItemToArray(alerts, item);
+    }
+}
+
+/**
+ * @brief Number of records to buffer before an upload
+ *
+ * Shrinks linearly from DUTY_CYCLE_FLUSH_RECORDS at the prediction
+ * horizon to a single record at the urgent limit, so the server sees a
+ * drying pot more and more often.
+ */
+static int duty_cycle_flush_records(void)
+{
+    float hours = duty_cycle_hours_to_dry();
+    if (hours < 0.0f || hours >= DRY_PREDICTOR_HORIZON_HOURS) {
+        return DUTY_CYCLE_FLUSH_RECORDS;
+    }
+    if (hours <= DRY_PREDICTOR_URGENT_HOURS) {
+        return 1;
+    }
+
+    float fraction = (hours - DRY_PREDICTOR_URGENT_HOURS) / (DRY_PREDICTOR_HORIZON_HOURS - DRY_PREDICTOR_URGENT_HOURS);
+    return 1 + (int)(fraction * (DUTY_CYCLE_FLUSH_RECORDS - 1));
+}
+
+/**
+ * @brief Add the rolling statistics of every quantity and window to a batch
+ *
+ * @param root Batch document
+ * @param timestamp Time the statistics refer to (wall-clock seconds)
+ */
+static void duty_cycle_add_stats(cJSON *root, int64_t timestamp)
+{
+    cJSON *statistics = cJSON_AddArrayToObject(root, "statistics");
+    for (int q = 0; statistics && q < HISTORY_QTY_COUNT; q++) {
+        history_quantity_t quantity = (history_quantity_t)q;
+        float scale = reading_history_scale(quantity);
+
+        for (int w = 0; w < ROLLING_STATS_WINDOWS; w++) {
+            rolling_summary_t summary;
+            if (!rolling_stats_summary(&g_state.stats[q], w, g_state.stats_time, &summary)) {
+                continue;
+            }
+
+            cJSON *item = cJSON_CreateObject();
+            if (!item) {
+                return;
+            }
+            cJSON_AddStringToObject(item, "quantity", reading_history_quantity_name(quantity));
+            cJSON_AddNumberToObject(item, "window_s", rolling_stats_window_seconds(w));
+            cJSON_AddNumberToObject(item, "timestamp", (double)timestamp);
+            cJSON_AddNumberToObject(item, "count", summary.count);
+            cJSON_AddNumberToObject(item, "mean", summary.mean / scale);
+            cJSON_AddNumberToObject(item, "stddev", summary.stddev / scale);
+            cJSON_AddNumberToObject(item, "min", summary.min / scale);
+            cJSON_AddNumberToObject(item, "max", summary.max / scale);
+            cJSON_AddItemToArray(statistics, item);
+        }
+    }
+}
+
+/**
+ * @brief Add the quality of a record's flagged fields to its batch item
+ *
+ * Adds e.g. "quality": {"temperature": ["stuck"]}; nothing when no field
+ * was flagged.
+ *
+ * @param item Batch item of the record
+ * @param record Record
+ */
+static void duty_cycle_add_quality(cJSON *item, const duty_cycle_record_t *record)
+{
+    if (!(record->stuck | record->rate)) {
+        return;
+    }
+
+    cJSON *quality = cJSON_AddObjectToObject(item, "quality");
+    for (int f = 0; quality && f < DUTY_CYCLE_FIELDS; f++) {
+        if (!(((record->stuck | record->rate) >> f) & 1)) {
+            continue;
+        }
+
+        cJSON *flags = cJSON_AddArrayToObject(quality, reading_history_quantity_name(k_field_quantity[f]));
+        if (!flags) {
+            return;
+        }
+        if ((record->stuck >> f) & 1) {
+            cJSON_AddItemToArray(flags, cJSON_CreateString("stuck"));
+        }
+        if ((record->rate >> f) & 1) {
+            cJSON_AddItemToArray(flags, cJSON_CreateString("rate"));
+        }
+    }
+}
+
+/**
+ * @brief Build the batch upload document for all buffered records
+ *
+ * @return Newly allocated JSON string (caller frees), or NULL on failure
+ */
+static char *duty_cycle_build_batch(void)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (!root) {
+        return NULL;
+    }
+
+    cJSON_AddStringToObject(root, "device_id", DEVICE_ID);
+    cJSON *readings = cJSON_AddArrayToObject(root, "readings");
+
+    // The prediction and the light so far today are as of the newest record
+    float hours_to_dry = duty_cycle_hours_to_dry();
+    light_summary_t light;
+    bool has_light = light_integral_today(&g_state.light, &light);
+
+    for (int i = 0; readings && i < g_state.count; i++) {
+        const duty_cycle_record_t *record = &g_state.records[(g_state.head + i) % DUTY_CYCLE_BUFFER_RECORDS];
+        int64_t timestamp = duty_cycle_wall_time(record->timestamp);
+
+        cJSON *item = cJSON_CreateObject();
+        if (!item) {
+            break;
+        }
+        cJSON_AddStringToObject(item, "device_id", DEVICE_ID);
+        cJSON_AddNumberToObject(item, "timestamp", (double)timestamp);
+        if (record->flags & DUTY_CYCLE_HAS_TEMPERATURE) {
+            cJSON_AddNumberToObject(item, "temperature", record->temperature_c100 / 100.0);
+        }
+        if (record->flags & DUTY_CYCLE_HAS_HUMIDITY) {
+            cJSON_AddNumberToObject(item, "humidity", record->humidity_c100 / 100.0);
+        }
+        // No VPD from a suspect temperature or humidity
+        uint8_t good = record->flags & (uint8_t)~(record->stuck | record->rate);
+        if ((good & DUTY_CYCLE_HAS_TEMPERATURE) && (good & DUTY_CYCLE_HAS_HUMIDITY)) {
+            cJSON_AddNumberToObject(item, "vpd", vpd_air(record->temperature_c100, record->humidity_c100) / 1000.0);
+            cJSON_AddNumberToObject(item, "dew_point",
+                                    vpd_dew_point(record->temperature_c100, record->humidity_c100) / 100.0);
+        }
+        if (record->flags & DUTY_CYCLE_HAS_SOIL_MOISTURE) {
+            cJSON_AddNumberToObject(item, "soil_moisture", record->soil_moisture);
+        }
+        if (record->flags & DUTY_CYCLE_HAS_LIGHT_LEVEL) {
+            cJSON_AddNumberToObject(item, "light_level", record->light_level);
+        }
+        if (record->flags & DUTY_CYCLE_HAS_LUX) {
+            cJSON_AddNumberToObject(item, "lux", record->lux);
+            cJSON_AddNumberToObject(item, "ppfd", light_integral_ppfd(&g_state.light, record->lux));
+        }
+        cJSON_AddNumberToObject(item, "health_score", record->health_score);
+        duty_cycle_add_quality(item, record);
+        if (i == g_state.count - 1 && hours_to_dry >= 0.0f) {
+            cJSON_AddNumberToObject(item, "hours_to_dry", hours_to_dry);
+        }
+        if (i == g_state.count - 1 && has_light) {
+            cJSON_AddNumberToObject(item, "dli", light.dli);
+            cJSON_AddNumberToObject(item, "photoperiod_h", light.photoperiod_h);
+        }
+        cJSON_AddItemToArray(readings, item);
+    }
+
+    duty_cycle_add_stats(root, duty_cycle_wall_time(g_state.stats_time));
+    duty_cycle_add_anomalies(root);
+    duty_cycle_add_alerts(root);
+
+    char *json = readings ? cJSON_PrintUnformatted(root) : NULL;
+    cJSON_Delete(root);
+    return json;
+}
+
+/**
+ * @brief Build the urgent document for the unreported anomalies and alerts
+ *
+ * @return Newly allocated JSON string (caller frees), or NULL on failure
+ */
+static char *duty_cycle_build_urgent(void)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (!root) {
+        return NULL;
+    }
+
+    cJSON_AddStringToObject(root, "device_id", DEVICE_ID);
+    duty_cycle_add_anomalies(root);
+    duty_cycle_add_alerts(root);
+
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return json;
+}
+
+/**
+ * @brief Bring WiFi up, set the clock if needed, post one document and shut WiFi down
+ *
+ * @param url Endpoint URL
+ * @param build Builds the document once the clock is known
+ * @return ESP_OK on success, error code on failure
+ */
+static esp_err_t duty_cycle_post(const char *url, char *(*build)(void))
+{
+    esp_err_t ret = uplink_connect(WIFI_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Records taken before the clock was first set carry time since
+    // boot; the RTC keeps counting through deep sleep, so shifting them
+    // by the correction applied at sync time restores wall-clock time.
+    if (!uplink_clock_is_valid()) {
+        time_t before = time(NULL);
+        ret = uplink_sync_time(WIFI_TIMEOUT_MS);
+        if (ret == ESP_OK) {
+            g_state.time_offset = (int32_t)(time(NULL) - before);
+        }
+    }
+
+    if (ret == ESP_OK) {
+        char *json = build();
+        ret = json ? uplink_post_json(url, json) : ESP_ERR_NO_MEM;
+        free(json);
+    }
+
+    uplink_disconnect();
+    return ret;
+}
+
+/**
+ * @brief Fill the detector limits of one measured quantity
+ */
+static void duty_cycle_limits(history_quantity_t quantity, uint16_t stuck_samples, float max_rate,
+                              float max_divergence, sensor_diag_limits_t *limits)
+{
+    limits->stuck_samples = stuck_samples;
+    limits->max_rate = reading_history_encode(quantity, max_rate);
+    limits->max_divergence = reading_history_encode(quantity, max_divergence);
+    limits->zero_may_stick = (quantity == HISTORY_QTY_LUX || quantity == HISTORY_QTY_LIGHT_LEVEL);
+}
+
+/**
+ * @brief Get the quantities a sensor type measures and their detector limits
+ *
+ * Same limits as the diagnostics in continuous mode: soil moisture and
+ * light jump legitimately, so only temperature and humidity are
+ * rate-limited, and only the air sensors are compared with each other.
+ *
+ * @param type Sensor type
+ * @param quantity Array to store the measured quantities in
+ * @param limits Array to store their detector limits in
+ * @return Number of measured quantities (0-2)
+ */
+static int duty_cycle_sensor_quantities(sensor_type_t type, history_quantity_t quantity[2],
+                                        sensor_diag_limits_t limits[2])
+{
+    switch (type) {
+        case SENSOR_TYPE_AHT10:
+        case SENSOR_TYPE_DHT11:
+        case SENSOR_TYPE_DHT22:
+            quantity[0] = HISTORY_QTY_TEMPERATURE;
+            quantity[1] = HISTORY_QTY_HUMIDITY;
+            duty_cycle_limits(quantity[0], SENSOR_DIAG_STUCK_SAMPLES, SENSOR_DIAG_AIR_TEMP_RATE,
+                              SENSOR_DIAG_TEMP_DIVERGENCE, &limits[0]);
+            duty_cycle_limits(quantity[1], SENSOR_DIAG_STUCK_SAMPLES, SENSOR_DIAG_HUMIDITY_RATE,
+                              SENSOR_DIAG_HUMIDITY_DIVERGENCE, &limits[1]);
+            return 2;
+        case SENSOR_TYPE_DS18B20:
+            quantity[0] = HISTORY_QTY_TEMPERATURE;
+            duty_cycle_limits(quantity[0], SENSOR_DIAG_COARSE_STUCK_SAMPLES, SENSOR_DIAG_SOIL_TEMP_RATE, 0.0f,
+                              &limits[0]);
+            return 1;
+        case SENSOR_TYPE_GY302:
+            quantity[0] = HISTORY_QTY_LUX;
+            duty_cycle_limits(quantity[0], SENSOR_DIAG_COARSE_STUCK_SAMPLES, 0.0f, 0.0f, &limits[0]);
+            return 1;
+        case SENSOR_TYPE_SOIL_MOISTURE:
+            quantity[0] = HISTORY_QTY_SOIL_MOISTURE;
+            duty_cycle_limits(quantity[0], SENSOR_DIAG_STUCK_SAMPLES, 0.0f, 0.0f, &limits[0]);
+            return 1;
+        case SENSOR_TYPE_LIGHT:
+            quantity[0] = HISTORY_QTY_LIGHT_LEVEL;
+            duty_cycle_limits(quantity[0], SENSOR_DIAG_COARSE_STUCK_SAMPLES, 0.0f, 0.0f, &limits[0]);
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Get the value of one quantity of a reading
+ */
+static float duty_cycle_reading_value(const sensor_reading_t *reading, history_quantity_t quantity)
+{
+    switch (quantity) {
+        case HISTORY_QTY_TEMPERATURE:
+            return reading->temperature;
+        case HISTORY_QTY_HUMIDITY:
+            return reading->humidity;
+        case HISTORY_QTY_SOIL_MOISTURE:
+            return reading->soil_moisture;
+        case HISTORY_QTY_LIGHT_LEVEL:
+            return reading->light_level;
+        case HISTORY_QTY_LUX:
+            return reading->lux;
+        default:
+            return 0.0f;
+    }
+}
+
+esp_err_t duty_cycle_init(void)
+{
+    if (g_initialized) {
+        return ESP_OK;
+    }
+
+    if (g_state.magic != DUTY_CYCLE_MAGIC || g_state.count > DUTY_CYCLE_BUFFER_RECORDS ||
+        g_state.head >= DUTY_CYCLE_BUFFER_RECORDS) {
+        memset(&g_state, 0, sizeof(g_state));
+        g_state.magic = DUTY_CYCLE_MAGIC;
+        light_integral_init(&g_state.light, light_integral_find_spectrum(LIGHT_SPECTRUM), LIGHT_UTC_OFFSET_MIN * 60);
+        for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+            anomaly_detector_init(&g_state.detectors[q], (history_quantity_t)q);
+        }
+        alert_engine_init(&g_state.alerts);
+        memset(g_state.diagnostics_type, SENSOR_TYPE_MAX, sizeof(g_state.diagnostics_type));
+        ESP_LOGI(TAG, "Duty-cycle buffer reset (%d records, %d s interval)",
+                 DUTY_CYCLE_BUFFER_RECORDS, DUTY_CYCLE_SLEEP_SECONDS);
+    }
+
+    if (duty_cycle_is_timer_wakeup()) {
+        g_state.wakeups++;
+    }
+
+    g_initialized = true;
+    return ESP_OK;
+}
+
+bool duty_cycle_is_timer_wakeup(void)
+{
+    return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+}
+
+void duty_cycle_diagnose(const sensor_config_t *sensors, sensor_reading_t *readings, int count)
+{
+    if (!sensors || !readings || count < 0) {
+        return;
+    }
+
+    if (!g_initialized) {
+        duty_cycle_init();
+    }
+
+    if (count > SENSOR_INTERFACE_MAX_SENSORS) {
+        count = SENSOR_INTERFACE_MAX_SENSORS;
+    }
+
+    // Air sensors compared with each other: [0] temperature, [1] humidity
+    sensor_diag_state_t *siblings[2][SENSOR_INTERFACE_MAX_SENSORS];
+    int16_t samples[2][SENSOR_INTERFACE_MAX_SENSORS];
+    int members[2][SENSOR_INTERFACE_MAX_SENSORS];
+    int sibling_count[2] = {0, 0};
+
+    // Millisecond time wraps every 49 days, far longer than a sampling period
+    uint32_t time_ms = (uint32_t)time(NULL) * 1000U;
+    for (int i = 0; i < count; i++) {
+        history_quantity_t quantity[2];
+        sensor_diag_limits_t limits[2];
+        int quantities = duty_cycle_sensor_quantities(sensors[i].type, quantity, limits);
+
+        // A new or replaced sensor starts from scratch
+        if (g_state.diagnostics_type[i] != (uint8_t)sensors[i].type) {
+            for (int k = 0; k < quantities; k++) {
+                sensor_diagnostics_state_init(&g_state.diagnostics[i][k], &limits[k]);
+            }
+            g_state.diagnostics_type[i] = (uint8_t)sensors[i].type;
+        }
+
+        if (!sensors[i].enabled || !readings[i].valid) {
+            continue;
+        }
+
+        for (int k = 0; k < quantities; k++) {
+            sensor_diag_state_t *state = &g_state.diagnostics[i][k];
+            int16_t raw = reading_history_encode(quantity[k], duty_cycle_reading_value(&readings[i], quantity[k]));
+            uint8_t diag = sensor_diagnostics_update(state, raw, time_ms);
+            if (diag & SENSOR_DIAG_STUCK) {
+                readings[i].quality_flags |= SENSOR_QUALITY_STUCK;
+            }
+            if (diag & SENSOR_DIAG_RATE) {
+                readings[i].quality_flags |= SENSOR_QUALITY_RATE;
+            }
+
+            if (state->limits.max_divergence > 0) {
+                int group = (quantity[k] == HISTORY_QTY_HUMIDITY);
+                int n = sibling_count[group]++;
+                siblings[group][n] = state;
+                samples[group][n] = raw;
+                members[group][n] = i;
+            }
+        }
+    }
+
+    for (int group = 0; group < 2; group++) {
+        uint8_t flags[SENSOR_INTERFACE_MAX_SENSORS] = {0};
+        sensor_diagnostics_compare_states(siblings[group], samples[group], sibling_count[group], flags);
+        for (int n = 0; n < sibling_count[group]; n++) {
+            if (flags[n] & SENSOR_DIAG_DIVERGENT) {
+                readings[members[group][n]].quality_flags |= SENSOR_QUALITY_DIVERGENT;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Take a reading into a single-sensor record field
+ *
+ * The first valid reading fills the field. A later one only replaces it
+ * when the field came from a stuck or rate-limited sensor and the new
+ * reading did not. The field's stuck and rate bits follow the reading
+ * it holds.
+ *
+ * @param record Record being packed
+ * @param field DUTY_CYCLE_HAS_* bit of the field
+ * @param quality_flags SENSOR_QUALITY_* flags of the reading
+ * @return true if the caller should store the reading's value
+ */
+static bool duty_cycle_take_field(duty_cycle_record_t *record, uint8_t field, uint8_t quality_flags)
+{
+    bool suspect = (record->stuck | record->rate) & field;
+    if ((record->flags & field) && !(suspect && !(quality_flags & SENSOR_QUALITY_SUSPECT))) {
+        return false;
+    }
+
+    record->flags |= field;
+    record->stuck &= (uint8_t)~field;
+    record->rate &= (uint8_t)~field;
+    if (quality_flags & SENSOR_QUALITY_STUCK) {
+        record->stuck |= field;
+    }
+    if (quality_flags & SENSOR_QUALITY_RATE) {
+        record->rate |= field;
+    }
+    return true;
+}
+
+esp_err_t duty_cycle_pack_record(const sensor_config_t *sensors, const sensor_reading_t *readings,
+                                 int count, float health_score, duty_cycle_record_t *record)
+{
+    if (!sensors || !readings || !record || count < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!g_initialized) {
+        duty_cycle_init();
+    }
+
+    memset(record, 0, sizeof(*record));
+    record->timestamp = (uint32_t)time(NULL);
+    record->health_score = (uint8_t)clamp_round(health_score, 0, 100);
+
+    // Air means over the sensors that passed their checks [0] and the flagged ones [1]
+    float temperature[2] = {0.0f, 0.0f};
+    float humidity[2] = {0.0f, 0.0f};
+    int air_readings[2] = {0, 0};
+    uint8_t air_quality = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (!sensors[i].enabled || !readings[i].valid) {
+            continue;
+        }
+
+        uint8_t quality = readings[i].quality_flags;
+        switch (sensors[i].type) {
+            case SENSOR_TYPE_AHT10: {
+                int suspect = (quality & SENSOR_QUALITY_SUSPECT) != 0;
+                temperature[suspect] += readings[i].temperature;
+                humidity[suspect] += readings[i].humidity;
+                air_readings[suspect]++;
+                if (suspect) {
+                    air_quality |= quality;
+                }
+                break;
+            }
+
+            case SENSOR_TYPE_SOIL_MOISTURE:
+                if (duty_cycle_take_field(record, DUTY_CYCLE_HAS_SOIL_MOISTURE, quality)) {
+                    record->soil_moisture = readings[i].soil_moisture;
+                }
+                break;
+
+            case SENSOR_TYPE_LIGHT:
+                if (duty_cycle_take_field(record, DUTY_CYCLE_HAS_LIGHT_LEVEL, quality)) {
+                    record->light_level = readings[i].light_level;
+                }
+                break;
+
+            case SENSOR_TYPE_GY302:
+                if (duty_cycle_take_field(record, DUTY_CYCLE_HAS_LUX, quality)) {
+                    record->lux = (uint16_t)clamp_round(readings[i].lux, 0, UINT16_MAX);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    // Flagged air sensors only count when no other one is left
+    int used = (air_readings[0] > 0) ? 0 : 1;
+    if (air_readings[used] > 0) {
+        float air_temperature = temperature[used] / air_readings[used];
+        float air_humidity = humidity[used] / air_readings[used];
+
+        // Prefer the fused estimates when this cycle's readings reached them
+        // (fusion counts the flagged sensors as misses)
+        fusion_estimate_t estimate;
+        if (sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate) && estimate.sources > 0) {
+            air_temperature = estimate.value;
+        }
+        if (sensor_fusion_get(FUSION_AIR_HUMIDITY, &estimate) && estimate.sources > 0) {
+            air_humidity = estimate.value;
+        }
+
+        record->temperature_c100 = (int16_t)clamp_round(air_temperature * 100.0f, INT16_MIN, INT16_MAX);
+        record->humidity_c100 = (uint16_t)clamp_round(air_humidity * 100.0f, 0, 10000);
+        record->flags |= DUTY_CYCLE_HAS_TEMPERATURE | DUTY_CYCLE_HAS_HUMIDITY;
+        if (used && (air_quality & SENSOR_QUALITY_STUCK)) {
+            record->stuck |= DUTY_CYCLE_HAS_TEMPERATURE | DUTY_CYCLE_HAS_HUMIDITY;
+        }
+        if (used && (air_quality & SENSOR_QUALITY_RATE)) {
+            record->rate |= DUTY_CYCLE_HAS_TEMPERATURE | DUTY_CYCLE_HAS_HUMIDITY;
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t duty_cycle_append(const duty_cycle_record_t *record, bool *flush_due, bool *urgent_due)
+{
+    if (!record) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!g_initialized) {
+        duty_cycle_init();
+    }
+
+    if (g_state.count == DUTY_CYCLE_BUFFER_RECORDS) {
+        g_state.head = (g_state.head + 1) % DUTY_CYCLE_BUFFER_RECORDS;
+        g_state.count--;
+        g_state.overwritten++;
+    }
+
+    g_state.records[(g_state.head + g_state.count) % DUTY_CYCLE_BUFFER_RECORDS] = *record;
+    g_state.count++;
+
+    int16_t value[HISTORY_QTY_COUNT];
+    uint8_t present = duty_cycle_record_values(record, value);
+    duty_cycle_update_stats(record, value, present);
+    bool anomaly = duty_cycle_check_anomalies(record, value, present);
+    bool alert = duty_cycle_check_alerts(record, value, present);
+
+    if (g_state.retry_countdown > 0) {
+        g_state.retry_countdown--;
+    }
+
+    if (flush_due) {
+        *flush_due = g_state.retry_countdown == 0 && g_state.count >= duty_cycle_flush_records();
+    }
+    if (urgent_due) {
+        // Only alerts raised or cleared are sent, not every sample while
+        // a condition persists
+        *urgent_due = (ANOMALY_ENABLED && anomaly) || (ALERT_ENGINE_ENABLED && alert);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t duty_cycle_flush(void)
+{
+    if (!g_initialized) {
+        duty_cycle_init();
+    }
+
+    if (g_state.count == 0) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = duty_cycle_post(SERVER_BATCH_URL, duty_cycle_build_batch);
+    if (ret != ESP_OK) {
+        g_state.retry_countdown = DUTY_CYCLE_FLUSH_RECORDS;
+        ESP_LOGW(TAG, "Upload of %d records failed (%s), retrying after %d more samples",
+                 g_state.count, esp_err_to_name(ret), DUTY_CYCLE_FLUSH_RECORDS);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Uploaded %d records (%lu overwritten since last upload)",
+             g_state.count, (unsigned long)g_state.overwritten);
+    g_state.head = 0;
+    g_state.count = 0;
+    g_state.overwritten = 0;
+    g_state.retry_countdown = 0;
+    g_state.anomaly_mask = 0;
+    g_state.transition_count = 0;
+    return ESP_OK;
+}
+
+esp_err_t duty_cycle_send_urgent(void)
+{
+    if (!g_initialized) {
+        duty_cycle_init();
+    }
+
+    if (g_state.anomaly_mask == 0 && g_state.transition_count == 0) {
+        return ESP_OK;
+    }
+
+    // On failure the anomalies and alerts stay pending and go out with the next batch
+    esp_err_t ret = duty_cycle_post(SERVER_URGENT_URL, duty_cycle_build_urgent);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Urgent upload failed (%s), left for the next batch", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Reported anomalies (mask 0x%02x) and %d alert transitions",
+             g_state.anomaly_mask, g_state.transition_count);
+    g_state.anomaly_mask = 0;
+    g_state.transition_count = 0;
+    return ESP_OK;
+}
+
+bool duty_cycle_restore_fusion(void)
+{
+    if (!g_initialized) {
+        duty_cycle_init();
+    }
+
+    if (!g_state.fusion_saved || !sensor_fusion_restore(&g_state.fusion)) {
+        return false;
+    }
+
+    // The RTC clock keeps counting through deep sleep
+    uint32_t now = (uint32_t)time(NULL);
+    sensor_fusion_predict(now > g_state.fusion_time ? (float)(now - g_state.fusion_time) : 0.0f);
+    return true;
+}
+
+int duty_cycle_get_count(void)
+{
+    return g_state.count;
+}
+
+float duty_cycle_hours_to_dry(void)
+{
+    return dry_predictor_hours(&g_state.dry, DRY_PREDICTOR_THRESHOLD, g_state.stats_time);
+}
+
+void duty_cycle_enter_sleep(void)
+{
+    // Keep a fixed sampling period by subtracting the time spent awake
+    uint64_t period_us = (uint64_t)DUTY_CYCLE_SLEEP_SECONDS * 1000000ULL;
+    uint64_t awake_us = (uint64_t)esp_timer_get_time();
+    uint64_t sleep_us = awake_us < period_us ? period_us - awake_us : period_us;
+
+    sensor_fusion_save(&g_state.fusion);
+    g_state.fusion_time = (uint32_t)time(NULL);
+    g_state.fusion_saved = true;
+
+    ESP_LOGI(TAG, "Entering deep sleep for %llu ms (%d records buffered)",
+             (unsigned long long)(sleep_us / 1000), g_state.count);
+
+    esp_sleep_enable_timer_wakeup(sleep_us);
+    esp_deep_sleep_start();
+}
@@ -0,0 +1,195 @@
+/**
+ * @file duty_cycle.h
+ * @brief Deep-Sleep Duty-Cycle Mode for Plant Monitoring System
+ *
+ * In duty-cycle mode the device wakes on a timer, takes one sample,
+ * appends a compact record to a ring buffer in RTC memory and goes back
+ * to deep sleep. WiFi is only brought up to upload the buffered records
+ * once DUTY_CYCLE_FLUSH_RECORDS have accumulated. While the soil is
+ * predicted to dry out within DRY_PREDICTOR_HORIZON_HOURS, fewer records
+ * are needed for an upload. A sample the anomaly detectors flag, and an
+ * alert the alert engine raises or clears, is reported at once in a
+ * small message of its own, leaving the batch schedule as it is.
+ *
+ * Every sensor's readings also go through the stuck-value, rate-limit
+ * and divergence detectors of the sensor diagnostics, whose state is
+ * kept in RTC memory per sensor, before fusion and health scoring. A
+ * record field only stuck or rate-limited sensors contributed to is
+ * still uploaded, marked in the record's quality, but is left out of
+ * the statistics, the VPD, the anomaly detectors and the alerts.
+ *
+ * The ring buffer survives deep sleep but not a power cycle.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef DUTY_CYCLE_H
+#define DUTY_CYCLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "config.h"
+#include "sensor_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Valid-field flags of a duty-cycle record
+ */
+#define DUTY_CYCLE_HAS_TEMPERATURE   (1 << 0)
+#define DUTY_CYCLE_HAS_HUMIDITY      (1 << 1)
+#define DUTY_CYCLE_HAS_SOIL_MOISTURE (1 << 2)
+#define DUTY_CYCLE_HAS_LIGHT_LEVEL   (1 << 3)
+#define DUTY_CYCLE_HAS_LUX           (1 << 4)
+#define DUTY_CYCLE_FIELDS            5
+
+/**
+ * @brief Compact sample record stored in RTC memory (20 bytes)
+ */
+typedef struct {
+    uint32_t timestamp;       /**< Seconds since the epoch (or since boot if the clock was never set) */
+    int16_t temperature_c100; /**< Air temperature in 0.01 °C */
+    uint16_t humidity_c100;   /**< Relative humidity in 0.01 % */
+    uint16_t soil_moisture;   /**< Soil moisture ADC value (0-4095) */
+    uint16_t light_level;     /**< Light level ADC value (0-4095) */
+    uint16_t lux;             /**< Light intensity in lux (saturates at 65535) */
+    uint8_t health_score;     /**< Plant health score (0-100) */
+    uint8_t flags;            /**< DUTY_CYCLE_HAS_* flags */
+    uint8_t stuck;            /**< Fields whose value looks stuck (DUTY_CYCLE_HAS_* bits) */
+    uint8_t rate;             /**< Fields that changed faster than possible (DUTY_CYCLE_HAS_* bits) */
+} duty_cycle_record_t;
+
+/**
+ * @brief Initialize duty-cycle state
+ *
+ * Validates the RTC ring buffer and resets it after a power cycle.
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t duty_cycle_init(void);
+
+/**
+ * @brief Check whether this boot is a deep-sleep timer wakeup
+ *
+ * @return true on a timer wakeup, false on a cold boot or reset
+ */
+bool duty_cycle_is_timer_wakeup(void);
+
+/**
+ * @brief Run this cycle's readings through the sensor self-diagnostics
+ *
+ * Each sensor has its own stuck-value and rate-limit detectors, with the
+ * same limits as in continuous mode, and the air sensors are compared
+ * with each other for divergence. The detector state is kept in RTC
+ * memory and starts afresh when the sensor at an index changes type.
+ * Call before feeding the readings to fusion and health scoring.
+ *
+ * @param sensors Sensor configurations (readings are indexed alike)
+ * @param readings Sensor readings; SENSOR_QUALITY_STUCK, _RATE and
+ *                 _DIVERGENT are set in their quality flags
+ * @param count Number of configured sensors
+ */
+void duty_cycle_diagnose(const sensor_config_t *sensors, sensor_reading_t *readings, int count);
+
+/**
+ * @brief Pack sensor readings into a compact record
+ *
+ * Temperature and humidity are the fused air estimates when this cycle's
+ * readings were fed to sensor fusion (see duty_cycle_restore_fusion()),
+ * otherwise the mean over the AHT10 sensors. The other fields come from
+ * the first valid sensor of the matching type. Sensors that
+ * duty_cycle_diagnose() flagged stuck or rate-limited are only used when
+ * no other sensor has the field, which is then marked in the record's
+ * stuck and rate masks.
+ *
+ * @param sensors Sensor configurations (readings are indexed alike)
+ * @param readings Sensor readings from sensor_interface_read_all()
+ * @param count Number of configured sensors
+ * @param health_score Plant health score
+ * @param record Pointer to store the record
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t duty_cycle_pack_record(const sensor_config_t *sensors, const sensor_reading_t *readings,
+                                 int count, float health_score, duty_cycle_record_t *record);
+
+/**
+ * @brief Append a record to the RTC ring buffer
+ *
+ * The oldest record is overwritten when the buffer is full. The values
+ * also go through the anomaly detectors and the alert engine.
+ *
+ * @param record Record to append
+ * @param flush_due Set to true if the buffered records should be uploaded now
+ * @param urgent_due Set to true if an anomaly or alert transition should be
+ *                   reported now (may be NULL)
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t duty_cycle_append(const duty_cycle_record_t *record, bool *flush_due, bool *urgent_due);
+
+/**
+ * @brief Upload all buffered records and clear the buffer
+ *
+ * Brings WiFi up, synchronizes the clock if needed, posts the records and
+ * any unreported anomalies and alert transitions as one batch and shuts
+ * WiFi down again. On failure the records are kept and the next attempt
+ * is postponed by DUTY_CYCLE_FLUSH_RECORDS samples.
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t duty_cycle_flush(void);
+
+/**
+ * @brief Report the unreported anomalies and alert transitions at once
+ *
+ * Posts them to SERVER_URGENT_URL in a small message of their own,
+ * without touching the buffered records. On failure they are kept and
+ * sent with the next batch instead.
+ *
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t duty_cycle_send_urgent(void);
+
+/**
+ * @brief Restore the sensor fusion state saved before the last deep sleep
+ *
+ * Call after the fusion sources have been registered. The state is saved
+ * by duty_cycle_enter_sleep(); the estimates are advanced by the time
+ * spent asleep. Nothing is restored after a cold boot or when the
+ * sources differ from the saved ones.
+ *
+ * @return true if the state was restored
+ */
+bool duty_cycle_restore_fusion(void);
+
+/**
+ * @brief Get the number of buffered records
+ *
+ * @return Number of records waiting for upload
+ */
+int duty_cycle_get_count(void);
+
+/**
+ * @brief Predicted time until the soil is dry, as of the newest record
+ *
+ * @return Hours until the soil moisture reaches DRY_PREDICTOR_THRESHOLD,
+ *         DRY_PREDICTOR_NONE if the soil is not drying
+ */
+float duty_cycle_hours_to_dry(void);
+
+/**
+ * @brief Arm the wakeup timer and enter deep sleep
+ *
+ * Saves the sensor fusion state to RTC memory first. Does not return.
+ */
+void duty_cycle_enter_sleep(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DUTY_CYCLE_H
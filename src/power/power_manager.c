@@ -0,0 +1,100 @@
+/**
+ * @file power_manager.c
+ * @brief Power Management Implementation
+ *
+ * Thin wrapper around esp_pm. Lock handles stay NULL until
+ * power_manager_init() succeeds, which turns acquire/release into no-ops
+ * on builds without CONFIG_PM_ENABLE.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "power_manager.h"
+#include "esp_pm.h"
+#include "esp_log.h"
+
+static const char *TAG = "POWER";
+
+// Global variables
+static esp_pm_lock_handle_t g_locks[POWER_LOCK_MAX] = {0};
+static bool g_initialized = false;
+
+/**
+ * @brief esp_pm lock type and name for each driver lock
+ */
+static const struct {
+    esp_pm_lock_type_t type;
+    const char *name;
+} g_lock_defs[POWER_LOCK_MAX] = {
+    [POWER_LOCK_BUS_TIMING] = { ESP_PM_CPU_FREQ_MAX,   "bus_timing" },
+    [POWER_LOCK_CONVERSION] = { ESP_PM_NO_LIGHT_SLEEP, "conversion" },
+};
+
+esp_err_t power_manager_init(void)
+{
+    if (g_initialized) {
+        ESP_LOGW(TAG, "Power manager already initialized");
+        return ESP_OK;
+    }
+
+    if (!POWER_MANAGEMENT_ENABLED) {
+        ESP_LOGI(TAG, "Power management disabled in config.h");
+        return ESP_OK;
+    }
+
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = POWER_MAX_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_CPU_FREQ_MHZ,
+        .light_sleep_enable = POWER_LIGHT_SLEEP_ENABLED
+    };
+
+    esp_err_t ret = esp_pm_configure(&pm_config);
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGW(TAG, "Power management not available (enable CONFIG_PM_ENABLE)");
+        return ret;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure power management: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    for (int i = 0; i < POWER_LOCK_MAX; i++) {
+        ret = esp_pm_lock_create(g_lock_defs[i].type, 0, g_lock_defs[i].name, &g_locks[i]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create %s lock: %s", g_lock_defs[i].name, esp_err_to_name(ret));
+            for (int j = 0; j < i; j++) {
+                esp_pm_lock_delete(g_locks[j]);
+                g_locks[j] = NULL;
+            }
+            return ret;
+        }
+    }
+
+    g_initialized = true;
+    ESP_LOGI(TAG, "Power management initialized (%d-%d MHz, light sleep %s)",
+             POWER_MIN_CPU_FREQ_MHZ, POWER_MAX_CPU_FREQ_MHZ,
+             POWER_LIGHT_SLEEP_ENABLED ? "enabled" : "disabled");
+
+    return ESP_OK;
+}
+
+void power_manager_acquire(power_lock_t lock)
+{
+    if ((unsigned)lock < POWER_LOCK_MAX && g_locks[lock]) {
+        esp_pm_lock_acquire(g_locks[lock]);
+    }
+}
+
+void power_manager_release(power_lock_t lock)
+{
+    if ((unsigned)lock < POWER_LOCK_MAX && g_locks[lock]) {
+        esp_pm_lock_release(g_locks[lock]);
+    }
+}
+
+bool power_manager_is_active(void)
+{
+    return g_initialized;
+}
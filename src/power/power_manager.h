@@ -0,0 +1,79 @@
+/**
+ * @file power_manager.h
+ * @brief Power Management for Plant Monitoring System
+ *
+ * This module configures ESP-IDF dynamic frequency scaling and automatic
+ * light sleep. Between samples the CPU drops to the minimum frequency and
+ * the chip light-sleeps whenever FreeRTOS is idle (tickless idle).
+ *
+ * Drivers hold one of the locks below only while timing-sensitive work is
+ * in progress. The legacy I2C driver already takes its own APB lock inside
+ * i2c_master_cmd_begin(), so I2C transactions need no extra lock here.
+ *
+ * If CONFIG_PM_ENABLE is not set, initialization reports that power
+ * management is unavailable and the lock functions become no-ops.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Power management locks available to drivers
+ */
+typedef enum {
+    POWER_LOCK_BUS_TIMING = 0,    /**< Bit-banged bus slots (CPU at maximum frequency) */
+    POWER_LOCK_CONVERSION,        /**< Sensor conversion in progress (no light sleep) */
+    POWER_LOCK_MAX
+} power_lock_t;
+
+/**
+ * @brief Initialize power management
+ *
+ * Configures frequency scaling and automatic light sleep from the
+ * POWER_* constants in config.h and creates the driver locks.
+ *
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if power management
+ *         is not enabled in sdkconfig, other error code on failure
+ */
+esp_err_t power_manager_init(void);
+
+/**
+ * @brief Acquire a power management lock
+ *
+ * Locks are counted, so nested acquire/release pairs are allowed.
+ *
+ * @param lock Lock to acquire
+ */
+void power_manager_acquire(power_lock_t lock);
+
+/**
+ * @brief Release a power management lock
+ *
+ * @param lock Lock to release
+ */
+void power_manager_release(power_lock_t lock);
+
+/**
+ * @brief Check whether power management is active
+ *
+ * @return true if frequency scaling was configured successfully
+ */
+bool power_manager_is_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POWER_MANAGER_H
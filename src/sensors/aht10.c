@@ -12,9 +12,10 @@
  */
 
 #include "aht10.h"
+#include "trace.h"
 #include <string.h>
 #include <esp_log.h>
-#include <driver/i2c.h>
+#include "i2c_bus.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
@@ -22,6 +23,7 @@ static const char *TAG = "AHT10";
 
 // Global variables
 static aht10_config_t g_config;
+static sensor_calibration_t g_calibration;
 static bool g_initialized = false;
 
 /**
@@ -49,7 +51,7 @@ static esp_err_t aht10_write_cmd(uint8_t cmd, const uint8_t *data, size_t data_l
     
     i2c_master_stop(cmd_handle);
     
-    esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd_handle, pdMS_TO_TICKS(1000));
+    esp_err_t ret = i2c_bus_cmd_begin(g_config.address, cmd_handle, 1 + data_len);
     i2c_cmd_link_delete(cmd_handle);
     
     if (ret != ESP_OK) {
@@ -78,7 +80,7 @@ static esp_err_t aht10_read_data(uint8_t *data, size_t data_len)
     i2c_master_read(cmd_handle, data, data_len, I2C_MASTER_LAST_NACK);
     i2c_master_stop(cmd_handle);
     
-    esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd_handle, pdMS_TO_TICKS(1000));
+    esp_err_t ret = i2c_bus_cmd_begin(g_config.address, cmd_handle, data_len);
     i2c_cmd_link_delete(cmd_handle);
     
     if (ret != ESP_OK) {
@@ -98,6 +100,12 @@ esp_err_t aht10_init(const aht10_config_t *config)
     
     // Copy configuration
     memcpy(&g_config, config, sizeof(aht10_config_t));
+    if (config->calibration) {
+        g_calibration = *config->calibration;
+    } else {
+        sensor_calibration_identity(&g_calibration);
+    }
+    g_config.calibration = NULL;
     
     // Check if sensor is enabled
     if (!g_config.enabled) {
@@ -105,13 +113,29 @@ esp_err_t aht10_init(const aht10_config_t *config)
         return ESP_OK;
     }
     
+    esp_err_t ret = i2c_bus_init(g_config.sda_pin, g_config.scl_pin, g_config.i2c_freq);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // The command helpers below require an initialized driver
+    g_initialized = true;
+    
+    // Sensor already brought up since power-on (warm boot): skip the
+    // power-up wait, soft reset and calibration check
+    if (g_config.skip_reset) {
+        ESP_LOGD(TAG, "AHT10 at 0x%02x already initialized, skipping reset", g_config.address);
+        return ESP_OK;
+    }
+    
     // Wait for sensor to power up
     vTaskDelay(pdMS_TO_TICKS(40));
     
     // Send soft reset command
-    esp_err_t ret = aht10_write_cmd(AHT10_CMD_SOFT_RESET, NULL, 0);
+    ret = aht10_write_cmd(AHT10_CMD_SOFT_RESET, NULL, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "AHT10 soft reset failed");
+        g_initialized = false;
         return ret;
     }
     
@@ -123,6 +147,7 @@ esp_err_t aht10_init(const aht10_config_t *config)
     ret = aht10_is_calibrated(&calibrated);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to check AHT10 calibration status");
+        g_initialized = false;
         return ret;
     }
     
@@ -131,23 +156,25 @@ esp_err_t aht10_init(const aht10_config_t *config)
         ret = aht10_calibrate();
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "AHT10 calibration failed");
+            g_initialized = false;
             return ret;
         }
     } else {
         ESP_LOGI(TAG, "AHT10 sensor is already calibrated");
     }
     
-    g_initialized = true;
     ESP_LOGI(TAG, "AHT10 sensor initialized successfully");
     return ESP_OK;
 }
 
-esp_err_t aht10_read(aht10_reading_t *reading)
+/**
+ * @brief Trigger a measurement and convert the result
+ * 
+ * @param reading Pointer to store the reading
+ * @return ESP_OK on success, error code on failure
+ */
+static esp_err_t aht10_measure(aht10_reading_t *reading)
 {
-    if (!reading || !g_initialized) {
-        return ESP_ERR_INVALID_ARG;
-    }
-    
     memset(reading, 0, sizeof(aht10_reading_t));
     
     // Send measurement command
@@ -187,13 +214,24 @@ esp_err_t aht10_read(aht10_reading_t *reading)
         return ESP_ERR_INVALID_STATE;
     }
     
-    // Convert humidity data (20 bits)
+    // Convert humidity data (20 bits) to 0.01 %
     uint32_t humidity_raw = ((uint32_t)data[1] << 12) | ((uint32_t)data[2] << 4) | (data[3] >> 4);
-    reading->humidity = (float)humidity_raw * 100.0f / 1048576.0f; // 2^20
+    int32_t humidity_c100 = (int32_t)(((uint64_t)humidity_raw * 10000 + (1 << 19)) >> 20); // 2^20
     
-    // Convert temperature data (20 bits)
+    // Convert temperature data (20 bits) to 0.01 °C
     uint32_t temp_raw = ((uint32_t)(data[3] & 0x0F) << 16) | ((uint32_t)data[4] << 8) | data[5];
-    reading->temperature = (float)temp_raw * 200.0f / 1048576.0f - 50.0f; // 2^20, -50°C offset
+    int32_t temp_c100 = (int32_t)(((uint64_t)temp_raw * 20000 + (1 << 19)) >> 20) - 5000; // 2^20, -50°C offset
+    
+    // Apply the per-sensor calibration while still in fixed point
+    temp_c100 = sensor_cal_apply(&g_calibration.temperature, temp_c100);
+    humidity_c100 = sensor_cal_apply(&g_calibration.humidity, humidity_c100);
+    if (humidity_c100 < 0) {
+        humidity_c100 = 0;
+    } else if (humidity_c100 > 10000) {
+        humidity_c100 = 10000;
+    }
+    reading->humidity = humidity_c100 / 100.0f;
+    reading->temperature = temp_c100 / 100.0f;
     
     // Validate readings
     if (reading->humidity >= 0.0f && reading->humidity <= 100.0f &&
@@ -210,6 +248,19 @@ esp_err_t aht10_read(aht10_reading_t *reading)
     return reading->error;
 }
 
+esp_err_t aht10_read(aht10_reading_t *reading)
+{
+    if (!reading || !g_initialized) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    TRACE_BEGIN(TRACE_EVT_AHT10_READ, g_config.address);
+    esp_err_t ret = aht10_measure(reading);
+    TRACE_END(TRACE_EVT_AHT10_READ, ret);
+    
+    return ret;
+}
+
 esp_err_t aht10_read_temperature(float *temperature)
 {
     if (!temperature) {
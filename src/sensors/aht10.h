@@ -17,6 +17,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "sensor_calibration.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +51,8 @@ typedef struct {
     uint8_t scl_pin;         /**< SCL pin number */
     uint32_t i2c_freq;       /**< I2C frequency in Hz */
     bool enabled;             /**< Whether sensor is enabled */
+    bool skip_reset;          /**< Sensor already initialized since power-on; skip reset and settle delays */
+    const sensor_calibration_t *calibration; /**< Per-sensor correction (copied), NULL for none */
 } aht10_config_t;
 
 /**
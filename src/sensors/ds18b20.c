@@ -13,6 +13,8 @@
  */
 
 #include "ds18b20.h"
+#include "trace.h"
+#include "power_manager.h"
 #include "driver/gpio.h"
 #include "driver/i2c.h"
 #include "esp_log.h"
@@ -25,6 +27,7 @@ static const char *TAG = "DS18B20";
 
 // Global variables for One-Wire communication
 static uint8_t g_onewire_pin = 0;
+static sensor_calibration_t g_calibration;
 static bool g_initialized = false;
 
 /**
@@ -75,6 +78,9 @@ static esp_err_t onewire_init_gpio(uint8_t pin)
  */
 static esp_err_t onewire_reset(void)
 {
+    TRACE_BEGIN(TRACE_EVT_ONEWIRE_RESET, g_onewire_pin);
+    power_manager_acquire(POWER_LOCK_BUS_TIMING);
+    
     gpio_set_level(g_onewire_pin, 0);
     esp_rom_delay_us(OW_DELAY_H);
     gpio_set_level(g_onewire_pin, 1);
@@ -84,6 +90,9 @@ static esp_err_t onewire_reset(void)
     int level = gpio_get_level(g_onewire_pin);
     esp_rom_delay_us(OW_DELAY_J);
     
+    power_manager_release(POWER_LOCK_BUS_TIMING);
+    TRACE_END(TRACE_EVT_ONEWIRE_RESET, level);
+    
     return (level == 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
 }
 
@@ -94,6 +103,8 @@ static esp_err_t onewire_reset(void)
  */
 static void onewire_write_byte(uint8_t byte)
 {
+    power_manager_acquire(POWER_LOCK_BUS_TIMING);
+    
     for (int i = 0; i < 8; i++) {
         gpio_set_level(g_onewire_pin, 0);
         esp_rom_delay_us(OW_DELAY_A);
@@ -108,6 +119,8 @@ static void onewire_write_byte(uint8_t byte)
         
         byte >>= 1;
     }
+    
+    power_manager_release(POWER_LOCK_BUS_TIMING);
 }
 
 /**
@@ -119,6 +132,8 @@ static uint8_t onewire_read_byte(void)
 {
     uint8_t byte = 0;
     
+    power_manager_acquire(POWER_LOCK_BUS_TIMING);
+    
     for (int i = 0; i < 8; i++) {
         gpio_set_level(g_onewire_pin, 0);
         esp_rom_delay_us(OW_DELAY_A);
@@ -133,6 +148,8 @@ static uint8_t onewire_read_byte(void)
         esp_rom_delay_us(OW_DELAY_F);
     }
     
+    power_manager_release(POWER_LOCK_BUS_TIMING);
+    
     return byte;
 }
 
@@ -155,6 +172,11 @@ esp_err_t ds18b20_init(const ds18b20_config_t *config)
     }
     
     g_onewire_pin = config->pin;
+    if (config->calibration) {
+        g_calibration = *config->calibration;
+    } else {
+        sensor_calibration_identity(&g_calibration);
+    }
     
     // Initialize GPIO
     esp_err_t ret = onewire_init_gpio(g_onewire_pin);
@@ -194,9 +216,14 @@ esp_err_t ds18b20_read(ds18b20_reading_t *reading)
         return ESP_ERR_INVALID_STATE;
     }
     
+    // Hold maximum CPU frequency for the whole command sequence so the
+    // clock does not switch between bit slots
+    power_manager_acquire(POWER_LOCK_BUS_TIMING);
+    
     // Reset One-Wire bus
     esp_err_t ret = onewire_reset();
     if (ret != ESP_OK) {
+        power_manager_release(POWER_LOCK_BUS_TIMING);
         reading->valid = false;
         reading->error = ret;
         return ret;
@@ -207,13 +234,22 @@ esp_err_t ds18b20_read(ds18b20_reading_t *reading)
     
     // Start temperature conversion
     onewire_write_byte(DS18B20_CMD_CONVERT_TEMP);
+    power_manager_release(POWER_LOCK_BUS_TIMING);
     
-    // Wait for conversion (750ms for 12-bit resolution)
+    // Wait for conversion (750ms for 12-bit resolution). The CPU may scale
+    // down, but light sleep is blocked so the bus stays driven high.
+    TRACE_BEGIN(TRACE_EVT_DS18B20_CONVERT, g_onewire_pin);
+    power_manager_acquire(POWER_LOCK_CONVERSION);
     vTaskDelay(pdMS_TO_TICKS(750));
+    power_manager_release(POWER_LOCK_CONVERSION);
+    TRACE_END(TRACE_EVT_DS18B20_CONVERT, g_onewire_pin);
+    
+    power_manager_acquire(POWER_LOCK_BUS_TIMING);
     
     // Reset One-Wire bus again
     ret = onewire_reset();
     if (ret != ESP_OK) {
+        power_manager_release(POWER_LOCK_BUS_TIMING);
         reading->valid = false;
         reading->error = ret;
         return ret;
@@ -230,6 +266,7 @@ esp_err_t ds18b20_read(ds18b20_reading_t *reading)
     for (int i = 0; i < 9; i++) {
         scratchpad[i] = onewire_read_byte();
     }
+    power_manager_release(POWER_LOCK_BUS_TIMING);
     
     // Check CRC (simplified - in production, implement proper CRC check)
     if (scratchpad[8] != 0) {
@@ -239,9 +276,10 @@ esp_err_t ds18b20_read(ds18b20_reading_t *reading)
         return ESP_ERR_INVALID_RESPONSE;
     }
     
-    // Convert temperature
+    // Convert temperature (1/16 °C) to 0.01 °C and apply the per-sensor calibration
     int16_t raw_temp = (scratchpad[1] << 8) | scratchpad[0];
-    reading->temperature = (float)raw_temp * 0.0625f;
+    int32_t temp_c100 = sensor_cal_apply(&g_calibration.temperature, ((int32_t)raw_temp * 25) / 4);
+    reading->temperature = temp_c100 / 100.0f;
     reading->valid = true;
     reading->error = ESP_OK;
     
@@ -355,6 +393,71 @@ esp_err_t ds18b20_get_resolution(uint8_t *resolution)
     return ESP_OK;
 }
 
+/**
+ * @brief Dallas/Maxim CRC-8 (polynomial x^8 + x^5 + x^4 + 1)
+ */
+static uint8_t onewire_crc8(const uint8_t *data, int length)
+{
+    uint8_t crc = 0;
+    for (int i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            uint8_t mix = (crc ^ byte) & 0x01;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            byte >>= 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Read the ROM code of the single device on the bus
+ * 
+ * @param rom_code Pointer to store the ROM code
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t ds18b20_read_rom(uint64_t *rom_code)
+{
+    if (!rom_code) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!g_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    power_manager_acquire(POWER_LOCK_BUS_TIMING);
+    
+    esp_err_t ret = onewire_reset();
+    if (ret != ESP_OK) {
+        power_manager_release(POWER_LOCK_BUS_TIMING);
+        return ret;
+    }
+    
+    // Family code, 48-bit serial number, CRC
+    onewire_write_byte(DS18B20_CMD_READ_ROM);
+    uint8_t rom[8];
+    for (int i = 0; i < 8; i++) {
+        rom[i] = onewire_read_byte();
+    }
+    power_manager_release(POWER_LOCK_BUS_TIMING);
+    
+    // All zeros also passes the CRC: the line is held low
+    if (rom[0] == 0 || onewire_crc8(rom, 7) != rom[7]) {
+        ESP_LOGW(TAG, "ROM code CRC mismatch on pin %d", g_onewire_pin);
+        return ESP_ERR_INVALID_CRC;
+    }
+    
+    *rom_code = 0;
+    for (int i = 7; i >= 0; i--) {
+        *rom_code = (*rom_code << 8) | rom[i];
+    }
+    return ESP_OK;
+}
+
 /**
  * @brief Search for DS18B20 devices on One-Wire bus
  * 
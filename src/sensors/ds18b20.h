@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "sensor_calibration.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,6 +50,7 @@ typedef struct {
     uint8_t resolution;       /**< Temperature resolution (9-12 bits) */
     bool enabled;             /**< Whether sensor is enabled */
     uint64_t rom_code;        /**< ROM code for this sensor */
+    const sensor_calibration_t *calibration; /**< Per-sensor correction (copied), NULL for none */
 } ds18b20_config_t;
 
 /**
@@ -100,6 +102,15 @@ esp_err_t ds18b20_set_resolution(uint8_t resolution);
  */
 esp_err_t ds18b20_get_resolution(uint8_t *resolution);
 
+/**
+ * @brief Read the ROM code of the single device on the bus
+ * 
+ * @param rom_code Pointer to store the ROM code (family code in the low byte)
+ * @return ESP_OK on success, ESP_ERR_INVALID_CRC if the code is corrupted
+ *         (e.g. several devices answered), error code on failure
+ */
+esp_err_t ds18b20_read_rom(uint64_t *rom_code);
+
 /**
  * @brief Search for DS18B20 devices on One-Wire bus
  * 
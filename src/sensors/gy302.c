@@ -12,7 +12,8 @@
  */
 
 #include "gy302.h"
-#include "driver/i2c.h"
+#include "trace.h"
+#include "i2c_bus.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
@@ -25,41 +26,6 @@ static const char *TAG = "GY302";
 static uint8_t g_i2c_address = 0;
 static uint8_t g_current_mode = 0;
 static bool g_initialized = false;
-static i2c_port_t g_i2c_port = I2C_NUM_0;
-
-/**
- * @brief Initialize I2C master for GY-302
- * 
- * @param sda_pin SDA pin number
- * @param scl_pin SCL pin number
- * @param freq I2C frequency in Hz
- * @return ESP_OK on success, error code on failure
- */
-static esp_err_t gy302_i2c_master_init(uint8_t sda_pin, uint8_t scl_pin, uint32_t freq)
-{
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = sda_pin,
-        .scl_io_num = scl_pin,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = freq,
-    };
-    
-    esp_err_t ret = i2c_param_config(g_i2c_port, &conf);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure I2C: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    ret = i2c_driver_install(g_i2c_port, conf.mode, 0, 0, 0);
-    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-        ESP_LOGE(TAG, "Failed to install I2C driver: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    return ESP_OK;
-}
 
 /**
  * @brief Write command to GY-302
@@ -75,7 +41,7 @@ static esp_err_t gy302_write_cmd(uint8_t cmd)
     i2c_master_write_byte(cmd_handle, cmd, true);
     i2c_master_stop(cmd_handle);
     
-    esp_err_t ret = i2c_master_cmd_begin(g_i2c_port, cmd_handle, pdMS_TO_TICKS(1000));
+    esp_err_t ret = i2c_bus_cmd_begin(g_i2c_address, cmd_handle, 1);
     i2c_cmd_link_delete(cmd_handle);
     
     if (ret != ESP_OK) {
@@ -104,7 +70,7 @@ static esp_err_t gy302_read_data(uint8_t *data, size_t len)
     i2c_master_read_byte(cmd_handle, data + len - 1, I2C_MASTER_NACK);
     i2c_master_stop(cmd_handle);
     
-    esp_err_t ret = i2c_master_cmd_begin(g_i2c_port, cmd_handle, pdMS_TO_TICKS(1000));
+    esp_err_t ret = i2c_bus_cmd_begin(g_i2c_address, cmd_handle, len);
     i2c_cmd_link_delete(cmd_handle);
     
     if (ret != ESP_OK) {
@@ -136,7 +102,7 @@ esp_err_t gy302_init(const gy302_config_t *config)
     g_current_mode = config->mode;
     
     // Initialize I2C
-    esp_err_t ret = gy302_i2c_master_init(config->sda_pin, config->scl_pin, config->i2c_freq);
+    esp_err_t ret = i2c_bus_init(config->sda_pin, config->scl_pin, config->i2c_freq);
     if (ret != ESP_OK) {
         return ret;
     }
@@ -169,24 +135,13 @@ esp_err_t gy302_init(const gy302_config_t *config)
 }
 
 /**
- * @brief Read light intensity from GY-302
+ * @brief Trigger a measurement and convert the result
  * 
  * @param reading Pointer to store the reading
  * @return ESP_OK on success, error code on failure
  */
-esp_err_t gy302_read(gy302_reading_t *reading)
+static esp_err_t gy302_measure(gy302_reading_t *reading)
 {
-    if (!reading) {
-        return ESP_ERR_INVALID_ARG;
-    }
-    
-    if (!g_initialized) {
-        ESP_LOGE(TAG, "GY-302 not initialized");
-        reading->valid = false;
-        reading->error = ESP_ERR_INVALID_STATE;
-        return ESP_ERR_INVALID_STATE;
-    }
-    
     // For one-time measurement modes, send the command
     if (g_current_mode >= GY302_MODE_ONE_H) {
         esp_err_t ret = gy302_write_cmd(g_current_mode);
@@ -245,6 +200,32 @@ esp_err_t gy302_read(gy302_reading_t *reading)
     return ESP_OK;
 }
 
+/**
+ * @brief Read light intensity from GY-302
+ * 
+ * @param reading Pointer to store the reading
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t gy302_read(gy302_reading_t *reading)
+{
+    if (!reading) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!g_initialized) {
+        ESP_LOGE(TAG, "GY-302 not initialized");
+        reading->valid = false;
+        reading->error = ESP_ERR_INVALID_STATE;
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    TRACE_BEGIN(TRACE_EVT_GY302_READ, g_i2c_address);
+    esp_err_t ret = gy302_measure(reading);
+    TRACE_END(TRACE_EVT_GY302_READ, ret);
+    
+    return ret;
+}
+
 /**
  * @brief Read only light intensity from GY-302
  * 
@@ -408,8 +389,7 @@ esp_err_t gy302_deinit(void)
     // Power down the sensor
     gy302_power_down();
     
-    // Uninstall I2C driver
-    i2c_driver_delete(g_i2c_port);
+    // The I2C bus is shared with the other sensors and stays installed
     
     g_initialized = false;
     g_i2c_address = 0;
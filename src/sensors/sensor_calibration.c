@@ -0,0 +1,244 @@
+/**
+ * @file sensor_calibration.c
+ * @brief Per-Sensor Calibration Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "sensor_calibration.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "SENSOR_CAL";
+
+/** Bump when sensor_calibration_t changes layout */
+#define SENSOR_CAL_VERSION       1
+
+/** NVS namespace */
+#define SENSOR_CAL_NAMESPACE     "calib"
+
+/** Largest accepted gain */
+#define SENSOR_CAL_MAX_GAIN      4.0f
+
+/**
+ * @brief Stored form of a calibration
+ */
+typedef struct {
+    uint16_t version;         /**< SENSOR_CAL_VERSION */
+    uint16_t reserved;
+    sensor_calibration_t cal; /**< Coefficients */
+} sensor_cal_image_t;
+
+// Global variables
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static sensor_calibration_t g_cal[SENSOR_REGISTRY_CAPACITY];
+static char g_keys[SENSOR_REGISTRY_CAPACITY][SENSOR_CAL_KEY_LEN];
+
+/**
+ * @brief Install a calibration for every loaded sensor with a key
+ */
+static void apply_to_loaded(const char *key, const sensor_calibration_t *cal)
+{
+    portENTER_CRITICAL(&g_lock);
+    for (int i = 0; i < SENSOR_REGISTRY_CAPACITY; i++) {
+        if (strcmp(g_keys[i], key) == 0) {
+            g_cal[i] = *cal;
+        }
+    }
+    portEXIT_CRITICAL(&g_lock);
+}
+
+/**
+ * @brief Open the calibration namespace
+ */
+static esp_err_t open_namespace(nvs_open_mode_t mode, nvs_handle_t *handle)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return nvs_open(SENSOR_CAL_NAMESPACE, mode, handle);
+}
+
+static bool key_is_valid(const char *key)
+{
+    return key && key[0] != '\0' && strlen(key) < SENSOR_CAL_KEY_LEN;
+}
+
+void sensor_calibration_identity(sensor_calibration_t *cal)
+{
+    cal->temperature.gain_q16 = SENSOR_CAL_GAIN_ONE;
+    cal->temperature.offset_c100 = 0;
+    cal->humidity.gain_q16 = SENSOR_CAL_GAIN_ONE;
+    cal->humidity.offset_c100 = 0;
+}
+
+esp_err_t sensor_calibration_linear(float gain, float offset, sensor_cal_coeff_t *coeff)
+{
+    if (!coeff || !(gain > 0.0f && gain <= SENSOR_CAL_MAX_GAIN) || !(fabsf(offset) < 1000.0f)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    coeff->gain_q16 = (int32_t)lroundf(gain * SENSOR_CAL_GAIN_ONE);
+    coeff->offset_c100 = (int32_t)lroundf(offset * 100.0f);
+    return ESP_OK;
+}
+
+esp_err_t sensor_calibration_two_point(float measured_low, float reference_low,
+                                       float measured_high, float reference_high,
+                                       sensor_cal_coeff_t *coeff)
+{
+    float span = measured_high - measured_low;
+    if (!(fabsf(span) >= 0.1f)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    float gain = (reference_high - reference_low) / span;
+    return sensor_calibration_linear(gain, reference_low - gain * measured_low, coeff);
+}
+
+void sensor_calibration_i2c_key(uint8_t address, uint8_t mux_address, uint8_t mux_channel, char *key)
+{
+    snprintf(key, SENSOR_CAL_KEY_LEN, "i2c%02x%02x%02x", mux_address, mux_channel, address);
+}
+
+void sensor_calibration_rom_key(uint64_t rom_code, char *key)
+{
+    // Family code and serial number: the CRC byte adds nothing and would
+    // not fit the 15-character NVS key
+    snprintf(key, SENSOR_CAL_KEY_LEN, "%014" PRIx64, (uint64_t)(rom_code & 0x00FFFFFFFFFFFFFFULL));
+}
+
+esp_err_t sensor_calibration_load(int index, const char *key)
+{
+    if (index < 0 || index >= SENSOR_REGISTRY_CAPACITY || !key_is_valid(key)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sensor_calibration_t cal;
+    sensor_calibration_identity(&cal);
+
+    nvs_handle_t handle;
+    esp_err_t ret = open_namespace(NVS_READONLY, &handle);
+    if (ret == ESP_OK) {
+        sensor_cal_image_t image;
+        size_t length = sizeof(image);
+        ret = nvs_get_blob(handle, key, &image, &length);
+        nvs_close(handle);
+
+        if (ret == ESP_OK && (length != sizeof(image) || image.version != SENSOR_CAL_VERSION)) {
+            ESP_LOGW(TAG, "Ignoring calibration %s from another firmware version", key);
+            ret = ESP_ERR_INVALID_VERSION;
+        }
+        if (ret == ESP_OK) {
+            cal = image.cal;
+        }
+    }
+
+    portENTER_CRITICAL(&g_lock);
+    strcpy(g_keys[index], key);
+    g_cal[index] = cal;
+    portEXIT_CRITICAL(&g_lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "No calibration for %s", key);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ESP_LOGI(TAG, "Calibration %s: T x%.4f %+.2f, H x%.4f %+.2f", key,
+             cal.temperature.gain_q16 / (float)SENSOR_CAL_GAIN_ONE, cal.temperature.offset_c100 / 100.0f,
+             cal.humidity.gain_q16 / (float)SENSOR_CAL_GAIN_ONE, cal.humidity.offset_c100 / 100.0f);
+    return ESP_OK;
+}
+
+void sensor_calibration_get(int index, sensor_calibration_t *cal)
+{
+    if (index < 0 || index >= SENSOR_REGISTRY_CAPACITY || g_keys[index][0] == '\0') {
+        sensor_calibration_identity(cal);
+        return;
+    }
+
+    portENTER_CRITICAL(&g_lock);
+    *cal = g_cal[index];
+    portEXIT_CRITICAL(&g_lock);
+}
+
+esp_err_t sensor_calibration_store(const char *key, const sensor_calibration_t *cal)
+{
+    if (!key_is_valid(key) || !cal) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = open_namespace(NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    sensor_cal_image_t image = {
+        .version = SENSOR_CAL_VERSION,
+        .reserved = 0,
+        .cal = *cal
+    };
+    ret = nvs_set_blob(handle, key, &image, sizeof(image));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to store calibration %s: %s", key, esp_err_to_name(ret));
+        return ret;
+    }
+
+    apply_to_loaded(key, cal);
+    ESP_LOGI(TAG, "Calibration %s stored", key);
+    return ESP_OK;
+}
+
+esp_err_t sensor_calibration_erase(const char *key)
+{
+    if (!key_is_valid(key)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = open_namespace(NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = nvs_erase_key(handle, key);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = ESP_OK;
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (ret == ESP_OK) {
+        sensor_calibration_t identity;
+        sensor_calibration_identity(&identity);
+        apply_to_loaded(key, &identity);
+    }
+    return ret;
+}
+
+void sensor_calibration_clear(void)
+{
+    portENTER_CRITICAL(&g_lock);
+    memset(g_keys, 0, sizeof(g_keys));
+    for (int i = 0; i < SENSOR_REGISTRY_CAPACITY; i++) {
+        sensor_calibration_identity(&g_cal[i]);
+    }
+    portEXIT_CRITICAL(&g_lock);
+}
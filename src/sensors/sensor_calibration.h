@@ -0,0 +1,168 @@
+/**
+ * @file sensor_calibration.h
+ * @brief Per-Sensor Calibration for Plant Monitoring System
+ *
+ * This module corrects the individual offset and gain of each
+ * temperature and humidity sensor. Coefficients are stored in NVS, keyed
+ * by the identity of the physical sensor rather than its position in the
+ * configuration:
+ * - I2C sensors by multiplexer address, multiplexer channel and address;
+ * - DS18B20 probes by their 64-bit ROM code.
+ *
+ * Coefficients are loaded once per sensor at init and kept in fixed
+ * point (gain in Q16.16, offset in hundredths), so drivers apply them in
+ * their integer conversion with one multiply and one add. They can be
+ * replaced at runtime with sensor_calibration_store(), which updates NVS
+ * and every loaded sensor with that identity; no reflash is needed.
+ *
+ * Coefficients are derived from a linear correction (gain and offset)
+ * or from two reference points.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef SENSOR_CALIBRATION_H
+#define SENSOR_CALIBRATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of a calibration key, including the terminator (NVS key limit) */
+#define SENSOR_CAL_KEY_LEN       16
+
+/** Gain of 1.0 in Q16.16 */
+#define SENSOR_CAL_GAIN_ONE      (1L << 16)
+
+/**
+ * @brief Linear correction of one quantity: corrected = value * gain + offset
+ */
+typedef struct {
+    int32_t gain_q16;         /**< Gain in Q16.16 */
+    int32_t offset_c100;      /**< Offset in hundredths of the unit (0.01 °C, 0.01 %) */
+} sensor_cal_coeff_t;
+
+/**
+ * @brief Calibration of one sensor
+ */
+typedef struct {
+    sensor_cal_coeff_t temperature;  /**< Temperature correction */
+    sensor_cal_coeff_t humidity;     /**< Humidity correction (unused for DS18B20) */
+} sensor_calibration_t;
+
+/**
+ * @brief Apply a correction to a value in hundredths
+ *
+ * @param coeff Correction
+ * @param value_c100 Value in hundredths of the unit
+ * @return Corrected value in hundredths, rounded to nearest
+ */
+static inline int32_t sensor_cal_apply(const sensor_cal_coeff_t *coeff, int32_t value_c100)
+{
+    return (int32_t)(((int64_t)value_c100 * coeff->gain_q16 + (1 << 15)) >> 16) + coeff->offset_c100;
+}
+
+/**
+ * @brief Get the calibration that leaves values unchanged
+ *
+ * @param cal Pointer to store the calibration
+ */
+void sensor_calibration_identity(sensor_calibration_t *cal);
+
+/**
+ * @brief Build a correction from a gain and an offset
+ *
+ * @param gain Gain (0 < gain <= 4)
+ * @param offset Offset in the unit of the quantity (°C or %)
+ * @param coeff Pointer to store the correction
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an unusable gain
+ */
+esp_err_t sensor_calibration_linear(float gain, float offset, sensor_cal_coeff_t *coeff);
+
+/**
+ * @brief Build a correction that maps two measured points onto references
+ *
+ * @param measured_low Sensor value at the first reference
+ * @param reference_low First reference value
+ * @param measured_high Sensor value at the second reference
+ * @param reference_high Second reference value
+ * @param coeff Pointer to store the correction
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the points are too
+ *         close together or give an unusable gain
+ */
+esp_err_t sensor_calibration_two_point(float measured_low, float reference_low,
+                                       float measured_high, float reference_high,
+                                       sensor_cal_coeff_t *coeff);
+
+/**
+ * @brief Make the key of an I2C sensor
+ *
+ * @param address 7-bit device address
+ * @param mux_address Multiplexer address, or 0 for the main bus
+ * @param mux_channel Multiplexer channel
+ * @param key Buffer of SENSOR_CAL_KEY_LEN bytes
+ */
+void sensor_calibration_i2c_key(uint8_t address, uint8_t mux_address, uint8_t mux_channel, char *key);
+
+/**
+ * @brief Make the key of a one-wire sensor
+ *
+ * @param rom_code ROM code (family code in the low byte)
+ * @param key Buffer of SENSOR_CAL_KEY_LEN bytes
+ */
+void sensor_calibration_rom_key(uint64_t rom_code, char *key);
+
+/**
+ * @brief Load the stored calibration of a configured sensor
+ *
+ * Sensors without a stored calibration get the identity.
+ *
+ * @param index Sensor index
+ * @param key Sensor key
+ * @return ESP_OK if a calibration was loaded, ESP_ERR_NOT_FOUND if the
+ *         identity was installed, ESP_ERR_INVALID_ARG for a bad index or key
+ */
+esp_err_t sensor_calibration_load(int index, const char *key);
+
+/**
+ * @brief Get the calibration of a configured sensor
+ *
+ * @param index Sensor index
+ * @param cal Pointer to store the calibration (the identity if none was loaded)
+ */
+void sensor_calibration_get(int index, sensor_calibration_t *cal);
+
+/**
+ * @brief Store a calibration and apply it to the loaded sensors with that key
+ *
+ * @param key Sensor key
+ * @param cal Calibration to store
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_calibration_store(const char *key, const sensor_calibration_t *cal);
+
+/**
+ * @brief Delete a stored calibration; loaded sensors revert to the identity
+ *
+ * @param key Sensor key
+ * @return ESP_OK on success (also if nothing was stored), error code on failure
+ */
+esp_err_t sensor_calibration_erase(const char *key);
+
+/**
+ * @brief Forget all loaded calibrations
+ */
+void sensor_calibration_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_CALIBRATION_H
@@ -13,10 +13,13 @@
  */
 
 #include "sensor_interface.h"
+#include "sensor_registry.h"
+#include "sensor_calibration.h"
 #include "aht10.h"
 #include "ds18b20.h"
 #include "gy302.h"
-#include "driver/i2c.h"
+#include "trace.h"
+#include "i2c_bus.h"
 #include "driver/adc.h"
 #include "esp_adc/adc_oneshot.h"
 #include "esp_adc/adc_cali.h"
@@ -33,39 +36,140 @@ static const char *TAG = "SENSOR_INTERFACE";
 static sensor_interface_config_t g_config;
 static bool g_initialized = false;
 static adc_oneshot_unit_handle_t g_adc_handle = NULL;
+static sensor_boot_state_t g_boot_state = {0};
+static uint8_t g_read_order[SENSOR_INTERFACE_MAX_SENSORS];
 
 /**
- * @brief Initialize I2C master for sensors
+ * @brief Known I2C address ranges per sensor type
+ *
+ * Types without an entry are not I2C devices.
+ */
+static const struct {
+    uint8_t first;
+    uint8_t last;
+} k_i2c_address_ranges[SENSOR_TYPE_MAX][2] = {
+    [SENSOR_TYPE_AHT10] = { { 0x38, 0x39 } },
+    [SENSOR_TYPE_GY302] = { { 0x23, 0x23 }, { 0x5C, 0x5C } },  // ADDR pin low / high
+};
+
+/**
+ * @brief Add the known address ranges of a set of sensor types to a map
  * 
- * @param sda_pin SDA pin number
- * @param scl_pin SCL pin number
- * @param freq I2C frequency in Hz
- * @return ESP_OK on success, error code on failure
+ * @param type_mask Sensor types (SENSOR_TYPE_BIT())
+ * @param map Map to update
+ */
+static void add_type_addresses(uint32_t type_mask, i2c_bus_map_t *map)
+{
+    for (int type = 0; type < SENSOR_TYPE_MAX; type++) {
+        if (!(type_mask & SENSOR_TYPE_BIT(type))) {
+            continue;
+        }
+        for (int r = 0; r < 2; r++) {
+            if (k_i2c_address_ranges[type][r].first != 0) {
+                i2c_bus_map_add_range(map, k_i2c_address_ranges[type][r].first,
+                                      k_i2c_address_ranges[type][r].last);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Check whether a sensor type is an I2C device
+ */
+static bool is_i2c_sensor(sensor_type_t type)
+{
+    return type < SENSOR_TYPE_MAX && k_i2c_address_ranges[type][0].first != 0;
+}
+
+/**
+ * @brief Sort key grouping sensors by multiplexer channel (main bus first)
+ */
+static uint16_t sensor_route(int index)
+{
+    const sensor_registry_t *registry = sensor_registry_get();
+    if (!is_i2c_sensor((sensor_type_t)registry->type[index]) || registry->mux_address[index] == 0) {
+        return 0;
+    }
+    return ((uint16_t)registry->mux_address[index] << 8) | (registry->mux_channel[index] + 1);
+}
+
+/**
+ * @brief Order the sensors so that each multiplexer channel is selected once per cycle
+ */
+static void build_read_order(void)
+{
+    for (int i = 0; i < sensor_registry_count(); i++) {
+        // Stable insertion sort: configuration order is kept within a channel
+        int j = i;
+        while (j > 0 && sensor_route(g_read_order[j - 1]) > sensor_route(i)) {
+            g_read_order[j] = g_read_order[j - 1];
+            j--;
+        }
+        g_read_order[j] = (uint8_t)i;
+    }
+}
+
+/**
+ * @brief Route the I2C bus to a sensor
  */
-static esp_err_t i2c_master_init(uint8_t sda_pin, uint8_t scl_pin, uint32_t freq)
+static esp_err_t select_sensor_channel(const sensor_config_t *config)
 {
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = sda_pin,
-        .scl_io_num = scl_pin,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = freq,
+    if (!is_i2c_sensor(config->type)) {
+        return ESP_OK;
+    }
+    return i2c_bus_select_channel(config->mux_address, config->mux_channel);
+}
+
+/**
+ * @brief Read the ROM code of the DS18B20 on a sensor's pin
+ */
+static esp_err_t read_ds18b20_rom(const sensor_config_t *config, uint64_t *rom_code)
+{
+    ds18b20_config_t ds18b20_config = {
+        .pin = config->pin,
+        .resolution = 12,
+        .enabled = config->enabled,
+        .rom_code = 0,
+        .calibration = NULL
     };
     
-    esp_err_t ret = i2c_param_config(I2C_NUM_0, &conf);
+    esp_err_t ret = ds18b20_init(&ds18b20_config);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure I2C: %s", esp_err_to_name(ret));
         return ret;
     }
-    
-    ret = i2c_driver_install(I2C_NUM_0, conf.mode, 0, 0, 0);
-    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-        ESP_LOGE(TAG, "Failed to install I2C driver: %s", esp_err_to_name(ret));
-        return ret;
+    ret = ds18b20_read_rom(rom_code);
+    ds18b20_deinit();
+    return ret;
+}
+
+/**
+ * @brief Load the stored calibration of a temperature/humidity sensor
+ * 
+ * I2C sensors are identified by their route and address, DS18B20 probes
+ * by their ROM code. A probe that cannot be identified runs uncalibrated.
+ * 
+ * @param index Sensor index
+ * @param config Sensor configuration
+ */
+static void load_calibration(int index, const sensor_config_t *config)
+{
+    char key[SENSOR_CAL_KEY_LEN];
+    
+    if (config->type == SENSOR_TYPE_AHT10) {
+        sensor_calibration_i2c_key(config->address, config->mux_address, config->mux_channel, key);
+    } else if (config->type == SENSOR_TYPE_DS18B20) {
+        uint64_t rom_code = 0;
+        esp_err_t ret = read_ds18b20_rom(config, &rom_code);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Cannot identify %s for calibration: %s", config->name, esp_err_to_name(ret));
+            return;
+        }
+        sensor_calibration_rom_key(rom_code, key);
+    } else {
+        return;
     }
     
-    return ESP_OK;
+    sensor_calibration_load(index, key);
 }
 
 /**
@@ -98,17 +202,22 @@ static esp_err_t adc_init(void)
  * @brief Read AHT10 sensor
  * 
  * @param config Sensor configuration
+ * @param ready Sensor already initialized since power-on
+ * @param calibration Per-sensor calibration
  * @param reading Pointer to store reading
  * @return ESP_OK on success, error code on failure
  */
-static esp_err_t read_aht10_sensor(const sensor_config_t *config, sensor_reading_t *reading)
+static esp_err_t read_aht10_sensor(const sensor_config_t *config, bool ready,
+                                   const sensor_calibration_t *calibration, sensor_reading_t *reading)
 {
     aht10_config_t aht10_config = {
         .address = config->address,
         .sda_pin = g_config.i2c_sda_pin,
         .scl_pin = g_config.i2c_scl_pin,
         .i2c_freq = g_config.i2c_frequency,
-        .enabled = config->enabled
+        .enabled = config->enabled,
+        .skip_reset = ready,
+        .calibration = calibration
     };
     
     esp_err_t ret = aht10_init(&aht10_config);
@@ -138,16 +247,19 @@ static esp_err_t read_aht10_sensor(const sensor_config_t *config, sensor_reading
  * @brief Read DS18B20 sensor
  * 
  * @param config Sensor configuration
+ * @param calibration Per-sensor calibration
  * @param reading Pointer to store reading
  * @return ESP_OK on success, error code on failure
  */
-static esp_err_t read_ds18b20_sensor(const sensor_config_t *config, sensor_reading_t *reading)
+static esp_err_t read_ds18b20_sensor(const sensor_config_t *config, const sensor_calibration_t *calibration,
+                                     sensor_reading_t *reading)
 {
     ds18b20_config_t ds18b20_config = {
         .pin = config->pin,
         .resolution = 12,
         .enabled = config->enabled,
-        .rom_code = 0
+        .rom_code = 0,
+        .calibration = calibration
     };
     
     esp_err_t ret = ds18b20_init(&ds18b20_config);
@@ -266,6 +378,85 @@ static esp_err_t read_light_sensor(const sensor_config_t *config, sensor_reading
     return ESP_OK;
 }
 
+/**
+ * @brief Start a sensor reading
+ * 
+ * @param index Sensor index
+ * @param config Sensor configuration
+ * @param reading Reading to initialize
+ * @return ESP_OK on success, error code on failure
+ */
+static esp_err_t reading_begin(int index, const sensor_config_t *config, sensor_reading_t *reading)
+{
+    if (!config || !reading || index < 0 || index >= SENSOR_INTERFACE_MAX_SENSORS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!g_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    *reading = (sensor_reading_t) {
+        .temperature = 0.0f,
+        .humidity = 0.0f,
+        .soil_moisture = 0,
+        .light_level = 0,
+        .lux = 0.0f,
+        .valid = false,
+        .quality_flags = 0,
+        .error = ESP_OK
+    };
+    
+    TRACE_BEGIN(TRACE_EVT_SENSOR_READ, index);
+    return ESP_OK;
+}
+
+/**
+ * @brief Store a sensor reading and update the bring-up state
+ * 
+ * @param index Sensor index
+ * @param config Sensor configuration
+ * @param ret Result of the driver read
+ * @param reading Reading
+ * @return ret
+ */
+static esp_err_t reading_finish(int index, const sensor_config_t *config, esp_err_t ret,
+                                const sensor_reading_t *reading)
+{
+    TRACE_END(TRACE_EVT_SENSOR_READ, index);
+    
+    sensor_registry_set_reading(index, reading);
+    
+    // Track bring-up state: a failed sensor gets a full reset next time,
+    // and an I2C read that contradicts the discovery map flags it stale
+    bool ok = (ret == ESP_OK && reading->valid);
+    if (ok) {
+        g_boot_state.ready_mask |= (1UL << index);
+    } else {
+        g_boot_state.ready_mask &= ~(1UL << index);
+    }
+    
+    // A quarantined device was not attempted, so its outcome says nothing,
+    // and the map only covers devices on the main bus
+    if (is_i2c_sensor(config->type) && config->mux_address == 0 && i2c_bus_map_is_valid() &&
+        ret != ESP_ERR_NOT_ALLOWED && ok != i2c_bus_is_present(config->address)) {
+        g_boot_state.mismatch_mask |= (1UL << index);
+        i2c_bus_mark_stale(config->address);
+    } else {
+        g_boot_state.mismatch_mask &= ~(1UL << index);
+    }
+    
+    if (ok) {
+        ESP_LOGD(TAG, "Sensor %s: T=%.2f°C, H=%.2f%%, SM=%d, L=%d, Lux=%.1f",
+                 config->name, reading->temperature, reading->humidity,
+                 reading->soil_moisture, reading->light_level, reading->lux);
+    } else {
+        ESP_LOGW(TAG, "Failed to read sensor %s: %s", config->name, esp_err_to_name(ret));
+    }
+    
+    return ret;
+}
+
 /**
  * @brief Initialize the sensor interface
  * 
@@ -284,14 +475,60 @@ esp_err_t sensor_interface_init(const sensor_interface_config_t *config)
         return ESP_OK;
     }
     
+    if (config->sensor_count > 0 && !config->sensors) {
+        ESP_LOGE(TAG, "Invalid configuration");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (config->sensor_count > SENSOR_INTERFACE_MAX_SENSORS) {
+        ESP_LOGE(TAG, "Too many sensors: %d (max %d)", config->sensor_count, SENSOR_INTERFACE_MAX_SENSORS);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    sensor_registry_clear();
+    sensor_calibration_clear();
+    for (int i = 0; i < config->sensor_count; i++) {
+        esp_err_t add_ret = sensor_registry_add(&config->sensors[i], NULL);
+        if (add_ret != ESP_OK) {
+            ESP_LOGE(TAG, "Invalid sensor %d: %s", i, esp_err_to_name(add_ret));
+            sensor_registry_clear();
+            return add_ret;
+        }
+    }
+    
+    // Sensors live in the registry from here on; the caller's array may go away
     memcpy(&g_config, config, sizeof(sensor_interface_config_t));
+    g_config.sensors = NULL;
+    build_read_order();
     
     // Initialize I2C
-    esp_err_t ret = i2c_master_init(g_config.i2c_sda_pin, g_config.i2c_scl_pin, g_config.i2c_frequency);
+    esp_err_t ret = i2c_bus_init(g_config.i2c_sda_pin, g_config.i2c_scl_pin, g_config.i2c_frequency);
     if (ret != ESP_OK) {
         return ret;
     }
     
+    // Negotiate per-device clock speeds
+    for (int i = 0; i < g_config.sensor_count; i++) {
+        sensor_config_t sensor;
+        sensor_registry_get_config(i, &sensor);
+        if (sensor.enabled && is_i2c_sensor(sensor.type) && sensor.i2c_freq > 0 &&
+            select_sensor_channel(&sensor) == ESP_OK) {
+            esp_err_t speed_ret = i2c_bus_set_device_speed(sensor.address, sensor.i2c_freq);
+            if (speed_ret != ESP_OK) {
+                ESP_LOGD(TAG, "No speed negotiated for %s: %s", sensor.name, esp_err_to_name(speed_ret));
+            }
+        }
+    }
+    
+    // Load per-sensor calibrations once; readings apply them in the drivers
+    for (int i = 0; i < g_config.sensor_count; i++) {
+        sensor_config_t sensor;
+        sensor_registry_get_config(i, &sensor);
+        if (sensor.enabled && select_sensor_channel(&sensor) == ESP_OK) {
+            load_calibration(i, &sensor);
+        }
+    }
+    
     // Initialize ADC
     ret = adc_init();
     if (ret != ESP_OK) {
@@ -323,65 +560,170 @@ int sensor_interface_read_all(sensor_reading_t *readings, int max_readings)
     }
     
     int valid_readings = 0;
+    TRACE_BEGIN(TRACE_EVT_SENSOR_READ_ALL, g_config.sensor_count);
     
-    for (int i = 0; i < g_config.sensor_count && i < max_readings; i++) {
-        const sensor_config_t *config = &g_config.sensors[i];
+    for (int n = 0; n < g_config.sensor_count; n++) {
+        int i = g_read_order[n];
+        sensor_config_t sensor;
+        sensor_registry_get_config(i, &sensor);
+        const sensor_config_t *config = &sensor;
         
-        if (!config->enabled) {
+        if (!config->enabled || i >= max_readings) {
             continue;
         }
         
-        // Initialize reading structure
-        readings[i].temperature = 0.0f;
-        readings[i].humidity = 0.0f;
-        readings[i].soil_moisture = 0;
-        readings[i].light_level = 0;
-        readings[i].lux = 0.0f;
-        readings[i].valid = false;
-        readings[i].error = ESP_OK;
-        
-        esp_err_t ret = ESP_OK;
-        
+        esp_err_t ret;
         switch (config->type) {
             case SENSOR_TYPE_AHT10:
-                ret = read_aht10_sensor(config, &readings[i]);
+                ret = sensor_interface_read_aht10(i, config, &readings[i]);
                 break;
                 
             case SENSOR_TYPE_DS18B20:
-                ret = read_ds18b20_sensor(config, &readings[i]);
+                ret = sensor_interface_read_ds18b20(i, config, &readings[i]);
                 break;
                 
             case SENSOR_TYPE_GY302:
-                ret = read_gy302_sensor(config, &readings[i]);
+                ret = sensor_interface_read_gy302(i, config, &readings[i]);
                 break;
                 
             case SENSOR_TYPE_SOIL_MOISTURE:
-                ret = read_soil_moisture_sensor(config, &readings[i]);
+                ret = sensor_interface_read_soil_moisture(i, config, &readings[i]);
                 break;
                 
             case SENSOR_TYPE_LIGHT:
-                ret = read_light_sensor(config, &readings[i]);
+                ret = sensor_interface_read_light(i, config, &readings[i]);
                 break;
                 
             default:
                 ESP_LOGW(TAG, "Unknown sensor type: %d", config->type);
-                readings[i].error = ESP_ERR_INVALID_ARG;
+                ret = reading_begin(i, config, &readings[i]);
+                if (ret == ESP_OK) {
+                    readings[i].error = ESP_ERR_INVALID_ARG;
+                    ret = reading_finish(i, config, ESP_ERR_INVALID_ARG, &readings[i]);
+                }
                 break;
         }
         
         if (ret == ESP_OK && readings[i].valid) {
             valid_readings++;
-            ESP_LOGD(TAG, "Sensor %s: T=%.2f°C, H=%.2f%%, SM=%d, L=%d, Lux=%.1f",
-                     config->name, readings[i].temperature, readings[i].humidity,
-                     readings[i].soil_moisture, readings[i].light_level, readings[i].lux);
-        } else {
-            ESP_LOGW(TAG, "Failed to read sensor %s: %s", config->name, esp_err_to_name(ret));
         }
     }
     
+    TRACE_END(TRACE_EVT_SENSOR_READ_ALL, valid_readings);
     return valid_readings;
 }
 
+/**
+ * @brief Read an AHT10 sensor
+ * 
+ * @param index Sensor index
+ * @param config Sensor configuration registered at index
+ * @param reading Pointer to store the reading
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_read_aht10(int index, const sensor_config_t *config, sensor_reading_t *reading)
+{
+    esp_err_t ret = reading_begin(index, config, reading);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    sensor_calibration_t calibration;
+    sensor_calibration_get(index, &calibration);
+    
+    ret = select_sensor_channel(config);
+    if (ret == ESP_OK) {
+        ret = read_aht10_sensor(config, (g_boot_state.ready_mask >> index) & 1, &calibration, reading);
+    } else {
+        reading->error = ret;
+    }
+    return reading_finish(index, config, ret, reading);
+}
+
+/**
+ * @brief Read a DS18B20 sensor
+ * 
+ * @param index Sensor index
+ * @param config Sensor configuration registered at index
+ * @param reading Pointer to store the reading
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_read_ds18b20(int index, const sensor_config_t *config, sensor_reading_t *reading)
+{
+    esp_err_t ret = reading_begin(index, config, reading);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    sensor_calibration_t calibration;
+    sensor_calibration_get(index, &calibration);
+    
+    ret = read_ds18b20_sensor(config, &calibration, reading);
+    return reading_finish(index, config, ret, reading);
+}
+
+/**
+ * @brief Read a GY-302 sensor
+ * 
+ * @param index Sensor index
+ * @param config Sensor configuration registered at index
+ * @param reading Pointer to store the reading
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_read_gy302(int index, const sensor_config_t *config, sensor_reading_t *reading)
+{
+    esp_err_t ret = reading_begin(index, config, reading);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ret = select_sensor_channel(config);
+    if (ret == ESP_OK) {
+        ret = read_gy302_sensor(config, reading);
+    } else {
+        reading->error = ret;
+    }
+    return reading_finish(index, config, ret, reading);
+}
+
+/**
+ * @brief Read an analog soil moisture sensor
+ * 
+ * @param index Sensor index
+ * @param config Sensor configuration registered at index
+ * @param reading Pointer to store the reading
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_read_soil_moisture(int index, const sensor_config_t *config, sensor_reading_t *reading)
+{
+    esp_err_t ret = reading_begin(index, config, reading);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ret = read_soil_moisture_sensor(config, reading);
+    return reading_finish(index, config, ret, reading);
+}
+
+/**
+ * @brief Read an analog light sensor
+ * 
+ * @param index Sensor index
+ * @param config Sensor configuration registered at index
+ * @param reading Pointer to store the reading
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_read_light(int index, const sensor_config_t *config, sensor_reading_t *reading)
+{
+    esp_err_t ret = reading_begin(index, config, reading);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ret = read_light_sensor(config, reading);
+    return reading_finish(index, config, ret, reading);
+}
+
 /**
  * @brief Read a specific sensor by type
  * 
@@ -400,8 +742,9 @@ esp_err_t sensor_interface_read_sensor(sensor_type_t type, sensor_reading_t *rea
     }
     
     // Find first sensor of the specified type
-    for (int i = 0; i < g_config.sensor_count; i++) {
-        if (g_config.sensors[i].type == type && g_config.sensors[i].enabled) {
+    const sensor_registry_t *registry = sensor_registry_get();
+    for (int i = 0; i < registry->count; i++) {
+        if (registry->type[i] == type && ((registry->enabled_mask >> i) & 1)) {
             return sensor_interface_read_all(reading, 1);
         }
     }
@@ -420,28 +763,134 @@ int sensor_interface_scan_i2c(void)
         return -1;
     }
     
-    int device_count = 0;
     ESP_LOGI(TAG, "Scanning I2C bus...");
     
-    for (uint8_t address = 1; address < 127; address++) {
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
-        i2c_master_stop(cmd);
-        
-        esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, pdMS_TO_TICKS(100));
-        i2c_cmd_link_delete(cmd);
-        
-        if (ret == ESP_OK) {
+    int device_count = i2c_bus_scan(NULL);
+    if (device_count < 0) {
+        return -1;
+    }
+    
+    for (uint8_t address = I2C_BUS_ADDRESS_FIRST; address <= I2C_BUS_ADDRESS_LAST; address++) {
+        if (i2c_bus_is_present(address)) {
             ESP_LOGI(TAG, "Found I2C device at address 0x%02X", address);
-            device_count++;
         }
     }
     
+    g_boot_state.mismatch_mask = 0;
+    
     ESP_LOGI(TAG, "I2C scan complete, found %d devices", device_count);
     return device_count;
 }
 
+/**
+ * @brief Scan only the known I2C addresses of some sensor types
+ * 
+ * @param type_mask Sensor types to look for (SENSOR_TYPE_BIT())
+ * @return Number of devices found, -1 on failure
+ */
+int sensor_interface_scan_i2c_types(uint32_t type_mask)
+{
+    if (!g_initialized) {
+        return -1;
+    }
+    
+    i2c_bus_map_t candidates = {0};
+    add_type_addresses(type_mask, &candidates);
+    
+    int device_count = i2c_bus_scan(&candidates);
+    if (device_count >= 0) {
+        ESP_LOGI(TAG, "I2C type scan complete, found %d devices", device_count);
+    }
+    return device_count;
+}
+
+/**
+ * @brief Incrementally rescan the I2C bus for hot-plugged or removed sensors
+ * 
+ * @return Number of addresses whose state changed, -1 on failure
+ */
+int sensor_interface_rescan_i2c(void)
+{
+    if (!g_initialized) {
+        return -1;
+    }
+    
+    // Devices may appear at any known address of a configured type
+    i2c_bus_map_t candidates = {0};
+    uint32_t type_mask = 0;
+    for (int i = 0; i < g_config.sensor_count; i++) {
+        sensor_config_t sensor;
+        sensor_registry_get_config(i, &sensor);
+        const sensor_config_t *config = &sensor;
+        if (!config->enabled || !is_i2c_sensor(config->type)) {
+            continue;
+        }
+        if (config->mux_address != 0) {
+            // Only the multiplexer itself is visible on the main bus
+            i2c_bus_map_set(&candidates, config->mux_address);
+        } else {
+            type_mask |= SENSOR_TYPE_BIT(config->type);
+            i2c_bus_map_set(&candidates, config->address);
+        }
+    }
+    add_type_addresses(type_mask, &candidates);
+    
+    i2c_bus_map_t changed;
+    int change_count = i2c_bus_rescan(&candidates, &changed);
+    if (change_count < 0) {
+        return -1;
+    }
+    
+    // The map now reflects the bus again
+    g_boot_state.mismatch_mask = 0;
+    
+    for (uint8_t address = I2C_BUS_ADDRESS_FIRST; address <= I2C_BUS_ADDRESS_LAST; address++) {
+        if (i2c_bus_map_has(&changed, address)) {
+            ESP_LOGI(TAG, "I2C device at 0x%02X %s", address,
+                     i2c_bus_is_present(address) ? "appeared" : "disappeared");
+        }
+    }
+    
+    return change_count;
+}
+
+/**
+ * @brief Get the sensor bring-up state
+ * 
+ * @param state Pointer to store the state
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_get_boot_state(sensor_boot_state_t *state)
+{
+    if (!state) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    *state = g_boot_state;
+    state->i2c_map_valid = (i2c_bus_get_map(&state->i2c_map) == ESP_OK);
+    return ESP_OK;
+}
+
+/**
+ * @brief Restore sensor bring-up state saved before a warm boot
+ * 
+ * @param state State to restore
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_restore_boot_state(const sensor_boot_state_t *state)
+{
+    if (!state) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    g_boot_state = *state;
+    g_boot_state.mismatch_mask = 0;
+    if (state->i2c_map_valid) {
+        i2c_bus_set_map(&state->i2c_map);
+    }
+    return ESP_OK;
+}
+
 /**
  * @brief Get sensor status
  * 
@@ -466,9 +915,10 @@ esp_err_t sensor_interface_get_status(int *working_sensors, int *total_sensors)
     
     // Test each sensor
     sensor_reading_t test_reading;
-    for (int i = 0; i < g_config.sensor_count; i++) {
-        if (g_config.sensors[i].enabled) {
-            if (sensor_interface_read_sensor(g_config.sensors[i].type, &test_reading) == ESP_OK) {
+    const sensor_registry_t *registry = sensor_registry_get();
+    for (int i = 0; i < registry->count; i++) {
+        if ((registry->enabled_mask >> i) & 1) {
+            if (sensor_interface_read_sensor((sensor_type_t)registry->type[i], &test_reading) == ESP_OK) {
                 (*working_sensors)++;
             }
         }
@@ -495,10 +945,13 @@ esp_err_t sensor_interface_deinit(void)
     }
     
     // Deinitialize I2C
-    i2c_driver_delete(I2C_NUM_0);
+    i2c_bus_deinit();
     
     g_initialized = false;
     memset(&g_config, 0, sizeof(sensor_interface_config_t));
+    memset(&g_boot_state, 0, sizeof(g_boot_state));
+    sensor_registry_clear();
+    sensor_calibration_clear();
     
     ESP_LOGI(TAG, "Sensor interface deinitialized");
     
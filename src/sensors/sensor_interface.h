@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "i2c_bus.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,15 +38,40 @@ typedef enum {
     SENSOR_TYPE_MAX           /**< Maximum sensor type value */
 } sensor_type_t;
 
+/** Maximum number of configured sensors (the sensor registry capacity) */
+#define SENSOR_INTERFACE_MAX_SENSORS  SENSOR_REGISTRY_CAPACITY
+
+/** Reading quality flags: the value was rejected as an outlier and replaced */
+#define SENSOR_QUALITY_TEMPERATURE_OUTLIER  (1 << 0)
+#define SENSOR_QUALITY_HUMIDITY_OUTLIER     (1 << 1)
+#define SENSOR_QUALITY_SOIL_OUTLIER         (1 << 2)
+#define SENSOR_QUALITY_LIGHT_OUTLIER        (1 << 3)
+#define SENSOR_QUALITY_LUX_OUTLIER          (1 << 4)
+#define SENSOR_QUALITY_OUTLIER_MASK         0x1F
+
+/** Reading quality flags: the sensor failed a self-diagnostic */
+#define SENSOR_QUALITY_STUCK                (1 << 5)
+#define SENSOR_QUALITY_RATE                 (1 << 6)
+#define SENSOR_QUALITY_DIVERGENT            (1 << 7)
+
+/** Readings with these flags must not be used for aggregates */
+#define SENSOR_QUALITY_SUSPECT              (SENSOR_QUALITY_STUCK | SENSOR_QUALITY_RATE)
+
+/** Bit for a sensor type in a type mask */
+#define SENSOR_TYPE_BIT(type)  (1UL << (type))
+
 /**
  * @brief Sensor configuration structure
  */
 typedef struct {
     sensor_type_t type;       /**< Type of sensor */
     uint8_t address;          /**< I2C address (for I2C sensors) */
+    uint32_t i2c_freq;        /**< Fastest I2C clock in Hz (0 = bus frequency) */
+    uint8_t mux_address;      /**< TCA9548A in front of the sensor (0 = main bus) */
+    uint8_t mux_channel;      /**< Multiplexer channel (0-7) */
     uint8_t pin;              /**< GPIO pin (for one-wire/analog sensors) */
     bool enabled;             /**< Whether sensor is enabled */
-    char name[32];            /**< Human-readable sensor name */
+    const char *name;         /**< Human-readable sensor name (not copied) */
 } sensor_config_t;
 
 /**
@@ -58,6 +84,7 @@ typedef struct {
     uint16_t light_level;    /**< Light level value (0-4095) */
     float lux;               /**< Light intensity in lux (GY-302) */
     bool valid;              /**< Whether reading is valid */
+    uint8_t quality_flags;   /**< SENSOR_QUALITY_* flags set by filtering and diagnostics */
     esp_err_t error;         /**< Error code if reading failed */
 } sensor_reading_t;
 
@@ -65,8 +92,8 @@ typedef struct {
  * @brief Sensor interface configuration
  */
 typedef struct {
-    sensor_config_t sensors[8];  /**< Array of sensor configurations */
-    uint8_t sensor_count;        /**< Number of configured sensors */
+    const sensor_config_t *sensors;  /**< Array of sensor configurations */
+    uint8_t sensor_count;        /**< Number of entries in sensors */
     uint8_t i2c_sda_pin;        /**< I2C SDA pin */
     uint8_t i2c_scl_pin;        /**< I2C SCL pin */
     uint32_t i2c_frequency;     /**< I2C frequency in Hz */
@@ -75,9 +102,22 @@ typedef struct {
     uint8_t adc_light_pin;      /**< ADC pin for light sensor */
 } sensor_interface_config_t;
 
+/**
+ * @brief Sensor bring-up state that can be carried across warm boots
+ */
+typedef struct {
+    i2c_bus_map_t i2c_map;    /**< Responding I2C addresses */
+    bool i2c_map_valid;       /**< Whether i2c_map holds discovery results */
+    uint32_t ready_mask;      /**< Sensors initialized since power-on (bit n = sensor index n) */
+    uint32_t mismatch_mask;   /**< Sensors whose last read contradicts i2c_map */
+} sensor_boot_state_t;
+
 /**
  * @brief Initialize the sensor interface
  * 
+ * The sensors are copied into the sensor registry, so the sensors array
+ * may be released afterwards; the name strings must stay valid.
+ * 
  * @param config Sensor interface configuration
  * @return ESP_OK on success, error code on failure
  */
@@ -86,12 +126,36 @@ esp_err_t sensor_interface_init(const sensor_interface_config_t *config);
 /**
  * @brief Read all configured sensors
  * 
+ * Readings are stored in the sensor registry and copied to readings,
+ * indexed like the configured sensors.
+ * 
  * @param readings Array to store sensor readings
  * @param max_readings Maximum number of readings to store
  * @return Number of valid readings, negative on error
  */
 int sensor_interface_read_all(sensor_reading_t *readings, int max_readings);
 
+/**
+ * @brief Read one sensor of a known type
+ * 
+ * For callers that know the sensor types at build time (see
+ * sensor_topology.h): the type switch and the configuration lookup of
+ * sensor_interface_read_all() are skipped. The driver is still set up
+ * and released around every read, as the drivers hold one device at a
+ * time. The reading is stored in the sensor registry and the bring-up
+ * state is updated as by sensor_interface_read_all().
+ * 
+ * @param index Sensor index
+ * @param config Sensor configuration registered at index
+ * @param reading Pointer to store the reading
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_read_aht10(int index, const sensor_config_t *config, sensor_reading_t *reading);
+esp_err_t sensor_interface_read_ds18b20(int index, const sensor_config_t *config, sensor_reading_t *reading);
+esp_err_t sensor_interface_read_gy302(int index, const sensor_config_t *config, sensor_reading_t *reading);
+esp_err_t sensor_interface_read_soil_moisture(int index, const sensor_config_t *config, sensor_reading_t *reading);
+esp_err_t sensor_interface_read_light(int index, const sensor_config_t *config, sensor_reading_t *reading);
+
 /**
  * @brief Read a specific sensor by type
  * 
@@ -108,6 +172,44 @@ esp_err_t sensor_interface_read_sensor(sensor_type_t type, sensor_reading_t *rea
  */
 int sensor_interface_scan_i2c(void);
 
+/**
+ * @brief Scan only the known I2C addresses of some sensor types
+ * 
+ * @param type_mask Sensor types to look for (SENSOR_TYPE_BIT())
+ * @return Number of devices found, -1 on failure
+ */
+int sensor_interface_scan_i2c_types(uint32_t type_mask);
+
+/**
+ * @brief Incrementally rescan the I2C bus for hot-plugged or removed sensors
+ * 
+ * Only re-probes addresses where a read contradicted the device map and
+ * absent addresses where a configured sensor type could appear, so it is
+ * cheap enough to run periodically.
+ * 
+ * @return Number of addresses whose state changed, -1 on failure
+ */
+int sensor_interface_rescan_i2c(void);
+
+/**
+ * @brief Get the sensor bring-up state
+ * 
+ * @param state Pointer to store the state
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_get_boot_state(sensor_boot_state_t *state);
+
+/**
+ * @brief Restore sensor bring-up state saved before a warm boot
+ * 
+ * Sensors marked ready skip their power-up reset and settle delays, and
+ * the I2C map stands in for a discovery scan.
+ * 
+ * @param state State to restore
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t sensor_interface_restore_boot_state(const sensor_boot_state_t *state);
+
 /**
  * @brief Get sensor status
  * 
@@ -0,0 +1,116 @@
+/**
+ * @file sensor_registry.c
+ * @brief Sensor Registry Implementation
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "sensor_registry.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "SENSOR_REGISTRY";
+
+// Global variables
+static sensor_registry_t g_registry;
+
+void sensor_registry_clear(void)
+{
+    memset(&g_registry, 0, sizeof(g_registry));
+}
+
+esp_err_t sensor_registry_add(const sensor_config_t *config, int *index)
+{
+    if (!config || config->type >= SENSOR_TYPE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (g_registry.count >= SENSOR_REGISTRY_CAPACITY) {
+        ESP_LOGE(TAG, "Registry full (%d sensors)", SENSOR_REGISTRY_CAPACITY);
+        return ESP_ERR_NO_MEM;
+    }
+
+    int i = g_registry.count++;
+    g_registry.type[i] = (uint8_t)config->type;
+    g_registry.address[i] = config->address;
+    g_registry.pin[i] = config->pin;
+    g_registry.mux_address[i] = config->mux_address;
+    g_registry.mux_channel[i] = config->mux_channel;
+    g_registry.i2c_khz[i] = (uint16_t)(config->i2c_freq / 1000);
+    g_registry.name[i] = config->name ? config->name : "";
+    if (config->enabled) {
+        g_registry.enabled_mask |= (1UL << i);
+    }
+
+    if (index) {
+        *index = i;
+    }
+    return ESP_OK;
+}
+
+const sensor_registry_t *sensor_registry_get(void)
+{
+    return &g_registry;
+}
+
+int sensor_registry_count(void)
+{
+    return g_registry.count;
+}
+
+esp_err_t sensor_registry_get_config(int index, sensor_config_t *config)
+{
+    if (!config || index < 0 || index >= g_registry.count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    config->type = (sensor_type_t)g_registry.type[index];
+    config->address = g_registry.address[index];
+    config->i2c_freq = g_registry.i2c_khz[index] * 1000UL;
+    config->mux_address = g_registry.mux_address[index];
+    config->mux_channel = g_registry.mux_channel[index];
+    config->pin = g_registry.pin[index];
+    config->enabled = (g_registry.enabled_mask >> index) & 1;
+    config->name = g_registry.name[index];
+    return ESP_OK;
+}
+
+esp_err_t sensor_registry_set_reading(int index, const sensor_reading_t *reading)
+{
+    if (!reading || index < 0 || index >= g_registry.count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    g_registry.temperature[index] = reading->temperature;
+    g_registry.humidity[index] = reading->humidity;
+    g_registry.soil_moisture[index] = reading->soil_moisture;
+    g_registry.light_level[index] = reading->light_level;
+    g_registry.lux[index] = reading->lux;
+    g_registry.quality_flags[index] = reading->quality_flags;
+    g_registry.error[index] = reading->error;
+    if (reading->valid) {
+        g_registry.valid_mask |= (1UL << index);
+    } else {
+        g_registry.valid_mask &= ~(1UL << index);
+    }
+    return ESP_OK;
+}
+
+esp_err_t sensor_registry_get_reading(int index, sensor_reading_t *reading)
+{
+    if (!reading || index < 0 || index >= g_registry.count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    reading->temperature = g_registry.temperature[index];
+    reading->humidity = g_registry.humidity[index];
+    reading->soil_moisture = g_registry.soil_moisture[index];
+    reading->light_level = g_registry.light_level[index];
+    reading->lux = g_registry.lux[index];
+    reading->valid = (g_registry.valid_mask >> index) & 1;
+    reading->quality_flags = g_registry.quality_flags[index];
+    reading->error = g_registry.error[index];
+    return ESP_OK;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file sensor_registry.h
+ * @brief Sensor Registry for Plant Monitoring System
+ *
+ * The registry holds the configured sensors and their latest readings.
+ * Data is kept in structure-of-arrays form: one column per field, indexed
+ * by sensor number, with the enabled and valid flags packed into bit
+ * masks. A sensor costs about a third of an inline sensor_config_t plus
+ * sensor_reading_t, and loops that touch one field (e.g. all temperatures)
+ * read contiguous memory.
+ *
+ * Capacity is fixed at build time by SENSOR_REGISTRY_CAPACITY, so small
+ * nodes only pay for the slots they use. Names are not copied: the
+ * registry keeps the pointer, which must stay valid (normally a string
+ * literal).
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "config.h"
+#include "sensor_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if SENSOR_REGISTRY_CAPACITY > 32
+#error "SENSOR_REGISTRY_CAPACITY must fit the 32-bit sensor masks"
+#endif
+
+/**
+ * @brief Sensor metadata and latest readings, one column per field
+ */
+typedef struct {
+    uint8_t count;                                   /**< Number of registered sensors */
+    uint32_t enabled_mask;                           /**< Enabled sensors (bit n = sensor n) */
+    uint8_t type[SENSOR_REGISTRY_CAPACITY];          /**< sensor_type_t */
+    uint8_t address[SENSOR_REGISTRY_CAPACITY];       /**< I2C address */
+    uint8_t pin[SENSOR_REGISTRY_CAPACITY];           /**< GPIO pin */
+    uint8_t mux_address[SENSOR_REGISTRY_CAPACITY];   /**< TCA9548A address (0 = main bus) */
+    uint8_t mux_channel[SENSOR_REGISTRY_CAPACITY];   /**< Multiplexer channel */
+    uint16_t i2c_khz[SENSOR_REGISTRY_CAPACITY];      /**< Fastest I2C clock in kHz (0 = bus frequency) */
+    const char *name[SENSOR_REGISTRY_CAPACITY];      /**< Human-readable name */
+
+    uint32_t valid_mask;                             /**< Sensors whose last reading is valid */
+    float temperature[SENSOR_REGISTRY_CAPACITY];     /**< Temperature in Celsius */
+    float humidity[SENSOR_REGISTRY_CAPACITY];        /**< Humidity percentage */
+    uint16_t soil_moisture[SENSOR_REGISTRY_CAPACITY];/**< Soil moisture value (0-4095) */
+    uint16_t light_level[SENSOR_REGISTRY_CAPACITY];  /**< Light level value (0-4095) */
+    float lux[SENSOR_REGISTRY_CAPACITY];             /**< Light intensity in lux */
+    uint8_t quality_flags[SENSOR_REGISTRY_CAPACITY]; /**< SENSOR_QUALITY_* flags */
+    esp_err_t error[SENSOR_REGISTRY_CAPACITY];       /**< Error code of the last reading */
+} sensor_registry_t;
+
+/**
+ * @brief Remove all sensors and readings
+ */
+void sensor_registry_clear(void);
+
+/**
+ * @brief Register a sensor
+ *
+ * @param config Sensor configuration (the name pointer is kept, not copied)
+ * @param index Optional pointer to store the sensor index
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the registry is full,
+ *         ESP_ERR_INVALID_ARG for an invalid configuration
+ */
+esp_err_t sensor_registry_add(const sensor_config_t *config, int *index);
+
+/**
+ * @brief Get read-only access to the registry columns
+ *
+ * @return Registry contents
+ */
+const sensor_registry_t *sensor_registry_get(void);
+
+/**
+ * @brief Number of registered sensors
+ *
+ * @return Sensor count
+ */
+int sensor_registry_count(void);
+
+/**
+ * @brief Assemble the configuration of one sensor
+ *
+ * @param index Sensor index
+ * @param config Pointer to store the configuration
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid index
+ */
+esp_err_t sensor_registry_get_config(int index, sensor_config_t *config);
+
+/**
+ * @brief Store the latest reading of a sensor
+ *
+ * @param index Sensor index
+ * @param reading Reading to store
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid index
+ */
+esp_err_t sensor_registry_set_reading(int index, const sensor_reading_t *reading);
+
+/**
+ * @brief Assemble the latest reading of a sensor
+ *
+ * @param index Sensor index
+ * @param reading Pointer to store the reading
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid index
+ */
+esp_err_t sensor_registry_get_reading(int index, sensor_reading_t *reading);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_REGISTRY_H
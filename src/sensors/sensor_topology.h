@@ -0,0 +1,373 @@
+/**
+ * @file sensor_topology.h
+ * @brief Compile-Time Sensor Topology for Plant Monitoring System
+ *
+ * C++ alternative to the runtime sensor table for nodes whose hardware is
+ * fixed at build time. The sensors are declared as a type list:
+ *
+ *     static constexpr char k_air[] = "AHT10-1";
+ *     static constexpr char k_soil[] = "Soil-Moisture";
+ *     using node = sensor_topology::topology<
+ *         sensor_topology::aht10<0x38, k_air>,
+ *         sensor_topology::soil_moisture<k_soil>>;
+ *
+ * and the compiler generates, for exactly that list:
+ * - node::sensors, the sensor table to pass to sensor_interface_init(),
+ *   so registration, calibration, discovery and the boot record work as
+ *   with a runtime table;
+ * - node::read_all(), which reads the sensors in an order planned at
+ *   compile time (one multiplexer channel switch per channel, as
+ *   sensor_interface_read_all() does) as an unrolled sequence of calls to
+ *   the typed readers, without the type switch, the configuration lookups
+ *   or the disabled-sensor checks, and with only the readers of the
+ *   listed types in the loop;
+ * - node::score(), which averages the readings into the health engine
+ *   inputs, with the quantities each sensor contributes fixed by its
+ *   type (DS18B20 probes contribute none).
+ *
+ * Only the dispatch is resolved at compile time. The typed readers are
+ * the same sensor_interface_read_*() calls sensor_interface_read_all()
+ * makes, so each read still builds the driver configuration and runs the
+ * driver's init and deinit: the AHT10, GY-302 and DS18B20 drivers hold a
+ * single device, and that is how several sensors of one type share them.
+ * An AHT10 already brought up skips its soft reset (see
+ * aht10_config_t::skip_reset).
+ *
+ * Sensor indices are the positions in the list. sensor_interface.h
+ * remains the generic API for configurations only known at run time.
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef SENSOR_TOPOLOGY_H
+#define SENSOR_TOPOLOGY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <tuple>
+#include <utility>
+#include "config.h"
+#include "sensor_interface.h"
+#include "reading_history.h"
+#include "health_engine.h"
+#include "trace.h"
+
+namespace sensor_topology {
+
+/**
+ * @brief Per-quantity sums of the readings that go into the health score
+ */
+struct health_sums {
+    int32_t value[HISTORY_QTY_COUNT] = {};
+    int count[HISTORY_QTY_COUNT] = {};
+
+    void add(history_quantity_t quantity, int32_t fixed_point)
+    {
+        value[quantity] += fixed_point;
+        count[quantity]++;
+    }
+};
+
+/**
+ * @brief AHT10 temperature/humidity sensor
+ *
+ * @tparam Address I2C address
+ * @tparam Name Sensor name (a static character array)
+ * @tparam MuxAddress TCA9548A in front of the sensor (0 = main bus)
+ * @tparam MuxChannel Multiplexer channel (0-7)
+ * @tparam I2cFreq Fastest I2C clock in Hz (0 = bus frequency)
+ */
+template <uint8_t Address, const char *Name, uint8_t MuxAddress = 0, uint8_t MuxChannel = 0,
+          uint32_t I2cFreq = I2C_FAST_MODE_FREQ_HZ>
+struct aht10 {
+    static constexpr bool i2c = true;
+    static constexpr sensor_config_t config = {
+        .type = SENSOR_TYPE_AHT10,
+        .address = Address,
+        .i2c_freq = I2cFreq,
+        .mux_address = MuxAddress,
+        .mux_channel = MuxChannel,
+        .pin = 0,
+        .enabled = true,
+        .name = Name
+    };
+
+    static esp_err_t read(int index, sensor_reading_t *reading)
+    {
+        return sensor_interface_read_aht10(index, &config, reading);
+    }
+
+    static void score(const sensor_reading_t &reading, health_sums &sums)
+    {
+        sums.add(HISTORY_QTY_TEMPERATURE, reading_history_encode(HISTORY_QTY_TEMPERATURE, reading.temperature));
+        sums.add(HISTORY_QTY_HUMIDITY, reading_history_encode(HISTORY_QTY_HUMIDITY, reading.humidity));
+    }
+};
+
+/**
+ * @brief DS18B20 waterproof temperature probe
+ *
+ * Measures soil (or leaf) temperature, which the health profiles do not
+ * score.
+ *
+ * @tparam Pin One-Wire GPIO pin
+ * @tparam Name Sensor name (a static character array)
+ */
+template <uint8_t Pin, const char *Name>
+struct ds18b20 {
+    static constexpr bool i2c = false;
+    static constexpr sensor_config_t config = {
+        .type = SENSOR_TYPE_DS18B20,
+        .address = 0,
+        .i2c_freq = 0,
+        .mux_address = 0,
+        .mux_channel = 0,
+        .pin = Pin,
+        .enabled = true,
+        .name = Name
+    };
+
+    static esp_err_t read(int index, sensor_reading_t *reading)
+    {
+        return sensor_interface_read_ds18b20(index, &config, reading);
+    }
+
+    static void score(const sensor_reading_t &, health_sums &)
+    {
+    }
+};
+
+/**
+ * @brief GY-302 (BH1750) digital light sensor
+ *
+ * @tparam Address I2C address
+ * @tparam Name Sensor name (a static character array)
+ * @tparam MuxAddress TCA9548A in front of the sensor (0 = main bus)
+ * @tparam MuxChannel Multiplexer channel (0-7)
+ * @tparam I2cFreq Fastest I2C clock in Hz (0 = bus frequency)
+ */
+template <uint8_t Address, const char *Name, uint8_t MuxAddress = 0, uint8_t MuxChannel = 0,
+          uint32_t I2cFreq = I2C_FAST_MODE_FREQ_HZ>
+struct gy302 {
+    static constexpr bool i2c = true;
+    static constexpr sensor_config_t config = {
+        .type = SENSOR_TYPE_GY302,
+        .address = Address,
+        .i2c_freq = I2cFreq,
+        .mux_address = MuxAddress,
+        .mux_channel = MuxChannel,
+        .pin = 0,
+        .enabled = true,
+        .name = Name
+    };
+
+    static esp_err_t read(int index, sensor_reading_t *reading)
+    {
+        return sensor_interface_read_gy302(index, &config, reading);
+    }
+
+    static void score(const sensor_reading_t &reading, health_sums &sums)
+    {
+        sums.add(HISTORY_QTY_LUX, reading_history_encode(HISTORY_QTY_LUX, reading.lux));
+    }
+};
+
+/**
+ * @brief Analog soil moisture sensor
+ *
+ * Read on the ADC channel given by adc_soil_pin in the interface
+ * configuration, like soil moisture sensors in the runtime table.
+ *
+ * @tparam Name Sensor name (a static character array)
+ */
+template <const char *Name>
+struct soil_moisture {
+    static constexpr bool i2c = false;
+    static constexpr sensor_config_t config = {
+        .type = SENSOR_TYPE_SOIL_MOISTURE,
+        .address = 0,
+        .i2c_freq = 0,
+        .mux_address = 0,
+        .mux_channel = 0,
+        .pin = 0,
+        .enabled = true,
+        .name = Name
+    };
+
+    static esp_err_t read(int index, sensor_reading_t *reading)
+    {
+        return sensor_interface_read_soil_moisture(index, &config, reading);
+    }
+
+    static void score(const sensor_reading_t &reading, health_sums &sums)
+    {
+        sums.add(HISTORY_QTY_SOIL_MOISTURE, reading.soil_moisture);
+    }
+};
+
+/**
+ * @brief Analog light sensor
+ *
+ * Read on the ADC channel given by adc_light_pin in the interface
+ * configuration, like light sensors in the runtime table.
+ *
+ * @tparam Name Sensor name (a static character array)
+ */
+template <const char *Name>
+struct light {
+    static constexpr bool i2c = false;
+    static constexpr sensor_config_t config = {
+        .type = SENSOR_TYPE_LIGHT,
+        .address = 0,
+        .i2c_freq = 0,
+        .mux_address = 0,
+        .mux_channel = 0,
+        .pin = 0,
+        .enabled = true,
+        .name = Name
+    };
+
+    static esp_err_t read(int index, sensor_reading_t *reading)
+    {
+        return sensor_interface_read_light(index, &config, reading);
+    }
+
+    static void score(const sensor_reading_t &reading, health_sums &sums)
+    {
+        sums.add(HISTORY_QTY_LIGHT_LEVEL, reading.light_level);
+    }
+};
+
+/**
+ * @brief Route key of a sensor, as sensor_route() in sensor_interface.c
+ */
+template <typename Sensor>
+constexpr uint16_t route()
+{
+    if (!Sensor::i2c || Sensor::config.mux_address == 0) {
+        return 0;
+    }
+    return (uint16_t)((Sensor::config.mux_address << 8) | (Sensor::config.mux_channel + 1));
+}
+
+/**
+ * @brief Order sensors so that each multiplexer channel is selected once per cycle
+ */
+template <typename... Sensors>
+constexpr std::array<uint8_t, sizeof...(Sensors)> plan_read_order()
+{
+    constexpr size_t count = sizeof...(Sensors);
+    const uint16_t key[count] = { route<Sensors>()... };
+    std::array<uint8_t, count> order = {};
+    for (size_t i = 0; i < count; i++) {
+        // Stable insertion sort: list order is kept within a channel
+        size_t j = i;
+        while (j > 0 && key[order[j - 1]] > key[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint8_t)i;
+    }
+    return order;
+}
+
+/**
+ * @brief A node's sensors, in registry order
+ *
+ * @tparam Sensors Sensor descriptors (aht10, ds18b20, gy302, soil_moisture, light)
+ */
+template <typename... Sensors>
+class topology {
+public:
+    /** Number of sensors */
+    static constexpr int count = sizeof...(Sensors);
+    static_assert(count > 0 && count <= SENSOR_INTERFACE_MAX_SENSORS, "Sensor count exceeds the registry capacity");
+
+    /** Sensor table for sensor_interface_init() */
+    static constexpr sensor_config_t sensors[count] = { Sensors::config... };
+
+    /** Read order: main bus first, then one run per multiplexer channel */
+    static constexpr std::array<uint8_t, count> read_order = plan_read_order<Sensors...>();
+
+    /**
+     * @brief Read all sensors
+     *
+     * Same contract as sensor_interface_read_all(): readings are stored
+     * in the sensor registry and in readings, indexed like the list.
+     *
+     * @param readings Array to store sensor readings
+     * @return Number of valid readings
+     */
+    template <size_t N>
+    static int read_all(sensor_reading_t (&readings)[N])
+    {
+        static_assert(N >= (size_t)count, "Readings array is smaller than the topology");
+        TRACE_BEGIN(TRACE_EVT_SENSOR_READ_ALL, count);
+        int valid_readings = read_sequence(readings, std::make_index_sequence<count>());
+        TRACE_END(TRACE_EVT_SENSOR_READ_ALL, valid_readings);
+        return valid_readings;
+    }
+
+    /**
+     * @brief Average the readings into the health engine inputs
+     *
+     * Invalid and suspect readings are left out. Sets the value and the
+     * present bit of every quantity measured by at least one sensor.
+     *
+     * @param readings Readings, indexed like the list
+     * @param inputs Health inputs to update
+     */
+    static void score(const sensor_reading_t *readings, health_inputs_t *inputs)
+    {
+        health_sums sums;
+        score_sequence(readings, sums, std::make_index_sequence<count>());
+
+        for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+            if (sums.count[q] > 0) {
+                inputs->value[q] = sums.value[q] / sums.count[q];
+                inputs->present |= (uint8_t)(1 << q);
+            }
+        }
+    }
+
+private:
+    template <size_t I>
+    using sensor = std::tuple_element_t<I, std::tuple<Sensors...>>;
+
+    template <size_t I>
+    static int read_one(sensor_reading_t *readings)
+    {
+        esp_err_t ret = sensor<I>::read((int)I, &readings[I]);
+        return ret == ESP_OK && readings[I].valid;
+    }
+
+    template <size_t... N>
+    static int read_sequence(sensor_reading_t *readings, std::index_sequence<N...>)
+    {
+        int valid_readings = 0;
+        ((valid_readings += read_one<read_order[N]>(readings)), ...);
+        return valid_readings;
+    }
+
+    template <size_t I>
+    static void score_one(const sensor_reading_t *readings, health_sums &sums)
+    {
+        const sensor_reading_t &reading = readings[I];
+        if (reading.valid && !(reading.quality_flags & SENSOR_QUALITY_SUSPECT)) {
+            sensor<I>::score(reading, sums);
+        }
+    }
+
+    template <size_t... I>
+    static void score_sequence(const sensor_reading_t *readings, health_sums &sums, std::index_sequence<I...>)
+    {
+        (score_one<I>(readings, sums), ...);
+    }
+};
+
+} // namespace sensor_topology
+
+#endif // SENSOR_TOPOLOGY_H
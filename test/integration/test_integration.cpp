@@ -32,6 +32,10 @@ protected:
         // Initialize comprehensive test configuration
         memset(&sensor_config, 0, sizeof(sensor_interface_config_t));
         memset(&display_config, 0, sizeof(display_interface_config_t));
+        memset(sensors, 0, sizeof(sensors));
+        memset(displays, 0, sizeof(displays));
+        sensor_config.sensors = sensors;
+        display_config.displays = displays;
         
         // Configure all available sensors
         sensor_config.sensor_count = 6;
@@ -43,38 +47,38 @@ protected:
         sensor_config.adc_light_pin = 2;
         
         // AHT10 sensors
-        sensor_config.sensors[0].type = SENSOR_TYPE_AHT10;
-        sensor_config.sensors[0].address = 0x38;
-        sensor_config.sensors[0].enabled = true;
-        strcpy(sensor_config.sensors[0].name, "AHT10-1");
+        sensors[0].type = SENSOR_TYPE_AHT10;
+        sensors[0].address = 0x38;
+        sensors[0].enabled = true;
+        sensors[0].name = "AHT10-1";
         
-        sensor_config.sensors[1].type = SENSOR_TYPE_AHT10;
-        sensor_config.sensors[1].address = 0x39;
-        sensor_config.sensors[1].enabled = true;
-        strcpy(sensor_config.sensors[1].name, "AHT10-2");
+        sensors[1].type = SENSOR_TYPE_AHT10;
+        sensors[1].address = 0x39;
+        sensors[1].enabled = true;
+        sensors[1].name = "AHT10-2";
         
         // DS18B20 sensor
-        sensor_config.sensors[2].type = SENSOR_TYPE_DS18B20;
-        sensor_config.sensors[2].pin = 4;
-        sensor_config.sensors[2].enabled = true;
-        strcpy(sensor_config.sensors[2].name, "DS18B20-Waterproof");
+        sensors[2].type = SENSOR_TYPE_DS18B20;
+        sensors[2].pin = 4;
+        sensors[2].enabled = true;
+        sensors[2].name = "DS18B20-Waterproof";
         
         // GY-302 sensor
-        sensor_config.sensors[3].type = SENSOR_TYPE_GY302;
-        sensor_config.sensors[3].address = 0x23;
-        sensor_config.sensors[3].enabled = true;
-        strcpy(sensor_config.sensors[3].name, "GY302-Light");
+        sensors[3].type = SENSOR_TYPE_GY302;
+        sensors[3].address = 0x23;
+        sensors[3].enabled = true;
+        sensors[3].name = "GY302-Light";
         
         // Analog sensors
-        sensor_config.sensors[4].type = SENSOR_TYPE_SOIL_MOISTURE;
-        sensor_config.sensors[4].pin = 1;
-        sensor_config.sensors[4].enabled = true;
-        strcpy(sensor_config.sensors[4].name, "Soil-Moisture");
+        sensors[4].type = SENSOR_TYPE_SOIL_MOISTURE;
+        sensors[4].pin = 1;
+        sensors[4].enabled = true;
+        sensors[4].name = "Soil-Moisture";
         
-        sensor_config.sensors[5].type = SENSOR_TYPE_LIGHT;
-        sensor_config.sensors[5].pin = 2;
-        sensor_config.sensors[5].enabled = true;
-        strcpy(sensor_config.sensors[5].name, "Light-Sensor");
+        sensors[5].type = SENSOR_TYPE_LIGHT;
+        sensors[5].pin = 2;
+        sensors[5].enabled = true;
+        sensors[5].name = "Light-Sensor";
         
         // Configure all available displays
         display_config.display_count = 3;
@@ -84,28 +88,28 @@ protected:
         display_config.auto_off_timeout = 0;
         
         // Console display
-        display_config.displays[0].type = DISPLAY_TYPE_CONSOLE;
-        display_config.displays[0].enabled = true;
-        strcpy(display_config.displays[0].name, "Console-Display");
+        displays[0].type = DISPLAY_TYPE_CONSOLE;
+        displays[0].enabled = true;
+        displays[0].name = "Console-Display";
         
         // Built-in OLED
-        display_config.displays[1].type = DISPLAY_TYPE_BUILTIN_SSD1306;
-        display_config.displays[1].i2c_address = 0x3C;
-        display_config.displays[1].sda_pin = 21;
-        display_config.displays[1].scl_pin = 22;
-        display_config.displays[1].enabled = true;
-        strcpy(display_config.displays[1].name, "Built-in-OLED");
+        displays[1].type = DISPLAY_TYPE_BUILTIN_SSD1306;
+        displays[1].i2c_address = 0x3C;
+        displays[1].sda_pin = 21;
+        displays[1].scl_pin = 22;
+        displays[1].enabled = true;
+        displays[1].name = "Built-in-OLED";
         
         // E-paper display
-        display_config.displays[2].type = DISPLAY_TYPE_EPAPER_SPI;
-        display_config.displays[2].spi_cs_pin = 5;
-        display_config.displays[2].spi_dc_pin = 17;
-        display_config.displays[2].spi_rst_pin = 16;
-        display_config.displays[2].spi_mosi_pin = 23;
-        display_config.displays[2].spi_sck_pin = 18;
-        display_config.displays[2].spi_busy_pin = 4;
-        display_config.displays[2].enabled = true;
-        strcpy(display_config.displays[2].name, "E-paper-Display");
+        displays[2].type = DISPLAY_TYPE_EPAPER_SPI;
+        displays[2].spi_cs_pin = 5;
+        displays[2].spi_dc_pin = 17;
+        displays[2].spi_rst_pin = 16;
+        displays[2].spi_mosi_pin = 23;
+        displays[2].spi_sck_pin = 18;
+        displays[2].spi_busy_pin = 4;
+        displays[2].enabled = true;
+        displays[2].name = "E-paper-Display";
     }
     
     void TearDown() override {
@@ -116,6 +120,8 @@ protected:
     
     sensor_interface_config_t sensor_config;
     display_interface_config_t display_config;
+    sensor_config_t sensors[SENSOR_INTERFACE_MAX_SENSORS];
+    display_config_t displays[4];
 };
 
 /**
@@ -436,8 +442,8 @@ TEST_F(PlantMonitorIntegrationTest, ErrorHandlingInvalidData) {
  */
 TEST_F(PlantMonitorIntegrationTest, ErrorHandlingMissingSensors) {
     // Configure with disabled sensors
-    sensor_config.sensors[0].enabled = false;
-    sensor_config.sensors[1].enabled = false;
+    sensors[0].enabled = false;
+    sensors[1].enabled = false;
     
     esp_err_t ret = sensor_interface_init(&sensor_config);
     ASSERT_EQ(ret, ESP_OK);
@@ -481,15 +487,17 @@ TEST_F(PlantMonitorIntegrationTest, PerformanceUnderLoad) {
  */
 TEST_F(PlantMonitorIntegrationTest, DifferentConfigurations) {
     // Test minimal configuration
+    sensor_config_t minimal_sensors[1] = {};
     sensor_interface_config_t minimal_config = {0};
+    minimal_config.sensors = minimal_sensors;
     minimal_config.sensor_count = 1;
     minimal_config.i2c_sda_pin = 21;
     minimal_config.i2c_scl_pin = 22;
     minimal_config.i2c_frequency = 100000;
-    minimal_config.sensors[0].type = SENSOR_TYPE_AHT10;
-    minimal_config.sensors[0].address = 0x38;
-    minimal_config.sensors[0].enabled = true;
-    strcpy(minimal_config.sensors[0].name, "Single-Sensor");
+    minimal_sensors[0].type = SENSOR_TYPE_AHT10;
+    minimal_sensors[0].address = 0x38;
+    minimal_sensors[0].enabled = true;
+    minimal_sensors[0].name = "Single-Sensor";
     
     esp_err_t ret = sensor_interface_init(&minimal_config);
     EXPECT_EQ(ret, ESP_OK);
@@ -0,0 +1,126 @@
+/**
+ * @file test_alert_engine.cpp
+ * @brief Unit Tests for the Threshold Alert State Machine
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "alert_engine.h"
+
+/**
+ * @brief Test fixture with a high-temperature and a dry-soil rule
+ */
+class AlertEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        alert_engine_init(&engine);
+    }
+
+    /** Feed one sample, return the number of transitions */
+    int feed(history_quantity_t quantity, int16_t value, uint32_t time_s) {
+        return alert_engine_update(&engine, rules, 2, quantity, value, time_s, transitions, 4);
+    }
+
+    const alert_rule_t rules[2] = {
+        { "temperature_high", HISTORY_QTY_TEMPERATURE, ALERT_ABOVE, ALERT_SEVERITY_WARNING, 3500, 100, 300, 3600 },
+        { "soil_dry", HISTORY_QTY_SOIL_MOISTURE, ALERT_BELOW, ALERT_SEVERITY_CRITICAL, 1000, 100, 0, 0 },
+    };
+    alert_engine_t engine;
+    alert_transition_t transitions[4];
+};
+
+/**
+ * @brief A breach is raised once it has lasted the minimum duration
+ */
+TEST_F(AlertEngineTest, RaisesAfterMinimumDuration) {
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3600, 1000), 0);
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3700, 1200), 0);
+    ASSERT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3650, 1300), 1);
+    EXPECT_EQ(transitions[0].rule, 0);
+    EXPECT_TRUE(transitions[0].raised);
+    EXPECT_EQ(transitions[0].value, 3650);
+    EXPECT_EQ(transitions[0].timestamp, 1300u);
+    EXPECT_TRUE(alert_engine_is_active(&engine, 0));
+
+    // Further breaching samples are not transitions
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3800, 1600), 0);
+}
+
+/**
+ * @brief A short breach does not raise, and other quantities are ignored
+ */
+TEST_F(AlertEngineTest, DebouncesShortBreach) {
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3600, 1000), 0);
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3400, 1200), 0);
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3600, 1400), 0);
+    EXPECT_EQ(feed(HISTORY_QTY_HUMIDITY, 9000, 1800), 0);
+    EXPECT_FALSE(alert_engine_is_active(&engine, 0));
+}
+
+/**
+ * @brief Values inside the hysteresis band keep the alert raised
+ */
+TEST_F(AlertEngineTest, ClearsPastHysteresis) {
+    ASSERT_EQ(feed(HISTORY_QTY_SOIL_MOISTURE, 900, 0), 1);
+    EXPECT_TRUE(transitions[0].raised);
+
+    // Hovering around the threshold does not toggle the alert
+    for (uint32_t t = 1; t < 20; t++) {
+        EXPECT_EQ(feed(HISTORY_QTY_SOIL_MOISTURE, (int16_t)(t % 2 ? 1050 : 980), t), 0);
+    }
+    EXPECT_EQ(feed(HISTORY_QTY_SOIL_MOISTURE, 700, 20), 0);
+
+    ASSERT_EQ(feed(HISTORY_QTY_SOIL_MOISTURE, 1100, 21), 1);
+    EXPECT_FALSE(transitions[0].raised);
+    EXPECT_EQ(transitions[0].rule, 1);
+    EXPECT_EQ(transitions[0].peak, 700);
+    EXPECT_FALSE(alert_engine_is_active(&engine, 1));
+}
+
+/**
+ * @brief Recovery must last the minimum duration too, then the cooldown applies
+ */
+TEST_F(AlertEngineTest, DebouncesRecoveryAndCoolsDown) {
+    feed(HISTORY_QTY_TEMPERATURE, 3600, 0);
+    ASSERT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3600, 300), 1);
+
+    // A brief dip below the band is not a recovery
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3300, 600), 0);
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3450, 700), 0);
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3300, 800), 0);
+    ASSERT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3300, 1100), 1);
+    EXPECT_FALSE(transitions[0].raised);
+
+    // A new breach within the cooldown waits for it to pass
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3600, 1200), 0);
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3600, 2000), 0);
+    EXPECT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3600, 4600), 0);
+    ASSERT_EQ(feed(HISTORY_QTY_TEMPERATURE, 3600, 4700), 1);
+    EXPECT_TRUE(transitions[0].raised);
+}
+
+/**
+ * @brief The built-in rules follow the config thresholds
+ */
+TEST(AlertEngineDefaults, MatchConfig) {
+    int count = 0;
+    const alert_rule_t *rules = alert_engine_default_rules(&count);
+    ASSERT_GT(count, 0);
+    ASSERT_LE(count, ALERT_ENGINE_MAX_RULES);
+
+    bool found = false;
+    for (int i = 0; i < count; i++) {
+        if (std::string(rules[i].name) == "soil_dry") {
+            EXPECT_EQ(rules[i].quantity, HISTORY_QTY_SOIL_MOISTURE);
+            EXPECT_EQ(rules[i].direction, ALERT_BELOW);
+            EXPECT_EQ(rules[i].threshold, ALERT_SOIL_MIN);
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+    EXPECT_STREQ(alert_engine_severity_name(ALERT_SEVERITY_CRITICAL), "critical");
+}
@@ -0,0 +1,125 @@
+/**
+ * @file test_anomaly_detector.cpp
+ * @brief Unit Tests for EWMA Anomaly Detection
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include "anomaly_detector.h"
+
+/**
+ * @brief Test fixture with a temperature channel
+ */
+class AnomalyDetectorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        anomaly_detector_init(&detector, HISTORY_QTY_TEMPERATURE);
+    }
+
+    /** Feed noisy samples around a level, return how many fired */
+    int feed(int samples, int16_t level, int noise) {
+        std::uniform_int_distribution<int> jitter(-noise, noise);
+        int fired = 0;
+        for (int i = 0; i < samples; i++) {
+            fired += anomaly_detector_update(&detector, (int16_t)(level + jitter(rng)), NULL);
+        }
+        return fired;
+    }
+
+    anomaly_detector_t detector;
+    std::mt19937 rng{3};
+};
+
+/**
+ * @brief Noise around a steady level does not fire
+ */
+TEST_F(AnomalyDetectorTest, QuietOnNoise) {
+    EXPECT_EQ(feed(2000, 2200, 60), 0);
+}
+
+/**
+ * @brief A spike fires once with its z-score, then the channel holds off
+ */
+TEST_F(AnomalyDetectorTest, FiresOnSpike) {
+    feed(200, 2200, 20);
+
+    anomaly_event_t event;
+    ASSERT_TRUE(anomaly_detector_update(&detector, 3200, &event));
+    EXPECT_EQ(event.quantity, HISTORY_QTY_TEMPERATURE);
+    EXPECT_EQ(event.value, 3200);
+    EXPECT_NEAR(event.mean, 2200, 10);
+    // The noise is below the floor, so the deviation is measured in floors
+    EXPECT_NEAR(event.z, 100 * 1000 / anomaly_detector_min_sigma(HISTORY_QTY_TEMPERATURE), 100);
+
+    // Further spikes within the hold-off stay quiet
+    for (int i = 0; i < ANOMALY_HOLDOFF_SAMPLES; i++) {
+        EXPECT_FALSE(anomaly_detector_update(&detector, (int16_t)(i % 2 ? 3200 : 1200), NULL)) << "sample " << i;
+    }
+
+    // Once the spikes have decayed out of the variance, a dip fires
+    EXPECT_EQ(feed(300, 2200, 20), 0);
+    ASSERT_TRUE(anomaly_detector_update(&detector, 1200, &event));
+    EXPECT_LT(event.z, 0);
+}
+
+/**
+ * @brief A lasting step fires once and becomes the new normal
+ */
+TEST_F(AnomalyDetectorTest, AdaptsToStep) {
+    feed(200, 2200, 20);
+    EXPECT_EQ(feed(500, 2800, 20), 1);
+    EXPECT_NEAR(detector.mean >> ANOMALY_FRACTION_BITS, 2800, 10);
+}
+
+/**
+ * @brief Nothing fires during warm-up, and the floor keeps flat signals quiet
+ */
+TEST_F(AnomalyDetectorTest, WarmUpAndFloor) {
+    for (int i = 0; i < ANOMALY_WARMUP_SAMPLES - 1; i++) {
+        EXPECT_FALSE(anomaly_detector_update(&detector, (int16_t)(i % 2 ? 2200 : 5000), NULL));
+    }
+
+    anomaly_detector_init(&detector, HISTORY_QTY_TEMPERATURE);
+    for (int i = 0; i < 100; i++) {
+        anomaly_detector_update(&detector, 2200, NULL);
+    }
+    int16_t sigma = anomaly_detector_min_sigma(HISTORY_QTY_TEMPERATURE);
+    EXPECT_FALSE(anomaly_detector_update(&detector, (int16_t)(2200 + (ANOMALY_Z_THRESHOLD - 1) * sigma), NULL));
+
+    anomaly_detector_init(&detector, HISTORY_QTY_TEMPERATURE);
+    for (int i = 0; i < 100; i++) {
+        anomaly_detector_update(&detector, 2200, NULL);
+    }
+    EXPECT_TRUE(anomaly_detector_update(&detector, (int16_t)(2200 + (ANOMALY_Z_THRESHOLD + 1) * sigma), NULL));
+}
+
+/**
+ * @brief The fixed-point state tracks a float EWMA
+ */
+TEST_F(AnomalyDetectorTest, MatchesFloatEwma) {
+    const double alpha = 1.0 / (1 << ANOMALY_EWMA_SHIFT);
+    std::normal_distribution<double> noise(0.0, 80.0);
+    double mean = 0.0;
+    double variance = 0.0;
+
+    for (int i = 0; i < 3000; i++) {
+        int16_t value = (int16_t)std::lround(1500.0 + 500.0 * std::sin(i / 300.0) + noise(rng));
+        if (i == 0) {
+            mean = value;
+        } else {
+            double diff = value - mean;
+            mean += alpha * diff;
+            variance = (1.0 - alpha) * (variance + alpha * diff * diff);
+        }
+        anomaly_detector_update(&detector, value, NULL);
+    }
+
+    EXPECT_NEAR(detector.mean / (double)(1 << ANOMALY_FRACTION_BITS), mean, 2.0);
+    EXPECT_NEAR(std::sqrt(detector.variance / (double)(1 << ANOMALY_FRACTION_BITS)), std::sqrt(variance),
+                0.05 * std::sqrt(variance));
+}
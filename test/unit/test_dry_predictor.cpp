@@ -0,0 +1,152 @@
+/**
+ * @file test_dry_predictor.cpp
+ * @brief Unit Tests for Time-to-Dry Prediction
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <deque>
+#include <random>
+#include "dry_predictor.h"
+
+/**
+ * @brief Test fixture with an empty predictor
+ */
+class DryPredictorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dry_predictor_init(&predictor);
+    }
+
+    /** Feed one reading every period_s, falling by drop per reading */
+    uint32_t feed(uint32_t start, int readings, uint32_t period_s, int16_t first, int16_t drop) {
+        uint32_t t = start;
+        for (int i = 0; i < readings; i++) {
+            t = start + i * period_s;
+            dry_predictor_update(&predictor, (int16_t)(first - i * drop), t);
+        }
+        return t;
+    }
+
+    dry_predictor_t predictor;
+};
+
+/**
+ * @brief A steady decline is extrapolated to the threshold
+ */
+TEST_F(DryPredictorTest, PredictsLinearDrying) {
+    // 10 units per 5 minutes = 120 per hour, 6 hours of readings
+    uint32_t last = feed(1000, 73, 300, 3000, 10);
+
+    float slope;
+    ASSERT_TRUE(dry_predictor_slope(&predictor, &slope));
+    EXPECT_NEAR(slope, -120.0f, 0.01f);
+
+    // The last reading (2280) is 1280 above the threshold
+    EXPECT_NEAR(dry_predictor_hours(&predictor, 1000, last), 1280.0f / 120.0f, 0.01f);
+    EXPECT_NEAR(dry_predictor_hours(&predictor, 1000, last + 7200), 1280.0f / 120.0f - 2.0f, 0.01f);
+    EXPECT_EQ(dry_predictor_hours(&predictor, 1000, last + 100 * 3600), 0.0f);
+    EXPECT_EQ(dry_predictor_hours(&predictor, 2500, last), 0.0f);
+}
+
+/**
+ * @brief No prediction without enough samples or without a drying trend
+ */
+TEST_F(DryPredictorTest, NoPredictionWithoutTrend) {
+    float slope;
+    EXPECT_FALSE(dry_predictor_slope(&predictor, &slope));
+    EXPECT_EQ(dry_predictor_hours(&predictor, 1000, 0), DRY_PREDICTOR_NONE);
+
+    uint32_t last = feed(0, 4 * DRY_PREDICTOR_MIN_SAMPLES, DRY_PREDICTOR_INTERVAL_S, 2000, 0);
+    ASSERT_TRUE(dry_predictor_slope(&predictor, &slope));
+    EXPECT_EQ(slope, 0.0f);
+    EXPECT_EQ(dry_predictor_hours(&predictor, 1000, last), DRY_PREDICTOR_NONE);
+
+    // Drying so slowly that the threshold is months away
+    dry_predictor_init(&predictor);
+    last = feed(0, DRY_PREDICTOR_SAMPLES, DRY_PREDICTOR_INTERVAL_S, 3000, 0);
+    dry_predictor_update(&predictor, 2999, last + DRY_PREDICTOR_INTERVAL_S);
+    dry_predictor_update(&predictor, 2999, last + 2 * DRY_PREDICTOR_INTERVAL_S);
+    EXPECT_EQ(dry_predictor_hours(&predictor, 1000, last), DRY_PREDICTOR_NONE);
+}
+
+/**
+ * @brief Watering, a clock set back and a long gap restart the fit
+ */
+TEST_F(DryPredictorTest, RestartsFit) {
+    uint32_t last = feed(0, 20, DRY_PREDICTOR_INTERVAL_S, 3000, 20);
+    EXPECT_GT(dry_predictor_hours(&predictor, 1000, last), 0.0f);
+
+    // Watered back up: the drying samples no longer apply
+    dry_predictor_update(&predictor, 3200, last + DRY_PREDICTOR_INTERVAL_S);
+    dry_predictor_update(&predictor, 3200, last + 2 * DRY_PREDICTOR_INTERVAL_S);
+    EXPECT_EQ(predictor.count, 1);
+
+    last = feed(last + 3 * DRY_PREDICTOR_INTERVAL_S, 10, DRY_PREDICTOR_INTERVAL_S, 3180, 20);
+    EXPECT_GT(predictor.count, 1);
+    dry_predictor_update(&predictor, 3000, last - 1);
+    EXPECT_EQ(predictor.count, 0);
+
+    last = feed(0, 10, DRY_PREDICTOR_INTERVAL_S, 3000, 20);
+    dry_predictor_update(&predictor, 2800, last + (DRY_PREDICTOR_SAMPLES + 1) * DRY_PREDICTOR_INTERVAL_S);
+    EXPECT_EQ(predictor.count, 0);
+}
+
+/**
+ * @brief Readings within one interval are averaged into one sample
+ */
+TEST_F(DryPredictorTest, AveragesReadings) {
+    dry_predictor_update(&predictor, 2000, 100);
+    dry_predictor_update(&predictor, 2010, 130);
+    dry_predictor_update(&predictor, 2021, 160);
+    EXPECT_EQ(predictor.count, 0);
+
+    dry_predictor_update(&predictor, 1990, 100 + DRY_PREDICTOR_INTERVAL_S);
+    ASSERT_EQ(predictor.count, 1);
+    EXPECT_EQ(predictor.value[0], 2010);
+    EXPECT_EQ(predictor.time[0], 130u);
+}
+
+/**
+ * @brief The incremental fit matches a direct fit over a long noisy series
+ *
+ * The series is long enough for samples to leave the ring and for the
+ * sums to move to a later origin.
+ */
+TEST_F(DryPredictorTest, MatchesDirectFit) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> noise(-50, 50);
+    std::deque<std::pair<double, double>> window;
+
+    for (int i = 0; i < 2000; i++) {
+        uint32_t t = 50000 + (uint32_t)i * DRY_PREDICTOR_INTERVAL_S;
+        int16_t value = (int16_t)(2500 - i / 2 + noise(rng));
+        dry_predictor_update(&predictor, value, t);
+
+        // The reading is committed when the next one arrives
+        if (i > 0 && i % 97 == 0) {
+            double n = window.size();
+            double st = 0, sv = 0, stt = 0, stv = 0;
+            for (const auto &sample : window) {
+                st += sample.first;
+                sv += sample.second;
+                stt += sample.first * sample.first;
+                stv += sample.first * sample.second;
+            }
+            double expected = (n * stv - st * sv) / (n * stt - st * st) * 3600.0;
+
+            float slope;
+            ASSERT_TRUE(dry_predictor_slope(&predictor, &slope));
+            EXPECT_NEAR(slope, expected, 1e-3 * std::fabs(expected) + 1e-3) << "reading " << i;
+        }
+
+        window.emplace_back((double)(t - 50000), (double)value);
+        if (window.size() > DRY_PREDICTOR_SAMPLES) {
+            window.pop_front();
+        }
+    }
+}
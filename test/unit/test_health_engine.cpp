@@ -0,0 +1,201 @@
+/**
+ * @file test_health_engine.cpp
+ * @brief Unit Tests for the Plant Health Engine
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "health_engine.h"
+
+/**
+ * @brief Test fixture with a context on the default profile
+ */
+class HealthEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        health_engine_set_profile(&context, NULL);
+    }
+
+    health_result_t evaluate(int32_t temperature, int32_t humidity) {
+        health_inputs_t inputs = {};
+        inputs.value[HISTORY_QTY_TEMPERATURE] = temperature;
+        inputs.value[HISTORY_QTY_HUMIDITY] = humidity;
+        inputs.present = (1 << HISTORY_QTY_TEMPERATURE) | (1 << HISTORY_QTY_HUMIDITY);
+        health_result_t result;
+        health_engine_evaluate(&context, &inputs, &result);
+        return result;
+    }
+
+    health_context_t context;
+};
+
+/**
+ * @brief Every built-in profile is found by name and has ordered ranges
+ */
+TEST_F(HealthEngineTest, ProfilesAreConsistent) {
+    ASSERT_GT(health_engine_profile_count(), 0);
+    EXPECT_STREQ(health_engine_profile(0)->name, "default");
+    EXPECT_EQ(health_engine_profile(health_engine_profile_count()), nullptr);
+    EXPECT_EQ(health_engine_find_profile("no-such-plant"), nullptr);
+
+    for (int i = 0; i < health_engine_profile_count(); i++) {
+        const health_profile_t *profile = health_engine_profile(i);
+        EXPECT_EQ(health_engine_find_profile(profile->name), profile);
+        for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+            const health_rule_t *rule = &profile->rules[q];
+            EXPECT_LE(rule->min, rule->optimal_min) << profile->name << " quantity " << q;
+            EXPECT_LE(rule->optimal_min, rule->optimal_max) << profile->name << " quantity " << q;
+            EXPECT_LE(rule->optimal_max, rule->max) << profile->name << " quantity " << q;
+        }
+    }
+}
+
+/**
+ * @brief Scores fall from 100 in the optimal range to 0 outside the acceptable range
+ */
+TEST_F(HealthEngineTest, ScoresCurve) {
+    health_result_t result = evaluate(2200, 5500);
+    EXPECT_EQ(result.score, HEALTH_SCORE_MAX);
+    EXPECT_EQ(result.level, HEALTH_LEVEL_EXCELLENT);
+
+    result = evaluate(1200, 5500);
+    EXPECT_EQ(result.quantity_score[HISTORY_QTY_TEMPERATURE], 6250);
+    EXPECT_EQ(result.limiting, HISTORY_QTY_TEMPERATURE);
+    EXPECT_TRUE(result.limiting_low);
+
+    result = evaluate(2200, 9000);
+    EXPECT_EQ(result.quantity_score[HISTORY_QTY_HUMIDITY], 0);
+    EXPECT_EQ(result.limiting, HISTORY_QTY_HUMIDITY);
+    EXPECT_FALSE(result.limiting_low);
+    EXPECT_EQ(result.level, HEALTH_LEVEL_FAIR);
+}
+
+/**
+ * @brief Golden scores of the compiled tables
+ *
+ * Values on the optimal edges and inside the ramps are exact; the
+ * acceptable edges lie between table samples, where the interpolation
+ * cuts the corner of the curve by up to about 2 points.
+ */
+TEST_F(HealthEngineTest, GoldenValues) {
+    static const struct {
+        const char *profile;
+        history_quantity_t quantity;
+        int32_t value;
+        uint16_t score;
+    } k_golden[] = {
+        { "default", HISTORY_QTY_TEMPERATURE, 500, 0 },
+        { "default", HISTORY_QTY_TEMPERATURE, 1000, 4900 },
+        { "default", HISTORY_QTY_TEMPERATURE, 1200, 6250 },
+        { "default", HISTORY_QTY_TEMPERATURE, 1800, 10000 },
+        { "default", HISTORY_QTY_TEMPERATURE, 2800, 10000 },
+        { "default", HISTORY_QTY_TEMPERATURE, 3000, 8571 },
+        { "default", HISTORY_QTY_TEMPERATURE, 3500, 4973 },
+        { "default", HISTORY_QTY_TEMPERATURE, 3700, 2142 },
+        { "default", HISTORY_QTY_TEMPERATURE, 4000, 0 },
+        { "default", HISTORY_QTY_HUMIDITY, 9000, 0 },
+        { "default", HISTORY_QTY_LUX, 40, 4763 },
+        { "default", HISTORY_QTY_LUX, 2500, 10000 },
+        { "default", HISTORY_QTY_VPD, 600, 7500 },
+        { "default", HISTORY_QTY_VPD, 1000, 10000 },
+        { "default", HISTORY_QTY_VPD, 2000, 0 },
+        { "tropical", HISTORY_QTY_HUMIDITY, 8500, 10000 },
+        { "succulent", HISTORY_QTY_LIGHT_LEVEL, 1000, 5833 },
+        { "succulent", HISTORY_QTY_LIGHT_LEVEL, 4095, 10000 },
+        { "succulent", HISTORY_QTY_LIGHT_LEVEL, INT16_MAX, 10000 },
+        { "herb", HISTORY_QTY_SOIL_MOISTURE, 1500, 7499 },
+    };
+
+    for (const auto &golden : k_golden) {
+        health_engine_set_profile(&context, health_engine_find_profile(golden.profile));
+        EXPECT_EQ(health_engine_curve_score(&context.curve[golden.quantity], golden.value), golden.score)
+            << golden.profile << " quantity " << golden.quantity << " value " << golden.value;
+    }
+}
+
+/**
+ * @brief Quantities that were not measured do not dilute the score
+ */
+TEST_F(HealthEngineTest, IgnoresMissingQuantities) {
+    health_inputs_t inputs = {};
+    inputs.value[HISTORY_QTY_TEMPERATURE] = 2200;
+    inputs.present = 1 << HISTORY_QTY_TEMPERATURE;
+    health_result_t result;
+    health_engine_evaluate(&context, &inputs, &result);
+    EXPECT_EQ(result.score, HEALTH_SCORE_MAX);
+
+    inputs.present = 0;
+    health_engine_evaluate(&context, &inputs, &result);
+    EXPECT_EQ(result.score, 0);
+    EXPECT_EQ(result.limiting, -1);
+}
+
+/**
+ * @brief Scores change smoothly across the whole input range
+ */
+TEST_F(HealthEngineTest, CurvesAreContinuous) {
+    for (int i = 0; i < health_engine_profile_count(); i++) {
+        health_engine_set_profile(&context, health_engine_profile(i));
+        for (int q = 0; q < HISTORY_QTY_COUNT; q++) {
+            int previous = health_engine_curve_score(&context.curve[q], -1000);
+            for (int32_t value = -999; value <= INT16_MAX; value++) {
+                int score = health_engine_curve_score(&context.curve[q], value);
+                ASSERT_LE(abs(score - previous), 100)
+                    << context.profile->name << " quantity " << q << " value " << value;
+                previous = score;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Contexts on different profiles score the same values independently
+ */
+TEST_F(HealthEngineTest, ProfilesDiffer) {
+    health_context_t succulent;
+    health_engine_set_profile(&succulent, health_engine_find_profile("succulent"));
+
+    health_inputs_t inputs = {};
+    inputs.value[HISTORY_QTY_HUMIDITY] = 8500;
+    inputs.present = 1 << HISTORY_QTY_HUMIDITY;
+    health_result_t tropical_result;
+    health_result_t succulent_result;
+    health_context_t tropical;
+    health_engine_set_profile(&tropical, health_engine_find_profile("tropical"));
+    health_engine_evaluate(&tropical, &inputs, &tropical_result);
+    health_engine_evaluate(&succulent, &inputs, &succulent_result);
+
+    EXPECT_EQ(tropical_result.score, HEALTH_SCORE_MAX);
+    EXPECT_EQ(succulent_result.score, 0);
+}
+
+/**
+ * @brief The level does not flap while the score hovers around a level floor
+ */
+TEST_F(HealthEngineTest, LevelHasHysteresis) {
+    // Find the temperature at which the score first drops below the GOOD floor
+    health_result_t result = evaluate(1800, 5500);
+    int32_t edge = 1800;
+    while (result.score >= 7000) {
+        health_engine_set_profile(&context, NULL);
+        result = evaluate(--edge, 5500);
+    }
+    EXPECT_EQ(result.level, HEALTH_LEVEL_FAIR);
+
+    // Going from GOOD, one step past the floor keeps the level
+    health_engine_set_profile(&context, NULL);
+    EXPECT_EQ(evaluate(edge + 1, 5500).level, HEALTH_LEVEL_GOOD);
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(evaluate(edge, 5500).level, HEALTH_LEVEL_GOOD);
+        EXPECT_EQ(evaluate(edge + 1, 5500).level, HEALTH_LEVEL_GOOD);
+    }
+
+    // Well past the floor the level changes, and stays until well back
+    EXPECT_EQ(evaluate(edge - 100, 5500).level, HEALTH_LEVEL_FAIR);
+    EXPECT_EQ(evaluate(edge + 1, 5500).level, HEALTH_LEVEL_FAIR);
+    EXPECT_EQ(evaluate(edge + 200, 5500).level, HEALTH_LEVEL_GOOD);
+}
@@ -0,0 +1,185 @@
+/**
+ * @file test_irrigation_controller.cpp
+ * @brief Unit Tests for the Closed-Loop Irrigation Control Law
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <deque>
+#include "irrigation_controller.h"
+
+/**
+ * @brief Pot whose moisture rises with a delay while the pump runs and dries steadily
+ */
+struct Pot {
+    double moisture = 1500.0;
+    double fill_per_s = 8.0;      // counts per second of pumping, once arrived
+    double dry_per_s = 0.02;      // counts per second
+    bool reservoir_empty = false;
+    std::deque<double> pipe = std::deque<double>(20, 0.0); // 20 s until water reaches the probe
+
+    void tick(bool pump_on) {
+        pipe.push_back(pump_on && !reservoir_empty ? fill_per_s : 0.0);
+        moisture += pipe.front() - dry_per_s;
+        pipe.pop_front();
+    }
+};
+
+/**
+ * @brief Test fixture with parameters for a 1 s control period
+ */
+class IrrigationControllerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params = {};
+        params.mode = IRRIGATION_MODE_BANG_BANG;
+        params.setpoint = 2000;
+        params.hysteresis = 200;
+        params.kp_permille = 3;
+        params.ki_permille_per_hour = 2;
+        params.window_ms = 120000;
+        params.min_on_ms = 5000;
+        params.min_off_ms = 30000;
+        params.max_pulse_ms = 60000;
+        params.max_daily_ms = 3600000;
+        params.dry_run_ms = 90000;
+        params.response_ms = 120000;
+        params.response_rise = 40;
+        params.max_age_ms = 60000;
+    }
+
+    /** Run the loop for a number of seconds, return the pump time in seconds */
+    uint32_t run(uint32_t seconds) {
+        uint32_t on = 0;
+        for (uint32_t i = 0; i < seconds; i++, now += 1000) {
+            bool pump = irrigation_controller_step(&controller, (int16_t)pot.moisture, 0, now);
+            pot.tick(pump);
+            on += pump;
+            low = std::min(low, pot.moisture);
+            high = std::max(high, pot.moisture);
+            if (pump != last_pump) {
+                uint32_t held = (now - last_switch) / 1000;
+                if (last_pump) {
+                    min_run = std::min(min_run, held);
+                } else if (last_switch != 0) {
+                    min_pause = std::min(min_pause, held);
+                }
+                last_pump = pump;
+                last_switch = now;
+            }
+        }
+        return on;
+    }
+
+    void reset_extremes() {
+        low = 1e9;
+        high = -1e9;
+    }
+
+    irrigation_params_t params;
+    irrigation_controller_t controller;
+    Pot pot;
+    uint32_t now = 1000;
+    double low = 1e9;
+    double high = -1e9;
+    bool last_pump = false;
+    uint32_t last_switch = 0;
+    uint32_t min_run = UINT32_MAX;
+    uint32_t min_pause = UINT32_MAX;
+};
+
+/**
+ * @brief Bang-bang keeps the pot around the setpoint with the run and pause limits
+ */
+TEST_F(IrrigationControllerTest, BangBangHoldsBand) {
+    irrigation_controller_init(&controller, &params);
+    run(6 * 3600);
+    reset_extremes();
+    run(12 * 3600);
+
+    EXPECT_GT(low, params.setpoint - params.hysteresis - 50);
+    EXPECT_LT(high, params.setpoint + 400);
+    EXPECT_GE(min_run, params.min_on_ms / 1000);
+    EXPECT_GE(min_pause, params.min_off_ms / 1000);
+    EXPECT_EQ(controller.faults, 0);
+}
+
+/**
+ * @brief PI settles near the setpoint without faults
+ */
+TEST_F(IrrigationControllerTest, PiSettlesNearSetpoint) {
+    params.mode = IRRIGATION_MODE_PI;
+    irrigation_controller_init(&controller, &params);
+    run(12 * 3600);
+    reset_extremes();
+    run(6 * 3600);
+
+    EXPECT_GT(low, params.setpoint - 150);
+    EXPECT_LT(high, params.setpoint + 150);
+    EXPECT_GE(min_run, params.min_on_ms / 1000);
+    EXPECT_EQ(controller.faults, 0);
+}
+
+/**
+ * @brief The daily dose caps the pump time, and a new day restores it
+ */
+TEST_F(IrrigationControllerTest, DailyLimitStopsPump) {
+    params.max_daily_ms = 120000;
+    pot.dry_per_s = 1.0;
+    irrigation_controller_init(&controller, &params);
+
+    EXPECT_LE(run(20 * 3600), params.max_daily_ms / 1000 + 1);
+    EXPECT_TRUE(controller.faults & IRRIGATION_FAULT_DAILY_LIMIT);
+
+    run(4 * 3600);
+    EXPECT_GT(controller.dose_today_ms, 0u);
+}
+
+/**
+ * @brief Pumping without a response pauses, then latches a dry-run fault
+ */
+TEST_F(IrrigationControllerTest, DetectsDryRun) {
+    pot.reservoir_empty = true;
+    irrigation_controller_init(&controller, &params);
+
+    uint32_t on = run(3600);
+    EXPECT_LE(on, params.dry_run_ms / 1000 + 1);
+    EXPECT_TRUE(controller.faults & IRRIGATION_FAULT_DRY_RUN);
+    EXPECT_FALSE(controller.pump_on);
+
+    // Refilled and reset, the loop waters again
+    pot.reservoir_empty = false;
+    irrigation_controller_reset_fault(&controller);
+    run(3600);
+    EXPECT_EQ(controller.faults, 0);
+    EXPECT_GT(pot.moisture, params.setpoint - params.hysteresis);
+}
+
+/**
+ * @brief A stale estimate stops the pump at once, even within the minimum run
+ */
+TEST_F(IrrigationControllerTest, StaleInputStopsPump) {
+    params.min_on_ms = 30000;
+    irrigation_controller_init(&controller, &params);
+    ASSERT_TRUE(irrigation_controller_step(&controller, 1000, 0, now));
+    EXPECT_FALSE(irrigation_controller_step(&controller, 1000, params.max_age_ms + 1, now + 1000));
+    EXPECT_TRUE(controller.faults & IRRIGATION_FAULT_STALE);
+}
+
+/**
+ * @brief The millisecond clock may wrap
+ */
+TEST_F(IrrigationControllerTest, SurvivesClockWrap) {
+    now = UINT32_MAX - 1800 * 1000;
+    irrigation_controller_init(&controller, &params);
+    run(6 * 3600);
+    reset_extremes();
+    run(6 * 3600);
+
+    EXPECT_GT(low, params.setpoint - params.hysteresis - 50);
+    EXPECT_EQ(controller.faults, 0);
+}
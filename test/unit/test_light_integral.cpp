@@ -0,0 +1,187 @@
+/**
+ * @file test_light_integral.cpp
+ * @brief Unit Tests for the Daily Light Integral
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include "light_integral.h"
+
+/** A local day well after the epoch */
+static const uint32_t k_day = 19800;
+
+/** UTC time of local midnight starting k_day, one hour ahead of UTC */
+static const uint32_t k_midnight = k_day * 86400 - 3600;
+
+/**
+ * @brief Test fixture with sunlight and a UTC+1 day
+ */
+class LightIntegralTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        light_integral_init(&light, light_integral_find_spectrum("sunlight"), 3600);
+    }
+
+    light_summary_t today() {
+        light_summary_t summary = {};
+        EXPECT_TRUE(light_integral_today(&light, &summary));
+        return summary;
+    }
+
+    light_integral_t light;
+};
+
+/**
+ * @brief Spectrum presets convert lux to PPFD with their own factor
+ */
+TEST_F(LightIntegralTest, ConvertsLux) {
+    EXPECT_NEAR(light_integral_ppfd(&light, 10000.0f), 185.0f, 0.01f);
+    EXPECT_EQ(light_integral_ppfd(&light, -5.0f), 0.0f);
+
+    light_integral_t hps;
+    light_integral_init(&hps, light_integral_find_spectrum("hps"), 0);
+    EXPECT_NEAR(light_integral_ppfd(&hps, 10000.0f), 122.0f, 0.01f);
+    EXPECT_EQ(light_integral_find_spectrum("candle"), nullptr);
+}
+
+/**
+ * @brief Constant light integrates to PPFD times duration
+ */
+TEST_F(LightIntegralTest, IntegratesConstantLight) {
+    light_summary_t summary;
+    EXPECT_FALSE(light_integral_today(&light, &summary));
+
+    for (uint32_t t = 0; t <= 3600; t += 30) {
+        light_integral_update(&light, 1000.0f, k_midnight + 8 * 3600 + t);
+    }
+
+    summary = today();
+    EXPECT_EQ(summary.day, k_day);
+    EXPECT_NEAR(summary.dli, 18.5f * 3600 / 1e6f, 1e-5f);
+    EXPECT_NEAR(summary.photoperiod_h, 1.0f, 1e-4f);
+    EXPECT_NEAR(summary.covered_h, 1.0f, 1e-4f);
+    EXPECT_EQ(summary.start_s, 8 * 3600);
+    EXPECT_EQ(summary.end_s, -1);
+    EXPECT_TRUE(summary.lit);
+}
+
+/**
+ * @brief The trapezoidal rule is exact for a ramp sampled at irregular times
+ */
+TEST_F(LightIntegralTest, IntegratesIrregularSamples) {
+    const uint32_t times[] = { 0, 7, 100, 130, 480, 481, 900, 1000 };
+    for (uint32_t t : times) {
+        light_integral_update(&light, 10.0f * t, k_midnight + 36000 + t);
+    }
+
+    // PPFD rises from 0 to 185 µmol/m²/s over 1000 s (exact up to the
+    // 0.01 µmol/m²/s resolution of the samples)
+    EXPECT_NEAR(today().dli, 185.0f * 1000 / 2 / 1e6f, 1e-5f);
+}
+
+/**
+ * @brief Lights on and off are placed where PPFD crosses the threshold
+ */
+TEST_F(LightIntegralTest, TracksPhotoperiod) {
+    // 20 µmol/m²/s, twice the threshold
+    const float bright = 20.0f / 0.0185f;
+    uint32_t on = k_midnight + 6 * 3600;
+    light_integral_update(&light, 0.0f, on - 600);
+    for (uint32_t t = on + 600; t <= on + 12 * 3600 - 600; t += 600) {
+        light_integral_update(&light, bright, t);
+    }
+    light_integral_update(&light, 0.0f, on + 12 * 3600 + 600);
+
+    light_summary_t summary = today();
+    EXPECT_NEAR(summary.start_s, 6 * 3600, 1);
+    EXPECT_NEAR(summary.end_s, 18 * 3600, 1);
+    EXPECT_NEAR(summary.photoperiod_h, 12.0f, 0.001f);
+    EXPECT_FALSE(summary.lit);
+}
+
+/**
+ * @brief An interval spanning local midnight is split between the days
+ */
+TEST_F(LightIntegralTest, SplitsAtMidnight) {
+    light_integral_update(&light, 1000.0f, k_midnight - 600);
+    light_integral_update(&light, 1000.0f, k_midnight + 600);
+
+    light_summary_t previous;
+    ASSERT_TRUE(light_integral_previous(&light, &previous));
+    EXPECT_EQ(previous.day, k_day - 1);
+    EXPECT_NEAR(previous.dli, 18.5f * 600 / 1e6f, 1e-6f);
+    EXPECT_TRUE(previous.lit);
+
+    light_summary_t summary = today();
+    EXPECT_EQ(summary.day, k_day);
+    EXPECT_NEAR(summary.dli, 18.5f * 600 / 1e6f, 1e-6f);
+    EXPECT_EQ(summary.start_s, 0);
+}
+
+/**
+ * @brief Long gaps are not integrated and a later day starts afresh
+ */
+TEST_F(LightIntegralTest, SkipsGaps) {
+    light_integral_update(&light, 1000.0f, k_midnight + 3600);
+    light_integral_update(&light, 1000.0f, k_midnight + 3600 + LIGHT_MAX_GAP_S + 1);
+    EXPECT_EQ(today().covered_h, 0.0f);
+    EXPECT_EQ(today().dli, 0.0f);
+
+    light_integral_update(&light, 1000.0f, k_midnight + 86400 + 3600);
+    light_summary_t previous;
+    ASSERT_TRUE(light_integral_previous(&light, &previous));
+    EXPECT_EQ(previous.day, k_day);
+    EXPECT_EQ(today().day, k_day + 1);
+}
+
+/**
+ * @brief The rolling window spans midnight and drops hours older than a day
+ */
+TEST_F(LightIntegralTest, RollingWindow) {
+    light_summary_t summary;
+    EXPECT_FALSE(light_integral_rolling(&light, &summary));
+
+    // Constant light from 23:00 to 01:00 local time
+    for (uint32_t t = k_midnight - 3600; t <= k_midnight + 3600; t += 600) {
+        light_integral_update(&light, 1000.0f, t);
+    }
+    ASSERT_TRUE(light_integral_rolling(&light, &summary));
+    EXPECT_NEAR(summary.dli, 18.5f * 7200 / 1e6f, 1e-6f);
+    EXPECT_NEAR(summary.photoperiod_h, 2.0f, 1e-4f);
+    EXPECT_EQ(summary.start_s, -1);
+    EXPECT_NEAR(today().dli, 18.5f * 3600 / 1e6f, 1e-6f);
+
+    // Darkness until a day after the lights came on: all the light is
+    // still inside the window
+    for (uint32_t t = k_midnight + 4200; t <= k_midnight + 23 * 3600; t += 600) {
+        light_integral_update(&light, 0.0f, t);
+    }
+    ASSERT_TRUE(light_integral_rolling(&light, &summary));
+    EXPECT_NEAR(summary.covered_h, 24.0f, 1e-4f);
+    EXPECT_NEAR(summary.dli, 18.5f * (7200 + 300) / 1e6f, 1e-6f);
+    EXPECT_FALSE(summary.lit);
+
+    // Half an hour later, half of the first lit hour has left the window
+    for (uint32_t t = k_midnight + 23 * 3600 + 600; t <= k_midnight + 23 * 3600 + 1800; t += 600) {
+        light_integral_update(&light, 0.0f, t);
+    }
+    ASSERT_TRUE(light_integral_rolling(&light, &summary));
+    EXPECT_NEAR(summary.covered_h, 24.0f, 1e-4f);
+    EXPECT_NEAR(summary.dli, 18.5f * (1800 + 3600 + 300) / 1e6f, 1e-6f);
+}
+
+/**
+ * @brief The rolling window works on time since boot, before the clock is set
+ */
+TEST_F(LightIntegralTest, RollingWindowFromBoot) {
+    for (uint32_t t = 10; t <= 1810; t += 30) {
+        light_integral_update(&light, 1000.0f, t);
+    }
+    light_summary_t summary;
+    ASSERT_TRUE(light_integral_rolling(&light, &summary));
+    EXPECT_NEAR(summary.dli, 18.5f * 1800 / 1e6f, 1e-6f);
+    EXPECT_NEAR(summary.covered_h, 0.5f, 1e-4f);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file test_outlier_filter.cpp
+ * @brief Unit Tests for the Outlier Filter
+ * 
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include "reading_history.h"
+#include "outlier_filter.h"
+
+/**
+ * @brief Test fixture with one temperature channel in Hampel mode
+ */
+class OutlierFilterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        reading_history_init();
+        outlier_filter_init(OUTLIER_FILTER_MODE_HAMPEL);
+        channel = reading_history_attach(0, HISTORY_QTY_TEMPERATURE);
+        ASSERT_GE(channel, 0);
+    }
+    
+    /** Feed samples around 21.00 °C with ±0.05 °C of noise */
+    void warm_up() {
+        for (int i = 0; i < OUTLIER_FILTER_WINDOW; i++) {
+            outlier_filter_result_t result = outlier_filter_apply(channel, 2100 + (i % 3 - 1) * 5);
+            EXPECT_FALSE(result.rejected);
+        }
+    }
+    
+    int channel;
+};
+
+/**
+ * @brief A single spike is rejected and replaced by the median
+ */
+TEST_F(OutlierFilterTest, SpikeIsRejected) {
+    warm_up();
+    
+    outlier_filter_result_t result = outlier_filter_apply(channel, 8500);
+    EXPECT_TRUE(result.rejected);
+    EXPECT_NEAR(result.value, 2100, 5);
+    
+    result = outlier_filter_apply(channel, 2105);
+    EXPECT_FALSE(result.rejected);
+    EXPECT_EQ(result.value, 2105);
+}
+
+/**
+ * @brief Noise within the per-quantity floor passes on a flat signal
+ */
+TEST_F(OutlierFilterTest, FlatSignalNoisePasses) {
+    for (int i = 0; i < OUTLIER_FILTER_WINDOW; i++) {
+        outlier_filter_apply(channel, 2000);
+    }
+    outlier_filter_result_t result = outlier_filter_apply(channel, 2015);
+    EXPECT_FALSE(result.rejected);
+    EXPECT_EQ(result.value, 2015);
+}
+
+/**
+ * @brief A genuine step change is accepted after half a window
+ */
+TEST_F(OutlierFilterTest, StepChangeIsAccepted) {
+    warm_up();
+    
+    int rejected = 0;
+    for (int i = 0; i < OUTLIER_FILTER_WINDOW; i++) {
+        outlier_filter_result_t result = outlier_filter_apply(channel, 2600);
+        rejected += result.rejected;
+        if (i >= OUTLIER_FILTER_WINDOW / 2) {
+            EXPECT_FALSE(result.rejected);
+            EXPECT_EQ(result.value, 2600);
+        }
+    }
+    EXPECT_LE(rejected, OUTLIER_FILTER_WINDOW / 2);
+}
+
+/**
+ * @brief Median mode always outputs the window median
+ */
+TEST_F(OutlierFilterTest, MedianMode) {
+    outlier_filter_init(OUTLIER_FILTER_MODE_MEDIAN);
+    const int16_t samples[] = { 10, 50, 20, 40, 30, 60, 70 };
+    outlier_filter_result_t result = {};
+    for (int16_t sample : samples) {
+        result = outlier_filter_apply(channel, sample);
+    }
+    EXPECT_EQ(result.value, 40);
+}
+
+/**
+ * @brief Filtering is disabled in off mode
+ */
+TEST_F(OutlierFilterTest, OffModePassesEverything) {
+    outlier_filter_init(OUTLIER_FILTER_MODE_OFF);
+    warm_up();
+    outlier_filter_result_t result = outlier_filter_apply(channel, 8500);
+    EXPECT_FALSE(result.rejected);
+    EXPECT_EQ(result.value, 8500);
+}
@@ -14,6 +14,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "sensor_interface.h"
+#include "sensor_registry.h"
+#include "sensor_calibration.h"
 #include "display_interface.h"
 #include "aht10.h"
 #include "ds18b20.h"
@@ -32,6 +34,10 @@ protected:
         // Initialize test configuration
         memset(&sensor_config, 0, sizeof(sensor_interface_config_t));
         memset(&display_config, 0, sizeof(display_interface_config_t));
+        memset(sensors, 0, sizeof(sensors));
+        memset(displays, 0, sizeof(displays));
+        sensor_config.sensors = sensors;
+        display_config.displays = displays;
         
         // Configure test sensors
         sensor_config.sensor_count = 4;
@@ -43,28 +49,28 @@ protected:
         sensor_config.adc_light_pin = 2;
         
         // AHT10 sensor
-        sensor_config.sensors[0].type = SENSOR_TYPE_AHT10;
-        sensor_config.sensors[0].address = 0x38;
-        sensor_config.sensors[0].enabled = true;
-        strcpy(sensor_config.sensors[0].name, "AHT10-Test");
+        sensors[0].type = SENSOR_TYPE_AHT10;
+        sensors[0].address = 0x38;
+        sensors[0].enabled = true;
+        sensors[0].name = "AHT10-Test";
         
         // DS18B20 sensor
-        sensor_config.sensors[1].type = SENSOR_TYPE_DS18B20;
-        sensor_config.sensors[1].pin = 4;
-        sensor_config.sensors[1].enabled = true;
-        strcpy(sensor_config.sensors[1].name, "DS18B20-Test");
+        sensors[1].type = SENSOR_TYPE_DS18B20;
+        sensors[1].pin = 4;
+        sensors[1].enabled = true;
+        sensors[1].name = "DS18B20-Test";
         
         // GY-302 sensor
-        sensor_config.sensors[2].type = SENSOR_TYPE_GY302;
-        sensor_config.sensors[2].address = 0x23;
-        sensor_config.sensors[2].enabled = true;
-        strcpy(sensor_config.sensors[2].name, "GY302-Test");
+        sensors[2].type = SENSOR_TYPE_GY302;
+        sensors[2].address = 0x23;
+        sensors[2].enabled = true;
+        sensors[2].name = "GY302-Test";
         
         // Soil moisture sensor
-        sensor_config.sensors[3].type = SENSOR_TYPE_SOIL_MOISTURE;
-        sensor_config.sensors[3].pin = 1;
-        sensor_config.sensors[3].enabled = true;
-        strcpy(sensor_config.sensors[3].name, "Soil-Test");
+        sensors[3].type = SENSOR_TYPE_SOIL_MOISTURE;
+        sensors[3].pin = 1;
+        sensors[3].enabled = true;
+        sensors[3].name = "Soil-Test";
         
         // Configure test displays
         display_config.display_count = 3;
@@ -72,21 +78,21 @@ protected:
         display_config.brightness = 128;
         
         // Console display
-        display_config.displays[0].type = DISPLAY_TYPE_CONSOLE;
-        display_config.displays[0].enabled = true;
-        strcpy(display_config.displays[0].name, "Console-Test");
+        displays[0].type = DISPLAY_TYPE_CONSOLE;
+        displays[0].enabled = true;
+        displays[0].name = "Console-Test";
         
         // Built-in OLED
-        display_config.displays[1].type = DISPLAY_TYPE_BUILTIN_SSD1306;
-        display_config.displays[1].i2c_address = 0x3C;
-        display_config.displays[1].enabled = true;
-        strcpy(display_config.displays[1].name, "OLED-Test");
+        displays[1].type = DISPLAY_TYPE_BUILTIN_SSD1306;
+        displays[1].i2c_address = 0x3C;
+        displays[1].enabled = true;
+        displays[1].name = "OLED-Test";
         
         // E-paper display
-        display_config.displays[2].type = DISPLAY_TYPE_EPAPER_SPI;
-        display_config.displays[2].spi_cs_pin = 5;
-        display_config.displays[2].enabled = true;
-        strcpy(display_config.displays[2].name, "Epaper-Test");
+        displays[2].type = DISPLAY_TYPE_EPAPER_SPI;
+        displays[2].spi_cs_pin = 5;
+        displays[2].enabled = true;
+        displays[2].name = "Epaper-Test";
     }
     
     void TearDown() override {
@@ -97,6 +103,8 @@ protected:
     
     sensor_interface_config_t sensor_config;
     display_interface_config_t display_config;
+    sensor_config_t sensors[SENSOR_INTERFACE_MAX_SENSORS];
+    display_config_t displays[4];
 };
 
 /**
@@ -200,6 +208,51 @@ TEST_F(PlantMonitorTest, I2CScan) {
     EXPECT_GE(device_count, 0);
 }
 
+/**
+ * @brief Test incremental I2C rescan against the cached device map
+ */
+TEST_F(PlantMonitorTest, I2CRescan) {
+    esp_err_t ret = sensor_interface_init(&sensor_config);
+    ASSERT_EQ(ret, ESP_OK);
+    
+    int device_count = sensor_interface_scan_i2c_types(SENSOR_TYPE_BIT(SENSOR_TYPE_AHT10) |
+                                                       SENSOR_TYPE_BIT(SENSOR_TYPE_GY302));
+    ASSERT_GE(device_count, 0);
+    
+    // Nothing was plugged in or removed since the scan
+    EXPECT_EQ(sensor_interface_rescan_i2c(), 0);
+}
+
+/**
+ * @brief Test that the sensor registry owns the configuration after init
+ */
+TEST_F(PlantMonitorTest, SensorRegistry) {
+    esp_err_t ret = sensor_interface_init(&sensor_config);
+    ASSERT_EQ(ret, ESP_OK);
+    
+    // The caller's table is no longer referenced
+    memset(sensors, 0, sizeof(sensors));
+    
+    const sensor_registry_t *registry = sensor_registry_get();
+    ASSERT_EQ(registry->count, 4);
+    EXPECT_EQ(registry->type[2], SENSOR_TYPE_GY302);
+    EXPECT_EQ(registry->address[2], 0x23);
+    EXPECT_EQ(registry->enabled_mask, 0x0Fu);
+    EXPECT_STREQ(registry->name[1], "DS18B20-Test");
+    
+    sensor_reading_t readings[SENSOR_INTERFACE_MAX_SENSORS];
+    sensor_interface_read_all(readings, SENSOR_INTERFACE_MAX_SENSORS);
+    for (int i = 0; i < registry->count; i++) {
+        sensor_reading_t stored;
+        ASSERT_EQ(sensor_registry_get_reading(i, &stored), ESP_OK);
+        EXPECT_EQ(stored.valid, readings[i].valid);
+        EXPECT_EQ(stored.error, readings[i].error);
+    }
+    
+    sensor_interface_deinit();
+    EXPECT_EQ(sensor_registry_count(), 0);
+}
+
 /**
  * @brief Test sensor status
  */
@@ -230,6 +283,44 @@ TEST_F(PlantMonitorTest, DisplayStatus) {
     EXPECT_LE(working_displays, total_displays);
 }
 
+/**
+ * @brief Test calibration coefficients and sensor keys
+ */
+TEST_F(PlantMonitorTest, SensorCalibration) {
+    sensor_cal_coeff_t coeff;
+    
+    // +0.5 °C offset
+    ASSERT_EQ(sensor_calibration_linear(1.0f, 0.5f, &coeff), ESP_OK);
+    EXPECT_EQ(sensor_cal_apply(&coeff, 2150), 2200);
+    EXPECT_EQ(sensor_cal_apply(&coeff, -1000), -950);
+    
+    // Two points: sensor reads 0.4 at 0 °C and 99.0 at 100 °C
+    ASSERT_EQ(sensor_calibration_two_point(0.4f, 0.0f, 99.0f, 100.0f, &coeff), ESP_OK);
+    EXPECT_NEAR(sensor_cal_apply(&coeff, 40), 0, 1);
+    EXPECT_NEAR(sensor_cal_apply(&coeff, 9900), 10000, 1);
+    EXPECT_NEAR(sensor_cal_apply(&coeff, 4970), 5000, 1);
+    
+    // Unusable corrections are rejected
+    EXPECT_EQ(sensor_calibration_linear(0.0f, 0.0f, &coeff), ESP_ERR_INVALID_ARG);
+    EXPECT_EQ(sensor_calibration_two_point(20.0f, 0.0f, 20.0f, 100.0f, &coeff), ESP_ERR_INVALID_ARG);
+    
+    // Keys fit NVS and tell routes and probes apart
+    char key_a[SENSOR_CAL_KEY_LEN];
+    char key_b[SENSOR_CAL_KEY_LEN];
+    sensor_calibration_i2c_key(0x38, 0x70, 1, key_a);
+    sensor_calibration_i2c_key(0x38, 0x70, 2, key_b);
+    EXPECT_STRNE(key_a, key_b);
+    sensor_calibration_rom_key(0xA2000004C8E3FF28ULL, key_a);
+    EXPECT_STREQ(key_a, "000004c8e3ff28");
+    
+    // Sensors without a loaded calibration read unchanged
+    sensor_calibration_t cal;
+    sensor_calibration_clear();
+    sensor_calibration_get(0, &cal);
+    EXPECT_EQ(cal.temperature.gain_q16, SENSOR_CAL_GAIN_ONE);
+    EXPECT_EQ(cal.humidity.offset_c100, 0);
+}
+
 /**
  * @brief Test AHT10 sensor driver
  */
@@ -343,7 +434,7 @@ TEST_F(PlantMonitorTest, SensorTypeValidation) {
  */
 TEST_F(PlantMonitorTest, DisplayTypeValidation) {
     display_interface_config_t config = display_config;
-    config.displays[0].type = DISPLAY_TYPE_MAX;
+    displays[0].type = DISPLAY_TYPE_MAX;
     
     esp_err_t ret = display_interface_init(&config);
     // Should handle unknown display type gracefully
@@ -356,7 +447,7 @@ TEST_F(PlantMonitorTest, DisplayTypeValidation) {
 TEST_F(PlantMonitorTest, ConfigurationValidation) {
     // Test with invalid sensor count
     sensor_interface_config_t invalid_config = sensor_config;
-    invalid_config.sensor_count = 10; // More than array size
+    invalid_config.sensor_count = SENSOR_INTERFACE_MAX_SENSORS + 1; // More than array size
     
     esp_err_t ret = sensor_interface_init(&invalid_config);
     // Should handle gracefully
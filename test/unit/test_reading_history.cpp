@@ -0,0 +1,86 @@
+/**
+ * @file test_reading_history.cpp
+ * @brief Unit Tests for the Reading History
+ * 
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include "reading_history.h"
+
+/**
+ * @brief Test fixture for reading history tests
+ */
+class ReadingHistoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        reading_history_init();
+    }
+};
+
+/**
+ * @brief Channels are allocated once per sensor quantity
+ */
+TEST_F(ReadingHistoryTest, AttachIsPerSensorQuantity) {
+    int temperature = reading_history_attach(0, HISTORY_QTY_TEMPERATURE);
+    int humidity = reading_history_attach(0, HISTORY_QTY_HUMIDITY);
+    ASSERT_GE(temperature, 0);
+    ASSERT_GE(humidity, 0);
+    EXPECT_NE(temperature, humidity);
+    EXPECT_EQ(reading_history_attach(0, HISTORY_QTY_TEMPERATURE), temperature);
+    EXPECT_EQ(reading_history_find(1, HISTORY_QTY_TEMPERATURE), -1);
+    EXPECT_EQ(reading_history_attach(0, HISTORY_QTY_COUNT), -1);
+}
+
+/**
+ * @brief The pool refuses channels beyond READING_HISTORY_CHANNELS
+ */
+TEST_F(ReadingHistoryTest, PoolExhaustion) {
+    for (int i = 0; i < READING_HISTORY_CHANNELS; i++) {
+        EXPECT_GE(reading_history_attach((uint8_t)i, HISTORY_QTY_TEMPERATURE), 0);
+    }
+    EXPECT_EQ(reading_history_attach(READING_HISTORY_CHANNELS, HISTORY_QTY_TEMPERATURE), -1);
+}
+
+/**
+ * @brief A full ring overwrites the oldest samples and spans stay chronological
+ */
+TEST_F(ReadingHistoryTest, RingWrapsChronologically) {
+    int ch = reading_history_attach(2, HISTORY_QTY_SOIL_MOISTURE);
+    ASSERT_GE(ch, 0);
+    
+    const int total = READING_HISTORY_DEPTH + 10;
+    for (int i = 0; i < total; i++) {
+        reading_history_push(ch, (float)i);
+    }
+    
+    EXPECT_EQ(reading_history_count(ch), READING_HISTORY_DEPTH);
+    EXPECT_EQ(reading_history_raw(ch, 0), total - 1);
+    EXPECT_EQ(reading_history_raw(ch, READING_HISTORY_DEPTH - 1), total - READING_HISTORY_DEPTH);
+    
+    history_span_t span;
+    ASSERT_TRUE(reading_history_span(ch, &span));
+    EXPECT_EQ(span.first_count + span.second_count, READING_HISTORY_DEPTH);
+    int expected = total - READING_HISTORY_DEPTH;
+    for (int i = 0; i < span.first_count; i++) {
+        EXPECT_EQ(span.first[i], expected++);
+    }
+    for (int i = 0; i < span.second_count; i++) {
+        EXPECT_EQ(span.second[i], expected++);
+    }
+}
+
+/**
+ * @brief Fixed-point encoding rounds, clamps and decodes back
+ */
+TEST_F(ReadingHistoryTest, FixedPointEncoding) {
+    EXPECT_EQ(reading_history_encode(HISTORY_QTY_TEMPERATURE, 21.456f), 2146);
+    EXPECT_EQ(reading_history_encode(HISTORY_QTY_TEMPERATURE, -5.004f), -500);
+    EXPECT_EQ(reading_history_encode(HISTORY_QTY_TEMPERATURE, 500.0f), INT16_MAX);
+    EXPECT_EQ(reading_history_encode(HISTORY_QTY_LUX, 1000.0f), 500);
+    EXPECT_EQ(reading_history_encode(HISTORY_QTY_LUX, 65535.0f), INT16_MAX);
+    EXPECT_FLOAT_EQ(reading_history_decode(HISTORY_QTY_HUMIDITY, 5525), 55.25f);
+    EXPECT_FLOAT_EQ(reading_history_decode(HISTORY_QTY_LUX, 500), 1000.0f);
+}
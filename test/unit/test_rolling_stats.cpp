@@ -0,0 +1,151 @@
+/**
+ * @file test_rolling_stats.cpp
+ * @brief Unit Tests for Rolling Window Statistics
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <deque>
+#include <random>
+#include "rolling_stats.h"
+
+/** Bucket length of the short window */
+static const uint32_t k_short_bucket_s = ROLLING_STATS_SHORT_S / ROLLING_STATS_BUCKETS;
+
+/**
+ * @brief Test fixture with an empty series
+ */
+class RollingStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rolling_stats_init(&stats);
+    }
+
+    rolling_stats_t stats;
+};
+
+/**
+ * @brief Summaries of a few samples match the direct computation
+ */
+TEST_F(RollingStatsTest, SummarizesSamples) {
+    const int16_t samples[] = { 2100, 2150, 2080, 2210, 2190 };
+    for (int i = 0; i < 5; i++) {
+        rolling_stats_update(&stats, samples[i], 1000 + i);
+    }
+
+    rolling_summary_t summary;
+    ASSERT_TRUE(rolling_stats_summary(&stats, 0, 1004, &summary));
+    EXPECT_EQ(summary.count, 5u);
+    EXPECT_NEAR(summary.mean, 2146.0f, 0.01f);
+    EXPECT_NEAR(summary.stddev, 55.95f, 0.01f);
+    EXPECT_EQ(summary.min, 2080);
+    EXPECT_EQ(summary.max, 2210);
+
+    EXPECT_EQ(rolling_stats_window_seconds(0), (uint32_t)ROLLING_STATS_SHORT_S);
+    EXPECT_EQ(rolling_stats_window_seconds(ROLLING_STATS_WINDOWS), 0u);
+}
+
+/**
+ * @brief An empty series has no summary
+ */
+TEST_F(RollingStatsTest, EmptySeries) {
+    rolling_summary_t summary;
+    EXPECT_FALSE(rolling_stats_summary(&stats, 0, 1000, &summary));
+    EXPECT_EQ(summary.count, 0u);
+    EXPECT_FALSE(rolling_stats_summary(&stats, -1, 1000, &summary));
+}
+
+/**
+ * @brief Samples age out whole buckets at a time, also without new samples
+ */
+TEST_F(RollingStatsTest, AgesOutBuckets) {
+    uint32_t start = 100 * k_short_bucket_s;
+    rolling_stats_update(&stats, 5000, start);
+    for (uint32_t b = 1; b < ROLLING_STATS_BUCKETS; b++) {
+        rolling_stats_update(&stats, 100, start + b * k_short_bucket_s);
+    }
+
+    rolling_summary_t summary;
+    uint32_t last = start + (ROLLING_STATS_BUCKETS - 1) * k_short_bucket_s;
+    ASSERT_TRUE(rolling_stats_summary(&stats, 0, last, &summary));
+    EXPECT_EQ(summary.count, (uint32_t)ROLLING_STATS_BUCKETS);
+    EXPECT_EQ(summary.max, 5000);
+
+    // One bucket later the first sample is gone, with or without an update
+    ASSERT_TRUE(rolling_stats_summary(&stats, 0, last + k_short_bucket_s, &summary));
+    EXPECT_EQ(summary.count, (uint32_t)ROLLING_STATS_BUCKETS - 1);
+    EXPECT_EQ(summary.max, 100);
+    EXPECT_FLOAT_EQ(summary.stddev, 0.0f);
+
+    // The long window still holds everything
+    ASSERT_TRUE(rolling_stats_summary(&stats, 2, last + k_short_bucket_s, &summary));
+    EXPECT_EQ(summary.max, 5000);
+
+    // After a full window of silence the short window is empty
+    EXPECT_FALSE(rolling_stats_summary(&stats, 0, last + ROLLING_STATS_SHORT_S, &summary));
+}
+
+/**
+ * @brief Min, max, mean and deviation agree with a brute-force sliding window
+ */
+TEST_F(RollingStatsTest, MatchesBruteForce) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> value(-3000, 3000);
+    std::uniform_int_distribution<int> step(1, 40);
+    std::deque<std::pair<uint32_t, int16_t>> kept;
+
+    uint32_t now = 5000;
+    for (int i = 0; i < 3000; i++) {
+        now += step(rng);
+        int16_t sample = (int16_t)value(rng);
+        rolling_stats_update(&stats, sample, now);
+        kept.emplace_back(now, sample);
+
+        // The short window keeps the current bucket and the BUCKETS - 1 before it
+        uint32_t first_bucket = now / k_short_bucket_s - (ROLLING_STATS_BUCKETS - 1);
+        while (kept.front().first / k_short_bucket_s < first_bucket) {
+            kept.pop_front();
+        }
+
+        double sum = 0.0;
+        int16_t min = INT16_MAX;
+        int16_t max = INT16_MIN;
+        for (const auto &entry : kept) {
+            sum += entry.second;
+            min = std::min(min, entry.second);
+            max = std::max(max, entry.second);
+        }
+        double mean = sum / kept.size();
+        double squares = 0.0;
+        for (const auto &entry : kept) {
+            squares += (entry.second - mean) * (entry.second - mean);
+        }
+
+        rolling_summary_t summary;
+        ASSERT_TRUE(rolling_stats_summary(&stats, 0, now, &summary));
+        ASSERT_EQ(summary.count, kept.size()) << "sample " << i;
+        ASSERT_EQ(summary.min, min) << "sample " << i;
+        ASSERT_EQ(summary.max, max) << "sample " << i;
+        ASSERT_NEAR(summary.mean, mean, 0.05) << "sample " << i;
+        if (kept.size() > 1) {
+            ASSERT_NEAR(summary.stddev, std::sqrt(squares / (kept.size() - 1)), 0.05) << "sample " << i;
+        }
+    }
+}
+
+/**
+ * @brief A clock set back counts samples in the current bucket
+ */
+TEST_F(RollingStatsTest, ClockSetBack) {
+    rolling_stats_update(&stats, 10, 10000);
+    rolling_stats_update(&stats, 20, 9000);
+
+    rolling_summary_t summary;
+    ASSERT_TRUE(rolling_stats_summary(&stats, 0, 9000, &summary));
+    EXPECT_EQ(summary.count, 2u);
+    EXPECT_EQ(summary.max, 20);
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_sensor_diagnostics.cpp
+ * @brief Unit Tests for Sensor Self-Diagnostics
+ * 
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include "sensor_diagnostics.h"
+
+/**
+ * @brief Test fixture with three temperature channels (0.01 °C units)
+ */
+class SensorDiagnosticsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sensor_diagnostics_init();
+        sensor_diag_limits_t limits = {
+            .stuck_samples = 10,
+            .max_rate = 500,        // 5 °C per minute
+            .max_divergence = 200,  // 2 °C
+            .zero_may_stick = false,
+        };
+        for (int channel = 0; channel < 3; channel++) {
+            sensor_diagnostics_configure(channel, &limits);
+        }
+    }
+};
+
+/**
+ * @brief A value repeated for the configured number of samples is stuck
+ */
+TEST_F(SensorDiagnosticsTest, DetectsStuckValue) {
+    for (int i = 0; i < 9; i++) {
+        EXPECT_EQ(sensor_diagnostics_check(0, 2150, i * 30000), 0) << "sample " << i;
+    }
+    EXPECT_EQ(sensor_diagnostics_check(0, 2150, 9 * 30000), SENSOR_DIAG_STUCK);
+    
+    // Any change clears the condition
+    EXPECT_EQ(sensor_diagnostics_check(0, 2151, 10 * 30000), 0);
+}
+
+/**
+ * @brief Constant zero is only accepted where the limits allow it
+ */
+TEST_F(SensorDiagnosticsTest, ZeroMayStick) {
+    sensor_diag_limits_t limits = { .stuck_samples = 3, .max_rate = 0, .max_divergence = 0, .zero_may_stick = true };
+    sensor_diagnostics_configure(3, &limits);
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(sensor_diagnostics_check(3, 0, i * 30000), 0);
+    }
+    sensor_diagnostics_check(3, 40, 5 * 30000);
+    sensor_diagnostics_check(3, 40, 6 * 30000);
+    EXPECT_EQ(sensor_diagnostics_check(3, 40, 7 * 30000), SENSOR_DIAG_STUCK);
+}
+
+/**
+ * @brief Changes faster than the rate limit are flagged, scaled by elapsed time
+ */
+TEST_F(SensorDiagnosticsTest, DetectsImpossibleRate) {
+    EXPECT_EQ(sensor_diagnostics_check(0, 2000, 0), 0);
+    EXPECT_EQ(sensor_diagnostics_check(0, 2200, 30000), 0);                 // 2 °C in 30 s
+    EXPECT_EQ(sensor_diagnostics_check(0, 2500, 60000), SENSOR_DIAG_RATE);  // 3 °C in 30 s
+    EXPECT_EQ(sensor_diagnostics_check(0, 3400, 300000), 0);                // 9 °C in 4 min
+    
+    // Timestamps may wrap
+    EXPECT_EQ(sensor_diagnostics_check(1, 2000, UINT32_MAX - 9999), 0);
+    EXPECT_EQ(sensor_diagnostics_check(1, 2100, 20000), 0);
+}
+
+/**
+ * @brief A sensor drifting away from two siblings is flagged, the others are not
+ */
+TEST_F(SensorDiagnosticsTest, DetectsDivergentSibling) {
+    const int channels[] = { 0, 1, 2 };
+    uint8_t flags[3] = { 0 };
+    
+    // A single disagreement is averaged out
+    int16_t spike[] = { 2100, 2110, 2600 };
+    sensor_diagnostics_compare(channels, spike, 3, flags);
+    EXPECT_EQ(flags[2], 0);
+    
+    for (int i = 0; i < 30; i++) {
+        int16_t samples[] = { 2100, 2110, 2400 };
+        sensor_diagnostics_compare(channels, samples, 3, flags);
+    }
+    EXPECT_EQ(flags[0], 0);
+    EXPECT_EQ(flags[1], 0);
+    EXPECT_EQ(flags[2], SENSOR_DIAG_DIVERGENT);
+}
+
+/**
+ * @brief A pair cannot tell which one is wrong, so both are flagged when they drift apart
+ */
+TEST_F(SensorDiagnosticsTest, PairIsFlaggedTogether) {
+    const int channels[] = { 0, 1 };
+    uint8_t flags[2] = { SENSOR_DIAG_DIVERGENT, 0 };
+    
+    // Agreement within the limit clears the flag
+    for (int i = 0; i < 30; i++) {
+        int16_t samples[] = { 2100, 2250 };
+        sensor_diagnostics_compare(channels, samples, 2, flags);
+    }
+    EXPECT_EQ(flags[0], 0);
+    EXPECT_EQ(flags[1], 0);
+    
+    for (int i = 0; i < 30; i++) {
+        int16_t samples[] = { 2100, 2900 };
+        sensor_diagnostics_compare(channels, samples, 2, flags);
+    }
+    EXPECT_EQ(flags[0], SENSOR_DIAG_DIVERGENT);
+    EXPECT_EQ(flags[1], SENSOR_DIAG_DIVERGENT);
+}
+
+/**
+ * @brief Reset forgets the state but keeps the limits
+ */
+TEST_F(SensorDiagnosticsTest, ResetKeepsLimits) {
+    for (int i = 0; i < 9; i++) {
+        sensor_diagnostics_check(0, 2150, i * 30000);
+    }
+    sensor_diagnostics_reset(0);
+    EXPECT_EQ(sensor_diagnostics_check(0, 2150, 0), 0);
+    EXPECT_EQ(sensor_diagnostics_check(0, 9000, 30000), SENSOR_DIAG_RATE);
+}
+
+/**
+ * @brief Caller-owned state runs the same detectors as a channel
+ */
+TEST_F(SensorDiagnosticsTest, CallerOwnedState) {
+    sensor_diag_limits_t limits = { .stuck_samples = 3, .max_rate = 500, .max_divergence = 0, .zero_may_stick = false };
+    sensor_diag_state_t state;
+    sensor_diagnostics_state_init(&state, &limits);
+
+    // Five-minute samples, as in duty-cycle mode
+    EXPECT_EQ(sensor_diagnostics_update(&state, 2150, 0), 0);
+    EXPECT_EQ(sensor_diagnostics_update(&state, 2150, 300000), 0);
+    EXPECT_EQ(sensor_diagnostics_update(&state, 2150, 600000), SENSOR_DIAG_STUCK);
+    EXPECT_EQ(sensor_diagnostics_update(&state, 4150, 900000), 0);
+    EXPECT_EQ(sensor_diagnostics_update(&state, 9000, 1200000), SENSOR_DIAG_RATE);
+
+    // The module's own channels are untouched
+    EXPECT_EQ(sensor_diagnostics_check(0, 2150, 0), 0);
+}
+
+/**
+ * @brief Caller-owned state runs the same divergence detector as a channel
+ */
+TEST_F(SensorDiagnosticsTest, CallerOwnedPairIsFlaggedTogether) {
+    sensor_diag_limits_t limits = { .stuck_samples = 0, .max_rate = 0, .max_divergence = 200, .zero_may_stick = false };
+    sensor_diag_state_t pair[2];
+    sensor_diag_state_t *states[] = { &pair[0], &pair[1] };
+    sensor_diagnostics_state_init(&pair[0], &limits);
+    sensor_diagnostics_state_init(&pair[1], &limits);
+    uint8_t flags[2] = { 0, 0 };
+
+    for (int i = 0; i < 30; i++) {
+        int16_t samples[] = { 2100, 2250 };
+        sensor_diagnostics_compare_states(states, samples, 2, flags);
+    }
+    EXPECT_EQ(flags[0], 0);
+    EXPECT_EQ(flags[1], 0);
+
+    for (int i = 0; i < 30; i++) {
+        int16_t samples[] = { 2100, 2900 };
+        sensor_diagnostics_compare_states(states, samples, 2, flags);
+    }
+    EXPECT_EQ(flags[0], SENSOR_DIAG_DIVERGENT);
+    EXPECT_EQ(flags[1], SENSOR_DIAG_DIVERGENT);
+}
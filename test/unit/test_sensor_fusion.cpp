@@ -0,0 +1,134 @@
+/**
+ * @file test_sensor_fusion.cpp
+ * @brief Unit Tests for Sensor Fusion
+ * 
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include "sensor_fusion.h"
+
+/**
+ * @brief Test fixture with three air temperature sensors and a soil probe
+ */
+class SensorFusionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sensor_fusion_init();
+        for (int i = 0; i < 3; i++) {
+            air[i] = sensor_fusion_add_source(FUSION_AIR_TEMPERATURE, 0.3f);
+            ASSERT_GE(air[i], 0);
+        }
+        soil = sensor_fusion_add_source(FUSION_SOIL_TEMPERATURE, 0.5f);
+        ASSERT_GE(soil, 0);
+    }
+    
+    int air[3];
+    int soil;
+};
+
+/**
+ * @brief Equal sensors are averaged and the estimate beats a single sensor
+ */
+TEST_F(SensorFusionTest, CombinesEqualSensors) {
+    sensor_fusion_predict(30.0f);
+    EXPECT_TRUE(sensor_fusion_update(air[0], 21.0f));
+    EXPECT_TRUE(sensor_fusion_update(air[1], 21.4f));
+    EXPECT_TRUE(sensor_fusion_update(air[2], 21.2f));
+    
+    fusion_estimate_t estimate;
+    ASSERT_TRUE(sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate));
+    EXPECT_NEAR(estimate.value, 21.2f, 0.1f);
+    EXPECT_LT(estimate.sigma, 0.3f);
+    EXPECT_EQ(estimate.sources, 3);
+}
+
+/**
+ * @brief Air and soil temperature are estimated separately
+ */
+TEST_F(SensorFusionTest, SoilIsSeparateQuantity) {
+    sensor_fusion_predict(30.0f);
+    sensor_fusion_update(air[0], 24.0f);
+    sensor_fusion_update(soil, 15.0f);
+    
+    fusion_estimate_t estimate;
+    ASSERT_TRUE(sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate));
+    EXPECT_FLOAT_EQ(estimate.value, 24.0f);
+    ASSERT_TRUE(sensor_fusion_get(FUSION_SOIL_TEMPERATURE, &estimate));
+    EXPECT_FLOAT_EQ(estimate.value, 15.0f);
+    EXPECT_FALSE(sensor_fusion_get(FUSION_AIR_HUMIDITY, &estimate));
+}
+
+/**
+ * @brief A sensor drifting away from its siblings loses weight
+ */
+TEST_F(SensorFusionTest, DriftingSensorIsDownWeighted) {
+    for (int cycle = 0; cycle < 60; cycle++) {
+        sensor_fusion_predict(30.0f);
+        sensor_fusion_update(air[0], 21.0f);
+        sensor_fusion_update(air[1], 21.0f);
+        sensor_fusion_update(air[2], 21.0f + cycle * 0.05f);
+    }
+    
+    EXPECT_LT(sensor_fusion_get_weight(air[2]), 0.1f);
+    
+    // A plain average would read about 22 °C by now
+    fusion_estimate_t estimate;
+    ASSERT_TRUE(sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate));
+    EXPECT_NEAR(estimate.value, 21.0f, 0.2f);
+}
+
+/**
+ * @brief Missed readings lower a sensor's weight
+ */
+TEST_F(SensorFusionTest, FailingSensorIsDownWeighted) {
+    sensor_fusion_predict(30.0f);
+    sensor_fusion_miss(air[1]);
+    sensor_fusion_miss(air[1]);
+    
+    EXPECT_NEAR(sensor_fusion_get_weight(air[0]), sensor_fusion_get_weight(air[2]), 1e-6f);
+    EXPECT_LT(sensor_fusion_get_weight(air[1]), sensor_fusion_get_weight(air[0]) / 2.0f);
+}
+
+/**
+ * @brief Measurements far outside the gate are rejected
+ */
+TEST_F(SensorFusionTest, GateRejectsImpossibleValues) {
+    sensor_fusion_predict(30.0f);
+    ASSERT_TRUE(sensor_fusion_update(air[0], 21.0f));
+    EXPECT_FALSE(sensor_fusion_update(air[1], 85.0f));
+    
+    fusion_estimate_t estimate;
+    ASSERT_TRUE(sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate));
+    EXPECT_FLOAT_EQ(estimate.value, 21.0f);
+}
+
+/**
+ * @brief A saved state carries the estimates and noise models across a re-registration
+ */
+TEST_F(SensorFusionTest, RestoresSavedState) {
+    sensor_fusion_predict(30.0f);
+    sensor_fusion_update(air[0], 21.0f);
+    sensor_fusion_update(air[1], 21.2f);
+    sensor_fusion_miss(air[2]);
+    float weight = sensor_fusion_get_weight(air[2]);
+    sensor_fusion_state_t saved;
+    sensor_fusion_save(&saved);
+    
+    // Same sources registered again, as after a deep-sleep wakeup
+    SetUp();
+    ASSERT_TRUE(sensor_fusion_restore(&saved));
+    fusion_estimate_t estimate;
+    ASSERT_TRUE(sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate));
+    EXPECT_NEAR(estimate.value, 21.1f, 0.05f);
+    EXPECT_EQ(estimate.sources, 0);
+    EXPECT_FLOAT_EQ(sensor_fusion_get_weight(air[2]), weight);
+    
+    // A different set of sources does not take the state
+    sensor_fusion_init();
+    sensor_fusion_add_source(FUSION_AIR_HUMIDITY, 2.0f);
+    EXPECT_FALSE(sensor_fusion_restore(&saved));
+    EXPECT_FALSE(sensor_fusion_get(FUSION_AIR_TEMPERATURE, &estimate));
+}
@@ -0,0 +1,147 @@
+/**
+ * @file test_sensor_topology.cpp
+ * @brief Unit Tests for the Compile-Time Sensor Topology
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "sensor_topology.h"
+
+// Fake typed readers: record the read order and return canned readings
+static std::vector<int> g_reads;
+static sensor_reading_t g_canned[SENSOR_INTERFACE_MAX_SENSORS];
+
+static esp_err_t fake_read(int index, const sensor_config_t *config, sensor_reading_t *reading)
+{
+    g_reads.push_back(index);
+    *reading = g_canned[index];
+    return reading->valid ? ESP_OK : ESP_FAIL;
+}
+
+extern "C" {
+    esp_err_t sensor_interface_read_aht10(int index, const sensor_config_t *config, sensor_reading_t *reading)
+    {
+        EXPECT_EQ(config->type, SENSOR_TYPE_AHT10);
+        return fake_read(index, config, reading);
+    }
+    esp_err_t sensor_interface_read_ds18b20(int index, const sensor_config_t *config, sensor_reading_t *reading)
+    {
+        EXPECT_EQ(config->type, SENSOR_TYPE_DS18B20);
+        return fake_read(index, config, reading);
+    }
+    esp_err_t sensor_interface_read_gy302(int index, const sensor_config_t *config, sensor_reading_t *reading)
+    {
+        EXPECT_EQ(config->type, SENSOR_TYPE_GY302);
+        return fake_read(index, config, reading);
+    }
+    esp_err_t sensor_interface_read_soil_moisture(int index, const sensor_config_t *config, sensor_reading_t *reading)
+    {
+        EXPECT_EQ(config->type, SENSOR_TYPE_SOIL_MOISTURE);
+        return fake_read(index, config, reading);
+    }
+    esp_err_t sensor_interface_read_light(int index, const sensor_config_t *config, sensor_reading_t *reading)
+    {
+        EXPECT_EQ(config->type, SENSOR_TYPE_LIGHT);
+        return fake_read(index, config, reading);
+    }
+    void trace_record(trace_phase_t phase, trace_event_id_t event_id, uint16_t arg)
+    {
+    }
+}
+
+static constexpr char k_air1[] = "AHT10-1";
+static constexpr char k_air2[] = "AHT10-2";
+static constexpr char k_probe[] = "DS18B20";
+static constexpr char k_lux[] = "GY-302";
+static constexpr char k_soil[] = "Soil";
+static constexpr char k_light[] = "Light";
+
+// Two AHT10s behind different channels of one multiplexer, listed out of order
+using test_topology = sensor_topology::topology<
+    sensor_topology::aht10<0x38, k_air1, 0x70, 3>,
+    sensor_topology::ds18b20<4, k_probe>,
+    sensor_topology::aht10<0x38, k_air2, 0x70, 1>,
+    sensor_topology::gy302<0x23, k_lux>,
+    sensor_topology::soil_moisture<k_soil>,
+    sensor_topology::light<k_light>>;
+
+/**
+ * @brief Test fixture with valid canned readings
+ */
+class SensorTopologyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        g_reads.clear();
+        memset(g_canned, 0, sizeof(g_canned));
+        for (int i = 0; i < test_topology::count; i++) {
+            g_canned[i].valid = true;
+        }
+        g_canned[0].temperature = 20.0f;
+        g_canned[0].humidity = 50.0f;
+        g_canned[1].temperature = 15.0f;
+        g_canned[2].temperature = 22.0f;
+        g_canned[2].humidity = 60.0f;
+        g_canned[3].lux = 1000.0f;
+        g_canned[4].soil_moisture = 2000;
+        g_canned[5].light_level = 300;
+    }
+
+    sensor_reading_t readings[SENSOR_INTERFACE_MAX_SENSORS];
+};
+
+/**
+ * @brief The generated table matches the type list
+ */
+TEST_F(SensorTopologyTest, GeneratesSensorTable) {
+    static_assert(test_topology::count == 6, "count");
+    static_assert(test_topology::sensors[2].mux_channel == 1, "mux channel");
+
+    EXPECT_EQ(test_topology::sensors[0].type, SENSOR_TYPE_AHT10);
+    EXPECT_EQ(test_topology::sensors[1].pin, 4);
+    EXPECT_EQ(test_topology::sensors[3].address, 0x23);
+    EXPECT_EQ(test_topology::sensors[3].i2c_freq, (uint32_t)I2C_FAST_MODE_FREQ_HZ);
+    EXPECT_STREQ(test_topology::sensors[4].name, "Soil");
+    for (int i = 0; i < test_topology::count; i++) {
+        EXPECT_TRUE(test_topology::sensors[i].enabled);
+    }
+}
+
+/**
+ * @brief Main bus sensors are read first, then one run per multiplexer channel
+ */
+TEST_F(SensorTopologyTest, ReadsInChannelOrder) {
+    EXPECT_EQ(test_topology::read_all(readings), test_topology::count);
+    EXPECT_EQ(g_reads, (std::vector<int>{1, 3, 4, 5, 2, 0}));
+    EXPECT_FLOAT_EQ(readings[2].humidity, 60.0f);
+}
+
+/**
+ * @brief Failed reads are not counted
+ */
+TEST_F(SensorTopologyTest, CountsValidReadings) {
+    g_canned[3].valid = false;
+    EXPECT_EQ(test_topology::read_all(readings), test_topology::count - 1);
+}
+
+/**
+ * @brief Quantities are averaged per sensor type, leaving out suspect readings
+ */
+TEST_F(SensorTopologyTest, ScoresByType) {
+    test_topology::read_all(readings);
+    readings[4].quality_flags = SENSOR_QUALITY_STUCK;
+
+    health_inputs_t inputs = {};
+    test_topology::score(readings, &inputs);
+
+    EXPECT_EQ(inputs.value[HISTORY_QTY_TEMPERATURE], reading_history_encode(HISTORY_QTY_TEMPERATURE, 21.0f));
+    EXPECT_EQ(inputs.value[HISTORY_QTY_HUMIDITY], reading_history_encode(HISTORY_QTY_HUMIDITY, 55.0f));
+    EXPECT_EQ(inputs.value[HISTORY_QTY_LUX], reading_history_encode(HISTORY_QTY_LUX, 1000.0f));
+    EXPECT_EQ(inputs.value[HISTORY_QTY_LIGHT_LEVEL], 300);
+    EXPECT_FALSE(inputs.present & (1 << HISTORY_QTY_SOIL_MOISTURE));
+    EXPECT_TRUE(inputs.present & (1 << HISTORY_QTY_TEMPERATURE));
+}
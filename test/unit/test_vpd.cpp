@@ -0,0 +1,78 @@
+/**
+ * @file test_vpd.cpp
+ * @brief Unit Tests for Vapour Pressure Deficit and Dew Point
+ *
+ * @author Plant Monitor System
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "vpd.h"
+
+/** Magnus formula the table is built from, in Pa */
+static double saturation(double celsius)
+{
+    return 610.94 * std::exp(17.625 * celsius / (celsius + 243.04));
+}
+
+/**
+ * @brief The table matches the formula over the whole range
+ */
+TEST(VpdTest, MatchesSaturationFormula) {
+    for (int32_t t = VPD_TABLE_MIN; t <= VPD_TABLE_MAX; t += 7) {
+        double expected = saturation(t / 100.0);
+        ASSERT_NEAR(vpd_saturation_pressure(t), expected, 6.0) << "temperature " << t;
+    }
+
+    EXPECT_EQ(vpd_saturation_pressure(2000), 2333);
+    EXPECT_EQ(vpd_saturation_pressure(VPD_TABLE_MIN - 1000), vpd_saturation_pressure(VPD_TABLE_MIN));
+    EXPECT_EQ(vpd_saturation_pressure(VPD_TABLE_MAX + 1000), vpd_saturation_pressure(VPD_TABLE_MAX));
+}
+
+/**
+ * @brief Air VPD is the unsaturated share of the saturation pressure
+ */
+TEST(VpdTest, ComputesAirDeficit) {
+    // 25 °C at 60 %: 3.17 kPa saturated, 1.27 kPa deficit
+    EXPECT_NEAR(vpd_air(2500, 6000), 0.4 * saturation(25.0), 3.0);
+    EXPECT_EQ(vpd_air(2500, 10000), 0);
+    EXPECT_EQ(vpd_air(2500, 12000), 0);
+    EXPECT_EQ(vpd_air(2500, 0), vpd_saturation_pressure(2500));
+    EXPECT_EQ(vpd_air(2500, 6000) + vpd_vapour_pressure(2500, 6000), vpd_saturation_pressure(2500));
+}
+
+/**
+ * @brief Leaf VPD uses the leaf's own saturation pressure
+ */
+TEST(VpdTest, ComputesLeafDeficit) {
+    EXPECT_EQ(vpd_leaf(2500, 2500, 6000), vpd_air(2500, 6000));
+
+    // A transpiring leaf 2 °C below the air sees a smaller deficit
+    int32_t cooler = vpd_leaf(2300, 2500, 6000);
+    EXPECT_LT(cooler, vpd_air(2500, 6000));
+    EXPECT_NEAR(cooler, saturation(23.0) - 0.6 * saturation(25.0), 3.0);
+
+    // Below the dew point water condenses on the leaf
+    EXPECT_LT(vpd_leaf(1000, 2500, 8000), 0);
+}
+
+/**
+ * @brief The dew point matches the inverted formula
+ */
+TEST(VpdTest, ComputesDewPoint) {
+    for (int32_t t = -1000; t <= 4500; t += 250) {
+        for (int32_t rh = 1000; rh <= 10000; rh += 500) {
+            double gamma = std::log(rh / 10000.0) + 17.625 * (t / 100.0) / (t / 100.0 + 243.04);
+            double expected = 243.04 * gamma / (17.625 - gamma);
+            if (expected * 100.0 < VPD_TABLE_MIN + 500) {
+                continue;
+            }
+            ASSERT_NEAR(vpd_dew_point(t, rh) / 100.0, expected, 0.15) << "temperature " << t << " humidity " << rh;
+        }
+    }
+
+    EXPECT_NEAR(vpd_dew_point(2500, 10000), 2500, 5);
+    EXPECT_EQ(vpd_dew_point(2500, 0), VPD_TABLE_MIN);
+}
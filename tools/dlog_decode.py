@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""
+Plant Monitor - Deferred Log Decoder
+====================================
+
+Formats the DLOG: token lines printed by the firmware when
+DLOG_BINARY_OUTPUT is enabled (see src/diagnostics/dlog.c). The format
+table is read straight from src/diagnostics/dlog_formats.h, so the
+decoder always matches the firmware built from the same tree.
+
+Lines that are not DLOG tokens are passed through unchanged, so the
+decoder can sit in a pipe behind the serial monitor:
+
+    pio device monitor | python3 tools/dlog_decode.py
+    python3 tools/dlog_decode.py serial.log > decoded.log
+
+Author: Plant Monitor System
+Version: 1.0.0
+Date: 2024
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+from typing import List, NamedTuple, Optional
+
+DEFAULT_FORMATS = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                               "..", "src", "diagnostics", "dlog_formats.h")
+
+FORMAT_ENTRY = re.compile(
+    r'DLOG_FORMAT\(\s*(\w+)\s*,\s*ESP_LOG_(\w+)\s*,\s*"([^"]*)"\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+CONVERSION = re.compile(r'%([-+ #0-9.]*)[hlzjt]*([diuxXcfeEgGs%])')
+LEVEL_LETTERS = {"ERROR": "E", "WARN": "W", "INFO": "I", "DEBUG": "D", "VERBOSE": "V"}
+
+
+class LogFormat(NamedTuple):
+    """One entry of the firmware format table"""
+    name: str
+    level: str
+    tag: str
+    format: str
+    conversions: List[str]
+
+
+def unescape_c(text: str) -> str:
+    """Resolve the simple C escape sequences used in format strings"""
+    return (text.replace('\\n', '\n').replace('\\t', '\t')
+                .replace('\\"', '"').replace('\\\\', '\\'))
+
+
+def load_formats(path: str) -> List[LogFormat]:
+    """
+    Load the format table in declaration order
+
+    Args:
+        path: Path to dlog_formats.h
+
+    Returns:
+        List of formats indexed by token
+    """
+    with open(path, "r", encoding="utf-8") as header:
+        source = header.read()
+
+    formats = []
+    for name, level, tag, fmt in FORMAT_ENTRY.findall(source):
+        fmt = unescape_c(fmt)
+        conversions = [conv for _, conv in CONVERSION.findall(fmt) if conv != '%']
+        python_fmt = CONVERSION.sub(lambda m: '%' + m.group(1) + m.group(2), fmt)
+        formats.append(LogFormat(name, LEVEL_LETTERS.get(level, "I"), tag, python_fmt, conversions))
+    return formats
+
+
+def decode_line(line: str, formats: List[LogFormat]) -> Optional[str]:
+    """
+    Decode one DLOG token line
+
+    Args:
+        line: Line containing a DLOG: token
+        formats: Format table
+
+    Returns:
+        Formatted log line, or None if the line is not a valid token
+    """
+    marker = line.find("DLOG:")
+    if marker < 0:
+        return None
+
+    fields = line[marker + len("DLOG:"):].strip().split(":")
+    try:
+        timestamp = int(fields[0], 16)
+        entry = formats[int(fields[1])]
+    except (IndexError, ValueError):
+        return None
+
+    values = []
+    for conversion, field in zip(entry.conversions, fields[2:]):
+        if conversion == 's':
+            values.append(bytes.fromhex(field[1:]).decode("utf-8", errors="replace"))
+            continue
+        word = int(field, 16)
+        if conversion in "feEgG":
+            values.append(struct.unpack("<f", struct.pack("<I", word))[0])
+        elif conversion in "di":
+            values.append(word - (1 << 32) if word & 0x80000000 else word)
+        else:
+            values.append(word)
+
+    try:
+        message = entry.format % tuple(values)
+    except (TypeError, ValueError):
+        message = f"<{entry.name}: undecodable arguments {fields[2:]}>"
+
+    return f"{entry.level} ({timestamp}) {entry.tag}: {message}"
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Decode plant monitor deferred log tokens")
+    parser.add_argument("log", nargs="?", default="-", help="Serial log to decode (default: stdin)")
+    parser.add_argument("--formats", default=DEFAULT_FORMATS, help="Path to dlog_formats.h")
+    args = parser.parse_args()
+
+    formats = load_formats(args.formats)
+    if not formats:
+        print(f"No DLOG_FORMAT entries found in {args.formats}", file=sys.stderr)
+        return 1
+
+    stream = sys.stdin if args.log == "-" else open(args.log, "r", errors="replace")
+    with stream:
+        for line in stream:
+            decoded = decode_line(line, formats)
+            sys.stdout.write(decoded + "\n" if decoded is not None else line)
+            sys.stdout.flush()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
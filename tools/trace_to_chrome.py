@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+Plant Monitor - Trace Converter
+===============================
+
+Converts a trace ring dump captured from the ESP32 serial console into
+Chrome trace JSON, which can be opened in chrome://tracing or
+https://ui.perfetto.dev.
+
+The firmware prints the dump as lines prefixed with "TRACE:" (see
+src/diagnostics/trace.c). Anything else in the log is ignored, so a raw
+`pio device monitor` capture can be passed in directly.
+
+Usage:
+    python3 tools/trace_to_chrome.py serial.log -o trace.json
+    python3 tools/trace_to_chrome.py serial.log --dump 0 -o first.json
+
+Author: Plant Monitor System
+Version: 1.0.0
+Date: 2024
+"""
+
+import argparse
+import json
+import struct
+import sys
+from typing import Any, Dict, List, TextIO
+
+EVENT_FORMAT = "<IBBH"  # timestamp_us, event_id, phase_track, arg
+EVENT_SIZE = struct.calcsize(EVENT_FORMAT)
+PHASES = {0: "B", 1: "E", 2: "i"}
+TIMESTAMP_WRAP = 1 << 32
+
+
+def parse_dumps(stream: TextIO) -> List[Dict[str, Any]]:
+    """
+    Extract every trace dump contained in a serial log
+
+    Args:
+        stream: Text stream with the captured serial output
+
+    Returns:
+        List of dumps with names, tracks and raw event bytes
+    """
+    dumps: List[Dict[str, Any]] = []
+    current = None
+
+    for line in stream:
+        marker = line.find("TRACE:")
+        if marker < 0:
+            continue
+        fields = line[marker + len("TRACE:"):].strip().split(" ", 2)
+        kind = fields[0]
+
+        if kind == "BEGIN":
+            current = {
+                "version": int(fields[1]),
+                "overwritten": int(fields[2].split()[1]) if len(fields) > 2 else 0,
+                "names": {},
+                "tracks": {},
+                "data": bytearray(),
+            }
+        elif current is None:
+            continue
+        elif kind == "NAME":
+            current["names"][int(fields[1])] = fields[2]
+        elif kind == "TRACK":
+            current["tracks"][int(fields[1])] = fields[2]
+        elif kind == "DATA":
+            current["data"].extend(bytes.fromhex(fields[1]))
+        elif kind == "END":
+            dumps.append(current)
+            current = None
+
+    return dumps
+
+
+def convert_dump(dump: Dict[str, Any]) -> Dict[str, Any]:
+    """
+    Convert one dump into a Chrome trace document
+
+    Timestamps are unwrapped across 32-bit rollovers. End events whose
+    begin was overwritten in the ring are dropped so every track nests
+    correctly.
+
+    Args:
+        dump: Dump as returned by parse_dumps()
+
+    Returns:
+        Chrome trace JSON object
+    """
+    events: List[Dict[str, Any]] = []
+    open_spans: Dict[int, List[int]] = {}
+    epoch = 0
+    last_ts = None
+
+    data = dump["data"]
+    for offset in range(0, len(data) - EVENT_SIZE + 1, EVENT_SIZE):
+        ts, event_id, phase_track, arg = struct.unpack_from(EVENT_FORMAT, data, offset)
+        phase = PHASES.get(phase_track & 0x03)
+        track = phase_track >> 2
+        if phase is None:
+            continue
+
+        if last_ts is not None and ts < last_ts and last_ts - ts > TIMESTAMP_WRAP // 2:
+            epoch += TIMESTAMP_WRAP
+        last_ts = ts
+
+        stack = open_spans.setdefault(track, [])
+        if phase == "B":
+            stack.append(event_id)
+        elif phase == "E":
+            if event_id not in stack:
+                continue
+            while stack and stack.pop() != event_id:
+                pass
+
+        event = {
+            "name": dump["names"].get(event_id, f"event_{event_id}"),
+            "ph": phase,
+            "ts": epoch + ts,
+            "pid": 1,
+            "tid": track,
+            "args": {"arg": arg},
+        }
+        if phase == "i":
+            event["s"] = "t"
+        events.append(event)
+
+    metadata = [{"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "plant_monitor"}}]
+    for track, name in sorted(dump["tracks"].items()):
+        metadata.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": track,
+                         "args": {"name": name}})
+
+    return {
+        "traceEvents": metadata + events,
+        "displayTimeUnit": "ms",
+        "otherData": {"overwritten_events": dump["overwritten"]},
+    }
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Convert a plant monitor trace dump to Chrome trace JSON")
+    parser.add_argument("log", help="Serial log containing TRACE: lines ('-' for stdin)")
+    parser.add_argument("-o", "--output", default="-", help="Output JSON file ('-' for stdout)")
+    parser.add_argument("--dump", type=int, default=-1, help="Index of the dump to convert (default: last)")
+    args = parser.parse_args()
+
+    stream = sys.stdin if args.log == "-" else open(args.log, "r", errors="replace")
+    with stream:
+        dumps = parse_dumps(stream)
+
+    if not dumps:
+        print("No complete trace dump found in input", file=sys.stderr)
+        return 1
+
+    try:
+        trace = convert_dump(dumps[args.dump])
+    except IndexError:
+        print(f"Dump index {args.dump} out of range ({len(dumps)} dumps found)", file=sys.stderr)
+        return 1
+
+    if args.output == "-":
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, "w") as out:
+            json.dump(trace, out)
+        print(f"Wrote {len(trace['traceEvents'])} events to {args.output}", file=sys.stderr)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())